@@ -0,0 +1,115 @@
+#ifndef ASYNC_DETECTOR_H
+#define ASYNC_DETECTOR_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "DetectorPool.h"
+#include "JsonConfigManager.h"
+
+// 异步请求的结束状态
+enum class AsyncStatus {
+    Completed,   // 检测完成
+    Rejected,    // 提交时在途请求已达上限（reject策略或wait超时）
+    Cancelled,   // 排队期间被cancel
+    Failed       // 检测器停止或执行出错
+};
+
+// detectAsync返回的future在请求未完成时抛出该异常
+class AsyncDetectError : public std::runtime_error {
+public:
+    explicit AsyncDetectError(AsyncStatus status);
+    AsyncStatus status() const { return status_; }
+
+private:
+    AsyncStatus status_;
+};
+
+struct AsyncStats {
+    uint64_t submitted = 0;          // 被接受的请求数
+    uint64_t completed = 0;
+    uint64_t rejected = 0;
+    uint64_t cancelled = 0;
+    uint64_t failed = 0;
+    size_t in_flight = 0;            // 当前排队与执行中的请求数
+    size_t peak_in_flight = 0;       // 在途请求数的峰值（不超过max_in_flight）
+};
+
+// 异步检测：请求进入有界队列，由每个会话一个的工作线程从DetectorPool租用会话执行
+// 完整的detect（预处理、推理、后处理都不占用提交方线程）。
+// - 背压：排队与执行中的请求总数不超过max_in_flight，达到上限时按overflow阻塞提交方或立即拒绝，
+//   在途图像与结果占用的内存因此有上界
+// - 取消：尚未开始执行的请求可按编号或全部取消，已开始的请求照常完成
+// - 完成回调在工作线程上调用，不应长时间阻塞；future版本在回调中设置结果
+// 图像按cv::Mat引用计数保留，请求完成前调用方不应改写其像素（复用采集缓冲区时先clone）。
+class AsyncDetector {
+public:
+    using Callback = std::function<void(uint64_t id, AsyncStatus status, std::vector<DetectionResult>& results)>;
+
+    AsyncDetector();
+    ~AsyncDetector();
+
+    // 按model/detection/async配置创建async.sessions个会话的检测器池
+    bool initialize(JsonConfigManager& config_manager);
+
+    // 使用调用方的检测器池（不获取所有权），工作线程数等于池的会话数
+    bool initialize(DetectorPool& pool, const AsyncConfig& config);
+
+    // 提交一个请求，返回请求编号；被拒绝时返回0，此时回调以Rejected状态在提交线程上立即调用
+    uint64_t submit(const cv::Mat& image, Callback callback);
+
+    // future版本：完成时得到检测结果，被拒绝/取消/失败时get()抛出AsyncDetectError
+    // id非空时写入请求编号（被拒绝时为0），供cancel使用
+    std::future<std::vector<DetectionResult>> detectAsync(const cv::Mat& image, uint64_t* id = nullptr);
+
+    // 取消仍在排队的请求，返回是否取消成功（已开始执行或已结束时返回false）
+    bool cancel(uint64_t id);
+
+    // 取消所有排队中的请求，返回取消的数量
+    size_t cancelAll();
+
+    // 阻塞直到没有在途请求
+    void waitIdle();
+
+    // 取消排队中的请求，等待执行中的请求完成后停止工作线程
+    void stop();
+
+    AsyncStats getStats() const;
+    const AsyncConfig& getConfig() const { return config_; }
+
+private:
+    struct Request {
+        uint64_t id = 0;
+        cv::Mat image;
+        Callback callback;
+    };
+
+    void workerLoop();
+    void finish(Request& request, AsyncStatus status, std::vector<DetectionResult>& results);
+
+    AsyncConfig config_;
+    bool reject_;                        // overflow为reject
+    std::unique_ptr<DetectorPool> owned_pool_;
+    DetectorPool* pool_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_ready_;  // 有新请求或停止
+    std::condition_variable space_ready_; // 有请求结束（在途数减少）或停止
+    std::deque<Request> queue_;
+    uint64_t next_id_;
+    bool running_;                        // 工作线程运行中，接受新请求
+    AsyncStats stats_;
+};
+
+#endif // ASYNC_DETECTOR_H
@@ -0,0 +1,73 @@
+#ifndef DETECTOR_POOL_H
+#define DETECTOR_POOL_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+
+// 线程安全的检测器池：M个ObjectDetector会话共享一个Ort::Env（可选全局线程池），
+// 调用方通过无锁空闲栈租用会话，同一进程内即可在多核上并发detect，
+// 无需每核一个进程、每个进程各加载一份模型。
+class DetectorPool {
+public:
+    // 租用的会话，析构时自动归还
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        explicit operator bool() const { return pool_ != nullptr; }
+        ObjectDetector* operator->() const;
+        ObjectDetector& operator*() const;
+
+        void release();
+
+    private:
+        friend class DetectorPool;
+        Lease(DetectorPool* pool, int index) : pool_(pool), index_(index) {}
+
+        DetectorPool* pool_ = nullptr;
+        int index_ = -1;
+    };
+
+    DetectorPool();
+    ~DetectorPool();
+
+    // 按model/pool配置创建会话；sessions <= 0 时使用pool.sessions
+    bool initialize(JsonConfigManager& config_manager, int sessions = 0);
+
+    // 阻塞直到有空闲会话（自旋后退避）
+    Lease acquire();
+
+    // 无空闲会话时返回空Lease
+    Lease tryAcquire();
+
+    // 租用一个会话完成检测后立即归还，可从任意线程调用
+    std::vector<DetectionResult> detect(const cv::Mat& image);
+    // 未初始化或推理失败时返回false
+    bool detect(const cv::Mat& image, std::vector<DetectionResult>& results);
+
+    int size() const { return static_cast<int>(detectors_.size()); }
+
+private:
+    // Treiber栈：head_高32位为版本号（防ABA），低32位为栈顶索引+1（0表示空）
+    int popFree();
+    void pushFree(int index);
+
+    std::shared_ptr<Ort::Env> env_;
+    std::vector<std::unique_ptr<ObjectDetector>> detectors_;
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;  // 栈中下一个元素的索引+1
+    std::atomic<uint64_t> head_;
+};
+
+#endif // DETECTOR_POOL_H
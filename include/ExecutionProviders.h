@@ -0,0 +1,53 @@
+#ifndef EXECUTION_PROVIDERS_H
+#define EXECUTION_PROVIDERS_H
+
+#include <onnxruntime_cxx_api.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// 一个执行提供者及其选项（ORT的提供者选项均为字符串键值对）
+struct ProviderSpec {
+    std::string name;                              // 规范名称：cpu、cuda、xnnpack、dnnl、openvino，或auto
+    std::map<std::string, std::string> options;
+};
+
+// 执行提供者的注册与选择：
+// - 配置中的名称不区分大小写，"onednn"等同"dnnl"
+// - 列表按顺序追加到会话选项，ORT按该优先级分配算子，未被认领的算子回退到CPU（CPU始终隐式位于最后）
+// - 当前ORT构建未编译的提供者、追加失败的提供者被跳过并给出警告，不会导致初始化失败
+// - auto模式的选择结果按模型/主机指纹在进程内记忆，并可写入缓存文件，重启后跳过测量
+class ExecutionProviders {
+public:
+    static std::string canonicalName(const std::string& name);
+
+    // 由配置得到提供者列表；providers为空时按旧的device_type（"GPU"为cuda，否则cpu）
+    static std::vector<ProviderSpec> fromConfig(const std::vector<std::string>& providers,
+                                                const std::map<std::string, std::map<std::string, std::string>>& options,
+                                                const std::string& device_type);
+
+    static bool isAuto(const std::vector<ProviderSpec>& providers);
+
+    // 当前ORT构建中编译进来的已知提供者（规范名称）
+    static std::vector<std::string> available();
+    static bool isAvailable(const std::string& name);
+
+    // 按顺序追加到session_options，返回实际生效的提供者（末尾总是cpu）
+    static std::vector<std::string> append(Ort::SessionOptions& session_options,
+                                           const std::vector<ProviderSpec>& providers);
+
+    // 优化后模型缓存文件名中的提供者标签：实际生效的提供者按顺序以'-'连接（如"xnnpack-cpu"），
+    // 生效的提供者带选项时再附加选项的哈希；不同提供者融合出的图不同，不能共用一份缓存
+    static std::string cacheTag(const std::vector<ProviderSpec>& providers, const std::vector<std::string>& active);
+
+    // 模型文件（路径、大小、修改时间）、主机（主机名、CPU型号、硬件线程数）、ORT版本与可用提供者，
+    // 再加上调用方给出的影响速度的设置，哈希为十六进制字符串
+    static std::string fingerprint(const std::string& model_path, const std::string& settings);
+
+    // 查询/记录auto模式的选择；cache_path为空时只使用进程内的记忆
+    static bool lookupChoice(const std::string& cache_path, const std::string& fingerprint, std::string& provider);
+    static void storeChoice(const std::string& cache_path, const std::string& fingerprint, const std::string& provider,
+                            double latency_ms);
+};
+
+#endif // EXECUTION_PROVIDERS_H
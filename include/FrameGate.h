@@ -0,0 +1,75 @@
+#ifndef FRAME_GATE_H
+#define FRAME_GATE_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+
+struct GateStats {
+    uint64_t frames = 0;             // 已处理帧数
+    uint64_t inferred = 0;           // 执行了完整检测的帧数
+    uint64_t cached = 0;             // 直接返回缓存结果的帧数
+    uint64_t motion_triggers = 0;    // 因监测区域变化而推理的帧数
+    uint64_t stale_refreshes = 0;    // 画面未变但缓存已超过时效而推理的帧数
+    uint64_t failed = 0;             // 推理出错的帧数（不计入inferred）
+    float last_changed_ratio = 0.0f; // 最近一帧与参考帧相比的变化像素比例
+    float last_mean_diff = 0.0f;     // 最近一帧与参考帧相比的平均灰度差
+
+    double hitRate() const { return frames > 0 ? static_cast<double>(cached) / frames : 0.0; }
+};
+
+// 帧门控：在detect之前比较当前帧与上次推理帧的指纹（缩小后的灰度缩略图），
+// 画面几乎不变时直接返回上次的检测结果，固定摄像头的静止画面不再逐帧运行模型。
+// - 指纹差异由SIMD内核计算：监测区域内灰度差超过pixel_threshold的像素比例与平均灰度差
+// - 监测区域掩码：只有掩码内的变化才触发推理（如只关注出入口，忽略摇动的树木与时间水印）
+// - 参考帧始终是最近一次推理的帧，缓慢的累积变化最终也会触发推理
+// - 时效上限：缓存结果复用超过max_stale_frames帧或max_stale_ms毫秒后强制推理一次
+class FrameGate {
+public:
+    FrameGate();
+    ~FrameGate();
+
+    // 按model/detection/gate配置创建检测器
+    bool initialize(JsonConfigManager& config_manager);
+
+    // 使用调用方的检测器，不获取所有权
+    void initialize(ObjectDetector& detector, const GateConfig& config);
+
+    // 设置监测区域：任意尺寸的单通道图像，非零为监测区域（缩放到指纹尺寸）；空图像表示监测整帧
+    void setMask(const cv::Mat& mask);
+
+    // 处理下一帧，返回本帧是否执行了完整检测
+    // 推理出错时results为空并返回false，参考帧与缓存结果保持不变，下一帧照常判断是否需要推理
+    bool process(const cv::Mat& frame, std::vector<DetectionResult>& results);
+
+    // 丢弃参考帧与缓存结果，下一帧重新检测（切换视频源时调用）
+    void reset();
+
+    const GateStats& getStats() const { return stats_; }
+    const GateConfig& getConfig() const { return config_; }
+
+private:
+    void fingerprint(const cv::Mat& frame, cv::Mat& thumbnail);
+
+    GateConfig config_;
+    std::unique_ptr<ObjectDetector> owned_detector_;
+    ObjectDetector* detector_;
+    cv::Mat mask_;                       // 指纹尺寸的0/255掩码
+    int mask_pixels_;                    // 掩码内的像素数
+    cv::Mat reference_;                  // 最近一次推理帧的指纹，为空表示尚未推理
+    cv::Mat thumbnail_;
+    cv::Mat small_bgr_;
+    cv::Size reference_frame_size_;
+    std::vector<DetectionResult> cached_;
+    std::vector<DetectionResult> detected_;  // 本次推理的结果，成功后与cached_交换
+    int frames_since_inference_;
+    std::chrono::steady_clock::time_point inferred_at_;
+    GateStats stats_;
+};
+
+#endif // FRAME_GATE_H
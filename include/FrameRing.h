@@ -0,0 +1,73 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+#include "InferenceProtocol.h"
+#include "SharedRing.h"
+
+// 同机进程之间经共享内存交换原始BGR帧与检测结果：一个帧环（生产方 -> 检测进程）
+// 与一个结果环（检测进程 -> 生产方），均为SharedRing。
+// 帧直接写入/读出共享内存槽位，不经过编码、文件或socket，检测进程把槽位包装为cv::Mat头直接detect。
+// 结果环使用与帧环相同的溢出策略：block模式下生产方需要及时读取结果，否则检测进程会等待结果槽位。
+
+// 检测进程一端：创建两个环，读取帧并写回结果
+class FrameRingReader {
+public:
+    bool create(const ShmRingConfig& config);
+    void close();
+
+    // 取得下一帧：frame为指向共享内存槽位的cv::Mat头（无拷贝），在releaseFrame或下一次nextFrame前有效
+    // 超时或生产方已关闭且没有剩余帧时返回false；类型不是CV_8UC3或尺寸超出槽位的帧被丢弃
+    bool nextFrame(cv::Mat& frame, uint64_t& frame_id, int timeout_ms = -1);
+    void releaseFrame();
+
+    // 写回frame_id对应的结果，超过max_detections的部分被截断
+    bool writeResults(uint64_t frame_id, const std::vector<DetectionResult>& results, int timeout_ms = -1);
+
+    // 生产方已调用FrameRingWriter::close
+    bool producerClosed() const { return frames_.closed(); }
+
+    RingStats frameStats() const { return frames_.getStats(); }
+    RingStats resultStats() const { return results_.getStats(); }
+
+private:
+    SharedRing frames_;
+    SharedRing results_;
+    SharedRing::Slot current_;
+    int max_detections_ = 0;
+};
+
+// 生产方一端（如解码进程）：打开检测进程创建的环，写入帧并读取结果
+class FrameRingWriter {
+public:
+    bool open(const std::string& name);
+
+    // 标记帧流结束后断开
+    void close();
+
+    // 取得一个width x height的可写帧（cv::Mat头指向共享内存槽位），解码器可直接解码到其中，
+    // 写好后调用commitFrame发布；超过槽位大小或超时时返回false
+    bool beginFrame(int width, int height, cv::Mat& frame, int timeout_ms = -1);
+    bool commitFrame(uint64_t frame_id);
+
+    // 复制一帧CV_8UC3图像到槽位并发布
+    bool writeFrame(const cv::Mat& image, uint64_t frame_id, int timeout_ms = -1);
+
+    // 读取下一个结果，frame_id为该结果对应的帧号；超时或结果的检测框数超出槽位容量时返回false
+    bool readResults(uint64_t& frame_id, std::vector<DetectionResult>& results, int timeout_ms = -1);
+
+    RingStats frameStats() const { return frames_.getStats(); }
+
+private:
+    SharedRing frames_;
+    SharedRing results_;
+    SharedRing::Slot pending_;
+};
+
+#endif // FRAME_RING_H
@@ -0,0 +1,46 @@
+#ifndef IMAGE_LOADER_H
+#define IMAGE_LOADER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 解码后的图像及其与原图的尺寸关系
+struct LoadedImage {
+    cv::Mat image;           // 实际解码得到的图像（可能是降分辨率的）
+    cv::Size original_size;  // 原图尺寸，检测框最终映射到该坐标系
+    int reduction = 1;       // 解码缩小倍数：1、2、4、8
+};
+
+// 图像加载器：JPEG源图远大于模型输入时使用libjpeg的DCT域缩放解码
+// （IMREAD_REDUCED_COLOR_2/4/8），直接得到接近letterbox尺寸的图像，
+// 省去全分辨率解码与随后被resize丢弃的像素。
+// 缩小倍数取不超过 1/letterbox缩放比例 的最大2的幂，保证解码图像不小于letterbox后的尺寸，
+// 因此letterbox仍然是缩小而非放大。非JPEG或关闭时按全分辨率解码。
+class ImageLoader {
+public:
+    ImageLoader() = default;
+
+    void setTargetSize(const cv::Size& target_size) { target_size_ = target_size; }
+    void setReducedDecode(bool enabled) { reduced_decode_ = enabled; }
+
+    // 读取并解码文件；文件缓冲区在多次调用间复用
+    bool load(const std::string& path, LoadedImage& loaded);
+
+    // 解码内存中的编码数据
+    bool decode(const std::vector<uchar>& data, LoadedImage& loaded) const;
+
+    // 从JPEG的SOF段读取宽高（不解码），非JPEG或格式异常时返回false
+    static bool readJpegSize(const uchar* data, size_t size, cv::Size& image_size);
+
+    // 对给定源图尺寸与模型输入尺寸选择缩小倍数
+    static int chooseReduction(const cv::Size& image_size, const cv::Size& target_size);
+
+private:
+    cv::Size target_size_{ 640, 640 };
+    bool reduced_decode_ = true;
+    std::vector<uchar> buffer_;
+};
+
+#endif // IMAGE_LOADER_H
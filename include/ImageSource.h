@@ -0,0 +1,41 @@
+#ifndef IMAGE_SOURCE_H
+#define IMAGE_SOURCE_H
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// 流式枚举图像路径，内存占用与图像数量无关：
+// - 目录：递归遍历其中的图像文件
+// - 通配符：如 frames/*.jpg（只允许文件名部分含 * 和 ?，只返回图像文件）
+// - 列表文件：.txt/.lst/.list，每行一个路径，空行和以#开头的行被忽略
+// - 单个图像文件
+// 其他输入（例如视频文件）open返回false，由调用方按视频处理
+class ImageSource {
+public:
+    ImageSource() = default;
+
+    bool open(const std::string& spec);
+
+    // 取下一个图像路径，枚举结束时返回false
+    bool next(std::string& path);
+
+    const std::string& description() const { return description_; }
+
+    static bool isImageFile(const std::filesystem::path& path);
+    // 简单的通配符匹配，支持 * 与 ?
+    static bool matchWildcard(const std::string& pattern, const std::string& name);
+
+private:
+    enum class Kind { None, Directory, Glob, ListFile, SingleFile };
+
+    Kind kind_ = Kind::None;
+    std::string description_;
+    std::string pattern_;   // Glob模式下的文件名模式
+    std::string single_file_;
+    std::filesystem::recursive_directory_iterator recursive_it_;
+    std::filesystem::directory_iterator directory_it_;
+    std::ifstream list_file_;
+};
+
+#endif // IMAGE_SOURCE_H
@@ -0,0 +1,43 @@
+#ifndef INFERENCE_CLIENT_H
+#define INFERENCE_CLIENT_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "InferenceProtocol.h"
+#include "LocalSocket.h"
+
+// InferenceServer的客户端：一个连接，可以连续send多个请求后再逐个receive（流水线），
+// 也可以用detect同步地发送并等待结果。单个对象不是线程安全的，每个线程使用自己的连接。
+class InferenceClient {
+public:
+    // port > 0 时连接127.0.0.1:port，否则连接Unix域socket
+    bool connect(const std::string& socket_path, int port = 0);
+    void close();
+    bool connected() const { return socket_.valid(); }
+
+    // 发送原始BGR帧（CV_8UC3），不等待响应
+    bool send(uint32_t request_id, const cv::Mat& image);
+
+    // 发送编码后的图像（JPEG/PNG等），由服务端解码
+    bool sendEncoded(uint32_t request_id, const std::vector<uchar>& bytes);
+
+    // 接收下一个响应；连接断开时返回false
+    bool receive(uint32_t& request_id, inference_protocol::ResponseStatus& status,
+                 std::vector<DetectionResult>& results);
+
+    // 同步检测：发送原始帧并等待对应的响应，状态不是Ok时返回false
+    bool detect(const cv::Mat& image, std::vector<DetectionResult>& results);
+
+private:
+    bool sendRequest(const inference_protocol::RequestHeader& header, const void* payload);
+
+    LocalSocket socket_;
+    std::vector<inference_protocol::WireDetection> wire_;
+    uint32_t next_id_ = 1;
+};
+
+#endif // INFERENCE_CLIENT_H
@@ -0,0 +1,56 @@
+#ifndef INFERENCE_PROTOCOL_H
+#define INFERENCE_PROTOCOL_H
+
+#include <cstdint>
+
+// InferenceServer与InferenceClient之间的二进制协议（仅用于本机通信，字段按本机字节序）。
+// 请求：RequestHeader + payload_bytes字节的图像
+//   - Encoded：JPEG/PNG等编码数据，服务端按BGR解码
+//   - RawBgr：width x height的CV_8UC3像素，行间无填充
+// 响应：ResponseHeader + count个WireDetection，request_id与请求相同。
+// 同一连接可连续发送多个请求而不等待响应；不同批次的响应可能乱序，按request_id对应。
+namespace inference_protocol {
+
+constexpr uint32_t kMagic = 0x4F4C4F59;                  // "YOLO"
+constexpr uint32_t kMaxPayloadBytes = 64u * 1024 * 1024; // 单个请求的图像数据上限
+
+enum class PayloadType : uint32_t {
+    Encoded = 1,
+    RawBgr = 2
+};
+
+enum class ResponseStatus : uint32_t {
+    Ok = 0,
+    Busy = 1,          // 服务端排队请求已满，请求未执行
+    BadRequest = 2,    // 图像无法解码或尺寸与数据长度不符
+    Failed = 3         // 服务端正在停止，或该图像推理出错（结果为空，不表示没有目标）
+};
+
+struct RequestHeader {
+    uint32_t magic = kMagic;
+    uint32_t type = static_cast<uint32_t>(PayloadType::Encoded);
+    uint32_t request_id = 0;
+    int32_t width = 0;                 // 仅RawBgr使用
+    int32_t height = 0;
+    uint32_t payload_bytes = 0;
+};
+
+struct ResponseHeader {
+    uint32_t magic = kMagic;
+    uint32_t status = static_cast<uint32_t>(ResponseStatus::Ok);
+    uint32_t request_id = 0;
+    uint32_t count = 0;
+};
+
+struct WireDetection {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    int32_t class_id;
+    float confidence;
+};
+
+} // namespace inference_protocol
+
+#endif // INFERENCE_PROTOCOL_H
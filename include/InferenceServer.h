@@ -0,0 +1,107 @@
+#ifndef INFERENCE_SERVER_H
+#define INFERENCE_SERVER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "DetectorPool.h"
+#include "JsonConfigManager.h"
+#include "LocalSocket.h"
+#include "InferenceProtocol.h"
+
+struct ServerStats {
+    uint64_t completed = 0;          // 已返回结果的请求数
+    uint64_t failed = 0;             // 推理出错、以Failed响应的请求数
+    uint64_t batches = 0;            // 执行的批次数
+    uint64_t busy = 0;               // 排队已满被拒绝的请求数
+    uint64_t bad_requests = 0;       // 无法解码的请求数
+    uint64_t connections = 0;        // 累计连接数
+    size_t active_connections = 0;
+    size_t queued = 0;               // 当前排队的请求数
+    size_t largest_batch = 0;
+
+    double meanBatchSize() const { return batches > 0 ? static_cast<double>(completed + failed) / batches : 0.0; }
+};
+
+// 本机推理服务：在Unix域socket或127.0.0.1的TCP端口上接收编码图像或原始BGR帧
+// （协议见InferenceProtocol.h），把不同连接的并发请求合并为批次调用detectBatch。
+// - 动态批处理：凑满max_batch_size个请求，或最早的请求已等待max_queue_delay_ms时立即执行，
+//   延迟上界可控；每个会话一个批处理线程，前一批推理时下一批继续排队
+// - 背压：每个连接最多max_pending_per_client个未完成请求，达到后暂停读取该连接，
+//   客户端的发送随socket缓冲区填满而阻塞；所有连接的排队总数超过queue_capacity时返回Busy
+// - 每个连接一个读取线程，图像解码在读取线程中完成，不占用批处理线程
+class InferenceServer {
+public:
+    InferenceServer();
+    ~InferenceServer();
+
+    // 按model/detection/server配置创建server.sessions个会话的检测器池
+    bool initialize(JsonConfigManager& config_manager);
+
+    // 使用调用方的检测器池（不获取所有权），批处理线程数等于池的会话数
+    bool initialize(DetectorPool& pool, const ServerConfig& config);
+
+    // 开始监听并启动批处理线程
+    bool start();
+
+    // 停止接受连接，执行完已排队的请求后断开所有连接
+    void stop();
+
+    bool running() const { return running_; }
+    ServerStats getStats() const;
+    const ServerConfig& getConfig() const { return config_; }
+
+private:
+    struct Client {
+        LocalSocket socket;
+        std::mutex write_mutex;          // 不同批处理线程的响应互斥写入
+        int pending = 0;                 // 已入队未响应的请求数（受mutex_保护）
+        std::atomic<bool> finished{false};
+        std::thread reader;
+    };
+
+    struct Request {
+        std::shared_ptr<Client> client;
+        uint32_t id = 0;
+        cv::Mat image;
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    void acceptLoop();
+    void readerLoop(std::shared_ptr<Client> client);
+    void batchLoop();
+    // 读取请求负载并解码；connection_lost为true表示连接已断开
+    bool readImage(Client& client, const inference_protocol::RequestHeader& header, cv::Mat& image,
+                   bool& connection_lost);
+    // 读取并丢弃bytes字节的负载，连接断开时返回false
+    static bool discardPayload(Client& client, size_t bytes);
+    static void respond(Client& client, uint32_t request_id, inference_protocol::ResponseStatus status,
+                        const std::vector<DetectionResult>& results);
+    void joinFinishedClients();
+
+    ServerConfig config_;
+    std::unique_ptr<DetectorPool> owned_pool_;
+    DetectorPool* pool_;
+    LocalSocket listener_;
+    std::thread accept_thread_;
+    std::vector<std::thread> batch_threads_;
+    std::atomic<bool> running_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable batch_ready_;  // 有新请求或停止
+    std::condition_variable client_ready_; // 有请求完成（连接的pending减少）或停止
+    std::deque<Request> queue_;
+    std::vector<std::shared_ptr<Client>> clients_;
+    ServerStats stats_;
+};
+
+#endif // INFERENCE_SERVER_H
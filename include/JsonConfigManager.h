@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <map>
 #include <string>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 // 配置结构体定义
@@ -9,21 +12,153 @@ struct ModelConfig {
     int input_width = 640;
     int input_height = 640;
     std::string device_type = "CPU"; // 默认使用CPU
+    int max_batch_size = 8;          // detectBatch单次Run的最大图像数量
+    bool io_binding = false;         // 预分配输入/输出张量并通过IoBinding绑定
+    int preprocess_threads = 0;      // 预处理并行线程数，0表示使用OpenCV线程数
+    int intra_op_threads = 1;        // ONNX Runtime算子内并行线程数，0表示由ORT决定
+    int inter_op_threads = 1;        // 算子间并行线程数（仅parallel模式生效），0表示由ORT决定
+    std::string execution_mode = "sequential"; // "sequential" 或 "parallel"
+    bool cpu_mem_arena = true;       // 启用CPU内存arena
+    bool mem_pattern = true;         // 启用内存模式预规划（固定输入尺寸时可减少分配）
+    bool shared_arena = false;       // 所有会话共享Env上注册的一个arena
+    // 以下两项只作用于shared_arena；ORT不提供设置会话自带CPU arena参数的接口
+    std::string arena_extend_strategy = "next_power_of_two"; // 或 "same_as_requested"
+    int64_t arena_initial_chunk_bytes = 0;  // 共享arena的初始块大小，0表示默认值
+    bool share_prepacked_weights = true;    // 同一模型的会话共享预打包权重
+    std::string optimized_model_path;       // 优化后模型的缓存路径（.onnx或.ort），为空表示不缓存
+    bool mmap_model = false;                // 通过内存映射加载模型字节
+    int warmup_runs = 0;                    // initialize中执行的预热推理次数
+    std::string precision = "fp32";         // "fp32" 或 "int8"：int8时加载int8_model_path（不存在时回退到path）
+    std::string int8_model_path;            // tools/quantize_int8.py生成的QDQ INT8模型
+    std::string input_format = "auto";      // "float_nchw"、"uint8_nhwc"（预处理已并入模型，见tools/fold_preprocess.py）或 "auto"（按模型输入类型）
+    std::string letterbox = "square";       // "square"（固定输入尺寸）或 "minimal"（按宽高比填充到stride整数倍，需动态H/W模型）
+    int stride = 32;                        // minimal模式下输入宽高的对齐倍数（模型的最大下采样倍数）
+    std::vector<std::string> providers;     // 执行提供者优先级列表："cpu"、"cuda"、"xnnpack"、"dnnl"、"openvino"，或["auto"]；为空时按device_type
+    std::map<std::string, std::map<std::string, std::string>> provider_options; // 各提供者的选项，如{"xnnpack": {"intra_op_num_threads": "4"}}
+    std::string provider_cache_path;        // auto模式选择结果的缓存文件（按模型/主机指纹），为空表示每次启动都测量
+    int provider_probe_runs = 5;            // auto模式下每个提供者计时的推理次数（另有一次不计时的预热）
 };
 
 struct DetectionConfig {
     float confidence_threshold = 0.35f;
     float nms_threshold = 0.45f;
+    bool nms_class_aware = true;     // 仅在同类别框之间执行NMS
+    int nms_top_k = 30000;           // NMS前按分数截取的候选上限
+    int max_detections = 0;          // 每张图像最多输出的检测数，0表示不限制
+    bool soft_nms = false;           // 使用高斯Soft-NMS
+    float soft_nms_sigma = 0.5f;
 };
 
 struct InputConfig {
     std::string image_path;
+    bool reduced_decode = false;     // 源图远大于模型输入时，JPEG按1/2、1/4、1/8降分辨率解码
 };
 
 struct ClassesConfig {
     std::vector<std::string> names;
 };
 
+// DetectorPool：多个会话共享一个Ort::Env
+struct PoolConfig {
+    int sessions = 1;                // 会话数量
+    bool global_thread_pools = true; // 会话共享Env的全局线程池（线程数取自model的intra/inter_op_threads）
+};
+
+// 视频流水线各阶段的工作线程数与队列容量
+struct PipelineConfig {
+    int preprocess_workers = 2;      // 预处理阶段线程数
+    int inference_workers = 1;       // 推理阶段线程数（每个线程持有独立会话）
+    int postprocess_workers = 1;     // 解码+NMS阶段线程数
+    int queue_capacity = 8;          // 相邻阶段之间每条队列的容量
+    int stats_interval_ms = 1000;    // 周期性输出各阶段统计的间隔，<= 0 表示只在结束时输出
+};
+
+// 运行时指标：直方图/计数器始终在内存中累计，导出方式可选
+struct TelemetryConfig {
+    bool enabled = true;             // 关闭后热路径不再记录任何指标
+    std::string prometheus_file;     // 周期性写入Prometheus文本格式的文件路径，为空表示不写
+    int prometheus_port = 0;         // 在127.0.0.1上提供/metrics的端口，0表示不启动
+    int export_interval_ms = 5000;   // 写文件的间隔
+};
+
+// 切片检测：高分辨率图像切成重叠的tile分别检测，合并后映射回原图
+struct TilingConfig {
+    bool enabled = false;
+    int tile_width = 640;            // tile尺寸（原图像素），与模型输入一致时切片无需缩放
+    int tile_height = 640;
+    float overlap = 0.2f;            // 相邻tile的重叠比例
+    bool full_image_pass = true;     // 额外对整图检测一次，保留跨越多个tile的大目标
+    std::string merge = "nmm";       // 跨tile去重："nms"（IoU抑制）或 "nmm"（按交集/较小框面积合并被切开的框）
+    float merge_threshold = 0.5f;    // nms为IoU阈值，nmm为交集占较小框面积的比例阈值
+    bool merge_class_aware = true;   // 仅合并同类别的框
+    int sessions = 1;                // 并行处理tile的会话数
+};
+
+// 检测+跟踪：每隔若干帧做一次完整检测，中间帧由跟踪器外推（视频模式）
+struct TrackingConfig {
+    bool enabled = false;
+    int keyframe_interval = 5;       // 固定间隔：每K帧检测一次（adaptive时为初始间隔）
+    bool adaptive = true;            // 按跟踪质量在[min_interval, max_interval]之间调整检测间隔
+    int min_interval = 1;
+    int max_interval = 10;
+    float min_confidence = 0.25f;    // 外推轨迹的置信度衰减到该值以下时提前检测
+    float iou_threshold = 0.3f;      // 检测框与轨迹匹配的最小IoU
+    int max_age = 2;                 // 连续未匹配的关键帧数超过该值时删除轨迹
+    float confidence_decay = 0.95f;  // 非关键帧上外推框的置信度逐帧衰减系数
+};
+
+// 异步检测：后台会话数与在途请求上限（AsyncDetector）
+struct AsyncConfig {
+    int sessions = 2;                // 后台检测会话数，每个会话一个工作线程
+    int max_in_flight = 16;          // 排队与执行中的请求总数上限
+    std::string overflow = "wait";   // 达到上限时："wait"阻塞提交方，"reject"立即拒绝
+    int wait_timeout_ms = 0;         // wait策略下最长等待时间，0表示一直等待
+};
+
+// 本机推理服务：动态批处理与每个客户端的背压（InferenceServer）
+struct ServerConfig {
+    std::string socket_path = "yolov8infer.sock"; // Unix域socket路径（port为0时使用）
+    int port = 0;                    // > 0 时改为监听127.0.0.1上的TCP端口
+    int sessions = 1;                // 执行批次的会话数，每个会话一个批处理线程
+    int max_batch_size = 8;          // 单个批次的最大请求数（模型的max_batch_size应不小于该值）
+    float max_queue_delay_ms = 2.0f; // 批次未满时，最早的请求最多等待的时间
+    int max_pending_per_client = 4;  // 每个连接未完成的请求上限，达到后暂停读取该连接
+    int queue_capacity = 64;         // 所有连接排队请求的上限，超出时返回busy
+};
+
+// 共享内存帧环：同机生产进程零拷贝地提交原始BGR帧（FrameRing）
+struct ShmRingConfig {
+    std::string name = "yolov8infer_frames"; // 共享内存名称，结果环为name_results
+    int slots = 4;                   // 帧槽位数
+    int max_width = 1920;            // 单帧的最大宽高，决定槽位大小
+    int max_height = 1080;
+    std::string overflow = "block";  // 槽位写满时："block"等待消费方，"overwrite"覆盖最早的未读帧
+    int max_detections = 300;        // 每帧结果最多返回的检测框数
+};
+
+// 帧门控：画面与上次推理的帧几乎相同时直接返回缓存的结果（FrameGate）
+struct GateConfig {
+    bool enabled = false;
+    int thumb_width = 160;           // 指纹缩略图尺寸（灰度），越大对小目标的运动越敏感
+    int thumb_height = 90;
+    int pixel_threshold = 12;        // 缩略图像素灰度差超过该值视为变化
+    float max_changed_ratio = 0.0005f; // 变化像素占监测区域的比例超过该值时推理
+    float max_mean_diff = 3.0f;      // 监测区域的平均灰度差超过该值时推理（整体光照变化）
+    int max_stale_frames = 150;      // 缓存结果最多复用的帧数，0表示不限
+    int max_stale_ms = 5000;         // 缓存结果最长复用时间，0表示不限
+    std::string mask_path;           // 监测区域掩码图像（非零为监测区域），为空时监测整帧
+};
+
+// 多实例分片：按NUMA节点或核组各启动一个检测器实例，线程与内存都留在本节点（ShardedRunner）
+struct ShardConfig {
+    std::string group_by = "node";   // "node"：每个NUMA节点一个实例；"cores"：每cores_per_instance个核一个实例
+    int cores_per_instance = 0;      // group_by为cores时每个实例的核数（不跨节点），0表示按intra_op_threads
+    int max_instances = 0;           // 实例数上限，0表示每个核组一个
+    bool pin_threads = true;         // 把实例的推理线程与ORT算子内线程绑定到核组内的CPU
+    std::string balance = "least_outstanding"; // "least_outstanding"或"stream_affinity"（同一路流固定到一个实例）
+    int queue_capacity = 8;          // 每个实例排队与执行中的帧数上限，达到后提交方阻塞
+};
+
 class JsonConfigManager {
 public:
     explicit JsonConfigManager(const std::string& config_path);
@@ -34,6 +169,27 @@ public:
     const DetectionConfig& getDetectionConfig() const { return detection_config_; }
     const InputConfig& getInputConfig() const { return input_config_; }
     const ClassesConfig& getClassesConfig() const { return classes_config_; }
+    const PipelineConfig& getPipelineConfig() const { return pipeline_config_; }
+    const PoolConfig& getPoolConfig() const { return pool_config_; }
+    const TelemetryConfig& getTelemetryConfig() const { return telemetry_config_; }
+    const TilingConfig& getTilingConfig() const { return tiling_config_; }
+    const TrackingConfig& getTrackingConfig() const { return tracking_config_; }
+    const AsyncConfig& getAsyncConfig() const { return async_config_; }
+    const ServerConfig& getServerConfig() const { return server_config_; }
+    const ShmRingConfig& getShmRingConfig() const { return shm_ring_config_; }
+    const GateConfig& getGateConfig() const { return gate_config_; }
+    const ShardConfig& getShardConfig() const { return shard_config_; }
+    
+    // 在加载后覆盖部分配置（基准测试扫描参数时使用）
+    void setModelConfig(const ModelConfig& model_config) { model_config_ = model_config; }
+    void setPoolConfig(const PoolConfig& pool_config) { pool_config_ = pool_config; }
+    void setTilingConfig(const TilingConfig& tiling_config) { tiling_config_ = tiling_config; }
+    void setTrackingConfig(const TrackingConfig& tracking_config) { tracking_config_ = tracking_config; }
+    void setAsyncConfig(const AsyncConfig& async_config) { async_config_ = async_config; }
+    void setServerConfig(const ServerConfig& server_config) { server_config_ = server_config; }
+    void setShmRingConfig(const ShmRingConfig& shm_ring_config) { shm_ring_config_ = shm_ring_config; }
+    void setGateConfig(const GateConfig& gate_config) { gate_config_ = gate_config; }
+    void setShardConfig(const ShardConfig& shard_config) { shard_config_ = shard_config; }
 
 private:
     std::string config_path_;
@@ -43,9 +199,29 @@ private:
     DetectionConfig detection_config_;
     InputConfig input_config_;
     ClassesConfig classes_config_;
+    PipelineConfig pipeline_config_;
+    PoolConfig pool_config_;
+    TelemetryConfig telemetry_config_;
+    TilingConfig tiling_config_;
+    TrackingConfig tracking_config_;
+    AsyncConfig async_config_;
+    ServerConfig server_config_;
+    ShmRingConfig shm_ring_config_;
+    GateConfig gate_config_;
+    ShardConfig shard_config_;
     
     bool parseModelConfig();
     bool parseDetectionConfig();
     bool parseInputConfig();
     bool parseClassesConfig();
+    bool parsePipelineConfig();
+    bool parsePoolConfig();
+    bool parseTelemetryConfig();
+    bool parseTilingConfig();
+    bool parseTrackingConfig();
+    bool parseAsyncConfig();
+    bool parseServerConfig();
+    bool parseShmRingConfig();
+    bool parseGateConfig();
+    bool parseShardConfig();
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef LETTERBOX_PREPROCESSOR_H
+#define LETTERBOX_PREPROCESSOR_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Letterbox几何参数：缩放后的尺寸以及居中填充的偏移量
+struct LetterboxInfo {
+    float scale = 1.0f;
+    int new_width = 0;
+    int new_height = 0;
+    int left = 0;
+    int top = 0;
+};
+
+// 融合预处理内核：一次读取BGR源图像，完成双线性缩放、填充、1/255归一化、
+// BGR->RGB通道交换以及HWC->CHW转换，直接写入输入张量缓冲区。
+// 结果与 letterboxResize + blobFromImage 一致（误差不超过1/255）。
+class LetterboxPreprocessor {
+public:
+    LetterboxPreprocessor();
+
+    // 计算与letterboxResize相同的缩放比例和偏移量
+    static LetterboxInfo computeLetterbox(const cv::Size& image_size, const cv::Size& target_size);
+
+    // 处理CV_8UC3图像，dst需要容纳 3 * target_size.area() 个float
+    LetterboxInfo run(const cv::Mat& image, const cv::Size& target_size, float* dst,
+                      const cv::Scalar& fill_color = cv::Scalar(0, 0, 0));
+
+    // 只做letterbox，结果以BGR HWC uint8写入dst（3 * target_size.area()字节），
+    // 供预处理已并入模型图的uint8输入模式使用：缩放直接写入dst中的有效区域，不经过中间图像
+    LetterboxInfo runBytes(const cv::Mat& image, const cv::Size& target_size, uchar* dst,
+                           const cv::Scalar& fill_color = cv::Scalar(0, 0, 0));
+
+    // 按行并行的线程数，<= 0 表示使用OpenCV的线程数
+    void setNumThreads(int num_threads) { num_threads_ = num_threads; }
+
+    // 处理[row_begin, row_end)范围内的输出行，供并行内核调用
+    void processRows(const cv::Mat& image, const LetterboxInfo& info, const cv::Size& target_size,
+                     const float* fill_values, float* dst, int* scratch,
+                     int row_begin, int row_end) const;
+
+private:
+    // 源/目标尺寸变化时重新计算插值坐标与定点系数
+    void prepareTables(const cv::Size& image_size, const LetterboxInfo& info);
+
+    cv::Size table_image_size_;
+    cv::Size table_scaled_size_;
+    std::vector<int> xofs_;      // 每个输出列的左右源像素字节偏移
+    std::vector<short> xalpha_;  // 每个输出列的水平定点系数
+    std::vector<int> yofs_;      // 每个输出行的上下源行号
+    std::vector<short> yalpha_;  // 每个输出行的垂直定点系数
+    std::vector<int> scratch_;   // 每个并行分块的水平插值行缓存
+    int num_threads_;
+};
+
+#endif // LETTERBOX_PREPROCESSOR_H
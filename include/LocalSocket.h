@@ -0,0 +1,48 @@
+#ifndef LOCAL_SOCKET_H
+#define LOCAL_SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 本机进程间通信用的流式socket：Unix域socket（Windows 10 1803起同样支持AF_UNIX），
+// 或只监听127.0.0.1的TCP端口。阻塞IO，只支持移动。
+class LocalSocket {
+public:
+    LocalSocket() = default;
+    ~LocalSocket();
+
+    LocalSocket(LocalSocket&& other) noexcept;
+    LocalSocket& operator=(LocalSocket&& other) noexcept;
+    LocalSocket(const LocalSocket&) = delete;
+    LocalSocket& operator=(const LocalSocket&) = delete;
+
+    // port > 0 时监听127.0.0.1:port，否则监听socket_path（已存在的同名文件会先删除）
+    static LocalSocket listen(const std::string& socket_path, int port, int backlog = 64);
+
+    // port > 0 时连接127.0.0.1:port，否则连接socket_path
+    static LocalSocket connect(const std::string& socket_path, int port);
+
+    // 阻塞等待一个连接，监听socket被shutdown后返回无效socket
+    LocalSocket accept();
+
+    // 完整发送/接收size字节，连接断开或出错时返回false
+    bool sendAll(const void* data, size_t size);
+    bool recvAll(void* data, size_t size);
+
+    // 中断阻塞中的accept/recv（其他线程调用），之后的IO均失败
+    void shutdown();
+    void close();
+
+    bool valid() const { return handle_ != kInvalidHandle; }
+
+private:
+    static constexpr intptr_t kInvalidHandle = -1;
+
+    explicit LocalSocket(intptr_t handle) : handle_(handle) {}
+
+    intptr_t handle_ = kInvalidHandle;
+    std::string unlink_path_;  // 监听的Unix域socket文件，关闭时删除
+};
+
+#endif // LOCAL_SOCKET_H
@@ -0,0 +1,63 @@
+#ifndef NMS_ENGINE_H
+#define NMS_ENGINE_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+struct NmsOptions {
+    float iou_threshold = 0.45f;   // IoU超过该值的框被抑制
+    float score_threshold = 0.0f;  // 参与NMS的最低分数（Soft-NMS衰减后低于该值的框被丢弃）
+    int top_k = 30000;             // 按分数预先截取的候选数量上限，<= 0 表示不限制
+    int max_detections = 0;        // 最终保留的框数量上限，<= 0 表示不限制
+    bool class_aware = true;       // 仅在同类别框之间执行抑制
+    bool soft_nms = false;         // 使用高斯Soft-NMS衰减分数而非直接抑制
+    float soft_nms_sigma = 0.5f;   // Soft-NMS高斯核参数
+};
+
+// 非极大值抑制引擎：
+// - 候选框转换为结构化数组(SoA)的float坐标，IoU按真实并集计算并以SIMD批量比较
+// - 按类别分组处理（class_aware），不同类别的框互不抑制
+// - 贪心NMS中每个候选只与已保留框比较，已保留框按空间网格分桶，
+//   只检查与候选框所在网格重叠的框，跳过不相交的框对
+// - 可选高斯Soft-NMS
+class NmsEngine {
+public:
+    NmsEngine() = default;
+
+    // 对boxes/scores/class_ids执行NMS，keep按分数降序输出保留框在输入中的索引
+    void run(const std::vector<cv::Rect>& boxes, const std::vector<float>& scores,
+             const std::vector<int>& class_ids, const NmsOptions& options,
+             std::vector<int>& keep);
+
+    // 与keep一一对应的最终分数（Soft-NMS下为衰减后的分数）
+    const std::vector<float>& keptScores() const { return kept_scores_; }
+
+private:
+    // 网格单元内已保留框的SoA坐标
+    struct Cell {
+        std::vector<float> x1, y1, x2, y2, area;
+        void clear();
+        void push(float bx1, float by1, float bx2, float by2, float barea);
+    };
+
+    void hardNmsGroup(int begin, int end, float iou_threshold);
+    void softNmsGroup(int begin, int end, const NmsOptions& options);
+    bool overlapsAny(const Cell& cell, int k, float iou_threshold) const;
+
+    // 排序后候选框（按类别、分数）对应的输入索引与SoA坐标
+    std::vector<int> order_;
+    std::vector<float> x1_, y1_, x2_, y2_, area_, scores_;
+
+    // 保留框在order_中的位置及其最终分数
+    std::vector<int> kept_pos_;
+    std::vector<float> kept_scores_;
+
+    // 空间网格与本组中被写入的网格索引
+    std::vector<Cell> grid_;
+    std::vector<int> touched_cells_;
+
+    // Soft-NMS中当前框与待处理框的IoU
+    std::vector<float> ious_;
+};
+
+#endif // NMS_ENGINE_H
@@ -0,0 +1,35 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+// 一组逻辑CPU：一个NUMA节点，或节点内切分出的核组
+struct CoreGroup {
+    int node = 0;             // 所属NUMA节点
+    std::vector<int> cpus;    // 逻辑CPU编号（从0开始）
+};
+
+// NUMA拓扑发现与线程绑定。
+// Linux读取/sys/devices/system/node，Windows使用GetNumaNodeProcessorMask（仅处理器组0）；
+// 只保留进程可用的CPU（容器/taskset限制后的亲和性掩码），无法获取拓扑时退化为包含全部CPU的单个节点。
+// 不依赖libnuma：内存的节点归属由首次写入（first touch）决定，在绑定到节点的线程上分配并写入即为本节点内存。
+class NumaTopology {
+public:
+    // 每个NUMA节点一个CoreGroup，至少返回一个
+    static std::vector<CoreGroup> discover();
+
+    // cores_per_group <= 0 时每个节点一组，否则把每个节点按该核数切分（不跨节点，末尾不足的核并入最后一组）
+    static std::vector<CoreGroup> split(const std::vector<CoreGroup>& nodes, int cores_per_group);
+
+    // 把调用线程绑定到cpus，不支持的平台返回false
+    static bool pinCurrentThread(const std::vector<int>& cpus);
+
+    // 解析"0-3,8-11"形式的CPU列表
+    static std::vector<int> parseCpuList(const std::string& text);
+
+    // 格式化为"0-3,8-11"
+    static std::string formatCpuList(const std::vector<int>& cpus);
+};
+
+#endif // NUMA_TOPOLOGY_H
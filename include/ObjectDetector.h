@@ -13,13 +13,36 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 
+#include "LetterboxPreprocessor.h"
+#include "OutputDecoder.h"
+#include "NmsEngine.h"
+#include "OrtResources.h"
+#include "ExecutionProviders.h"
+#include "MappedFile.h"
+#include "Telemetry.h"
+#include "ImageLoader.h"
+
 // 前向声明JSON配置管理器
 class JsonConfigManager;
+struct ModelConfig;
 
 struct DetectionResult {
     cv::Rect box;
     int class_id;
     float confidence;
+    int track_id = -1;  // 跟踪模式下的轨迹编号（见ObjectTracker），单帧检测为-1
+};
+
+// 模型输入张量格式
+enum class InputFormat {
+    Float32Nchw,  // [N,3,H,W] float32 RGB，1/255归一化在预处理中完成
+    Uint8Nhwc     // [N,H,W,3] uint8 BGR，归一化/通道交换/转置已并入模型图（tools/fold_preprocess.py）
+};
+
+// 模型输出格式，决定使用的后处理路径
+enum class OutputFormat {
+    RawAnchors,   // [N,4+C,A]：C++中解码 + NMS
+    EndToEnd      // [K,6]：x1,y1,x2,y2,score,class_id，NMS已在图内完成（tools/export_end2end.py）
 };
 
 class ObjectDetector {
@@ -33,9 +56,61 @@ public:
     // 传统初始化方法
     bool initialize(const std::string& model_path);
     
+    // 仅应用JSON中的输入尺寸、阈值、NMS与类别等参数，不加载模型
+    // （只执行postprocess的实例使用）
+    void applyConfig(JsonConfigManager& config_manager);
+    
+    // 使用外部共享的Ort::Env（须在initialize之前调用）
+    // use_global_thread_pools为true时Env需以全局线程池创建，会话不再创建自己的线程池
+    void setEnvironment(std::shared_ptr<Ort::Env> env, bool use_global_thread_pools);
+    
+    // 执行提供者优先级列表（或{"auto"}），须在initialize之前调用
+    void setProviders(const std::vector<ProviderSpec>& providers) { providers_ = providers; }
+    // initialize后实际生效的提供者（末尾总是cpu）
+    const std::vector<std::string>& getActiveProviders() const { return active_providers_; }
+    
+    // 算子内线程的CPU亲和性（ORT的session.intra_op_thread_affinities格式："2;3;4"，逻辑处理器编号从1开始，
+    // 每个条目对应一个额外的算子内线程，共intra_op_threads-1个），仅在不使用全局线程池时生效，须在initialize之前调用
+    void setThreadAffinity(const std::string& affinities) { intra_op_affinities_ = affinities; }
+    
+    // 以空白输入执行runs次推理，使首帧detect不再承担懒初始化开销；推理失败时返回false
+    // IoBinding模式下每次只执行Run本身，可作为ORT内部开销（耗时、分配）的基准
+    bool warmup(int runs);
+    
+    // 设置后正在执行与之后的Run立即以错误返回（ORT RunOptions的terminate标志），
+    // detect返回false；停止服务时可据此不必等待长推理完成。可从其他线程调用，清除后恢复正常推理
+    void setTerminate(bool terminate);
+    
     std::vector<DetectionResult> detect(const cv::Mat& image);
+    
+    // 复用调用方的结果容器，预热后稳态下不产生堆分配（需开启io_binding）
+    // 推理或后处理失败时results为空并返回false（错误计入遥测），调用方可据此区分"无目标"与"失败"
+    bool detect(const cv::Mat& image, std::vector<DetectionResult>& results);
+    
+    // 对ImageLoader解码的图像（可能是降分辨率的）检测，框坐标映射回原图
+    bool detect(const LoadedImage& loaded, std::vector<DetectionResult>& results);
+    
+    // 将检测框从from尺寸的图像坐标按比例映射到to尺寸的图像坐标
+    static void scaleResults(std::vector<DetectionResult>& results, const cv::Size& from, const cv::Size& to);
+    
+    // 按precision选择要加载的模型：int8且int8_model_path存在时返回true并改用量化模型，
+    // 此时优化模型缓存路径追加.int8后缀，避免与FP32模型的缓存互相覆盖
+    static bool selectModel(const ModelConfig& model_config, std::string& model_path,
+                            std::string& optimized_model_path);
+    
+    // 批量推理：将多张图像打包为[N,3,H,W]张量，单次Run完成推理
+    // 返回结果与输入图像一一对应；模型不支持动态batch时退化为逐张检测
+    std::vector<std::vector<DetectionResult>> detectBatch(const std::vector<cv::Mat>& images);
+    
+    // 同上，并输出每张图像是否检测成功：空图像、所在分块推理或后处理出错时为false（结果为空），
+    // 调用方可据此区分"无目标"与"失败"
+    std::vector<std::vector<DetectionResult>> detectBatch(const std::vector<cv::Mat>& images,
+                                                          std::vector<bool>& succeeded);
+    
     void setConfidenceThreshold(float threshold);
     void setNMSThreshold(float threshold);
+    void setInputSize(int width, int height);
+    void setClassNames(const std::vector<std::string>& class_names);
     void drawBoxes(cv::Mat& image, const std::vector<DetectionResult>& detections);
     
     // 获取类别名称
@@ -44,8 +119,59 @@ public:
     // Letterbox图像预处理函数
     cv::Mat letterboxResize(const cv::Mat& image, cv::Size target_size, cv::Scalar fill_color = cv::Scalar(0, 0, 0));
     
+    // 对已预处理的单张[1,3,H,W]输入张量执行一次Run，输出[1,4+C,N]（端到端模型为[K,6]）复制到output
+    // output复用调用方容量，供流水线将预处理、推理、后处理拆分到不同线程
+    // input_size为张量的宽高（minimal模式下由inputSizeFor按图像确定），为空时使用配置的输入尺寸
+    bool infer(const float* input_tensor, std::vector<float>& output, std::vector<int64_t>& output_shape,
+               const cv::Size& input_size = cv::Size());
+    
+    // uint8输入模式：input_tensor为letterbox后的[1,H,W,3] BGR字节（LetterboxPreprocessor::runBytes的输出）
+    bool infer(const uint8_t* input_tensor, std::vector<float>& output, std::vector<int64_t>& output_shape,
+               const cv::Size& input_size = cv::Size());
+    
+    cv::Size getInputSize() const { return cv::Size(input_width_, input_height_); }
+    
+    // "square"（默认）或 "minimal"，须在initialize之前调用；minimal要求模型输入的H/W为动态维度
+    void setLetterboxMode(const std::string& mode, int stride = 32);
+    
+    // image_size的图像实际使用的输入尺寸：square模式为配置的输入尺寸；
+    // minimal模式为能容纳按比例缩放后图像的最小stride整数倍尺寸（如1920x1080 -> 640x384），
+    // 缩放比例与square模式相同，只是省去了多余的填充行/列
+    cv::Size inputSizeFor(const cv::Size& image_size) const;
+    
+    // minimal模式下当前缓存的输入形状数
+    size_t cachedShapeCount() const { return shape_states_.size(); }
+    
+    // "auto"（默认，按模型输入类型选择）、"float_nchw" 或 "uint8_nhwc"，须在initialize之前调用
+    void setInputFormat(const std::string& format) { input_format_name_ = format; }
+    // initialize后实际使用的输入格式
+    InputFormat getInputFormat() const { return input_format_; }
+    
+    // 将单张图像对应的输出切片[4+C, N]解码并执行NMS，结果写入results
+    void postprocess(const float* raw_output, int num_classes, int num_anchors,
+                     const cv::Size& image_size, std::vector<DetectionResult>& results);
+    
+    // 端到端模型的[K, 6]输出：只做阈值筛选与坐标映射
+    void postprocessEndToEnd(const float* detections, int count, const cv::Size& image_size,
+                             std::vector<DetectionResult>& results);
+    
+    // 按输出形状选择后处理路径：[1,4+C,N]走解码+NMS，[K,6]走端到端路径；形状无法识别时返回false
+    bool postprocessOutput(const float* output, const std::vector<int64_t>& output_shape,
+                           const cv::Size& image_size, std::vector<DetectionResult>& results);
+    
+    static bool isEndToEndOutput(const std::vector<int64_t>& output_shape) {
+        return output_shape.size() == 2 && output_shape[1] == 6;
+    }
+    
+    // initialize后按模型输出签名确定的后处理路径
+    OutputFormat getOutputFormat() const { return output_format_; }
+    
 private:
-    std::unique_ptr<Ort::Env> env_;
+    std::shared_ptr<Ort::Env> env_;
+    // 须在session_之前声明：会话销毁后才能释放共享的预打包权重
+    std::shared_ptr<Ort::PrepackedWeightsContainer> prepacked_weights_;
+    // ORT格式模型直接使用映射的字节，映射须在会话存续期间保持有效
+    MappedFile model_file_;
     std::unique_ptr<Ort::Session> session_;
     std::vector<std::string> input_node_names_;
     std::vector<std::string> output_node_names_;
@@ -54,10 +180,120 @@ private:
     float nms_threshold_;
     int input_width_;
     int input_height_;
-    std::string device_type_; // 设备类型(CPU/GPU)
+    std::string device_type_; // 设备类型(CPU/GPU)，未配置providers时使用
+    std::vector<ProviderSpec> providers_;       // 配置的提供者列表，{"auto", ...}表示测量后选择
+    std::vector<std::string> active_providers_; // 当前会话实际生效的提供者
+    std::string provider_cache_path_;           // auto选择结果的缓存文件
+    int provider_probe_runs_;                   // auto模式下每个提供者计时的推理次数
+    int max_batch_size_;      // detectBatch单次Run的最大图像数量
+    bool dynamic_batch_;      // 模型输入的batch维度是否为动态
+    
+    bool use_io_binding_;     // 是否使用预分配张量 + IoBinding
+    
+    bool minimal_letterbox_;  // 按图像宽高比使用stride对齐的最小输入尺寸
+    int stride_;              // minimal模式下输入宽高的对齐倍数
+    int preprocess_threads_;  // 预处理并行线程数（按形状缓存的预处理器使用）
+    
+    int intra_op_threads_;             // 算子内并行线程数
+    int inter_op_threads_;             // 算子间并行线程数
+    std::string execution_mode_;       // sequential / parallel
+    std::string intra_op_affinities_;  // 算子内线程的CPU亲和性，为空时由操作系统调度
+    bool use_global_thread_pools_;     // 使用共享Env的全局线程池
+    
+    // 会话内存选项
+    bool cpu_mem_arena_;
+    bool mem_pattern_;
+    bool shared_arena_;
+    std::string arena_extend_strategy_;
+    int64_t arena_initial_chunk_bytes_;
+    bool share_prepacked_weights_;
+    
+    // 冷启动选项
+    std::string optimized_model_path_;
+    bool mmap_model_;
+    int warmup_runs_;
+    bool warming_up_;                       // 预热期间的推理不计入延迟直方图
+    
+    std::string input_format_name_;          // 配置的输入格式
+    InputFormat input_format_;               // 按配置与模型输入类型确定的输入格式
+    OutputFormat output_format_;             // 按模型输出签名确定的后处理路径
+    
+    LetterboxPreprocessor preprocessor_;     // 融合预处理内核
+    std::vector<float> input_buffer_;        // 持久化的单张NCHW输入张量缓冲区
+    std::vector<float> batch_input_buffer_;  // detectBatch使用的输入缓冲区
+    std::vector<uint8_t> input_bytes_;       // uint8输入模式下的单张NHWC输入缓冲区
+    std::vector<uint8_t> batch_input_bytes_; // uint8输入模式下detectBatch使用的输入缓冲区
+    
+    // 初始化时构建一次，避免每帧重建
+    std::vector<const char*> input_names_cstr_;
+    std::vector<const char*> output_names_cstr_;
+    Ort::MemoryInfo memory_info_;
+    Ort::RunOptions run_options_;
+    
+    // IoBinding模式下预分配并绑定的输入/输出张量
+    std::unique_ptr<Ort::IoBinding> io_binding_;
+    Ort::Value input_tensor_;
+    Ort::Value output_tensor_;
+    std::vector<float> output_buffer_;
+    std::vector<int64_t> output_shape_;
+    
+    OutputDecoder decoder_;  // SIMD输出解码器
+    
+    // 解码与NMS的复用缓冲区
+    std::vector<cv::Rect> boxes_;
+    std::vector<float> confidences_;
+    std::vector<int> class_ids_;
+    std::vector<int> nms_indices_;
+    
+    NmsEngine nms_engine_;    // 按类别分组的SIMD NMS
+    NmsOptions nms_options_;  // NMS选项（阈值在每次调用时同步）
+    
+    // minimal模式下每种输入形状的状态：插值表与IoBinding按形状保留，
+    // 多路不同宽高比的输入交替出现时不必重新规划
+    struct ShapeState {
+        cv::Size input_size;
+        uint64_t last_used = 0;
+        LetterboxPreprocessor preprocessor;
+        std::unique_ptr<Ort::IoBinding> io_binding;
+        Ort::Value input_tensor{nullptr};
+        Ort::Value output_tensor{nullptr};
+        std::vector<float> output_buffer;
+        std::vector<int64_t> output_shape;
+        bool binding_failed = false;  // 输出无法预分配，该形状始终使用普通Run
+    };
+    std::vector<std::unique_ptr<ShapeState>> shape_states_;
+    uint64_t shape_clock_;
+    
+    // 查找或创建input_size对应的状态，超过上限时淘汰最久未使用的形状
+    ShapeState& shapeState(const cv::Size& input_size);
+    
+    // 以首次普通Run得到的输出形状为该形状预分配输出并绑定IoBinding
+    void bindShape(ShapeState& state, const std::vector<int64_t>& output_shape);
+    
+    // 预分配输入/输出张量并通过IoBinding绑定，失败时回退到普通Run
+    bool setupIoBinding();
+    
+    // 按配置与模型输入的元素类型确定input_format_，二者不一致时返回false
+    bool resolveInputFormat();
+    
+    // 单张图像的输入缓冲区（按输入格式为float或uint8）
+    void* inputData();
+    
+    // 按输入格式将一张图像letterbox到input_size，dst指向float或uint8缓冲区中该图像的切片
+    void preprocessImage(const cv::Mat& image, const cv::Size& input_size, void* dst);
+    
+    // 以data为缓冲区创建batch_size张input_size图像的输入张量，形状与元素类型由输入格式决定
+    Ort::Value createInputTensor(void* data, int64_t batch_size, const cv::Size& input_size);
+    
+    // 按实际的输入尺寸计算letterbox参数解码（detectBatch中同一块图像共用该块的最大尺寸）
+    void postprocess(const float* raw_output, int num_classes, int num_anchors, const cv::Size& image_size,
+                     const cv::Size& input_size, std::vector<DetectionResult>& results);
+    
+    // 执行一次Run并将[1,4+C,N]输出复制到output，infer的两种输入类型共用
+    bool runSingle(Ort::Value& input, std::vector<float>& output, std::vector<int64_t>& output_shape);
     
-    std::vector<int> nmsBoxes(const std::vector<cv::Rect>& boxes, 
-                             const std::vector<float>& confidences);
+    // auto模式：依次用每个可用的提供者创建会话并计时，providers返回最快的一个（优先使用缓存的选择）
+    bool selectProvider(const std::string& model_path, std::vector<ProviderSpec>& providers);
 };
 
 #endif // OBJECT_DETECTOR_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef OBJECT_TRACKER_H
+#define OBJECT_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "ObjectDetector.h"
+
+struct TrackerOptions {
+    float iou_threshold = 0.3f;      // 检测框与轨迹预测框匹配所需的最小IoU
+    int max_age = 2;                 // 连续多少个关键帧未匹配后删除轨迹
+    bool class_aware = true;         // 只匹配同类别的检测框
+    float confidence_decay = 0.95f;  // 非关键帧上外推的框每帧置信度乘以该系数
+};
+
+// 关键帧更新的匹配统计，供自适应调度判断跟踪质量
+struct TrackerUpdateStats {
+    int matched = 0;                 // 与已有轨迹匹配的检测数
+    int created = 0;                 // 新建的轨迹数
+    int lost = 0;                    // 本次未匹配的已有轨迹数
+    int removed = 0;                 // 超过max_age被删除的轨迹数
+};
+
+// SORT风格的多目标跟踪器：
+// - 每条轨迹的中心x/y与宽高各用一个[位置, 速度]匀速卡尔曼滤波器（四个维度解耦，2x2协方差），
+//   噪声按框高缩放，每帧一次预测
+// - 关键帧上按IoU从大到小贪心匹配检测框与预测框，匹配的轨迹用检测框校正，
+//   未匹配的检测新建轨迹，连续max_age个关键帧未匹配的轨迹删除
+// - 非关键帧只做预测，输出外推的框（置信度按confidence_decay衰减）
+// 结果中的track_id在轨迹存续期间保持不变。
+class ObjectTracker {
+public:
+    ObjectTracker();
+
+    void setOptions(const TrackerOptions& options) { options_ = options; }
+    const TrackerOptions& getOptions() const { return options_; }
+
+    // 关键帧：预测一帧后用detections校正，results输出本帧检测到的目标（带track_id）
+    void update(const std::vector<DetectionResult>& detections, std::vector<DetectionResult>& results);
+
+    // 非关键帧：所有轨迹预测一帧，results输出外推的框
+    void predict(std::vector<DetectionResult>& results);
+
+    void reset();
+
+    size_t trackCount() const { return tracks_.size(); }
+    const TrackerUpdateStats& lastUpdate() const { return last_update_; }
+
+    // 上个关键帧匹配到检测的轨迹（即predict输出的轨迹）中最低的置信度（外推后会逐帧衰减），
+    // 没有这样的轨迹时为1
+    float minConfidence() const;
+
+private:
+    // 单个维度的匀速卡尔曼滤波器
+    struct Axis {
+        float position = 0.0f;
+        float velocity = 0.0f;
+        float p00 = 0.0f, p01 = 0.0f, p10 = 0.0f, p11 = 0.0f;
+
+        void init(float value, float position_std, float velocity_std);
+        void predict(float position_std, float velocity_std);
+        void correct(float value, float measurement_std);
+    };
+
+    struct Track {
+        int id = 0;
+        int class_id = 0;
+        float confidence = 0.0f;
+        int misses = 0;              // 连续未匹配的关键帧数
+        Axis cx, cy, w, h;
+
+        cv::Rect box() const;
+    };
+
+    void initTrack(Track& track, const DetectionResult& detection);
+    void predictTrack(Track& track) const;
+    void correctTrack(Track& track, const DetectionResult& detection) const;
+    void emit(const Track& track, std::vector<DetectionResult>& results) const;
+
+    TrackerOptions options_;
+    std::vector<Track> tracks_;
+    int next_id_;
+    TrackerUpdateStats last_update_;
+
+    // 匹配的复用缓冲区
+    struct Candidate {
+        float iou;
+        int track;
+        int detection;
+    };
+    std::vector<Candidate> candidates_;
+    std::vector<int> track_match_;
+    std::vector<int> detection_match_;
+};
+
+#endif // OBJECT_TRACKER_H
@@ -0,0 +1,26 @@
+#ifndef ORT_RESOURCES_H
+#define ORT_RESOURCES_H
+
+#include <onnxruntime_cxx_api.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 进程内多个会话共享的ONNX Runtime资源：
+// - 同一模型路径的会话共享一个PrepackedWeightsContainer，预打包后的权重只保存一份
+// - OrtEnv在进程内是单例，共享CPU arena分配器在其上只注册一次，
+//   会话通过 session.use_env_allocators 使用它而不是各自创建arena
+class OrtResources {
+public:
+    // 获取（不存在时创建）model_path对应的预打包权重容器，所有使用者释放后容器随之销毁
+    static std::shared_ptr<Ort::PrepackedWeightsContainer> prepackedWeights(const std::string& model_path);
+
+    // 在env上注册共享CPU arena分配器，已注册时直接返回true（以首次注册的参数为准）。
+    // 注册随进程级OrtEnv存在，与注册时使用的Env包装对象是否已释放无关
+    // extend_strategy: "next_power_of_two" 或 "same_as_requested"
+    // initial_chunk_bytes <= 0 表示使用ORT默认值
+    static bool registerCpuArena(const std::shared_ptr<Ort::Env>& env, const std::string& extend_strategy,
+                                 int64_t initial_chunk_bytes);
+};
+
+#endif // ORT_RESOURCES_H
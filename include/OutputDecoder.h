@@ -0,0 +1,45 @@
+#ifndef OUTPUT_DECODER_H
+#define OUTPUT_DECODER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "LetterboxPreprocessor.h"
+
+// YOLOv8输出解码器：输入为通道优先布局[4+C, N]（每个通道的N个anchor连续存放）。
+// 先以SIMD按anchor并行计算类别最大分数并与阈值比较，只对通过阈值的anchor
+// 压缩存储并计算框坐标，被拒绝的anchor不做任何几何运算。
+// 对单类别(1)和COCO(80)类别数提供编译期特化，其余类别数走通用路径。
+class OutputDecoder {
+public:
+    OutputDecoder() = default;
+
+    // 筛选最大类别分数大于threshold的anchor，返回候选数量
+    int selectCandidates(const float* output, int num_classes, int num_anchors, float threshold);
+
+    // 筛选候选并将其映射回原图坐标，结果追加到boxes/confidences/class_ids
+    void decode(const float* output, int num_classes, int num_anchors, float threshold,
+                const LetterboxInfo& letterbox, const cv::Size& image_size,
+                std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                std::vector<int>& class_ids);
+
+    // 解码端到端模型（tools/export_end2end.py）的[K, 6]输出：每行x1, y1, x2, y2, score, class_id，
+    // 坐标为letterbox输入坐标，NMS已在图内完成；分数大于threshold的框映射回原图坐标后追加
+    static void decodeDetections(const float* detections, int count, float threshold,
+                                 const LetterboxInfo& letterbox, const cv::Size& image_size,
+                                 std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                                 std::vector<int>& class_ids);
+
+    // 最近一次selectCandidates的结果
+    const int* candidateIndices() const { return indices_.data(); }
+    const float* candidateScores() const { return scores_.data(); }
+    const int* candidateClasses() const { return classes_.data(); }
+
+private:
+    // 候选缓冲区按anchor数量一次分配，之后重复使用
+    std::vector<int> indices_;
+    std::vector<float> scores_;
+    std::vector<int> classes_;
+};
+
+#endif // OUTPUT_DECODER_H
@@ -0,0 +1,33 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "VideoPipeline.h"
+
+// 将逐帧检测结果流式写出为JSON-lines或CSV，写完即丢弃，内存占用与帧数无关
+class ResultWriter {
+public:
+    enum class Format { JsonLines, Csv };
+
+    static bool parseFormat(const std::string& name, Format& format);
+
+    // path为空或"-"时写到stdout
+    bool open(const std::string& path, Format format, const std::vector<std::string>& class_names);
+    void write(const FrameInfo& info, const std::vector<DetectionResult>& detections);
+    void close();
+
+private:
+    std::string className(int class_id) const;
+    static std::string csvEscape(const std::string& value);
+
+    Format format_ = Format::JsonLines;
+    std::vector<std::string> class_names_;
+    std::ofstream file_;
+    std::ostream* out_ = nullptr;
+};
+
+#endif // RESULT_WRITER_H
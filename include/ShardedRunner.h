@@ -0,0 +1,104 @@
+#ifndef SHARDED_RUNNER_H
+#define SHARDED_RUNNER_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+#include "AsyncDetector.h"
+#include "NumaTopology.h"
+
+struct ShardStats {
+    int node = 0;                 // 实例所在的NUMA节点
+    std::vector<int> cpus;        // 实例的核组
+    bool pinned = false;          // 线程是否成功绑定到核组
+    uint64_t completed = 0;       // 已完成的帧数
+    uint64_t failed = 0;          // 推理出错的帧数（回调收到Failed）
+    size_t outstanding = 0;       // 当前排队与执行中的帧数
+};
+
+// 多实例分片：发现NUMA拓扑后按节点（或节点内的核组）各启动一个检测器实例，
+// 多路插槽的主机上单个会话的线程与内存不再跨节点访问。
+// - 每个实例一个工作线程，先绑定到核组的第一个CPU，再在该线程上创建并初始化检测器：
+//   权重、arena与输入张量都由该线程首次写入，按first-touch策略分配在本节点
+// - 每个实例有独立的ORT算子内线程池（不使用全局线程池，也不共享预打包权重与arena），
+//   线程数等于核组的CPU数，额外的算子内线程逐个绑定到核组内其余的CPU
+// - 配置了optimized_model_path时第一个实例先初始化（写入缓存），其余实例随后并行初始化并加载该缓存
+// - 负载均衡：least_outstanding把帧交给排队+执行中帧数最少的实例；
+//   stream_affinity把同一路流（stream_id >= 0）固定到首次出现时负载最少的实例，同一路的帧按提交顺序完成
+// - 背压：每个实例的在途帧数不超过queue_capacity，达到上限时提交方阻塞
+// 单节点机器上group_by为node时只有一个实例（等同普通ObjectDetector），可改用cores按核组切分。
+// 图像按cv::Mat引用计数保留，帧完成前调用方不应改写其像素。
+class ShardedRunner {
+public:
+    using Callback = AsyncDetector::Callback;
+
+    ShardedRunner();
+    ~ShardedRunner();
+
+    // 按model/detection/shard配置发现拓扑并启动所有实例，任一实例初始化失败时返回false
+    bool initialize(JsonConfigManager& config_manager);
+
+    // 提交一帧，返回帧编号；停止后提交时回调以Failed状态在提交线程上立即调用并返回0
+    // 推理出错的帧回调状态为Failed（detectAsync的future抛出AsyncDetectError）
+    uint64_t submit(const cv::Mat& image, Callback callback, int64_t stream_id = -1);
+
+    // future版本，失败时get()抛出AsyncDetectError
+    std::future<std::vector<DetectionResult>> detectAsync(const cv::Mat& image, int64_t stream_id = -1);
+
+    // 同步检测（在实例线程上执行，调用方阻塞等待）
+    std::vector<DetectionResult> detect(const cv::Mat& image, int64_t stream_id = -1);
+
+    // 阻塞直到没有在途帧
+    void waitIdle();
+
+    // 执行完已提交的帧后停止所有实例
+    void stop();
+
+    int size() const { return static_cast<int>(shards_.size()); }
+    std::vector<ShardStats> getStats() const;
+
+private:
+    struct Request {
+        uint64_t id = 0;
+        cv::Mat image;
+        Callback callback;
+    };
+
+    struct Shard {
+        CoreGroup group;
+        std::thread worker;
+        std::condition_variable work_ready;
+        std::deque<Request> queue;
+        size_t outstanding = 0;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        bool pinned = false;
+    };
+
+    void workerLoop(Shard& shard, JsonConfigManager config_manager, std::promise<bool> ready);
+
+    // 选择负载最少的实例，调用时须持有mutex_
+    int leastOutstanding() const;
+
+    ShardConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable space_ready_;  // 有帧完成或停止
+    std::map<int64_t, int> stream_shards_; // stream_affinity下每路流所在的实例
+    uint64_t next_id_;
+    size_t in_flight_;
+    bool running_;
+};
+
+#endif // SHARDED_RUNNER_H
@@ -0,0 +1,105 @@
+#ifndef SHARED_RING_H
+#define SHARED_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 槽位写满时生产方的行为
+enum class RingOverflow : uint32_t {
+    Block = 0,            // 等待消费方释放槽位（不丢帧，生产方被消费方限速）
+    OverwriteOldest = 1   // 覆盖最早的未读槽位（不阻塞生产方，消费方总是拿到较新的帧）
+};
+
+struct RingStats {
+    uint64_t written = 0;   // 已发布的槽位数
+    uint64_t read = 0;      // 消费方已取走的槽位数
+    uint64_t dropped = 0;   // OverwriteOldest下被覆盖、未被读取的槽位数
+};
+
+// 进程间共享内存中的单生产者/单消费者环形缓冲区，槽位大小固定。
+// 每个槽位有一个原子状态（Empty -> Writing -> Ready -> Reading -> Empty），
+// 生产方与消费方通过CAS转移槽位的所有权，持有期间直接读写槽位内存，不经过任何拷贝。
+// 槽位带发布序号，消费方记录下一个期望的序号，只在扫描开始前已发布的序号中取最小的未读槽位，
+// 因此帧按发布顺序读出（覆盖模式下跳过被覆盖的序号）。
+// 等待采用自旋+退避轮询（跨进程不依赖平台的futex/事件对象）。
+// POSIX下使用shm_open的命名共享内存，Windows下使用页面文件支持的命名文件映射。
+class SharedRing {
+public:
+    // 槽位头，紧挨着槽位数据放在共享内存中
+    struct SlotHeader {
+        std::atomic<uint32_t> state;
+        uint32_t payload_bytes;
+        std::atomic<uint64_t> sequence;  // 环内的发布序号（从0开始连续递增），扫描时不持有槽位也会读取
+        uint64_t tag;             // 使用方的编号（帧号，或结果对应的帧号）
+        int64_t timestamp_us;     // 生产方发布时的steady_clock时间
+        int32_t width;            // 帧的宽高、行字节数与cv::Mat类型（结果环中width为检测框数）
+        int32_t height;
+        int32_t stride;
+        int32_t type;
+    };
+
+    // 持有中的槽位
+    struct Slot {
+        SlotHeader* header = nullptr;
+        uint8_t* data = nullptr;
+        size_t capacity = 0;
+        uint64_t sequence = 0;
+        int index = -1;
+
+        bool valid() const { return header != nullptr; }
+    };
+
+    SharedRing() = default;
+    ~SharedRing();
+
+    SharedRing(const SharedRing&) = delete;
+    SharedRing& operator=(const SharedRing&) = delete;
+
+    // 创建命名共享内存并初始化（同名的旧区域会被替换），关闭时删除名称
+    bool create(const std::string& name, int slot_count, size_t slot_bytes, RingOverflow overflow);
+
+    // 打开其他进程创建的环，槽位数、大小与溢出策略从共享内存读取
+    bool open(const std::string& name);
+    void close();
+
+    // 生产方：取得下一个可写槽位，timeout_ms < 0 表示一直等待
+    bool acquireWrite(Slot& slot, int timeout_ms = -1);
+    // 生产方：发布已写好的槽位
+    void publish(Slot& slot);
+
+    // 消费方：取得最早的未读槽位；OverwriteOldest下被覆盖的序号会被跳过
+    bool acquireRead(Slot& slot, int timeout_ms = -1);
+    // 消费方：归还槽位
+    void release(Slot& slot);
+
+    // 生产方结束（如视频读完），消费方读完剩余槽位后acquireRead立即返回false
+    void markClosed();
+    bool closed() const;
+
+    bool isOpen() const { return header_ != nullptr; }
+    int slotCount() const;
+    size_t slotBytes() const;
+    RingOverflow overflow() const;
+    RingStats getStats() const;
+
+private:
+    struct RingHeader;
+
+    bool map(const std::string& name, size_t size, bool create);
+    SlotHeader* slotHeader(int index) const;
+    void fillSlot(Slot& slot, int index, uint64_t sequence) const;
+
+    RingHeader* header_ = nullptr;
+    uint8_t* base_ = nullptr;
+    size_t mapped_size_ = 0;
+    size_t slot_stride_ = 0;          // 槽位头+数据，按缓存行对齐
+    std::string unlink_name_;         // 创建方关闭时删除的共享内存名称
+    uint64_t read_cursor_ = 0;        // 消费方：下一个期望读取的序号，更小的序号不再读出
+#ifdef _WIN32
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+#endif // SHARED_RING_H
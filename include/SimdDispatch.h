@@ -0,0 +1,43 @@
+#ifndef SIMD_DISPATCH_H
+#define SIMD_DISPATCH_H
+
+// SIMD内核的运行时分派。
+// AVX2/SSE4.1版本的内核以函数级target属性单独编译，库的其余代码保持编译器的基线指令集，
+// 运行时按CPU支持的指令集选择内核：没有AVX2的CPU上不会执行到任何AVX2指令。
+// MSVC允许在任意函数中使用内在函数，不需要target属性。
+// 仅x86-64：内核使用64位的_mm_cvtsi128_si64等指令
+#if defined(__x86_64__) || defined(_M_X64)
+#define YOLO_SIMD_SSE41 1
+#if defined(YOLO_ENABLE_AVX2)
+#define YOLO_SIMD_AVX2 1
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#define YOLO_TARGET_SSE41
+#define YOLO_TARGET_AVX2
+#else
+#define YOLO_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define YOLO_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+enum class SimdLevel {
+    Scalar = 0,
+    Sse41 = 1,
+    Avx2 = 2,
+};
+
+class SimdDispatch {
+public:
+    // 内核使用的指令集：CPU支持且已编译的最高级别，不超过setMaxLevel设置的上限
+    static SimdLevel level();
+
+    // CPU支持且已编译的最高级别（首次调用时检测）
+    static SimdLevel detected();
+
+    // 限制内核使用的最高级别（测试与基准中比较各级别的结果与速度）
+    static void setMaxLevel(SimdLevel level);
+
+    static const char* name(SimdLevel level);
+};
+
+#endif // SIMD_DISPATCH_H
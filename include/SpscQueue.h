@@ -0,0 +1,110 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 有界单生产者/单消费者无锁环形队列。
+// 生产者只写tail_，消费者只写head_，二者位于不同缓存行以避免伪共享。
+// 容量向上取整为2的幂，下标通过掩码回绕。
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : head_(0), tail_(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 生产者调用：队列已满时返回false
+    bool tryPush(T&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) {
+                return false;
+            }
+        }
+        buffer_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用：队列为空时返回false
+    bool tryPop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        value = std::move(buffer_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 阻塞式推入：自旋后退避，直到成功或stop被置位
+    bool push(T&& value, const std::atomic<bool>& stop) {
+        for (int spins = 0; !tryPush(std::move(value)); ++spins) {
+            if (stop.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            backoff(spins);
+        }
+        return true;
+    }
+
+    // 阻塞式弹出：自旋后退避，直到成功或stop被置位
+    bool pop(T& value, const std::atomic<bool>& stop) {
+        for (int spins = 0; !tryPop(value); ++spins) {
+            if (stop.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            backoff(spins);
+        }
+        return true;
+    }
+
+    // 近似的当前元素数量（任意线程可调用，用于监控）
+    size_t size() const {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t head = head_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static void backoff(int spins) {
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    static constexpr size_t kCacheLine = 64;
+
+    std::vector<T> buffer_;
+    size_t mask_;
+
+    alignas(kCacheLine) std::atomic<size_t> head_;  // 消费者位置
+    size_t tail_cache_ = 0;                         // 消费者缓存的tail_
+
+    alignas(kCacheLine) std::atomic<size_t> tail_;  // 生产者位置
+    size_t head_cache_ = 0;                         // 生产者缓存的head_
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,135 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct TelemetryConfig;
+
+// 热路径中计时的阶段
+enum class TelemetryStage {
+    Preprocess,
+    Inference,
+    Decode,
+    Nms,
+    Detect,      // 单次detect/detectBatch的端到端耗时
+    Count
+};
+
+enum class TelemetryCounter {
+    Frames,            // 完成后处理的图像数
+    Batches,           // detectBatch中执行的Run次数
+    Candidates,        // NMS前的候选框数
+    Detections,        // NMS后输出的检测框数
+    Errors,            // 推理异常次数
+    Count
+};
+
+enum class TelemetryGauge {
+    InFlight,          // 正在执行的detect/detectBatch调用数
+    Sessions,          // 当前存活的推理会话数
+    Count
+};
+
+// 延迟直方图的只读快照；桶上界按10us * 2^i 指数增长，最后一个桶为+Inf
+struct HistogramSnapshot {
+    static constexpr int kNumBuckets = 22;
+
+    std::array<uint64_t, kNumBuckets> buckets{};  // 各桶计数（非累计）
+    uint64_t count = 0;
+    double sum_ms = 0.0;
+
+    static double bucketUpperBoundMs(int bucket);
+
+    double meanMs() const { return count > 0 ? sum_ms / count : 0.0; }
+    // 在桶内线性插值估计分位数，q取值[0, 1]
+    double quantileMs(double q) const;
+};
+
+// 无锁延迟直方图：record只执行relaxed原子加，不分配内存
+class LatencyHistogram {
+public:
+    void record(int64_t nanoseconds);
+    HistogramSnapshot snapshot() const;
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::kNumBuckets> buckets_{};
+    std::atomic<uint64_t> sum_ns_{0};
+};
+
+struct TelemetrySnapshot {
+    std::array<HistogramSnapshot, static_cast<size_t>(TelemetryStage::Count)> stages;
+    std::array<uint64_t, static_cast<size_t>(TelemetryCounter::Count)> counters{};
+    std::array<int64_t, static_cast<size_t>(TelemetryGauge::Count)> gauges{};
+
+    const HistogramSnapshot& stage(TelemetryStage s) const { return stages[static_cast<size_t>(s)]; }
+    uint64_t counter(TelemetryCounter c) const { return counters[static_cast<size_t>(c)]; }
+    int64_t gauge(TelemetryGauge g) const { return gauges[static_cast<size_t>(g)]; }
+};
+
+// 进程级指标注册表：所有ObjectDetector实例（含DetectorPool与视频流水线中的实例）汇总到同一份指标
+// 记录接口均为无锁原子操作，可在任意线程的热路径中调用；导出在独立线程中完成
+class Telemetry {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static Telemetry& instance();
+
+    ~Telemetry();
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void recordLatency(TelemetryStage stage, int64_t nanoseconds);
+    // 记录从start到现在的耗时并返回当前时间，便于连续阶段链式计时
+    Clock::time_point recordSince(TelemetryStage stage, Clock::time_point start);
+    void increment(TelemetryCounter counter, uint64_t value = 1);
+    void addGauge(TelemetryGauge gauge, int64_t delta);
+
+    TelemetrySnapshot snapshot() const;
+    void reset();
+
+    // Prometheus文本格式（0.0.4）
+    std::string toPrometheus() const;
+    // 先写临时文件再重命名，抓取方不会读到半个文件
+    bool writePrometheusFile(const std::string& path) const;
+    // 以info级别输出各阶段p50/p99与计数器
+    void logSummary() const;
+
+    // 按配置启动导出线程（周期写文件 和/或 本地HTTP端点）；重复调用会先停止已有导出
+    bool startExporter(const TelemetryConfig& config);
+    void stopExporter();
+
+    static const char* stageName(TelemetryStage stage);
+    static const char* counterName(TelemetryCounter counter);
+    static const char* gaugeName(TelemetryGauge gauge);
+
+private:
+    Telemetry() = default;
+
+    void fileExportLoop(std::string path, int interval_ms);
+    void httpServeLoop(intptr_t listen_socket);
+
+    std::atomic<bool> enabled_{true};
+    std::array<LatencyHistogram, static_cast<size_t>(TelemetryStage::Count)> histograms_;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(TelemetryCounter::Count)> counters_{};
+    std::array<std::atomic<int64_t>, static_cast<size_t>(TelemetryGauge::Count)> gauges_{};
+
+    // 导出线程
+    std::mutex exporter_mutex_;
+    std::condition_variable exporter_cv_;
+    bool stop_exporter_ = false;
+    std::thread file_thread_;
+    std::thread http_thread_;
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,81 @@
+#ifndef TILED_DETECTOR_H
+#define TILED_DETECTOR_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "DetectorPool.h"
+#include "JsonConfigManager.h"
+#include "NmsEngine.h"
+
+// 切片检测：整图letterbox到640x640后小目标（如4K画面中的人脸）只剩几个像素，
+// 这里把原图切成重叠的tile，每个tile以原分辨率检测，再把框映射回原图并跨tile去重。
+// - tile是源图像的ROI（只创建Mat头，不拷贝像素），经detectBatch直接预处理进同一个batch张量
+// - 可选的整图检测作为batch中的一项，保留跨越多个tile的大目标
+// - sessions > 1 时tile分块后在多个会话上并行推理：第0块在调用线程上执行，其余各块由
+//   initialize时启动的常驻工作线程执行，每帧只做一次唤醒与等待，不再创建/回收线程
+// - 合并：nms按IoU抑制；nmm把被tile边界切开的同一目标按交集/较小框面积合并为外接框
+class TiledDetector {
+public:
+    TiledDetector();
+    ~TiledDetector();
+
+    // 按tiling配置创建tiling.sessions个会话（共享Env，见DetectorPool）
+    bool initialize(JsonConfigManager& config_manager);
+
+    // 使用调用方的检测器（单会话），不获取所有权
+    void initialize(ObjectDetector& detector, const TilingConfig& config);
+
+    std::vector<DetectionResult> detect(const cv::Mat& image);
+    void detect(const cv::Mat& image, std::vector<DetectionResult>& results);
+
+    // 按tile尺寸与重叠比例计算切片区域：步长为 tile * (1 - overlap)，
+    // 最后一行/列的tile向内平移以保持完整尺寸；图像小于tile时该方向只有一个tile
+    static std::vector<cv::Rect> computeTiles(const cv::Size& image_size, const cv::Size& tile_size, float overlap);
+
+    // 对所有tile合并后的检测结果去重（按分数降序输出）
+    static void mergeDetections(std::vector<DetectionResult>& detections, const TilingConfig& config,
+                                NmsEngine& engine);
+
+    const TilingConfig& getConfig() const { return config_; }
+
+    // 上一次detect处理的区域数（tile数 + 整图）
+    int lastRegionCount() const { return static_cast<int>(regions_.size()); }
+
+private:
+    // 检测regions_[begin, end)，结果映射回原图坐标
+    void detectRegions(ObjectDetector& detector, const cv::Mat& image, size_t begin, size_t end,
+                       std::vector<DetectionResult>& results);
+
+    // 区域按chunks均分时第chunk块的起始下标
+    size_t chunkBegin(size_t chunk, size_t chunks) const { return regions_.size() * chunk / chunks; }
+
+    // 第chunk块（chunk >= 1）的常驻工作线程
+    void workerLoop(size_t chunk);
+    void stopWorkers();
+
+    TilingConfig config_;
+    std::unique_ptr<DetectorPool> pool_;     // initialize(config)创建的会话
+    ObjectDetector* detector_;               // 外部检测器，pool_为空时使用
+
+    std::vector<cv::Rect> regions_;          // 本次检测的区域（整图在前）
+    std::vector<std::vector<DetectionResult>> chunk_results_;  // 每个会话分块的结果
+    NmsEngine nms_engine_;
+
+    std::vector<std::thread> workers_;       // workers_[k]处理第k+1块
+    std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable work_done_;
+    const cv::Mat* job_image_;               // 当前帧，detect返回前一直有效
+    size_t job_chunks_;                      // 当前帧的分块数，块号不小于它的线程本帧空闲
+    uint64_t job_generation_;                // 每帧加一，工作线程据此识别新任务
+    size_t pending_;                         // 本帧尚未完成的工作线程数
+    bool stopping_;
+};
+
+#endif // TILED_DETECTOR_H
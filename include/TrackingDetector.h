@@ -0,0 +1,60 @@
+#ifndef TRACKING_DETECTOR_H
+#define TRACKING_DETECTOR_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "ObjectTracker.h"
+#include "JsonConfigManager.h"
+
+struct TrackingStats {
+    uint64_t frames = 0;             // 已处理帧数
+    uint64_t keyframes = 0;          // 执行完整检测的帧数
+    uint64_t early_keyframes = 0;    // 因置信度衰减或轨迹丢失提前检测的帧数
+    int interval = 0;                // 当前检测间隔
+};
+
+// 检测+跟踪：只在关键帧上运行ObjectDetector，中间帧由ObjectTracker按运动模型外推，
+// 结果带有稳定的track_id。帧须按顺序逐帧传入。
+// 自适应调度（tracking.adaptive）：
+// - 关键帧上所有轨迹都匹配且没有新目标时，检测间隔加1（不超过max_interval）
+// - 有轨迹丢失或出现新目标时，间隔减半（不低于min_interval）
+// - 外推轨迹的置信度衰减到min_confidence以下时，不等间隔到期立即检测
+class TrackingDetector {
+public:
+    TrackingDetector();
+    ~TrackingDetector();
+
+    // 按model/detection/tracking配置创建检测器
+    bool initialize(JsonConfigManager& config_manager);
+
+    // 使用调用方的检测器，不获取所有权
+    void initialize(ObjectDetector& detector, const TrackingConfig& config);
+
+    // 处理下一帧，返回本帧是否执行了完整检测
+    bool process(const cv::Mat& frame, std::vector<DetectionResult>& results);
+
+    // 清空轨迹，下一帧重新检测（切换视频源时调用）
+    void reset();
+
+    const TrackingStats& getStats() const { return stats_; }
+    const TrackingConfig& getConfig() const { return config_; }
+
+private:
+    bool needsDetection() const;
+    void adjustInterval(bool had_tracks);
+
+    TrackingConfig config_;
+    std::unique_ptr<ObjectDetector> owned_detector_;
+    ObjectDetector* detector_;
+    ObjectTracker tracker_;
+    std::vector<DetectionResult> detections_;
+    int interval_;
+    int frames_since_keyframe_;      // -1表示尚未检测过
+    TrackingStats stats_;
+};
+
+#endif // TRACKING_DETECTOR_H
@@ -0,0 +1,152 @@
+#ifndef VIDEO_PIPELINE_H
+#define VIDEO_PIPELINE_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+#include "SpscQueue.h"
+#include "ImageSource.h"
+
+// 单个阶段的统计快照
+struct PipelineStageStats {
+    std::string name;
+    int workers = 0;
+    uint64_t frames = 0;         // 已处理帧数
+    double fps = 0.0;            // 自启动以来的吞吐量
+    double avg_latency_ms = 0.0; // 单帧平均处理耗时（不含排队）
+    size_t queue_depth = 0;      // 该阶段所有输入队列中的帧数
+    size_t queue_capacity = 0;   // 该阶段所有输入队列的总容量
+};
+
+// 随每帧结果一起回调的信息
+struct FrameInfo {
+    int64_t index = 0;           // 输入顺序中的序号
+    std::string source;          // 图像模式下为文件路径，视频模式下为空
+    cv::Size image_size;         // 原图尺寸（解码失败时为0）
+    bool valid = true;           // 解码/推理是否成功
+    double latency_ms = 0.0;     // 从进入流水线到输出的端到端耗时
+};
+
+struct PipelineStats {
+    std::vector<PipelineStageStats> stages;
+    uint64_t frames = 0;         // 已按序输出的帧数
+    double elapsed_s = 0.0;
+    double fps = 0.0;
+};
+
+// 多阶段视频流水线：解码 -> 预处理 -> 推理 -> 后处理(解码+NMS) -> 按序输出。
+// - 相邻两级的每一对工作线程之间各有一条有界SPSC无锁队列，
+//   第i帧固定由各级的第 i % workers 个线程处理，消费者按帧序号轮询对应队列，
+//   因此无需重排缓冲即可保证输出顺序与输入一致
+// - 每个推理线程持有独立的ObjectDetector会话，后处理线程持有只做postprocess的实例
+// - 队列容量限制了在途帧数，从而限制内存占用
+class VideoPipeline {
+public:
+    // 帧按输入顺序回调，在调用run的线程中执行
+    // 图像模式开启reduced_decode时frame可能是降分辨率解码的图像，检测框已映射到原图坐标（info.image_size）
+    using FrameCallback = std::function<void(const FrameInfo& info, const cv::Mat& frame,
+                                             const std::vector<DetectionResult>& detections)>;
+
+    VideoPipeline();
+    ~VideoPipeline();
+
+    // 按配置创建各阶段工作对象（每个推理线程加载一次模型）
+    bool initialize(JsonConfigManager& config_manager);
+
+    // 处理视频文件或摄像头（纯数字视为摄像头编号），阻塞直到流结束或stop()
+    // max_frames <= 0 表示处理全部帧；读取帧时出错则已读入的帧照常输出，之后返回false
+    bool run(const std::string& source, const FrameCallback& callback, int64_t max_frames = 0);
+
+    // 处理图像序列：解码阶段只枚举路径，图像在预处理线程中并行解码
+    bool runImages(ImageSource& images, const FrameCallback& callback, int64_t max_frames = 0);
+
+    // 请求停止，可在回调或其他线程中调用
+    void stop();
+
+    // 各阶段吞吐量、平均耗时与队列深度，可在运行期间从任意线程调用
+    PipelineStats getStats() const;
+
+    // 以表格形式输出统计
+    void logStats() const;
+
+private:
+    struct FramePacket {
+        int64_t index = 0;
+        std::string path;   // 非空时由预处理线程从该路径解码frame
+        std::chrono::steady_clock::time_point start;
+        cv::Mat frame;
+        cv::Size original_size;  // 降分辨率解码时的原图尺寸，检测框映射到该尺寸
+        std::vector<float> input_tensor;
+        std::vector<uint8_t> input_bytes;  // uint8输入模式下的letterbox图像（NHWC BGR）
+        cv::Size input_size;     // 输入张量的宽高（minimal letterbox模式下随帧的宽高比变化）
+        std::vector<float> output;
+        std::vector<int64_t> output_shape;
+        std::vector<DetectionResult> detections;
+        bool valid = true;  // 任一阶段失败后置为false，帧仍按序传递以保持顺序
+    };
+    // 空指针作为流结束标记
+    using PacketPtr = std::unique_ptr<FramePacket>;
+    using PacketQueue = SpscQueue<PacketPtr>;
+
+    struct Stage {
+        std::string name;
+        int workers = 1;
+        int producers = 0;  // 上一级的线程数
+        // inputs[producer * workers + worker]
+        std::vector<std::unique_ptr<PacketQueue>> inputs;
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> busy_ns{0};
+
+        PacketQueue& input(int producer, int worker) { return *inputs[producer * workers + worker]; }
+    };
+
+    using Processor = void (VideoPipeline::*)(int worker, FramePacket& packet);
+    // 解码阶段填充下一帧（图像或路径），流结束时返回false
+    using FrameReader = std::function<bool(FramePacket& packet)>;
+
+    // 每次run重建队列，避免上一次残留的结束标记
+    void buildStages();
+    bool runStages(const std::string& description, const FrameReader& reader,
+                   const FrameCallback& callback, int64_t max_frames);
+    void decodeLoop(const FrameReader& reader, int64_t max_frames);
+    void workerLoop(size_t stage_index, int worker, Processor process);
+    void collectOutput(const FrameCallback& callback);
+    void sendEndOfStream(Stage& next, int producer);
+
+    void preprocess(int worker, FramePacket& packet);
+    void inference(int worker, FramePacket& packet);
+    void postprocess(int worker, FramePacket& packet);
+
+    PipelineConfig config_;
+    cv::Size input_size_;
+    InputFormat input_format_ = InputFormat::Float32Nchw;
+
+    // stages_[0]为解码，最后一级为输出，中间为预处理/推理/后处理
+    // buildStages替换stages_与start_time_时持有stages_mutex_，getStats在其他线程读取时同样加锁；
+    // 流水线线程只在两次buildStages之间访问stages_，不需要加锁
+    std::vector<std::unique_ptr<Stage>> stages_;
+    mutable std::mutex stages_mutex_;
+    // 输出阶段回收的帧包（SPSC：输出线程 -> 解码线程），复用张量缓冲区
+    std::unique_ptr<PacketQueue> free_packets_;
+
+    std::vector<std::unique_ptr<LetterboxPreprocessor>> preprocessors_;
+    std::vector<std::unique_ptr<ImageLoader>> loaders_;  // 图像模式下各预处理线程的解码器
+    std::vector<std::unique_ptr<ObjectDetector>> inference_detectors_;
+    std::vector<std::unique_ptr<ObjectDetector>> postprocess_detectors_;
+
+    std::atomic<bool> stop_;
+    std::atomic<bool> decode_failed_;  // 解码线程因异常提前结束，本次run返回false
+    std::chrono::steady_clock::time_point start_time_;
+};
+
+#endif // VIDEO_PIPELINE_H
@@ -0,0 +1,251 @@
+#include "AsyncDetector.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+const char* statusName(AsyncStatus status) {
+    switch (status) {
+    case AsyncStatus::Completed:
+        return "completed";
+    case AsyncStatus::Rejected:
+        return "rejected: too many requests in flight";
+    case AsyncStatus::Cancelled:
+        return "cancelled";
+    default:
+        return "failed: detector is not running";
+    }
+}
+
+} // namespace
+
+AsyncDetectError::AsyncDetectError(AsyncStatus status)
+    : std::runtime_error(std::string("Async detect request ") + statusName(status))
+    , status_(status) {}
+
+AsyncDetector::AsyncDetector()
+    : reject_(false)
+    , pool_(nullptr)
+    , next_id_(1)
+    , running_(false) {}
+
+AsyncDetector::~AsyncDetector() {
+    stop();
+}
+
+bool AsyncDetector::initialize(JsonConfigManager& config_manager) {
+    stop();
+    const AsyncConfig& config = config_manager.getAsyncConfig();
+    owned_pool_ = std::make_unique<DetectorPool>();
+    if (!owned_pool_->initialize(config_manager, std::max(1, config.sessions))) {
+        spdlog::error("Failed to initialize detector pool for async detection");
+        owned_pool_.reset();
+        pool_ = nullptr;
+        return false;
+    }
+    return initialize(*owned_pool_, config);
+}
+
+bool AsyncDetector::initialize(DetectorPool& pool, const AsyncConfig& config) {
+    stop();
+    if (pool.size() <= 0) {
+        spdlog::error("Async detection needs at least one pool session");
+        return false;
+    }
+
+    config_ = config;
+    config_.max_in_flight = std::max(1, config_.max_in_flight);
+    if (config_.overflow != "wait" && config_.overflow != "reject") {
+        spdlog::warn("Unknown async overflow policy '{}', using wait", config_.overflow);
+        config_.overflow = "wait";
+    }
+    reject_ = config_.overflow == "reject";
+    pool_ = &pool;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+        stats_ = AsyncStats();
+    }
+
+    for (int i = 0; i < pool.size(); ++i) {
+        workers_.emplace_back(&AsyncDetector::workerLoop, this);
+    }
+    spdlog::info("Async detection: {} workers, at most {} requests in flight ({}{})", pool.size(),
+                 config_.max_in_flight, config_.overflow,
+                 !reject_ && config_.wait_timeout_ms > 0 ? ", timeout " + std::to_string(config_.wait_timeout_ms) + " ms"
+                                                         : std::string());
+    return true;
+}
+
+uint64_t AsyncDetector::submit(const cv::Mat& image, Callback callback) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto has_space = [this]() {
+        return !running_ || stats_.in_flight < static_cast<size_t>(config_.max_in_flight);
+    };
+
+    bool accepted = false;
+    if (!running_) {
+        accepted = false;
+    } else if (reject_) {
+        accepted = has_space();
+    } else if (config_.wait_timeout_ms > 0) {
+        accepted = space_ready_.wait_for(lock, std::chrono::milliseconds(config_.wait_timeout_ms), has_space);
+    } else {
+        space_ready_.wait(lock, has_space);
+        accepted = true;
+    }
+
+    if (!accepted || !running_) {
+        // 未被接受的请求不进入队列，回调在提交线程上立即调用（等待期间停止时为Failed）
+        AsyncStatus status = running_ ? AsyncStatus::Rejected : AsyncStatus::Failed;
+        if (status == AsyncStatus::Rejected) {
+            ++stats_.rejected;
+        } else {
+            ++stats_.failed;
+        }
+        lock.unlock();
+        if (callback) {
+            std::vector<DetectionResult> empty;
+            callback(0, status, empty);
+        }
+        return 0;
+    }
+
+    Request request;
+    request.id = next_id_++;
+    request.image = image;
+    request.callback = std::move(callback);
+    uint64_t id = request.id;
+    queue_.push_back(std::move(request));
+    ++stats_.submitted;
+    ++stats_.in_flight;
+    stats_.peak_in_flight = std::max(stats_.peak_in_flight, stats_.in_flight);
+    lock.unlock();
+    work_ready_.notify_one();
+    return id;
+}
+
+std::future<std::vector<DetectionResult>> AsyncDetector::detectAsync(const cv::Mat& image, uint64_t* id) {
+    auto promise = std::make_shared<std::promise<std::vector<DetectionResult>>>();
+    std::future<std::vector<DetectionResult>> future = promise->get_future();
+    uint64_t request_id = submit(image, [promise](uint64_t, AsyncStatus status, std::vector<DetectionResult>& results) {
+        if (status == AsyncStatus::Completed) {
+            promise->set_value(std::move(results));
+        } else {
+            promise->set_exception(std::make_exception_ptr(AsyncDetectError(status)));
+        }
+    });
+    if (id) {
+        *id = request_id;
+    }
+    return future;
+}
+
+bool AsyncDetector::cancel(uint64_t id) {
+    Request request;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(queue_.begin(), queue_.end(), [id](const Request& queued) { return queued.id == id; });
+        if (it == queue_.end()) {
+            return false;
+        }
+        request = std::move(*it);
+        queue_.erase(it);
+    }
+    std::vector<DetectionResult> empty;
+    finish(request, AsyncStatus::Cancelled, empty);
+    return true;
+}
+
+size_t AsyncDetector::cancelAll() {
+    std::deque<Request> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled.swap(queue_);
+    }
+    std::vector<DetectionResult> empty;
+    for (auto& request : cancelled) {
+        finish(request, AsyncStatus::Cancelled, empty);
+    }
+    return cancelled.size();
+}
+
+void AsyncDetector::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_ready_.wait(lock, [this]() { return stats_.in_flight == 0; });
+}
+
+void AsyncDetector::stop() {
+    if (workers_.empty()) {
+        return;
+    }
+    size_t cancelled = cancelAll();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    // 唤醒空闲的工作线程与等待空位的提交方；停止前已入队的请求由工作线程执行完
+    work_ready_.notify_all();
+    space_ready_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+    if (cancelled > 0) {
+        spdlog::info("Async detection stopped, {} queued requests cancelled", cancelled);
+    }
+}
+
+AsyncStats AsyncDetector::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void AsyncDetector::workerLoop() {
+    std::vector<DetectionResult> results;
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_ready_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            request = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        bool ok = false;
+        {
+            DetectorPool::Lease lease = pool_->acquire();
+            ok = lease->detect(request.image, results);
+        }
+        // 推理出错的请求以Failed完成，不把空结果当作"未检测到目标"交给调用方
+        finish(request, ok ? AsyncStatus::Completed : AsyncStatus::Failed, results);
+    }
+}
+
+void AsyncDetector::finish(Request& request, AsyncStatus status, std::vector<DetectionResult>& results) {
+    // 回调返回后才释放名额：回调中持有的图像与结果同样计入在途上限
+    if (request.callback) {
+        request.callback(request.id, status, results);
+    }
+    request.image.release();
+    request.callback = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --stats_.in_flight;
+        switch (status) {
+        case AsyncStatus::Completed:
+            ++stats_.completed;
+            break;
+        case AsyncStatus::Cancelled:
+            ++stats_.cancelled;
+            break;
+        default:
+            ++stats_.failed;
+            break;
+        }
+    }
+    space_ready_.notify_all();
+}
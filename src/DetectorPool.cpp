@@ -0,0 +1,156 @@
+#include "DetectorPool.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+DetectorPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_)
+    , index_(other.index_) {
+    other.pool_ = nullptr;
+    other.index_ = -1;
+}
+
+DetectorPool::Lease& DetectorPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        index_ = other.index_;
+        other.pool_ = nullptr;
+        other.index_ = -1;
+    }
+    return *this;
+}
+
+DetectorPool::Lease::~Lease() {
+    release();
+}
+
+ObjectDetector* DetectorPool::Lease::operator->() const {
+    return pool_->detectors_[index_].get();
+}
+
+ObjectDetector& DetectorPool::Lease::operator*() const {
+    return *pool_->detectors_[index_];
+}
+
+void DetectorPool::Lease::release() {
+    if (pool_) {
+        pool_->pushFree(index_);
+        pool_ = nullptr;
+        index_ = -1;
+    }
+}
+
+DetectorPool::DetectorPool()
+    : head_(0) {
+}
+
+DetectorPool::~DetectorPool() = default;
+
+bool DetectorPool::initialize(JsonConfigManager& config_manager, int sessions) {
+    const auto& model_config = config_manager.getModelConfig();
+    const auto& pool_config = config_manager.getPoolConfig();
+    if (sessions <= 0) {
+        sessions = std::max(1, pool_config.sessions);
+    }
+
+    detectors_.clear();
+    head_.store(0);
+
+    try {
+        // 所有会话共享一个Env；全局线程池模式下算子线程也只创建一份
+        if (pool_config.global_thread_pools) {
+            Ort::ThreadingOptions threading_options;
+            threading_options.SetGlobalIntraOpNumThreads(model_config.intra_op_threads);
+            threading_options.SetGlobalInterOpNumThreads(model_config.inter_op_threads);
+            env_ = std::make_shared<Ort::Env>(threading_options, ORT_LOGGING_LEVEL_WARNING, "DetectorPool");
+        } else {
+            env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "DetectorPool");
+        }
+    }
+    catch (const Ort::Exception& e) {
+        spdlog::error("ONNX Runtime Exception while creating pool environment: {}", e.what());
+        return false;
+    }
+
+    for (int i = 0; i < sessions; ++i) {
+        auto detector = std::make_unique<ObjectDetector>();
+        detector->setEnvironment(env_, pool_config.global_thread_pools);
+        if (!detector->initialize(config_manager)) {
+            spdlog::error("Failed to initialize pool session {}", i);
+            detectors_.clear();
+            return false;
+        }
+        detectors_.push_back(std::move(detector));
+    }
+
+    next_ = std::make_unique<std::atomic<uint32_t>[]>(sessions);
+    for (int i = 0; i < sessions; ++i) {
+        pushFree(i);
+    }
+
+    spdlog::info("Detector pool initialized with {} sessions ({})", sessions,
+                 pool_config.global_thread_pools ? "global thread pools" : "per-session thread pools");
+    return true;
+}
+
+int DetectorPool::popFree() {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0) {
+            return -1;
+        }
+        uint32_t next = next_[top - 1].load(std::memory_order_relaxed);
+        uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+        if (head_.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return static_cast<int>(top - 1);
+        }
+    }
+}
+
+void DetectorPool::pushFree(int index) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    for (;;) {
+        next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        uint64_t new_head = (((head >> 32) + 1) << 32) | static_cast<uint32_t>(index + 1);
+        if (head_.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+DetectorPool::Lease DetectorPool::acquire() {
+    for (int spins = 0; ; ++spins) {
+        int index = popFree();
+        if (index >= 0) {
+            return Lease(this, index);
+        }
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+DetectorPool::Lease DetectorPool::tryAcquire() {
+    int index = popFree();
+    return index >= 0 ? Lease(this, index) : Lease();
+}
+
+std::vector<DetectionResult> DetectorPool::detect(const cv::Mat& image) {
+    std::vector<DetectionResult> results;
+    detect(image, results);
+    return results;
+}
+
+bool DetectorPool::detect(const cv::Mat& image, std::vector<DetectionResult>& results) {
+    if (detectors_.empty()) {
+        spdlog::error("Detector pool is not initialized");
+        results.clear();
+        return false;
+    }
+    Lease lease = acquire();
+    return lease->detect(image, results);
+}
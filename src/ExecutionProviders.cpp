@@ -0,0 +1,340 @@
+#include "ExecutionProviders.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct KnownProvider {
+    const char* name;      // 规范名称
+    const char* ort_name;  // Ort::GetAvailableProviders中的名称
+};
+
+const KnownProvider kKnownProviders[] = {
+    { "cpu", "CPUExecutionProvider" },
+    { "cuda", "CUDAExecutionProvider" },
+    { "xnnpack", "XnnpackExecutionProvider" },
+    { "dnnl", "DnnlExecutionProvider" },
+    { "openvino", "OpenVINOExecutionProvider" },
+};
+
+std::mutex g_choice_mutex;
+std::map<std::string, std::string> g_choices;   // 进程内记忆的auto选择：指纹 -> 提供者
+
+std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+std::string joined(const std::vector<std::string>& names) {
+    std::string text;
+    for (const auto& name : names) {
+        text += (text.empty() ? "" : ", ") + name;
+    }
+    return text;
+}
+
+std::string hostName() {
+#ifdef _WIN32
+    const char* name = std::getenv("COMPUTERNAME");
+    return name ? name : "";
+#else
+    char name[256] = {};
+    return gethostname(name, sizeof(name) - 1) == 0 ? name : "";
+#endif
+}
+
+std::string cpuModel() {
+#ifdef _WIN32
+    const char* identifier = std::getenv("PROCESSOR_IDENTIFIER");
+    return identifier ? identifier : "";
+#else
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            return line.substr(line.find(':') + 1);
+        }
+    }
+    return "";
+#endif
+}
+
+// FNV-1a 64位
+std::string hashHex(const std::string& text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+void appendCuda(Ort::SessionOptions& session_options, const std::map<std::string, std::string>& options) {
+    OrtCUDAProviderOptions cuda_options;
+    cuda_options.device_id = 0;  // Use the first GPU
+    cuda_options.arena_extend_strategy = 0;
+    cuda_options.gpu_mem_limit = SIZE_MAX;
+    cuda_options.cudnn_conv_algo_search = OrtCudnnConvAlgoSearchExhaustive;
+    cuda_options.do_copy_in_default_stream = 1;
+
+    // cudnn_conv_algo_search：
+    // "exhaustive" (默认) - 最优化但可能较慢
+    // "heuristic" - 启发式搜索，较快但可能不是最优
+    // "default" - 不搜索，最快但可能不是最优
+    for (const auto& [key, value] : options) {
+        if (key == "device_id") {
+            cuda_options.device_id = std::stoi(value);
+        } else if (key == "cudnn_conv_algo_search") {
+            cuda_options.cudnn_conv_algo_search = value == "heuristic" ? OrtCudnnConvAlgoSearchHeuristic
+                : value == "default" ? OrtCudnnConvAlgoSearchDefault : OrtCudnnConvAlgoSearchExhaustive;
+        } else if (key == "gpu_mem_limit") {
+            cuda_options.gpu_mem_limit = static_cast<size_t>(std::stoull(value));
+        } else {
+            spdlog::warn("Unknown CUDA provider option '{}'", key);
+        }
+    }
+    session_options.AppendExecutionProvider_CUDA(cuda_options);
+}
+
+void appendDnnl(Ort::SessionOptions& session_options, const std::map<std::string, std::string>& options) {
+    // oneDNN在C++ API中没有对应的追加函数，经由C API的provider options对象
+    const OrtApi& api = Ort::GetApi();
+    OrtDnnlProviderOptions* dnnl_options = nullptr;
+    Ort::ThrowOnError(api.CreateDnnlProviderOptions(&dnnl_options));
+    auto release = [&api](OrtDnnlProviderOptions* ptr) { api.ReleaseDnnlProviderOptions(ptr); };
+    std::unique_ptr<OrtDnnlProviderOptions, decltype(release)> guard(dnnl_options, release);
+
+    std::vector<const char*> keys;
+    std::vector<const char*> values;
+    for (const auto& [key, value] : options) {
+        keys.push_back(key.c_str());
+        values.push_back(value.c_str());
+    }
+    Ort::ThrowOnError(api.UpdateDnnlProviderOptions(dnnl_options, keys.data(), values.data(), keys.size()));
+    Ort::ThrowOnError(api.SessionOptionsAppendExecutionProvider_Dnnl(session_options, dnnl_options));
+}
+
+} // namespace
+
+std::string ExecutionProviders::canonicalName(const std::string& name) {
+    std::string canonical = lower(name);
+    if (canonical == "onednn" || canonical == "mkldnn") {
+        return "dnnl";
+    }
+    if (canonical == "gpu") {
+        return "cuda";
+    }
+    return canonical;
+}
+
+std::vector<ProviderSpec> ExecutionProviders::fromConfig(
+    const std::vector<std::string>& providers,
+    const std::map<std::string, std::map<std::string, std::string>>& options,
+    const std::string& device_type) {
+    std::vector<std::string> names = providers;
+    if (names.empty()) {
+        names.push_back(device_type == "GPU" ? "cuda" : "cpu");
+    }
+
+    // 选项的键同样按规范名称匹配
+    std::map<std::string, std::map<std::string, std::string>> canonical_options;
+    for (const auto& [provider, values] : options) {
+        canonical_options[canonicalName(provider)] = values;
+    }
+
+    std::vector<ProviderSpec> specs;
+    for (const auto& name : names) {
+        ProviderSpec spec;
+        spec.name = canonicalName(name);
+        auto it = canonical_options.find(spec.name);
+        if (it != canonical_options.end()) {
+            spec.options = it->second;
+        }
+        specs.push_back(spec);
+    }
+    // auto模式下候选提供者的选项也需要保留
+    if (isAuto(specs)) {
+        for (const auto& [provider, values] : canonical_options) {
+            specs.push_back({ provider, values });
+        }
+    }
+    return specs;
+}
+
+bool ExecutionProviders::isAuto(const std::vector<ProviderSpec>& providers) {
+    return !providers.empty() && providers.front().name == "auto";
+}
+
+std::vector<std::string> ExecutionProviders::available() {
+    std::vector<std::string> ort_names = Ort::GetAvailableProviders();
+    std::vector<std::string> names;
+    for (const auto& known : kKnownProviders) {
+        if (std::find(ort_names.begin(), ort_names.end(), known.ort_name) != ort_names.end()) {
+            names.push_back(known.name);
+        }
+    }
+    return names;
+}
+
+bool ExecutionProviders::isAvailable(const std::string& name) {
+    std::vector<std::string> names = available();
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+std::vector<std::string> ExecutionProviders::append(Ort::SessionOptions& session_options,
+                                                    const std::vector<ProviderSpec>& providers) {
+    std::vector<std::string> applied;
+    for (const auto& spec : providers) {
+        if (spec.name == "cpu") {
+            // CPU总是最后的回退，排在它后面的提供者不会被分配到任何算子
+            break;
+        }
+        if (!isAvailable(spec.name)) {
+            spdlog::warn("Execution provider '{}' is not available in this ONNX Runtime build (available: {}), "
+                         "skipping", spec.name, joined(available()));
+            continue;
+        }
+        try {
+            if (spec.name == "cuda") {
+                appendCuda(session_options, spec.options);
+            } else if (spec.name == "xnnpack") {
+                // XNNPACK使用自己的线程池，ORT的算子内线程不应自旋等待与其争抢CPU
+                session_options.AddConfigEntry("session.intra_op.allow_spinning", "0");
+                std::unordered_map<std::string, std::string> options(spec.options.begin(), spec.options.end());
+                session_options.AppendExecutionProvider("XNNPACK", options);
+            } else if (spec.name == "dnnl") {
+                appendDnnl(session_options, spec.options);
+            } else if (spec.name == "openvino") {
+                std::unordered_map<std::string, std::string> options(spec.options.begin(), spec.options.end());
+                // 本项目以CPU推理为主，未指定设备时使用OpenVINO的CPU插件
+                options.emplace("device_type", "CPU");
+                session_options.AppendExecutionProvider_OpenVINO_V2(options);
+            }
+            applied.push_back(spec.name);
+        }
+        catch (const std::exception& e) {
+            spdlog::warn("Execution provider '{}' could not be added ({}), skipping", spec.name, e.what());
+        }
+    }
+    applied.push_back("cpu");
+    return applied;
+}
+
+std::string ExecutionProviders::cacheTag(const std::vector<ProviderSpec>& providers,
+                                         const std::vector<std::string>& active) {
+    std::string tag;
+    std::string options;
+    for (const auto& name : active) {
+        tag += (tag.empty() ? "" : "-") + name;
+        auto spec = std::find_if(providers.begin(), providers.end(),
+                                 [&name](const ProviderSpec& candidate) { return candidate.name == name; });
+        if (spec == providers.end()) {
+            continue;
+        }
+        for (const auto& option : spec->options) {
+            options += name + '.' + option.first + '=' + option.second + ';';
+        }
+    }
+    return options.empty() ? tag : tag + "-" + hashHex(options).substr(0, 8);
+}
+
+std::string ExecutionProviders::fingerprint(const std::string& model_path, const std::string& settings) {
+    std::ostringstream text;
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::absolute(model_path, ec);
+    text << path.string() << '|' << std::filesystem::file_size(path, ec) << '|';
+    auto modified = std::filesystem::last_write_time(path, ec);
+    text << (ec ? 0 : modified.time_since_epoch().count()) << '|';
+    text << hostName() << '|' << cpuModel() << '|' << std::thread::hardware_concurrency() << '|';
+    text << Ort::GetVersionString() << '|' << joined(available()) << '|' << settings;
+    return hashHex(text.str());
+}
+
+bool ExecutionProviders::lookupChoice(const std::string& cache_path, const std::string& fingerprint,
+                                      std::string& provider) {
+    std::lock_guard<std::mutex> lock(g_choice_mutex);
+    auto it = g_choices.find(fingerprint);
+    if (it != g_choices.end()) {
+        provider = it->second;
+        return true;
+    }
+    if (cache_path.empty()) {
+        return false;
+    }
+
+    std::ifstream file(cache_path);
+    if (!file.is_open()) {
+        return false;
+    }
+    try {
+        nlohmann::json cache = nlohmann::json::parse(file);
+        if (!cache.contains(fingerprint)) {
+            return false;
+        }
+        provider = cache[fingerprint]["provider"].get<std::string>();
+        // 缓存的提供者在当前构建中已不可用（如换了ORT包）时重新测量
+        if (!isAvailable(provider)) {
+            return false;
+        }
+        g_choices[fingerprint] = provider;
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::warn("Ignoring unreadable provider cache {}: {}", cache_path, e.what());
+        return false;
+    }
+}
+
+void ExecutionProviders::storeChoice(const std::string& cache_path, const std::string& fingerprint,
+                                     const std::string& provider, double latency_ms) {
+    std::lock_guard<std::mutex> lock(g_choice_mutex);
+    g_choices[fingerprint] = provider;
+    if (cache_path.empty()) {
+        return;
+    }
+
+    nlohmann::json cache = nlohmann::json::object();
+    {
+        std::ifstream file(cache_path);
+        if (file.is_open()) {
+            try {
+                cache = nlohmann::json::parse(file);
+            }
+            catch (const std::exception&) {
+                cache = nlohmann::json::object();
+            }
+        }
+    }
+    cache[fingerprint] = { { "provider", provider }, { "latency_ms", latency_ms }, { "host", hostName() } };
+
+    // 先写临时文件再替换，多个进程同时写入时不会留下半个文件
+    std::string temp_path = cache_path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file.is_open()) {
+            spdlog::warn("Cannot write provider cache {}", cache_path);
+            return;
+        }
+        file << cache.dump(2);
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, cache_path, ec);
+    if (ec) {
+        spdlog::warn("Cannot write provider cache {}: {}", cache_path, ec.message());
+    }
+}
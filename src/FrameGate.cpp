@@ -0,0 +1,221 @@
+#include "FrameGate.h"
+#include "SimdDispatch.h"
+#include <algorithm>
+#include <bitset>
+
+#if defined(YOLO_SIMD_SSE41)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct DiffResult {
+    uint64_t sum = 0;    // 掩码内的灰度差之和
+    int changed = 0;     // 掩码内灰度差超过阈值的像素数
+};
+
+#if defined(YOLO_SIMD_AVX2)
+// 向量部分，结果写入result，返回已比较的像素数
+YOLO_TARGET_AVX2 int diffStatsAvx2(const uint8_t* a, const uint8_t* b, const uint8_t* mask, int n, uint8_t threshold,
+                                   DiffResult& result) {
+    int i = 0;
+    const __m256i vthreshold = _mm256_set1_epi8(static_cast<char>(threshold));
+    const __m256i vzero = _mm256_setzero_si256();
+    __m256i vsum = _mm256_setzero_si256();
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i vm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i));
+        __m256i diff = _mm256_and_si256(_mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va)), vm);
+        vsum = _mm256_add_epi64(vsum, _mm256_sad_epu8(diff, vzero));
+        // diff > threshold 等价于 diff饱和减threshold后非零
+        __m256i unchanged = _mm256_cmpeq_epi8(_mm256_subs_epu8(diff, vthreshold), vzero);
+        result.changed += 32 - static_cast<int>(std::bitset<32>(static_cast<uint32_t>(_mm256_movemask_epi8(unchanged))).count());
+    }
+    alignas(32) uint64_t partial[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(partial), vsum);
+    result.sum = partial[0] + partial[1] + partial[2] + partial[3];
+    return i;
+}
+#endif
+
+#if defined(YOLO_SIMD_SSE41)
+YOLO_TARGET_SSE41 int diffStatsSse41(const uint8_t* a, const uint8_t* b, const uint8_t* mask, int n, uint8_t threshold,
+                                     DiffResult& result) {
+    int i = 0;
+    const __m128i vthreshold = _mm_set1_epi8(static_cast<char>(threshold));
+    const __m128i vzero = _mm_setzero_si128();
+    __m128i vsum = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i vm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+        __m128i diff = _mm_and_si128(_mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va)), vm);
+        vsum = _mm_add_epi64(vsum, _mm_sad_epu8(diff, vzero));
+        __m128i unchanged = _mm_cmpeq_epi8(_mm_subs_epu8(diff, vthreshold), vzero);
+        result.changed += 16 - static_cast<int>(std::bitset<16>(static_cast<uint32_t>(_mm_movemask_epi8(unchanged))).count());
+    }
+    result.sum = static_cast<uint64_t>(_mm_cvtsi128_si64(vsum)) + static_cast<uint64_t>(_mm_extract_epi64(vsum, 1));
+    return i;
+}
+#endif
+
+// 两幅灰度指纹逐像素比较：|a-b|与掩码相与后累加（SAD指令）并统计超过阈值的像素
+DiffResult diffStats(const uint8_t* a, const uint8_t* b, const uint8_t* mask, int n, uint8_t threshold) {
+    DiffResult result;
+    int i = 0;
+    switch (SimdDispatch::level()) {
+#if defined(YOLO_SIMD_AVX2)
+    case SimdLevel::Avx2:
+        i = diffStatsAvx2(a, b, mask, n, threshold, result);
+        break;
+#endif
+#if defined(YOLO_SIMD_SSE41)
+    case SimdLevel::Sse41:
+        i = diffStatsSse41(a, b, mask, n, threshold, result);
+        break;
+#endif
+    default:
+        break;
+    }
+    for (; i < n; ++i) {
+        int diff = mask[i] ? std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])) : 0;
+        result.sum += static_cast<uint64_t>(diff);
+        result.changed += diff > threshold ? 1 : 0;
+    }
+    return result;
+}
+
+} // namespace
+
+FrameGate::FrameGate()
+    : detector_(nullptr)
+    , mask_pixels_(0)
+    , frames_since_inference_(0) {}
+
+FrameGate::~FrameGate() = default;
+
+bool FrameGate::initialize(JsonConfigManager& config_manager) {
+    owned_detector_ = std::make_unique<ObjectDetector>();
+    if (!owned_detector_->initialize(config_manager)) {
+        spdlog::error("Failed to initialize detector for frame gating");
+        owned_detector_.reset();
+        detector_ = nullptr;
+        return false;
+    }
+    initialize(*owned_detector_, config_manager.getGateConfig());
+    spdlog::info("Frame gate: {}x{} fingerprint, changed ratio > {}, mean diff > {}, stale after {} frames / {} ms{}",
+                 config_.thumb_width, config_.thumb_height, config_.max_changed_ratio, config_.max_mean_diff,
+                 config_.max_stale_frames, config_.max_stale_ms,
+                 config_.mask_path.empty() ? std::string() : ", mask " + config_.mask_path);
+    return true;
+}
+
+void FrameGate::initialize(ObjectDetector& detector, const GateConfig& config) {
+    detector_ = &detector;
+    config_ = config;
+    config_.thumb_width = std::max(8, config_.thumb_width);
+    config_.thumb_height = std::max(8, config_.thumb_height);
+    config_.pixel_threshold = std::clamp(config_.pixel_threshold, 0, 254);
+
+    cv::Mat mask;
+    if (!config_.mask_path.empty()) {
+        mask = cv::imread(config_.mask_path, cv::IMREAD_GRAYSCALE);
+        if (mask.empty()) {
+            spdlog::warn("Cannot read gate mask {}, monitoring the whole frame", config_.mask_path);
+        }
+    }
+    setMask(mask);
+    reset();
+}
+
+void FrameGate::setMask(const cv::Mat& mask) {
+    cv::Size size(config_.thumb_width, config_.thumb_height);
+    if (mask.empty()) {
+        mask_ = cv::Mat(size, CV_8UC1, cv::Scalar(255));
+    } else {
+        cv::Mat gray = mask;
+        if (mask.channels() != 1) {
+            cv::cvtColor(mask, gray, cv::COLOR_BGR2GRAY);
+        }
+        // 缩略图像素只要部分落在监测区域内就参与比较
+        cv::resize(gray, mask_, size, 0, 0, cv::INTER_AREA);
+        cv::threshold(mask_, mask_, 0, 255, cv::THRESH_BINARY);
+    }
+    mask_pixels_ = cv::countNonZero(mask_);
+    if (mask_pixels_ == 0) {
+        spdlog::warn("Frame gate mask is empty, every frame falls back to max staleness");
+    }
+    // 掩码变化后旧的比较结果不再有意义
+    reference_.release();
+}
+
+void FrameGate::reset() {
+    reference_.release();
+    cached_.clear();
+    frames_since_inference_ = 0;
+    stats_ = GateStats();
+}
+
+void FrameGate::fingerprint(const cv::Mat& frame, cv::Mat& thumbnail) {
+    // 先缩小再转灰度：INTER_AREA的区域平均同时抑制了传感器噪声
+    cv::resize(frame, small_bgr_, cv::Size(config_.thumb_width, config_.thumb_height), 0, 0, cv::INTER_AREA);
+    if (small_bgr_.channels() == 3) {
+        cv::cvtColor(small_bgr_, thumbnail, cv::COLOR_BGR2GRAY);
+    } else {
+        small_bgr_.copyTo(thumbnail);
+    }
+}
+
+bool FrameGate::process(const cv::Mat& frame, std::vector<DetectionResult>& results) {
+    if (!detector_ || frame.empty()) {
+        results.clear();
+        return false;
+    }
+    ++stats_.frames;
+    fingerprint(frame, thumbnail_);
+
+    bool infer = reference_.empty() || frame.size() != reference_frame_size_;
+    if (!infer) {
+        DiffResult diff = diffStats(thumbnail_.data, reference_.data, mask_.data, static_cast<int>(thumbnail_.total()),
+                                    static_cast<uint8_t>(config_.pixel_threshold));
+        int monitored = std::max(1, mask_pixels_);
+        stats_.last_changed_ratio = static_cast<float>(diff.changed) / monitored;
+        stats_.last_mean_diff = static_cast<float>(diff.sum) / monitored;
+        if (stats_.last_changed_ratio > config_.max_changed_ratio || stats_.last_mean_diff > config_.max_mean_diff) {
+            infer = true;
+            ++stats_.motion_triggers;
+        } else {
+            auto stale_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - inferred_at_).count();
+            if ((config_.max_stale_frames > 0 && frames_since_inference_ >= config_.max_stale_frames) ||
+                (config_.max_stale_ms > 0 && stale_ms >= config_.max_stale_ms)) {
+                infer = true;
+                ++stats_.stale_refreshes;
+            }
+        }
+    }
+
+    if (!infer) {
+        results = cached_;
+        ++frames_since_inference_;
+        ++stats_.cached;
+        return false;
+    }
+
+    // 推理失败的帧不成为参考帧：空结果不能被当作"画面中没有目标"缓存下来
+    if (!detector_->detect(frame, detected_)) {
+        results.clear();
+        ++stats_.failed;
+        return false;
+    }
+    std::swap(cached_, detected_);
+    results = cached_;
+    // 参考帧更新为本次推理的帧，后续帧与它比较
+    std::swap(reference_, thumbnail_);
+    reference_frame_size_ = frame.size();
+    frames_since_inference_ = 0;
+    inferred_at_ = std::chrono::steady_clock::now();
+    ++stats_.inferred;
+    return true;
+}
@@ -0,0 +1,186 @@
+#include "FrameRing.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+using inference_protocol::WireDetection;
+
+namespace {
+
+std::string resultRingName(const std::string& name) {
+    return name + "_results";
+}
+
+} // namespace
+
+bool FrameRingReader::create(const ShmRingConfig& config) {
+    close();
+    RingOverflow overflow = RingOverflow::Block;
+    if (config.overflow == "overwrite") {
+        overflow = RingOverflow::OverwriteOldest;
+    } else if (config.overflow != "block") {
+        spdlog::warn("Unknown shm_ring overflow policy '{}', using block", config.overflow);
+    }
+
+    int slots = std::max(2, config.slots);
+    size_t frame_bytes = static_cast<size_t>(std::max(1, config.max_width)) * std::max(1, config.max_height) * 3;
+    max_detections_ = std::max(1, config.max_detections);
+    // 结果槽位较小，数量取帧槽位的两倍，生产方偶尔读取不及时也不会立即阻塞检测
+    if (!frames_.create(config.name, slots, frame_bytes, overflow) ||
+        !results_.create(resultRingName(config.name), slots * 2, max_detections_ * sizeof(WireDetection), overflow)) {
+        close();
+        return false;
+    }
+    spdlog::info("Frame ring '{}': {} slots of {}x{}, {}", config.name, slots, config.max_width, config.max_height,
+                 overflow == RingOverflow::Block ? "block" : "overwrite oldest");
+    return true;
+}
+
+void FrameRingReader::close() {
+    releaseFrame();
+    frames_.close();
+    results_.close();
+}
+
+bool FrameRingReader::nextFrame(cv::Mat& frame, uint64_t& frame_id, int timeout_ms) {
+    for (;;) {
+        frames_.release(current_);
+        if (!frames_.acquireRead(current_, timeout_ms)) {
+            return false;
+        }
+        const SharedRing::SlotHeader& header = *current_.header;
+        if (header.width <= 0 || header.height <= 0) {
+            continue;
+        }
+        // 槽位头来自另一个进程，包装为cv::Mat之前确认整帧都位于槽位之内
+        int64_t row_bytes = static_cast<int64_t>(header.width) * 3;
+        if (header.type != CV_8UC3 || header.stride < row_bytes ||
+            static_cast<int64_t>(header.stride) * header.height > static_cast<int64_t>(current_.capacity)) {
+            spdlog::warn("Dropping malformed frame {} in ring: {}x{} type {} stride {} (slot holds {} bytes)",
+                         header.tag, header.width, header.height, header.type, header.stride, current_.capacity);
+            continue;
+        }
+        frame = cv::Mat(header.height, header.width, header.type, current_.data, static_cast<size_t>(header.stride));
+        frame_id = header.tag;
+        return true;
+    }
+}
+
+void FrameRingReader::releaseFrame() {
+    frames_.release(current_);
+}
+
+bool FrameRingReader::writeResults(uint64_t frame_id, const std::vector<DetectionResult>& results, int timeout_ms) {
+    SharedRing::Slot slot;
+    if (!results_.acquireWrite(slot, timeout_ms)) {
+        return false;
+    }
+    size_t count = std::min(results.size(), static_cast<size_t>(max_detections_));
+    WireDetection* wire = reinterpret_cast<WireDetection*>(slot.data);
+    for (size_t i = 0; i < count; ++i) {
+        const DetectionResult& result = results[i];
+        wire[i] = {result.box.x, result.box.y, result.box.width, result.box.height, result.class_id,
+                   result.confidence};
+    }
+    slot.header->tag = frame_id;
+    slot.header->width = static_cast<int32_t>(count);
+    slot.header->payload_bytes = static_cast<uint32_t>(count * sizeof(WireDetection));
+    results_.publish(slot);
+    return true;
+}
+
+bool FrameRingWriter::open(const std::string& name) {
+    close();
+    if (!frames_.open(name) || !results_.open(resultRingName(name))) {
+        frames_.close();
+        results_.close();
+        return false;
+    }
+    return true;
+}
+
+void FrameRingWriter::close() {
+    if (frames_.isOpen()) {
+        // 已取得但未提交的槽位发布为0x0的空帧（检测方跳过），槽位序号保持连续
+        if (pending_.valid()) {
+            pending_.header->width = 0;
+            pending_.header->height = 0;
+            frames_.publish(pending_);
+        }
+        frames_.markClosed();
+    }
+    frames_.close();
+    results_.close();
+}
+
+bool FrameRingWriter::beginFrame(int width, int height, cv::Mat& frame, int timeout_ms) {
+    size_t stride = static_cast<size_t>(width) * 3;
+    if (!frames_.isOpen()) {
+        return false;
+    }
+    if (width <= 0 || height <= 0 || stride * height > frames_.slotBytes()) {
+        spdlog::error("Frame {}x{} does not fit in a ring slot of {} bytes", width, height, frames_.slotBytes());
+        return false;
+    }
+    if (!pending_.valid() && !frames_.acquireWrite(pending_, timeout_ms)) {
+        return false;
+    }
+    SharedRing::SlotHeader& header = *pending_.header;
+    header.width = width;
+    header.height = height;
+    header.stride = static_cast<int32_t>(stride);
+    header.type = CV_8UC3;
+    header.payload_bytes = static_cast<uint32_t>(stride * height);
+    frame = cv::Mat(height, width, CV_8UC3, pending_.data, stride);
+    return true;
+}
+
+bool FrameRingWriter::commitFrame(uint64_t frame_id) {
+    if (!pending_.valid()) {
+        return false;
+    }
+    pending_.header->tag = frame_id;
+    frames_.publish(pending_);
+    return true;
+}
+
+bool FrameRingWriter::writeFrame(const cv::Mat& image, uint64_t frame_id, int timeout_ms) {
+    if (image.empty() || image.type() != CV_8UC3) {
+        spdlog::error("FrameRingWriter::writeFrame expects a non-empty CV_8UC3 image");
+        return false;
+    }
+    cv::Mat slot_frame;
+    if (!beginFrame(image.cols, image.rows, slot_frame, timeout_ms)) {
+        return false;
+    }
+    image.copyTo(slot_frame);
+    return commitFrame(frame_id);
+}
+
+bool FrameRingWriter::readResults(uint64_t& frame_id, std::vector<DetectionResult>& results, int timeout_ms) {
+    SharedRing::Slot slot;
+    if (!results_.acquireRead(slot, timeout_ms)) {
+        return false;
+    }
+    const WireDetection* wire = reinterpret_cast<const WireDetection*>(slot.data);
+    int count = slot.header->width;
+    frame_id = slot.header->tag;
+    // 检测框数来自另一个进程，不能超过槽位能容纳的max_detections
+    size_t max_detections = slot.capacity / sizeof(WireDetection);
+    if (count < 0 || static_cast<size_t>(count) > max_detections) {
+        spdlog::error("Malformed result for frame {}: {} detections, slot holds at most {}", frame_id, count,
+                      max_detections);
+        results_.release(slot);
+        return false;
+    }
+    results.clear();
+    results.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        DetectionResult result;
+        result.box = cv::Rect(wire[i].x, wire[i].y, wire[i].width, wire[i].height);
+        result.class_id = wire[i].class_id;
+        result.confidence = wire[i].confidence;
+        results.push_back(result);
+    }
+    results_.release(slot);
+    return true;
+}
@@ -0,0 +1,124 @@
+#include "ImageLoader.h"
+#include <algorithm>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+bool ImageLoader::readJpegSize(const uchar* data, size_t size, cv::Size& image_size) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+
+    size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        uchar marker = data[pos + 1];
+        // 填充字节
+        if (marker == 0xFF) {
+            ++pos;
+            continue;
+        }
+        // 无长度字段的独立标记：TEM、RSTn、SOI、EOI
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD9)) {
+            pos += 2;
+            continue;
+        }
+
+        size_t length = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+        if (length < 2) {
+            return false;
+        }
+        // SOF0..SOF15（排除DHT=C4、JPG=C8、DAC=CC）：精度(1) 高(2) 宽(2)
+        bool is_sof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (is_sof) {
+            if (pos + 9 > size) {
+                return false;
+            }
+            int height = (data[pos + 5] << 8) | data[pos + 6];
+            int width = (data[pos + 7] << 8) | data[pos + 8];
+            if (width <= 0 || height <= 0) {
+                return false;
+            }
+            image_size = cv::Size(width, height);
+            return true;
+        }
+        // SOS之后是熵编码数据，正常情况下SOF已经出现
+        if (marker == 0xDA) {
+            return false;
+        }
+        pos += 2 + length;
+    }
+    return false;
+}
+
+int ImageLoader::chooseReduction(const cv::Size& image_size, const cv::Size& target_size) {
+    if (image_size.width <= 0 || image_size.height <= 0 || target_size.width <= 0 || target_size.height <= 0) {
+        return 1;
+    }
+    // EXIF方向可能交换宽高，两种方向都需要满足
+    auto limit = [&target_size](int w, int h) {
+        return std::max(static_cast<double>(w) / target_size.width, static_cast<double>(h) / target_size.height);
+    };
+    double max_reduction = std::min(limit(image_size.width, image_size.height),
+                                    limit(image_size.height, image_size.width));
+    // max_reduction = 1 / letterbox缩放比例
+    int reduction = 1;
+    while (reduction < 8 && reduction * 2 <= max_reduction) {
+        reduction *= 2;
+    }
+    return reduction;
+}
+
+bool ImageLoader::decode(const std::vector<uchar>& data, LoadedImage& loaded) const {
+    cv::Size jpeg_size;
+    int reduction = 1;
+    if (reduced_decode_ && readJpegSize(data.data(), data.size(), jpeg_size)) {
+        reduction = chooseReduction(jpeg_size, target_size_);
+    }
+
+    int flags = cv::IMREAD_COLOR;
+    switch (reduction) {
+    case 2: flags = cv::IMREAD_REDUCED_COLOR_2; break;
+    case 4: flags = cv::IMREAD_REDUCED_COLOR_4; break;
+    case 8: flags = cv::IMREAD_REDUCED_COLOR_8; break;
+    default: break;
+    }
+
+    loaded.image = cv::imdecode(data, flags);
+    loaded.reduction = reduction;
+    if (loaded.image.empty()) {
+        return false;
+    }
+
+    if (reduction == 1) {
+        loaded.original_size = loaded.image.size();
+        return true;
+    }
+
+    // libjpeg缩放解码的尺寸为ceil(原尺寸 / 倍数)；应用EXIF方向后宽高可能互换
+    auto reduced = [reduction](int v) { return (v + reduction - 1) / reduction; };
+    if (loaded.image.cols == reduced(jpeg_size.width) && loaded.image.rows == reduced(jpeg_size.height)) {
+        loaded.original_size = jpeg_size;
+    } else {
+        loaded.original_size = cv::Size(jpeg_size.height, jpeg_size.width);
+    }
+    return true;
+}
+
+bool ImageLoader::load(const std::string& path, LoadedImage& loaded) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    if (size <= 0) {
+        return false;
+    }
+    file.seekg(0, std::ios::beg);
+    buffer_.resize(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(buffer_.data()), size)) {
+        return false;
+    }
+    return decode(buffer_, loaded);
+}
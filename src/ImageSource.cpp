@@ -0,0 +1,160 @@
+#include "ImageSource.h"
+#include <algorithm>
+#include <cctype>
+#include <spdlog/spdlog.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string lowerExtension(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+} // namespace
+
+bool ImageSource::isImageFile(const fs::path& path) {
+    static const char* extensions[] = { ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp", ".jp2", ".pgm", ".ppm" };
+    std::string extension = lowerExtension(path);
+    return std::any_of(std::begin(extensions), std::end(extensions),
+                       [&extension](const char* e) { return extension == e; });
+}
+
+bool ImageSource::matchWildcard(const std::string& pattern, const std::string& name) {
+    // 贪心匹配，回溯到最近一个 * 处
+    size_t p = 0, n = 0, star = std::string::npos, resume = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++p;
+            ++n;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = n;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            n = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool ImageSource::open(const std::string& spec) {
+    kind_ = Kind::None;
+    description_ = spec;
+    list_file_.close();
+
+    std::error_code ec;
+    fs::path path(spec);
+    std::string filename = path.filename().string();
+
+    if (filename.find_first_of("*?") != std::string::npos) {
+        fs::path directory = path.has_parent_path() ? path.parent_path() : fs::path(".");
+        if (directory.string().find_first_of("*?") != std::string::npos) {
+            spdlog::error("Wildcards are only supported in the file name: {}", spec);
+            return false;
+        }
+        directory_it_ = fs::directory_iterator(directory, ec);
+        if (ec) {
+            spdlog::error("Cannot open directory {}: {}", directory.string(), ec.message());
+            return false;
+        }
+        pattern_ = filename;
+        kind_ = Kind::Glob;
+        return true;
+    }
+
+    if (fs::is_directory(path, ec)) {
+        recursive_it_ = fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, ec);
+        if (ec) {
+            spdlog::error("Cannot open directory {}: {}", spec, ec.message());
+            return false;
+        }
+        kind_ = Kind::Directory;
+        return true;
+    }
+
+    if (!fs::is_regular_file(path, ec)) {
+        return false;
+    }
+
+    std::string extension = lowerExtension(path);
+    if (extension == ".txt" || extension == ".lst" || extension == ".list") {
+        list_file_.open(path);
+        if (!list_file_.is_open()) {
+            spdlog::error("Cannot open image list: {}", spec);
+            return false;
+        }
+        kind_ = Kind::ListFile;
+        return true;
+    }
+
+    if (isImageFile(path)) {
+        single_file_ = spec;
+        kind_ = Kind::SingleFile;
+        return true;
+    }
+    return false;
+}
+
+bool ImageSource::next(std::string& path) {
+    std::error_code ec;
+    switch (kind_) {
+    case Kind::Directory:
+        for (; recursive_it_ != fs::recursive_directory_iterator(); recursive_it_.increment(ec)) {
+            if (ec) {
+                spdlog::warn("Error while listing {}: {}", description_, ec.message());
+                break;
+            }
+            if (recursive_it_->is_regular_file(ec) && isImageFile(recursive_it_->path())) {
+                path = recursive_it_->path().string();
+                recursive_it_.increment(ec);
+                return true;
+            }
+        }
+        break;
+    case Kind::Glob:
+        for (; directory_it_ != fs::directory_iterator(); directory_it_.increment(ec)) {
+            if (ec) {
+                spdlog::warn("Error while listing {}: {}", description_, ec.message());
+                break;
+            }
+            if (directory_it_->is_regular_file(ec) && isImageFile(directory_it_->path()) &&
+                matchWildcard(pattern_, directory_it_->path().filename().string())) {
+                path = directory_it_->path().string();
+                directory_it_.increment(ec);
+                return true;
+            }
+        }
+        break;
+    case Kind::ListFile: {
+        std::string line;
+        while (std::getline(list_file_, line)) {
+            // 兼容Windows换行，去掉首尾空白
+            size_t begin = line.find_first_not_of(" \t\r");
+            size_t end = line.find_last_not_of(" \t\r");
+            if (begin == std::string::npos || line[begin] == '#') {
+                continue;
+            }
+            path = line.substr(begin, end - begin + 1);
+            return true;
+        }
+        break;
+    }
+    case Kind::SingleFile:
+        path = single_file_;
+        kind_ = Kind::None;
+        return true;
+    default:
+        break;
+    }
+    kind_ = Kind::None;
+    return false;
+}
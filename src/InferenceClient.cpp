@@ -0,0 +1,90 @@
+#include "InferenceClient.h"
+#include <spdlog/spdlog.h>
+
+using namespace inference_protocol;
+
+bool InferenceClient::connect(const std::string& socket_path, int port) {
+    socket_ = LocalSocket::connect(socket_path, port);
+    if (!socket_.valid()) {
+        spdlog::error("Cannot connect to inference server at {}",
+                      port > 0 ? "127.0.0.1:" + std::to_string(port) : socket_path);
+        return false;
+    }
+    return true;
+}
+
+void InferenceClient::close() {
+    socket_.close();
+}
+
+bool InferenceClient::send(uint32_t request_id, const cv::Mat& image) {
+    if (image.empty() || image.type() != CV_8UC3) {
+        spdlog::error("InferenceClient::send expects a non-empty CV_8UC3 image");
+        return false;
+    }
+    // 协议要求行间无填充，ROI等非连续图像先复制
+    cv::Mat continuous = image.isContinuous() ? image : image.clone();
+
+    RequestHeader header;
+    header.type = static_cast<uint32_t>(PayloadType::RawBgr);
+    header.request_id = request_id;
+    header.width = continuous.cols;
+    header.height = continuous.rows;
+    header.payload_bytes = static_cast<uint32_t>(continuous.total() * continuous.elemSize());
+    return sendRequest(header, continuous.data);
+}
+
+bool InferenceClient::sendEncoded(uint32_t request_id, const std::vector<uchar>& bytes) {
+    RequestHeader header;
+    header.type = static_cast<uint32_t>(PayloadType::Encoded);
+    header.request_id = request_id;
+    header.payload_bytes = static_cast<uint32_t>(bytes.size());
+    return sendRequest(header, bytes.data());
+}
+
+bool InferenceClient::sendRequest(const RequestHeader& header, const void* payload) {
+    if (header.payload_bytes > kMaxPayloadBytes) {
+        spdlog::error("Request payload of {} bytes exceeds the protocol limit", header.payload_bytes);
+        return false;
+    }
+    return socket_.sendAll(&header, sizeof(header)) &&
+           (header.payload_bytes == 0 || socket_.sendAll(payload, header.payload_bytes));
+}
+
+bool InferenceClient::receive(uint32_t& request_id, ResponseStatus& status, std::vector<DetectionResult>& results) {
+    ResponseHeader header;
+    if (!socket_.recvAll(&header, sizeof(header)) || header.magic != kMagic) {
+        return false;
+    }
+    wire_.resize(header.count);
+    if (header.count > 0 && !socket_.recvAll(wire_.data(), wire_.size() * sizeof(WireDetection))) {
+        return false;
+    }
+
+    request_id = header.request_id;
+    status = static_cast<ResponseStatus>(header.status);
+    results.clear();
+    results.reserve(wire_.size());
+    for (const auto& detection : wire_) {
+        DetectionResult result;
+        result.box = cv::Rect(detection.x, detection.y, detection.width, detection.height);
+        result.class_id = detection.class_id;
+        result.confidence = detection.confidence;
+        results.push_back(result);
+    }
+    return true;
+}
+
+bool InferenceClient::detect(const cv::Mat& image, std::vector<DetectionResult>& results) {
+    uint32_t id = next_id_++;
+    if (!send(id, image)) {
+        return false;
+    }
+    uint32_t response_id = 0;
+    ResponseStatus status = ResponseStatus::Failed;
+    // 同步调用时连接上只有这一个请求，下一个响应即为它的结果
+    if (!receive(response_id, status, results) || response_id != id) {
+        return false;
+    }
+    return status == ResponseStatus::Ok;
+}
@@ -0,0 +1,372 @@
+#include "InferenceServer.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+using namespace inference_protocol;
+
+InferenceServer::InferenceServer()
+    : pool_(nullptr)
+    , running_(false) {}
+
+InferenceServer::~InferenceServer() {
+    stop();
+}
+
+bool InferenceServer::initialize(JsonConfigManager& config_manager) {
+    stop();
+    const ServerConfig& config = config_manager.getServerConfig();
+    if (config_manager.getModelConfig().max_batch_size < config.max_batch_size) {
+        spdlog::warn("model.max_batch_size ({}) is smaller than server.max_batch_size ({}), "
+                     "batches will be split into several Run calls",
+                     config_manager.getModelConfig().max_batch_size, config.max_batch_size);
+    }
+    owned_pool_ = std::make_unique<DetectorPool>();
+    if (!owned_pool_->initialize(config_manager, std::max(1, config.sessions))) {
+        spdlog::error("Failed to initialize detector pool for inference server");
+        owned_pool_.reset();
+        pool_ = nullptr;
+        return false;
+    }
+    return initialize(*owned_pool_, config);
+}
+
+bool InferenceServer::initialize(DetectorPool& pool, const ServerConfig& config) {
+    stop();
+    if (pool.size() <= 0) {
+        spdlog::error("Inference server needs at least one pool session");
+        return false;
+    }
+    config_ = config;
+    config_.max_batch_size = std::max(1, config_.max_batch_size);
+    config_.max_queue_delay_ms = std::max(0.0f, config_.max_queue_delay_ms);
+    config_.max_pending_per_client = std::max(1, config_.max_pending_per_client);
+    config_.queue_capacity = std::max(config_.max_batch_size, config_.queue_capacity);
+    pool_ = &pool;
+    return true;
+}
+
+bool InferenceServer::start() {
+    if (running_) {
+        return true;
+    }
+    if (!pool_) {
+        spdlog::error("Inference server is not initialized");
+        return false;
+    }
+    listener_ = LocalSocket::listen(config_.socket_path, config_.port);
+    if (!listener_.valid()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = ServerStats();
+    }
+    running_ = true;
+    for (int i = 0; i < pool_->size(); ++i) {
+        batch_threads_.emplace_back(&InferenceServer::batchLoop, this);
+    }
+    accept_thread_ = std::thread(&InferenceServer::acceptLoop, this);
+
+    spdlog::info("Inference server listening on {}: {} sessions, batch <= {}, queue delay {} ms, "
+                 "{} pending per client",
+                 config_.port > 0 ? "127.0.0.1:" + std::to_string(config_.port) : config_.socket_path,
+                 pool_->size(), config_.max_batch_size, config_.max_queue_delay_ms,
+                 config_.max_pending_per_client);
+    return true;
+}
+
+void InferenceServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    // 唤醒accept：监听socket的shutdown在部分平台上不会中断阻塞的accept，再发起一次连接
+    listener_.shutdown();
+    LocalSocket::connect(config_.socket_path, config_.port);
+    if (accept_thread_.joinable()) {
+        accept_thread_.join();
+    }
+
+    // 批处理线程执行完已排队的请求后退出，此时连接仍然打开，响应可以正常送达
+    // （先经过一次加锁，保证等待中的线程要么已看到running_为false，要么能收到下面的通知）
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    batch_ready_.notify_all();
+    client_ready_.notify_all();
+    for (auto& thread : batch_threads_) {
+        thread.join();
+    }
+    batch_threads_.clear();
+
+    std::vector<std::shared_ptr<Client>> clients;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients.swap(clients_);
+    }
+    for (auto& client : clients) {
+        client->socket.shutdown();
+    }
+    for (auto& client : clients) {
+        if (client->reader.joinable()) {
+            client->reader.join();
+        }
+    }
+    listener_.close();
+
+    ServerStats stats = getStats();
+    spdlog::info("Inference server stopped: {} requests in {} batches (mean {:.2f}), {} failed, {} busy, "
+                 "{} bad requests", stats.completed, stats.batches, stats.meanBatchSize(), stats.failed, stats.busy,
+                 stats.bad_requests);
+}
+
+ServerStats InferenceServer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ServerStats stats = stats_;
+    stats.queued = queue_.size();
+    stats.active_connections = static_cast<size_t>(std::count_if(
+        clients_.begin(), clients_.end(), [](const std::shared_ptr<Client>& client) { return !client->finished; }));
+    return stats;
+}
+
+void InferenceServer::acceptLoop() {
+    while (running_) {
+        LocalSocket socket = listener_.accept();
+        if (!running_) {
+            break;
+        }
+        if (!socket.valid()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        joinFinishedClients();
+        auto client = std::make_shared<Client>();
+        client->socket = std::move(socket);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            clients_.push_back(client);
+            ++stats_.connections;
+        }
+        client->reader = std::thread(&InferenceServer::readerLoop, this, client);
+    }
+}
+
+void InferenceServer::joinFinishedClients() {
+    std::vector<std::shared_ptr<Client>> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::partition(clients_.begin(), clients_.end(),
+                                 [](const std::shared_ptr<Client>& client) { return !client->finished; });
+        finished.assign(it, clients_.end());
+        clients_.erase(it, clients_.end());
+    }
+    // 读取线程须在Client析构前join（排队中的请求可能仍持有Client）
+    for (auto& client : finished) {
+        client->reader.join();
+    }
+}
+
+void InferenceServer::readerLoop(std::shared_ptr<Client> client) {
+    std::vector<DetectionResult> no_results;
+    while (running_) {
+        {
+            // 未完成请求达到上限时不再读取，客户端的后续请求留在socket缓冲区中
+            std::unique_lock<std::mutex> lock(mutex_);
+            client_ready_.wait(lock, [this, &client]() {
+                return !running_ || client->pending < config_.max_pending_per_client;
+            });
+        }
+        if (!running_) {
+            break;
+        }
+
+        RequestHeader header;
+        if (!client->socket.recvAll(&header, sizeof(header))) {
+            break;
+        }
+        if (header.magic != kMagic || header.payload_bytes > kMaxPayloadBytes) {
+            // 流已失去同步，无法定位下一个请求
+            spdlog::warn("Inference server: malformed request header, closing connection");
+            break;
+        }
+
+        cv::Mat image;
+        bool connection_lost = false;
+        if (!readImage(*client, header, image, connection_lost)) {
+            if (connection_lost) {
+                break;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++stats_.bad_requests;
+            }
+            respond(*client, header.request_id, ResponseStatus::BadRequest, no_results);
+            continue;
+        }
+
+        ResponseStatus rejected = ResponseStatus::Ok;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                rejected = ResponseStatus::Failed;
+            } else if (queue_.size() >= static_cast<size_t>(config_.queue_capacity)) {
+                rejected = ResponseStatus::Busy;
+                ++stats_.busy;
+            } else {
+                Request request;
+                request.client = client;
+                request.id = header.request_id;
+                request.image = std::move(image);
+                request.arrival = std::chrono::steady_clock::now();
+                queue_.push_back(std::move(request));
+                ++client->pending;
+            }
+        }
+        if (rejected != ResponseStatus::Ok) {
+            respond(*client, header.request_id, rejected, no_results);
+        } else {
+            batch_ready_.notify_one();
+        }
+    }
+    // 连接断开或请求格式错误：关闭连接，尚未响应的请求在批处理线程中写入失败即丢弃
+    client->socket.shutdown();
+    client->finished = true;
+}
+
+bool InferenceServer::readImage(Client& client, const RequestHeader& header, cv::Mat& image,
+                                bool& connection_lost) {
+    if (header.type == static_cast<uint32_t>(PayloadType::RawBgr)) {
+        size_t expected = static_cast<size_t>(std::max(0, header.width)) * std::max(0, header.height) * 3;
+        if (expected == 0 || expected != header.payload_bytes) {
+            connection_lost = !discardPayload(client, header.payload_bytes);
+            return false;
+        }
+        // 直接接收到Mat中，不经过中间缓冲区
+        image.create(header.height, header.width, CV_8UC3);
+        if (!client.socket.recvAll(image.data, expected)) {
+            connection_lost = true;
+            return false;
+        }
+        return true;
+    }
+
+    if (header.type != static_cast<uint32_t>(PayloadType::Encoded) || header.payload_bytes == 0) {
+        connection_lost = !discardPayload(client, header.payload_bytes);
+        return false;
+    }
+    std::vector<uchar> bytes(header.payload_bytes);
+    if (!client.socket.recvAll(bytes.data(), bytes.size())) {
+        connection_lost = true;
+        return false;
+    }
+    image = cv::imdecode(bytes, cv::IMREAD_COLOR);
+    return !image.empty();
+}
+
+bool InferenceServer::discardPayload(Client& client, size_t bytes) {
+    // 丢弃负载以保持流同步：按固定大小分段读取，格式错误的请求不按声明的长度（最多64 MB）分配内存
+    uchar chunk[64 * 1024];
+    while (bytes > 0) {
+        size_t n = std::min(bytes, sizeof(chunk));
+        if (!client.socket.recvAll(chunk, n)) {
+            return false;
+        }
+        bytes -= n;
+    }
+    return true;
+}
+
+void InferenceServer::respond(Client& client, uint32_t request_id, ResponseStatus status,
+                              const std::vector<DetectionResult>& results) {
+    ResponseHeader header;
+    header.status = static_cast<uint32_t>(status);
+    header.request_id = request_id;
+    header.count = static_cast<uint32_t>(results.size());
+
+    std::vector<WireDetection> wire;
+    wire.reserve(results.size());
+    for (const auto& result : results) {
+        wire.push_back({result.box.x, result.box.y, result.box.width, result.box.height,
+                        result.class_id, result.confidence});
+    }
+
+    std::lock_guard<std::mutex> lock(client.write_mutex);
+    if (client.socket.sendAll(&header, sizeof(header)) && !wire.empty()) {
+        client.socket.sendAll(wire.data(), wire.size() * sizeof(WireDetection));
+    }
+}
+
+void InferenceServer::batchLoop() {
+    const auto max_delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float, std::milli>(config_.max_queue_delay_ms));
+    const size_t max_batch = static_cast<size_t>(config_.max_batch_size);
+    std::vector<Request> batch;
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<DetectionResult>> results;
+    std::vector<bool> succeeded;
+
+    while (true) {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            batch_ready_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                if (!running_) {
+                    return;
+                }
+                continue;
+            }
+            // 批次未满时等到最早请求的截止时间；停止时不再等待，直接处理剩余请求
+            auto deadline = queue_.front().arrival + max_delay;
+            batch_ready_.wait_until(lock, deadline, [this, max_batch]() {
+                return !running_ || queue_.empty() || queue_.size() >= max_batch;
+            });
+            // 等待期间可能已被其他批处理线程取走
+            size_t count = std::min(max_batch, queue_.size());
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+        if (batch.empty()) {
+            continue;
+        }
+
+        images.clear();
+        for (const auto& request : batch) {
+            images.push_back(request.image);
+        }
+        {
+            DetectorPool::Lease lease = pool_->acquire();
+            if (images.size() == 1) {
+                results.resize(1);
+                succeeded.assign(1, lease->detect(images[0], results[0]));
+            } else {
+                results = lease->detectBatch(images, succeeded);
+            }
+        }
+
+        // 推理出错的图像以Failed响应，客户端不会把空结果误当作"没有目标"
+        size_t failed = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            ResponseStatus status = succeeded[i] ? ResponseStatus::Ok : ResponseStatus::Failed;
+            failed += succeeded[i] ? 0 : 1;
+            respond(*batch[i].client, batch[i].id, status, results[i]);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& request : batch) {
+                --request.client->pending;
+            }
+            stats_.completed += batch.size() - failed;
+            stats_.failed += failed;
+            ++stats_.batches;
+            stats_.largest_batch = std::max(stats_.largest_batch, batch.size());
+        }
+        client_ready_.notify_all();
+        // 尽早释放连接与图像，避免断开的连接等到下一批才析构
+        batch.clear();
+    }
+}
@@ -34,6 +34,46 @@ bool JsonConfigManager::loadConfig() {
             return false;
         }
         
+        if (!parsePipelineConfig()) {
+            return false;
+        }
+        
+        if (!parsePoolConfig()) {
+            return false;
+        }
+        
+        if (!parseTelemetryConfig()) {
+            return false;
+        }
+        
+        if (!parseTilingConfig()) {
+            return false;
+        }
+        
+        if (!parseTrackingConfig()) {
+            return false;
+        }
+        
+        if (!parseAsyncConfig()) {
+            return false;
+        }
+        
+        if (!parseServerConfig()) {
+            return false;
+        }
+        
+        if (!parseShmRingConfig()) {
+            return false;
+        }
+        
+        if (!parseGateConfig()) {
+            return false;
+        }
+        
+        if (!parseShardConfig()) {
+            return false;
+        }
+        
         spdlog::info("Configuration loaded successfully from {}", config_path_);
         return true;
     }
@@ -59,6 +99,85 @@ bool JsonConfigManager::parseModelConfig() {
             if (model.contains("device_type")) {
                 model_config_.device_type = model["device_type"].get<std::string>();
             }
+            if (model.contains("max_batch_size")) {
+                model_config_.max_batch_size = model["max_batch_size"].get<int>();
+            }
+            if (model.contains("io_binding")) {
+                model_config_.io_binding = model["io_binding"].get<bool>();
+            }
+            if (model.contains("preprocess_threads")) {
+                model_config_.preprocess_threads = model["preprocess_threads"].get<int>();
+            }
+            if (model.contains("intra_op_threads")) {
+                model_config_.intra_op_threads = model["intra_op_threads"].get<int>();
+            }
+            if (model.contains("inter_op_threads")) {
+                model_config_.inter_op_threads = model["inter_op_threads"].get<int>();
+            }
+            if (model.contains("execution_mode")) {
+                model_config_.execution_mode = model["execution_mode"].get<std::string>();
+            }
+            if (model.contains("cpu_mem_arena")) {
+                model_config_.cpu_mem_arena = model["cpu_mem_arena"].get<bool>();
+            }
+            if (model.contains("mem_pattern")) {
+                model_config_.mem_pattern = model["mem_pattern"].get<bool>();
+            }
+            if (model.contains("shared_arena")) {
+                model_config_.shared_arena = model["shared_arena"].get<bool>();
+            }
+            if (model.contains("arena_extend_strategy")) {
+                model_config_.arena_extend_strategy = model["arena_extend_strategy"].get<std::string>();
+            }
+            if (model.contains("arena_initial_chunk_bytes")) {
+                model_config_.arena_initial_chunk_bytes = model["arena_initial_chunk_bytes"].get<int64_t>();
+            }
+            if (model.contains("share_prepacked_weights")) {
+                model_config_.share_prepacked_weights = model["share_prepacked_weights"].get<bool>();
+            }
+            if (model.contains("optimized_model_path")) {
+                model_config_.optimized_model_path = model["optimized_model_path"].get<std::string>();
+            }
+            if (model.contains("mmap_model")) {
+                model_config_.mmap_model = model["mmap_model"].get<bool>();
+            }
+            if (model.contains("warmup_runs")) {
+                model_config_.warmup_runs = model["warmup_runs"].get<int>();
+            }
+            if (model.contains("precision")) {
+                model_config_.precision = model["precision"].get<std::string>();
+            }
+            if (model.contains("int8_model_path")) {
+                model_config_.int8_model_path = model["int8_model_path"].get<std::string>();
+            }
+            if (model.contains("input_format")) {
+                model_config_.input_format = model["input_format"].get<std::string>();
+            }
+            if (model.contains("letterbox")) {
+                model_config_.letterbox = model["letterbox"].get<std::string>();
+            }
+            if (model.contains("stride")) {
+                model_config_.stride = model["stride"].get<int>();
+            }
+            if (model.contains("providers")) {
+                model_config_.providers = model["providers"].get<std::vector<std::string>>();
+            }
+            if (model.contains("provider_options")) {
+                // 选项值统一转为字符串（ORT的提供者选项均为字符串键值对）
+                model_config_.provider_options.clear();
+                for (const auto& [provider, options] : model["provider_options"].items()) {
+                    auto& values = model_config_.provider_options[provider];
+                    for (const auto& [key, value] : options.items()) {
+                        values[key] = value.is_string() ? value.get<std::string>() : value.dump();
+                    }
+                }
+            }
+            if (model.contains("provider_cache_path")) {
+                model_config_.provider_cache_path = model["provider_cache_path"].get<std::string>();
+            }
+            if (model.contains("provider_probe_runs")) {
+                model_config_.provider_probe_runs = model["provider_probe_runs"].get<int>();
+            }
         }
         return true;
     }
@@ -78,6 +197,21 @@ bool JsonConfigManager::parseDetectionConfig() {
             if (detection.contains("nms_threshold")) {
                 detection_config_.nms_threshold = detection["nms_threshold"].get<float>();
             }
+            if (detection.contains("nms_class_aware")) {
+                detection_config_.nms_class_aware = detection["nms_class_aware"].get<bool>();
+            }
+            if (detection.contains("nms_top_k")) {
+                detection_config_.nms_top_k = detection["nms_top_k"].get<int>();
+            }
+            if (detection.contains("max_detections")) {
+                detection_config_.max_detections = detection["max_detections"].get<int>();
+            }
+            if (detection.contains("soft_nms")) {
+                detection_config_.soft_nms = detection["soft_nms"].get<bool>();
+            }
+            if (detection.contains("soft_nms_sigma")) {
+                detection_config_.soft_nms_sigma = detection["soft_nms_sigma"].get<float>();
+            }
         }
         return true;
     }
@@ -94,6 +228,9 @@ bool JsonConfigManager::parseInputConfig() {
             if (input.contains("image_path")) {
                 input_config_.image_path = input["image_path"].get<std::string>();
             }
+            if (input.contains("reduced_decode")) {
+                input_config_.reduced_decode = input["reduced_decode"].get<bool>();
+            }
         }
         return true;
     }
@@ -121,4 +258,317 @@ bool JsonConfigManager::parseClassesConfig() {
         spdlog::error("Failed to parse classes config: {}", e.what());
         return false;
     }
-}
\ No newline at end of file
+}
+
+bool JsonConfigManager::parsePipelineConfig() {
+    try {
+        if (config_data_.contains("pipeline")) {
+            const auto& pipeline = config_data_["pipeline"];
+            if (pipeline.contains("preprocess_workers")) {
+                pipeline_config_.preprocess_workers = pipeline["preprocess_workers"].get<int>();
+            }
+            if (pipeline.contains("inference_workers")) {
+                pipeline_config_.inference_workers = pipeline["inference_workers"].get<int>();
+            }
+            if (pipeline.contains("postprocess_workers")) {
+                pipeline_config_.postprocess_workers = pipeline["postprocess_workers"].get<int>();
+            }
+            if (pipeline.contains("queue_capacity")) {
+                pipeline_config_.queue_capacity = pipeline["queue_capacity"].get<int>();
+            }
+            if (pipeline.contains("stats_interval_ms")) {
+                pipeline_config_.stats_interval_ms = pipeline["stats_interval_ms"].get<int>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse pipeline config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parsePoolConfig() {
+    try {
+        if (config_data_.contains("pool")) {
+            const auto& pool = config_data_["pool"];
+            if (pool.contains("sessions")) {
+                pool_config_.sessions = pool["sessions"].get<int>();
+            }
+            if (pool.contains("global_thread_pools")) {
+                pool_config_.global_thread_pools = pool["global_thread_pools"].get<bool>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse pool config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parseTelemetryConfig() {
+    try {
+        if (config_data_.contains("telemetry")) {
+            const auto& telemetry = config_data_["telemetry"];
+            if (telemetry.contains("enabled")) {
+                telemetry_config_.enabled = telemetry["enabled"].get<bool>();
+            }
+            if (telemetry.contains("prometheus_file")) {
+                telemetry_config_.prometheus_file = telemetry["prometheus_file"].get<std::string>();
+            }
+            if (telemetry.contains("prometheus_port")) {
+                telemetry_config_.prometheus_port = telemetry["prometheus_port"].get<int>();
+            }
+            if (telemetry.contains("export_interval_ms")) {
+                telemetry_config_.export_interval_ms = telemetry["export_interval_ms"].get<int>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse telemetry config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parseTilingConfig() {
+    try {
+        if (config_data_.contains("tiling")) {
+            const auto& tiling = config_data_["tiling"];
+            if (tiling.contains("enabled")) {
+                tiling_config_.enabled = tiling["enabled"].get<bool>();
+            }
+            if (tiling.contains("tile_width")) {
+                tiling_config_.tile_width = tiling["tile_width"].get<int>();
+            }
+            if (tiling.contains("tile_height")) {
+                tiling_config_.tile_height = tiling["tile_height"].get<int>();
+            }
+            if (tiling.contains("overlap")) {
+                tiling_config_.overlap = tiling["overlap"].get<float>();
+            }
+            if (tiling.contains("full_image_pass")) {
+                tiling_config_.full_image_pass = tiling["full_image_pass"].get<bool>();
+            }
+            if (tiling.contains("merge")) {
+                tiling_config_.merge = tiling["merge"].get<std::string>();
+            }
+            if (tiling.contains("merge_threshold")) {
+                tiling_config_.merge_threshold = tiling["merge_threshold"].get<float>();
+            }
+            if (tiling.contains("merge_class_aware")) {
+                tiling_config_.merge_class_aware = tiling["merge_class_aware"].get<bool>();
+            }
+            if (tiling.contains("sessions")) {
+                tiling_config_.sessions = tiling["sessions"].get<int>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse tiling config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parseTrackingConfig() {
+    try {
+        if (config_data_.contains("tracking")) {
+            const auto& tracking = config_data_["tracking"];
+            if (tracking.contains("enabled")) {
+                tracking_config_.enabled = tracking["enabled"].get<bool>();
+            }
+            if (tracking.contains("keyframe_interval")) {
+                tracking_config_.keyframe_interval = tracking["keyframe_interval"].get<int>();
+            }
+            if (tracking.contains("adaptive")) {
+                tracking_config_.adaptive = tracking["adaptive"].get<bool>();
+            }
+            if (tracking.contains("min_interval")) {
+                tracking_config_.min_interval = tracking["min_interval"].get<int>();
+            }
+            if (tracking.contains("max_interval")) {
+                tracking_config_.max_interval = tracking["max_interval"].get<int>();
+            }
+            if (tracking.contains("min_confidence")) {
+                tracking_config_.min_confidence = tracking["min_confidence"].get<float>();
+            }
+            if (tracking.contains("iou_threshold")) {
+                tracking_config_.iou_threshold = tracking["iou_threshold"].get<float>();
+            }
+            if (tracking.contains("max_age")) {
+                tracking_config_.max_age = tracking["max_age"].get<int>();
+            }
+            if (tracking.contains("confidence_decay")) {
+                tracking_config_.confidence_decay = tracking["confidence_decay"].get<float>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse tracking config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parseAsyncConfig() {
+    try {
+        if (config_data_.contains("async")) {
+            const auto& async = config_data_["async"];
+            if (async.contains("sessions")) {
+                async_config_.sessions = async["sessions"].get<int>();
+            }
+            if (async.contains("max_in_flight")) {
+                async_config_.max_in_flight = async["max_in_flight"].get<int>();
+            }
+            if (async.contains("overflow")) {
+                async_config_.overflow = async["overflow"].get<std::string>();
+            }
+            if (async.contains("wait_timeout_ms")) {
+                async_config_.wait_timeout_ms = async["wait_timeout_ms"].get<int>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse async config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parseServerConfig() {
+    try {
+        if (config_data_.contains("server")) {
+            const auto& server = config_data_["server"];
+            if (server.contains("socket_path")) {
+                server_config_.socket_path = server["socket_path"].get<std::string>();
+            }
+            if (server.contains("port")) {
+                server_config_.port = server["port"].get<int>();
+            }
+            if (server.contains("sessions")) {
+                server_config_.sessions = server["sessions"].get<int>();
+            }
+            if (server.contains("max_batch_size")) {
+                server_config_.max_batch_size = server["max_batch_size"].get<int>();
+            }
+            if (server.contains("max_queue_delay_ms")) {
+                server_config_.max_queue_delay_ms = server["max_queue_delay_ms"].get<float>();
+            }
+            if (server.contains("max_pending_per_client")) {
+                server_config_.max_pending_per_client = server["max_pending_per_client"].get<int>();
+            }
+            if (server.contains("queue_capacity")) {
+                server_config_.queue_capacity = server["queue_capacity"].get<int>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse server config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parseShmRingConfig() {
+    try {
+        if (config_data_.contains("shm_ring")) {
+            const auto& shm_ring = config_data_["shm_ring"];
+            if (shm_ring.contains("name")) {
+                shm_ring_config_.name = shm_ring["name"].get<std::string>();
+            }
+            if (shm_ring.contains("slots")) {
+                shm_ring_config_.slots = shm_ring["slots"].get<int>();
+            }
+            if (shm_ring.contains("max_width")) {
+                shm_ring_config_.max_width = shm_ring["max_width"].get<int>();
+            }
+            if (shm_ring.contains("max_height")) {
+                shm_ring_config_.max_height = shm_ring["max_height"].get<int>();
+            }
+            if (shm_ring.contains("overflow")) {
+                shm_ring_config_.overflow = shm_ring["overflow"].get<std::string>();
+            }
+            if (shm_ring.contains("max_detections")) {
+                shm_ring_config_.max_detections = shm_ring["max_detections"].get<int>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse shared memory ring config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parseGateConfig() {
+    try {
+        if (config_data_.contains("gate")) {
+            const auto& gate = config_data_["gate"];
+            if (gate.contains("enabled")) {
+                gate_config_.enabled = gate["enabled"].get<bool>();
+            }
+            if (gate.contains("thumb_width")) {
+                gate_config_.thumb_width = gate["thumb_width"].get<int>();
+            }
+            if (gate.contains("thumb_height")) {
+                gate_config_.thumb_height = gate["thumb_height"].get<int>();
+            }
+            if (gate.contains("pixel_threshold")) {
+                gate_config_.pixel_threshold = gate["pixel_threshold"].get<int>();
+            }
+            if (gate.contains("max_changed_ratio")) {
+                gate_config_.max_changed_ratio = gate["max_changed_ratio"].get<float>();
+            }
+            if (gate.contains("max_mean_diff")) {
+                gate_config_.max_mean_diff = gate["max_mean_diff"].get<float>();
+            }
+            if (gate.contains("max_stale_frames")) {
+                gate_config_.max_stale_frames = gate["max_stale_frames"].get<int>();
+            }
+            if (gate.contains("max_stale_ms")) {
+                gate_config_.max_stale_ms = gate["max_stale_ms"].get<int>();
+            }
+            if (gate.contains("mask_path")) {
+                gate_config_.mask_path = gate["mask_path"].get<std::string>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse gate config: {}", e.what());
+        return false;
+    }
+}
+
+bool JsonConfigManager::parseShardConfig() {
+    try {
+        if (config_data_.contains("shard")) {
+            const auto& shard = config_data_["shard"];
+            if (shard.contains("group_by")) {
+                shard_config_.group_by = shard["group_by"].get<std::string>();
+            }
+            if (shard.contains("cores_per_instance")) {
+                shard_config_.cores_per_instance = shard["cores_per_instance"].get<int>();
+            }
+            if (shard.contains("max_instances")) {
+                shard_config_.max_instances = shard["max_instances"].get<int>();
+            }
+            if (shard.contains("pin_threads")) {
+                shard_config_.pin_threads = shard["pin_threads"].get<bool>();
+            }
+            if (shard.contains("balance")) {
+                shard_config_.balance = shard["balance"].get<std::string>();
+            }
+            if (shard.contains("queue_capacity")) {
+                shard_config_.queue_capacity = shard["queue_capacity"].get<int>();
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Failed to parse shard config: {}", e.what());
+        return false;
+    }
+}
@@ -0,0 +1,322 @@
+#include "LetterboxPreprocessor.h"
+#include "SimdDispatch.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(YOLO_SIMD_SSE41)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 与OpenCV INTER_LINEAR相同的定点精度
+constexpr int kCoefBits = 11;
+constexpr int kCoefScale = 1 << kCoefBits;
+constexpr int kCastShift = kCoefBits * 2;
+constexpr int kCastRound = 1 << (kCastShift - 1);
+
+short toCoef(float value) {
+    return static_cast<short>(std::lround(value * kCoefScale));
+}
+
+// 水平插值：将一行BGR源像素插值到缩放后的宽度，按通道平面存储
+void horizontalResize(const uchar* src, const int* xofs, const short* xalpha, int width, int* dst) {
+    int* dst_b = dst;
+    int* dst_g = dst + width;
+    int* dst_r = dst + 2 * width;
+    for (int x = 0; x < width; ++x) {
+        const uchar* s0 = src + xofs[2 * x];
+        const uchar* s1 = src + xofs[2 * x + 1];
+        int a0 = xalpha[2 * x];
+        int a1 = xalpha[2 * x + 1];
+        dst_b[x] = s0[0] * a0 + s1[0] * a1;
+        dst_g[x] = s0[1] * a0 + s1[1] * a1;
+        dst_r[x] = s0[2] * a0 + s1[2] * a1;
+    }
+}
+
+#if defined(YOLO_SIMD_AVX2)
+// 向量部分，返回已处理的像素数
+YOLO_TARGET_AVX2 int verticalBlendAvx2(const int* h0, const int* h1, int b0, int b1, int width, float* dst) {
+    const __m256i vb0 = _mm256_set1_epi32(b0);
+    const __m256i vb1 = _mm256_set1_epi32(b1);
+    const __m256i vround = _mm256_set1_epi32(kCastRound);
+    const __m256 vscale = _mm256_set1_ps(1.0f / 255.0f);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h0 + x));
+        __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h1 + x));
+        __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(s0, vb0), _mm256_mullo_epi32(s1, vb1));
+        v = _mm256_srai_epi32(_mm256_add_epi32(v, vround), kCastShift);
+        _mm256_storeu_ps(dst + x, _mm256_mul_ps(_mm256_cvtepi32_ps(v), vscale));
+    }
+    return x;
+}
+#endif
+
+#if defined(YOLO_SIMD_SSE41)
+YOLO_TARGET_SSE41 int verticalBlendSse41(const int* h0, const int* h1, int b0, int b1, int width, float* dst) {
+    const __m128i vb0 = _mm_set1_epi32(b0);
+    const __m128i vb1 = _mm_set1_epi32(b1);
+    const __m128i vround = _mm_set1_epi32(kCastRound);
+    const __m128 vscale = _mm_set1_ps(1.0f / 255.0f);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h0 + x));
+        __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h1 + x));
+        __m128i v = _mm_add_epi32(_mm_mullo_epi32(s0, vb0), _mm_mullo_epi32(s1, vb1));
+        v = _mm_srai_epi32(_mm_add_epi32(v, vround), kCastShift);
+        _mm_storeu_ps(dst + x, _mm_mul_ps(_mm_cvtepi32_ps(v), vscale));
+    }
+    return x;
+}
+#endif
+
+// 垂直插值 + 舍入到8位 + 归一化，结果写入一个输出平面
+void verticalBlend(const int* h0, const int* h1, int b0, int b1, int width, float* dst) {
+    const float inv_255 = 1.0f / 255.0f;
+    int x = 0;
+    switch (SimdDispatch::level()) {
+#if defined(YOLO_SIMD_AVX2)
+    case SimdLevel::Avx2:
+        x = verticalBlendAvx2(h0, h1, b0, b1, width, dst);
+        break;
+#endif
+#if defined(YOLO_SIMD_SSE41)
+    case SimdLevel::Sse41:
+        x = verticalBlendSse41(h0, h1, b0, b1, width, dst);
+        break;
+#endif
+    default:
+        break;
+    }
+    for (; x < width; ++x) {
+        int v = (h0[x] * b0 + h1[x] * b1 + kCastRound) >> kCastShift;
+        dst[x] = static_cast<float>(v) * inv_255;
+    }
+}
+
+class LetterboxParallelBody : public cv::ParallelLoopBody {
+public:
+    LetterboxParallelBody(const LetterboxPreprocessor& preprocessor, const cv::Mat& image,
+                          const LetterboxInfo& info, const cv::Size& target_size,
+                          const float* fill_values, float* dst, int* scratch,
+                          int scratch_stride, int num_stripes)
+        : preprocessor_(preprocessor), image_(image), info_(info), target_size_(target_size)
+        , fill_values_(fill_values), dst_(dst), scratch_(scratch)
+        , scratch_stride_(scratch_stride), num_stripes_(num_stripes) {}
+
+    void operator()(const cv::Range& range) const override {
+        for (int stripe = range.start; stripe < range.end; ++stripe) {
+            int row_begin = target_size_.height * stripe / num_stripes_;
+            int row_end = target_size_.height * (stripe + 1) / num_stripes_;
+            preprocessor_.processRows(image_, info_, target_size_, fill_values_, dst_,
+                                      scratch_ + stripe * scratch_stride_, row_begin, row_end);
+        }
+    }
+
+private:
+    const LetterboxPreprocessor& preprocessor_;
+    const cv::Mat& image_;
+    const LetterboxInfo& info_;
+    const cv::Size& target_size_;
+    const float* fill_values_;
+    float* dst_;
+    int* scratch_;
+    int scratch_stride_;
+    int num_stripes_;
+};
+
+} // namespace
+
+LetterboxPreprocessor::LetterboxPreprocessor()
+    : num_threads_(0) {}
+
+LetterboxInfo LetterboxPreprocessor::computeLetterbox(const cv::Size& image_size, const cv::Size& target_size) {
+    LetterboxInfo info;
+    info.scale = std::min(static_cast<float>(target_size.width) / image_size.width,
+                          static_cast<float>(target_size.height) / image_size.height);
+    info.new_width = static_cast<int>(image_size.width * info.scale);
+    info.new_height = static_cast<int>(image_size.height * info.scale);
+    info.left = (target_size.width - info.new_width) / 2;
+    info.top = (target_size.height - info.new_height) / 2;
+    return info;
+}
+
+void LetterboxPreprocessor::prepareTables(const cv::Size& image_size, const LetterboxInfo& info) {
+    cv::Size scaled_size(info.new_width, info.new_height);
+    if (image_size == table_image_size_ && scaled_size == table_scaled_size_) {
+        return;
+    }
+
+    // 与cv::resize相同的像素中心对齐方式
+    double scale_x = static_cast<double>(image_size.width) / info.new_width;
+    double scale_y = static_cast<double>(image_size.height) / info.new_height;
+
+    xofs_.resize(2 * info.new_width);
+    xalpha_.resize(2 * info.new_width);
+    for (int x = 0; x < info.new_width; ++x) {
+        float fx = static_cast<float>((x + 0.5) * scale_x - 0.5);
+        int sx = static_cast<int>(std::floor(fx));
+        fx -= sx;
+        if (sx < 0) {
+            sx = 0;
+            fx = 0.0f;
+        }
+        if (sx >= image_size.width - 1) {
+            sx = image_size.width - 1;
+            fx = 0.0f;
+        }
+        int sx1 = std::min(sx + 1, image_size.width - 1);
+        xofs_[2 * x] = sx * 3;
+        xofs_[2 * x + 1] = sx1 * 3;
+        xalpha_[2 * x] = toCoef(1.0f - fx);
+        xalpha_[2 * x + 1] = static_cast<short>(kCoefScale - xalpha_[2 * x]);
+    }
+
+    yofs_.resize(2 * info.new_height);
+    yalpha_.resize(2 * info.new_height);
+    for (int y = 0; y < info.new_height; ++y) {
+        float fy = static_cast<float>((y + 0.5) * scale_y - 0.5);
+        int sy = static_cast<int>(std::floor(fy));
+        fy -= sy;
+        if (sy < 0) {
+            sy = 0;
+            fy = 0.0f;
+        }
+        if (sy >= image_size.height - 1) {
+            sy = image_size.height - 1;
+            fy = 0.0f;
+        }
+        yofs_[2 * y] = sy;
+        yofs_[2 * y + 1] = std::min(sy + 1, image_size.height - 1);
+        yalpha_[2 * y] = toCoef(1.0f - fy);
+        yalpha_[2 * y + 1] = static_cast<short>(kCoefScale - yalpha_[2 * y]);
+    }
+
+    table_image_size_ = image_size;
+    table_scaled_size_ = scaled_size;
+}
+
+LetterboxInfo LetterboxPreprocessor::run(const cv::Mat& image, const cv::Size& target_size, float* dst,
+                                         const cv::Scalar& fill_color) {
+    CV_Assert(image.type() == CV_8UC3 && !image.empty());
+
+    LetterboxInfo info = computeLetterbox(cv::Size(image.cols, image.rows), target_size);
+    prepareTables(cv::Size(image.cols, image.rows), info);
+
+    // 输出平面顺序为RGB，对应BGR填充色的第2/1/0通道
+    const float fill_values[3] = {
+        static_cast<float>(fill_color[2] / 255.0),
+        static_cast<float>(fill_color[1] / 255.0),
+        static_cast<float>(fill_color[0] / 255.0)
+    };
+
+    int num_threads = num_threads_ > 0 ? num_threads_ : cv::getNumThreads();
+    int num_stripes = std::max(1, std::min(num_threads, target_size.height / 32));
+
+    int scratch_stride = 6 * info.new_width;
+    size_t scratch_size = static_cast<size_t>(scratch_stride) * num_stripes;
+    if (scratch_.size() < scratch_size) {
+        scratch_.resize(scratch_size);
+    }
+
+    if (num_stripes == 1) {
+        processRows(image, info, target_size, fill_values, dst, scratch_.data(), 0, target_size.height);
+    } else {
+        LetterboxParallelBody body(*this, image, info, target_size, fill_values, dst,
+                                   scratch_.data(), scratch_stride, num_stripes);
+        cv::parallel_for_(cv::Range(0, num_stripes), body, num_stripes);
+    }
+
+    return info;
+}
+
+LetterboxInfo LetterboxPreprocessor::runBytes(const cv::Mat& image, const cv::Size& target_size, uchar* dst,
+                                              const cv::Scalar& fill_color) {
+    CV_Assert(image.type() == CV_8UC3 && !image.empty());
+
+    LetterboxInfo info = computeLetterbox(cv::Size(image.cols, image.rows), target_size);
+    cv::Mat canvas(target_size, CV_8UC3, dst);
+    cv::Rect content(info.left, info.top, info.new_width, info.new_height);
+
+    // 只填充四周的边框，有效区域由缩放结果直接覆盖
+    cv::Rect borders[4] = {
+        cv::Rect(0, 0, target_size.width, info.top),
+        cv::Rect(0, content.y + content.height, target_size.width, target_size.height - content.y - content.height),
+        cv::Rect(0, info.top, info.left, info.new_height),
+        cv::Rect(content.x + content.width, info.top, target_size.width - content.x - content.width, info.new_height)
+    };
+    for (const cv::Rect& border : borders) {
+        if (border.area() > 0) {
+            canvas(border).setTo(fill_color);
+        }
+    }
+
+    // dst中的ROI尺寸与类型已确定，resize/copyTo不会重新分配
+    cv::Mat roi = canvas(content);
+    if (content.size() == image.size()) {
+        image.copyTo(roi);
+    } else {
+        cv::resize(image, roi, content.size(), 0, 0, cv::INTER_LINEAR);
+    }
+    return info;
+}
+
+void LetterboxPreprocessor::processRows(const cv::Mat& image, const LetterboxInfo& info,
+                                        const cv::Size& target_size, const float* fill_values,
+                                        float* dst, int* scratch, int row_begin, int row_end) const {
+    const int width = target_size.width;
+    const size_t plane_size = static_cast<size_t>(target_size.area());
+    const int new_width = info.new_width;
+    const int right = info.left + new_width;
+
+    // 两行水平插值缓存，相邻输出行共享源行时直接复用
+    int* hrows[2] = { scratch, scratch + 3 * new_width };
+    int cached_rows[2] = { -1, -1 };
+
+    for (int y = row_begin; y < row_end; ++y) {
+        int yy = y - info.top;
+        bool padded_row = yy < 0 || yy >= info.new_height;
+
+        for (int p = 0; p < 3; ++p) {
+            float* row = dst + p * plane_size + static_cast<size_t>(y) * width;
+            if (padded_row) {
+                std::fill(row, row + width, fill_values[p]);
+            } else {
+                std::fill(row, row + info.left, fill_values[p]);
+                std::fill(row + right, row + width, fill_values[p]);
+            }
+        }
+        if (padded_row) {
+            continue;
+        }
+
+        int sy0 = yofs_[2 * yy];
+        int sy1 = yofs_[2 * yy + 1];
+        const int* h[2] = { nullptr, nullptr };
+        const int needed[2] = { sy0, sy1 };
+        for (int k = 0; k < 2; ++k) {
+            if (cached_rows[0] == needed[k]) {
+                h[k] = hrows[0];
+            } else if (cached_rows[1] == needed[k]) {
+                h[k] = hrows[1];
+            } else {
+                // 不覆盖当前行仍需要的缓存槽
+                int slot = (k == 0) ? (cached_rows[0] == needed[1] ? 1 : 0)
+                                    : (h[0] == hrows[0] ? 1 : 0);
+                horizontalResize(image.ptr<uchar>(needed[k]), xofs_.data(), xalpha_.data(), new_width, hrows[slot]);
+                cached_rows[slot] = needed[k];
+                h[k] = hrows[slot];
+            }
+        }
+
+        int b0 = yalpha_[2 * yy];
+        int b1 = yalpha_[2 * yy + 1];
+        for (int c = 0; c < 3; ++c) {
+            // BGR源通道c写入RGB平面(2 - c)
+            float* row = dst + (2 - c) * plane_size + static_cast<size_t>(y) * width + info.left;
+            verticalBlend(h[0] + c * new_width, h[1] + c * new_width, b0, b1, new_width, row);
+        }
+    }
+}
@@ -0,0 +1,224 @@
+#include "LocalSocket.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+
+bool initializeSockets() {
+    static bool initialized = []() {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return initialized;
+}
+
+void closeNative(NativeSocket socket) { closesocket(socket); }
+constexpr int kShutdownBoth = SD_BOTH;
+constexpr int kSendFlags = 0;
+#else
+using NativeSocket = int;
+
+bool initializeSockets() { return true; }
+void closeNative(NativeSocket socket) { ::close(socket); }
+constexpr int kShutdownBoth = SHUT_RDWR;
+// 对端已关闭时send返回错误而不是触发SIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+#endif
+
+NativeSocket native(intptr_t handle) { return static_cast<NativeSocket>(handle); }
+
+// 小请求与响应不等待合并发送
+void setNoDelay(NativeSocket socket) {
+    int flag = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&flag), sizeof(flag));
+}
+
+bool makeUnixAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        spdlog::error("Invalid Unix socket path '{}' (at most {} characters)", path, sizeof(address.sun_path) - 1);
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+sockaddr_in makeLoopbackAddress(int port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+} // namespace
+
+LocalSocket::~LocalSocket() {
+    close();
+}
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+    : handle_(other.handle_)
+    , unlink_path_(std::move(other.unlink_path_)) {
+    other.handle_ = kInvalidHandle;
+    other.unlink_path_.clear();
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        handle_ = other.handle_;
+        unlink_path_ = std::move(other.unlink_path_);
+        other.handle_ = kInvalidHandle;
+        other.unlink_path_.clear();
+    }
+    return *this;
+}
+
+LocalSocket LocalSocket::listen(const std::string& socket_path, int port, int backlog) {
+    if (!initializeSockets()) {
+        spdlog::error("Socket library initialization failed");
+        return LocalSocket();
+    }
+
+    NativeSocket socket = ::socket(port > 0 ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+    LocalSocket listener(static_cast<intptr_t>(socket));
+    if (!listener.valid()) {
+        spdlog::error("Cannot create listening socket");
+        return LocalSocket();
+    }
+
+    int result = -1;
+    if (port > 0) {
+        int reuse = 1;
+        setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        sockaddr_in address = makeLoopbackAddress(port);
+        result = ::bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    } else {
+        sockaddr_un address;
+        if (!makeUnixAddress(socket_path, address)) {
+            return LocalSocket();
+        }
+        // 上次异常退出遗留的socket文件会使bind失败
+        std::remove(socket_path.c_str());
+        result = ::bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        listener.unlink_path_ = socket_path;
+    }
+    if (result != 0 || ::listen(socket, backlog) != 0) {
+        spdlog::error("Cannot listen on {}", port > 0 ? "127.0.0.1:" + std::to_string(port) : socket_path);
+        listener.unlink_path_.clear();
+        return LocalSocket();
+    }
+    return listener;
+}
+
+LocalSocket LocalSocket::connect(const std::string& socket_path, int port) {
+    if (!initializeSockets()) {
+        spdlog::error("Socket library initialization failed");
+        return LocalSocket();
+    }
+
+    NativeSocket socket = ::socket(port > 0 ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+    LocalSocket connection(static_cast<intptr_t>(socket));
+    if (!connection.valid()) {
+        return LocalSocket();
+    }
+
+    int result = -1;
+    if (port > 0) {
+        sockaddr_in address = makeLoopbackAddress(port);
+        result = ::connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        setNoDelay(socket);
+    } else {
+        sockaddr_un address;
+        if (!makeUnixAddress(socket_path, address)) {
+            return LocalSocket();
+        }
+        result = ::connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+    if (result != 0) {
+        return LocalSocket();
+    }
+    return connection;
+}
+
+LocalSocket LocalSocket::accept() {
+    if (!valid()) {
+        return LocalSocket();
+    }
+    NativeSocket socket = ::accept(native(handle_), nullptr, nullptr);
+    LocalSocket connection(static_cast<intptr_t>(socket));
+    if (connection.valid() && unlink_path_.empty()) {
+        setNoDelay(socket);
+    }
+    return connection;
+}
+
+bool LocalSocket::sendAll(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0 && valid()) {
+        int chunk = static_cast<int>(std::min<size_t>(size, 1 << 30));
+        auto sent = ::send(native(handle_), bytes, chunk, kSendFlags);
+        if (sent <= 0) {
+            return false;
+        }
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return size == 0;
+}
+
+bool LocalSocket::recvAll(void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0 && valid()) {
+        int chunk = static_cast<int>(std::min<size_t>(size, 1 << 30));
+        auto received = ::recv(native(handle_), bytes, chunk, 0);
+        if (received <= 0) {
+            return false;
+        }
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return size == 0;
+}
+
+void LocalSocket::shutdown() {
+    if (valid()) {
+        ::shutdown(native(handle_), kShutdownBoth);
+    }
+}
+
+void LocalSocket::close() {
+    if (valid()) {
+        closeNative(native(handle_));
+        handle_ = kInvalidHandle;
+    }
+    if (!unlink_path_.empty()) {
+        std::remove(unlink_path_.c_str());
+        unlink_path_.clear();
+    }
+}
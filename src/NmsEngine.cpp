@@ -0,0 +1,400 @@
+#include "NmsEngine.h"
+#include "SimdDispatch.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#if defined(YOLO_SIMD_SSE41)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 网格边长上限，以及启用网格的最小组规模（小组直接线性比较更快）
+constexpr int kMaxGridDim = 64;
+constexpr int kGridMinGroupSize = 256;
+
+#if defined(YOLO_SIMD_AVX2)
+// 向量部分，返回已比较的框数；发现超过阈值的框时返回-1
+YOLO_TARGET_AVX2 int anyIouAboveAvx2(float bx1, float by1, float bx2, float by2, float barea,
+                                     const float* x1, const float* y1, const float* x2, const float* y2,
+                                     const float* area, int n, float iou_threshold) {
+    int j = 0;
+    const __m256 vbx1 = _mm256_set1_ps(bx1);
+    const __m256 vby1 = _mm256_set1_ps(by1);
+    const __m256 vbx2 = _mm256_set1_ps(bx2);
+    const __m256 vby2 = _mm256_set1_ps(by2);
+    const __m256 vbarea = _mm256_set1_ps(barea);
+    const __m256 vthreshold = _mm256_set1_ps(iou_threshold);
+    const __m256 vzero = _mm256_setzero_ps();
+    for (; j + 8 <= n; j += 8) {
+        __m256 iw = _mm256_sub_ps(_mm256_min_ps(vbx2, _mm256_loadu_ps(x2 + j)), _mm256_max_ps(vbx1, _mm256_loadu_ps(x1 + j)));
+        __m256 ih = _mm256_sub_ps(_mm256_min_ps(vby2, _mm256_loadu_ps(y2 + j)), _mm256_max_ps(vby1, _mm256_loadu_ps(y1 + j)));
+        __m256 inter = _mm256_mul_ps(_mm256_max_ps(iw, vzero), _mm256_max_ps(ih, vzero));
+        __m256 uni = _mm256_sub_ps(_mm256_add_ps(vbarea, _mm256_loadu_ps(area + j)), inter);
+        if (_mm256_movemask_ps(_mm256_cmp_ps(inter, _mm256_mul_ps(vthreshold, uni), _CMP_GT_OQ))) {
+            return -1;
+        }
+    }
+    return j;
+}
+#endif
+
+#if defined(YOLO_SIMD_SSE41)
+YOLO_TARGET_SSE41 int anyIouAboveSse41(float bx1, float by1, float bx2, float by2, float barea,
+                                       const float* x1, const float* y1, const float* x2, const float* y2,
+                                       const float* area, int n, float iou_threshold) {
+    int j = 0;
+    const __m128 vbx1 = _mm_set1_ps(bx1);
+    const __m128 vby1 = _mm_set1_ps(by1);
+    const __m128 vbx2 = _mm_set1_ps(bx2);
+    const __m128 vby2 = _mm_set1_ps(by2);
+    const __m128 vbarea = _mm_set1_ps(barea);
+    const __m128 vthreshold = _mm_set1_ps(iou_threshold);
+    const __m128 vzero = _mm_setzero_ps();
+    for (; j + 4 <= n; j += 4) {
+        __m128 iw = _mm_sub_ps(_mm_min_ps(vbx2, _mm_loadu_ps(x2 + j)), _mm_max_ps(vbx1, _mm_loadu_ps(x1 + j)));
+        __m128 ih = _mm_sub_ps(_mm_min_ps(vby2, _mm_loadu_ps(y2 + j)), _mm_max_ps(vby1, _mm_loadu_ps(y1 + j)));
+        __m128 inter = _mm_mul_ps(_mm_max_ps(iw, vzero), _mm_max_ps(ih, vzero));
+        __m128 uni = _mm_sub_ps(_mm_add_ps(vbarea, _mm_loadu_ps(area + j)), inter);
+        if (_mm_movemask_ps(_mm_cmpgt_ps(inter, _mm_mul_ps(vthreshold, uni)))) {
+            return -1;
+        }
+    }
+    return j;
+}
+#endif
+
+// 判断框b与数组中任一框的IoU是否超过阈值：inter > thr * union，避免除法
+bool anyIouAbove(float bx1, float by1, float bx2, float by2, float barea,
+                 const float* x1, const float* y1, const float* x2, const float* y2,
+                 const float* area, int n, float iou_threshold) {
+    int j = 0;
+    switch (SimdDispatch::level()) {
+#if defined(YOLO_SIMD_AVX2)
+    case SimdLevel::Avx2:
+        j = anyIouAboveAvx2(bx1, by1, bx2, by2, barea, x1, y1, x2, y2, area, n, iou_threshold);
+        break;
+#endif
+#if defined(YOLO_SIMD_SSE41)
+    case SimdLevel::Sse41:
+        j = anyIouAboveSse41(bx1, by1, bx2, by2, barea, x1, y1, x2, y2, area, n, iou_threshold);
+        break;
+#endif
+    default:
+        break;
+    }
+    if (j < 0) {
+        return true;
+    }
+    for (; j < n; ++j) {
+        float iw = std::max(0.0f, std::min(bx2, x2[j]) - std::max(bx1, x1[j]));
+        float ih = std::max(0.0f, std::min(by2, y2[j]) - std::max(by1, y1[j]));
+        float inter = iw * ih;
+        if (inter > iou_threshold * (barea + area[j] - inter)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(YOLO_SIMD_AVX2)
+YOLO_TARGET_AVX2 int iouBatchAvx2(float bx1, float by1, float bx2, float by2, float barea,
+                                  const float* x1, const float* y1, const float* x2, const float* y2,
+                                  const float* area, int n, float* out) {
+    int j = 0;
+    const __m256 vbx1 = _mm256_set1_ps(bx1);
+    const __m256 vby1 = _mm256_set1_ps(by1);
+    const __m256 vbx2 = _mm256_set1_ps(bx2);
+    const __m256 vby2 = _mm256_set1_ps(by2);
+    const __m256 vbarea = _mm256_set1_ps(barea);
+    const __m256 vzero = _mm256_setzero_ps();
+    const __m256 veps = _mm256_set1_ps(1e-9f);
+    for (; j + 8 <= n; j += 8) {
+        __m256 iw = _mm256_sub_ps(_mm256_min_ps(vbx2, _mm256_loadu_ps(x2 + j)), _mm256_max_ps(vbx1, _mm256_loadu_ps(x1 + j)));
+        __m256 ih = _mm256_sub_ps(_mm256_min_ps(vby2, _mm256_loadu_ps(y2 + j)), _mm256_max_ps(vby1, _mm256_loadu_ps(y1 + j)));
+        __m256 inter = _mm256_mul_ps(_mm256_max_ps(iw, vzero), _mm256_max_ps(ih, vzero));
+        __m256 uni = _mm256_sub_ps(_mm256_add_ps(vbarea, _mm256_loadu_ps(area + j)), inter);
+        _mm256_storeu_ps(out + j, _mm256_div_ps(inter, _mm256_max_ps(uni, veps)));
+    }
+    return j;
+}
+#endif
+
+#if defined(YOLO_SIMD_SSE41)
+YOLO_TARGET_SSE41 int iouBatchSse41(float bx1, float by1, float bx2, float by2, float barea,
+                                    const float* x1, const float* y1, const float* x2, const float* y2,
+                                    const float* area, int n, float* out) {
+    int j = 0;
+    const __m128 vbx1 = _mm_set1_ps(bx1);
+    const __m128 vby1 = _mm_set1_ps(by1);
+    const __m128 vbx2 = _mm_set1_ps(bx2);
+    const __m128 vby2 = _mm_set1_ps(by2);
+    const __m128 vbarea = _mm_set1_ps(barea);
+    const __m128 vzero = _mm_setzero_ps();
+    const __m128 veps = _mm_set1_ps(1e-9f);
+    for (; j + 4 <= n; j += 4) {
+        __m128 iw = _mm_sub_ps(_mm_min_ps(vbx2, _mm_loadu_ps(x2 + j)), _mm_max_ps(vbx1, _mm_loadu_ps(x1 + j)));
+        __m128 ih = _mm_sub_ps(_mm_min_ps(vby2, _mm_loadu_ps(y2 + j)), _mm_max_ps(vby1, _mm_loadu_ps(y1 + j)));
+        __m128 inter = _mm_mul_ps(_mm_max_ps(iw, vzero), _mm_max_ps(ih, vzero));
+        __m128 uni = _mm_sub_ps(_mm_add_ps(vbarea, _mm_loadu_ps(area + j)), inter);
+        _mm_storeu_ps(out + j, _mm_div_ps(inter, _mm_max_ps(uni, veps)));
+    }
+    return j;
+}
+#endif
+
+// 计算框b与数组中每个框的IoU
+void iouBatch(float bx1, float by1, float bx2, float by2, float barea,
+              const float* x1, const float* y1, const float* x2, const float* y2,
+              const float* area, int n, float* out) {
+    int j = 0;
+    switch (SimdDispatch::level()) {
+#if defined(YOLO_SIMD_AVX2)
+    case SimdLevel::Avx2:
+        j = iouBatchAvx2(bx1, by1, bx2, by2, barea, x1, y1, x2, y2, area, n, out);
+        break;
+#endif
+#if defined(YOLO_SIMD_SSE41)
+    case SimdLevel::Sse41:
+        j = iouBatchSse41(bx1, by1, bx2, by2, barea, x1, y1, x2, y2, area, n, out);
+        break;
+#endif
+    default:
+        break;
+    }
+    for (; j < n; ++j) {
+        float iw = std::max(0.0f, std::min(bx2, x2[j]) - std::max(bx1, x1[j]));
+        float ih = std::max(0.0f, std::min(by2, y2[j]) - std::max(by1, y1[j]));
+        float inter = iw * ih;
+        out[j] = inter / std::max(barea + area[j] - inter, 1e-9f);
+    }
+}
+
+} // namespace
+
+void NmsEngine::Cell::clear() {
+    x1.clear();
+    y1.clear();
+    x2.clear();
+    y2.clear();
+    area.clear();
+}
+
+void NmsEngine::Cell::push(float bx1, float by1, float bx2, float by2, float barea) {
+    x1.push_back(bx1);
+    y1.push_back(by1);
+    x2.push_back(bx2);
+    y2.push_back(by2);
+    area.push_back(barea);
+}
+
+void NmsEngine::run(const std::vector<cv::Rect>& boxes, const std::vector<float>& scores,
+                    const std::vector<int>& class_ids, const NmsOptions& options,
+                    std::vector<int>& keep) {
+    keep.clear();
+    kept_scores_.clear();
+    kept_pos_.clear();
+
+    // 筛选分数达到阈值的候选
+    order_.clear();
+    for (size_t i = 0; i < scores.size(); ++i) {
+        if (scores[i] >= options.score_threshold) {
+            order_.push_back(static_cast<int>(i));
+        }
+    }
+    if (order_.empty()) {
+        return;
+    }
+
+    auto by_score = [&scores](int a, int b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    };
+
+    // 仅保留分数最高的top_k个候选
+    if (options.top_k > 0 && order_.size() > static_cast<size_t>(options.top_k)) {
+        std::nth_element(order_.begin(), order_.begin() + options.top_k, order_.end(), by_score);
+        order_.resize(options.top_k);
+    }
+
+    // 按类别分组，组内按分数降序
+    const bool class_aware = options.class_aware && class_ids.size() == scores.size();
+    std::sort(order_.begin(), order_.end(), [&](int a, int b) {
+        if (class_aware && class_ids[a] != class_ids[b]) {
+            return class_ids[a] < class_ids[b];
+        }
+        return by_score(a, b);
+    });
+
+    // 转换为SoA float坐标
+    const int n = static_cast<int>(order_.size());
+    x1_.resize(n);
+    y1_.resize(n);
+    x2_.resize(n);
+    y2_.resize(n);
+    area_.resize(n);
+    scores_.resize(n);
+    for (int k = 0; k < n; ++k) {
+        const cv::Rect& box = boxes[order_[k]];
+        x1_[k] = static_cast<float>(box.x);
+        y1_[k] = static_cast<float>(box.y);
+        x2_[k] = static_cast<float>(box.x + box.width);
+        y2_[k] = static_cast<float>(box.y + box.height);
+        area_[k] = static_cast<float>(box.width) * static_cast<float>(box.height);
+        scores_[k] = scores[order_[k]];
+    }
+
+    // 逐类别组执行NMS
+    for (int begin = 0; begin < n;) {
+        int end = begin + 1;
+        while (end < n && (!class_aware || class_ids[order_[end]] == class_ids[order_[begin]])) {
+            ++end;
+        }
+        if (options.soft_nms) {
+            softNmsGroup(begin, end, options);
+        } else {
+            hardNmsGroup(begin, end, options.iou_threshold);
+        }
+        begin = end;
+    }
+
+    // 合并各类别结果，按最终分数降序输出
+    std::sort(kept_pos_.begin(), kept_pos_.end(), [this](int a, int b) {
+        return scores_[a] > scores_[b] || (scores_[a] == scores_[b] && order_[a] < order_[b]);
+    });
+    size_t kept_count = kept_pos_.size();
+    if (options.max_detections > 0) {
+        kept_count = std::min(kept_count, static_cast<size_t>(options.max_detections));
+    }
+    for (size_t i = 0; i < kept_count; ++i) {
+        keep.push_back(order_[kept_pos_[i]]);
+        kept_scores_.push_back(scores_[kept_pos_[i]]);
+    }
+}
+
+void NmsEngine::hardNmsGroup(int begin, int end, float iou_threshold) {
+    const int count = end - begin;
+
+    // 组内框的外接范围决定网格覆盖区域
+    float min_x = x1_[begin], min_y = y1_[begin], max_x = x2_[begin], max_y = y2_[begin];
+    float side_sum = 0.0f;
+    for (int k = begin; k < end; ++k) {
+        min_x = std::min(min_x, x1_[k]);
+        min_y = std::min(min_y, y1_[k]);
+        max_x = std::max(max_x, x2_[k]);
+        max_y = std::max(max_y, y2_[k]);
+        side_sum += std::max(x2_[k] - x1_[k], y2_[k] - y1_[k]);
+    }
+
+    // 网格单元边长取平均框边长，使典型框只落入约2x2个单元
+    int grid_cols = 1;
+    int grid_rows = 1;
+    if (count >= kGridMinGroupSize) {
+        float cell_size = std::max(16.0f, side_sum / count);
+        grid_cols = std::clamp(static_cast<int>((max_x - min_x) / cell_size) + 1, 1, kMaxGridDim);
+        grid_rows = std::clamp(static_cast<int>((max_y - min_y) / cell_size) + 1, 1, kMaxGridDim);
+    }
+    const float cell_w = std::max(1.0f, (max_x - min_x) / grid_cols);
+    const float cell_h = std::max(1.0f, (max_y - min_y) / grid_rows);
+    if (grid_.size() < static_cast<size_t>(grid_cols * grid_rows)) {
+        grid_.resize(grid_cols * grid_rows);
+    }
+    touched_cells_.clear();
+
+    for (int k = begin; k < end; ++k) {
+        int cx0 = std::clamp(static_cast<int>((x1_[k] - min_x) / cell_w), 0, grid_cols - 1);
+        int cx1 = std::clamp(static_cast<int>((x2_[k] - min_x) / cell_w), 0, grid_cols - 1);
+        int cy0 = std::clamp(static_cast<int>((y1_[k] - min_y) / cell_h), 0, grid_rows - 1);
+        int cy1 = std::clamp(static_cast<int>((y2_[k] - min_y) / cell_h), 0, grid_rows - 1);
+
+        // 只与重叠网格中的已保留框比较
+        bool suppressed = false;
+        for (int cy = cy0; cy <= cy1 && !suppressed; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                if (overlapsAny(grid_[cy * grid_cols + cx], k, iou_threshold)) {
+                    suppressed = true;
+                    break;
+                }
+            }
+        }
+        if (suppressed) {
+            continue;
+        }
+
+        kept_pos_.push_back(k);
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                Cell& cell = grid_[cy * grid_cols + cx];
+                if (cell.x1.empty()) {
+                    touched_cells_.push_back(cy * grid_cols + cx);
+                }
+                cell.push(x1_[k], y1_[k], x2_[k], y2_[k], area_[k]);
+            }
+        }
+    }
+
+    for (int index : touched_cells_) {
+        grid_[index].clear();
+    }
+}
+
+bool NmsEngine::overlapsAny(const Cell& cell, int k, float iou_threshold) const {
+    if (cell.x1.empty()) {
+        return false;
+    }
+    return anyIouAbove(x1_[k], y1_[k], x2_[k], y2_[k], area_[k],
+                       cell.x1.data(), cell.y1.data(), cell.x2.data(), cell.y2.data(),
+                       cell.area.data(), static_cast<int>(cell.x1.size()), iou_threshold);
+}
+
+void NmsEngine::softNmsGroup(int begin, int end, const NmsOptions& options) {
+    auto swap_entries = [this](int a, int b) {
+        std::swap(order_[a], order_[b]);
+        std::swap(x1_[a], x1_[b]);
+        std::swap(y1_[a], y1_[b]);
+        std::swap(x2_[a], x2_[b]);
+        std::swap(y2_[a], y2_[b]);
+        std::swap(area_[a], area_[b]);
+        std::swap(scores_[a], scores_[b]);
+    };
+
+    const float inv_sigma = 1.0f / std::max(options.soft_nms_sigma, 1e-6f);
+    if (ious_.size() < static_cast<size_t>(end - begin)) {
+        ious_.resize(end - begin);
+    }
+
+    // [begin, head)为已选中框，[head, tail)为待处理框，保持连续以便SIMD计算IoU
+    int head = begin;
+    int tail = end;
+    while (head < tail) {
+        int best = head;
+        for (int k = head + 1; k < tail; ++k) {
+            if (scores_[k] > scores_[best]) {
+                best = k;
+            }
+        }
+        swap_entries(head, best);
+        kept_pos_.push_back(head);
+
+        int rest = tail - head - 1;
+        iouBatch(x1_[head], y1_[head], x2_[head], y2_[head], area_[head],
+                 x1_.data() + head + 1, y1_.data() + head + 1, x2_.data() + head + 1,
+                 y2_.data() + head + 1, area_.data() + head + 1, rest, ious_.data());
+        for (int j = 0; j < rest; ++j) {
+            float iou = ious_[j];
+            scores_[head + 1 + j] *= std::exp(-(iou * iou) * inv_sigma);
+        }
+
+        // 丢弃衰减后低于分数阈值的框
+        int j = head + 1;
+        while (j < tail) {
+            if (scores_[j] < options.score_threshold) {
+                swap_entries(j, tail - 1);
+                --tail;
+            } else {
+                ++j;
+            }
+        }
+        ++head;
+    }
+}
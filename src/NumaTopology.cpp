@@ -0,0 +1,192 @@
+#include "NumaTopology.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <windows.h>  // 使用(std::max)避免与max宏冲突
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// 进程当前可以运行的CPU
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        int count = static_cast<int>((std::max)(1u, std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<CoreGroup> platformNodes() {
+    std::vector<CoreGroup> nodes;
+#if defined(__linux__)
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+            !std::all_of(name.begin() + 4, name.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+            continue;
+        }
+        std::ifstream file(entry.path() / "cpulist");
+        std::string text;
+        if (std::getline(file, text)) {
+            CoreGroup node;
+            node.node = std::stoi(name.substr(4));
+            node.cpus = NumaTopology::parseCpuList(text);
+            nodes.push_back(node);
+        }
+    }
+#elif defined(_WIN32)
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest)) {
+        for (ULONG id = 0; id <= highest; ++id) {
+            ULONGLONG mask = 0;
+            if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(id), &mask)) {
+                continue;
+            }
+            CoreGroup node;
+            node.node = static_cast<int>(id);
+            for (int cpu = 0; cpu < 64; ++cpu) {
+                if (mask & (1ull << cpu)) {
+                    node.cpus.push_back(cpu);
+                }
+            }
+            nodes.push_back(node);
+        }
+    }
+#endif
+    std::sort(nodes.begin(), nodes.end(), [](const CoreGroup& a, const CoreGroup& b) { return a.node < b.node; });
+    return nodes;
+}
+
+} // namespace
+
+std::vector<CoreGroup> NumaTopology::discover() {
+    std::vector<int> allowed = allowedCpus();
+    std::vector<CoreGroup> nodes;
+    for (CoreGroup& node : platformNodes()) {
+        // 只保留进程可用的CPU，全部不可用的节点（如被taskset排除）整体去掉
+        std::vector<int> cpus;
+        std::set_intersection(node.cpus.begin(), node.cpus.end(), allowed.begin(), allowed.end(),
+                              std::back_inserter(cpus));
+        if (!cpus.empty()) {
+            node.cpus = cpus;
+            nodes.push_back(node);
+        }
+    }
+    if (nodes.empty()) {
+        CoreGroup node;
+        node.cpus = allowed;
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+std::vector<CoreGroup> NumaTopology::split(const std::vector<CoreGroup>& nodes, int cores_per_group) {
+    if (cores_per_group <= 0) {
+        return nodes;
+    }
+    std::vector<CoreGroup> groups;
+    for (const CoreGroup& node : nodes) {
+        size_t count = (std::max<size_t>)(1, node.cpus.size() / cores_per_group);
+        for (size_t i = 0; i < count; ++i) {
+            CoreGroup group;
+            group.node = node.node;
+            auto begin = node.cpus.begin() + i * cores_per_group;
+            auto end = i + 1 == count ? node.cpus.end() : begin + cores_per_group;
+            group.cpus.assign(begin, end);
+            groups.push_back(group);
+        }
+    }
+    return groups;
+}
+
+bool NumaTopology::pinCurrentThread(const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return false;
+    }
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+            mask |= static_cast<DWORD_PTR>(1) << cpu;
+        }
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;
+#endif
+}
+
+std::vector<int> NumaTopology::parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.find_first_of("0123456789") == std::string::npos) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        catch (const std::exception&) {
+            spdlog::warn("Ignoring malformed CPU range '{}'", range);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::string NumaTopology::formatCpuList(const std::vector<int>& cpus) {
+    std::string text;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            ++j;
+        }
+        text += (text.empty() ? "" : ",") + std::to_string(cpus[i]);
+        if (j > i) {
+            text += "-" + std::to_string(cpus[j]);
+        }
+        i = j + 1;
+    }
+    return text;
+}
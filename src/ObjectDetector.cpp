@@ -2,50 +2,89 @@
 #include "JsonConfigManager.h"
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
 
 ObjectDetector::ObjectDetector() 
     : confidence_threshold_(0.0f)
     , nms_threshold_(0.0f)
     , input_width_(0)
-    , input_height_(0) {
+    , input_height_(0)
+    , provider_probe_runs_(5)
+    , max_batch_size_(1)
+    , dynamic_batch_(false)
+    , use_io_binding_(false)
+    , minimal_letterbox_(false)
+    , stride_(32)
+    , preprocess_threads_(0)
+    , intra_op_threads_(1)
+    , inter_op_threads_(1)
+    , execution_mode_("sequential")
+    , use_global_thread_pools_(false)
+    , cpu_mem_arena_(true)
+    , mem_pattern_(true)
+    , shared_arena_(false)
+    , arena_extend_strategy_("next_power_of_two")
+    , arena_initial_chunk_bytes_(0)
+    , share_prepacked_weights_(true)
+    , mmap_model_(false)
+    , warmup_runs_(0)
+    , warming_up_(false)
+    , input_format_name_("auto")
+    , input_format_(InputFormat::Float32Nchw)
+    , output_format_(OutputFormat::RawAnchors)
+    , memory_info_(Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault))
+    , input_tensor_(nullptr)
+    , output_tensor_(nullptr)
+    , shape_clock_(0) {
     // 类别名称将从JSON配置中加载
     spdlog::info("ObjectDetector initialized");
 }
 
-ObjectDetector::~ObjectDetector() = default;
+ObjectDetector::~ObjectDetector() {
+    if (session_) {
+        Telemetry::instance().addGauge(TelemetryGauge::Sessions, -1);
+    }
+}
 
 bool ObjectDetector::initialize(JsonConfigManager& config_manager) {
     try {
-        // 从JSON配置获取参数
-        const auto& model_config = config_manager.getModelConfig();
-        const auto& detection_config = config_manager.getDetectionConfig();
-        const auto& classes_config = config_manager.getClassesConfig();
-        
-        // 设置模型参数
-        input_width_ = model_config.input_width;
-        input_height_ = model_config.input_height;
-        confidence_threshold_ = detection_config.confidence_threshold;
-        nms_threshold_ = detection_config.nms_threshold;
-        device_type_ = model_config.device_type; // 设置设备类型
-        
-        // 设置类别名称
-        if (!classes_config.names.empty()) {
-            class_names_ = classes_config.names;
-        } else {
-            // 默认类别名称
-            class_names_ = {"face"};
-        }
+        applyConfig(config_manager);
         
+        const auto& model_config = config_manager.getModelConfig();
+        std::string model_path;
+        bool int8 = selectModel(model_config, model_path, optimized_model_path_);
         spdlog::info("Initializing ObjectDetector from JSON config");
-        spdlog::info("Model path: {}", model_config.path);
+        spdlog::info("Model path: {}", model_path);
+        spdlog::info("Precision: {}", int8 ? "int8 (QDQ)" : "fp32");
+        bool cuda = std::any_of(providers_.begin(), providers_.end(),
+                                [](const ProviderSpec& spec) { return spec.name == "cuda"; });
+        if (int8 && cuda) {
+            spdlog::warn("INT8 QDQ models are tuned for the CPU provider; CUDA may fall back to FP32 kernels");
+        }
         spdlog::info("Input size: {}x{}", input_width_, input_height_);
         spdlog::info("Confidence threshold: {}", confidence_threshold_);
         spdlog::info("NMS threshold: {}", nms_threshold_);
-        spdlog::info("Device type: {}", device_type_);
+        spdlog::info("NMS mode: {}, {}", nms_options_.soft_nms ? "soft" : "hard",
+                     nms_options_.class_aware ? "class-aware" : "class-agnostic");
+        std::string provider_names;
+        for (const auto& spec : providers_) {
+            provider_names += (provider_names.empty() ? "" : ", ") + spec.name;
+        }
+        spdlog::info("Execution providers: {}", provider_names);
+        spdlog::info("Max batch size: {}", max_batch_size_);
+        spdlog::info("IoBinding: {}", use_io_binding_ ? "enabled" : "disabled");
+        if (minimal_letterbox_) {
+            spdlog::info("Letterbox: minimal (stride {}, at most {}x{})", stride_, input_width_, input_height_);
+        }
+        spdlog::info("Threads: intra-op {}, inter-op {}, execution mode {}{}", intra_op_threads_,
+                     inter_op_threads_, execution_mode_, use_global_thread_pools_ ? " (global thread pools)" : "");
+        spdlog::info("Memory: arena {}{}, mem pattern {}, shared prepacked weights {}",
+                     cpu_mem_arena_ ? "on" : "off", cpu_mem_arena_ && shared_arena_ ? " (shared)" : "",
+                     mem_pattern_ ? "on" : "off", share_prepacked_weights_ ? "on" : "off");
         spdlog::info("Number of classes: {}", class_names_.size());
         
         // 调用基础初始化方法
-        return initialize(model_config.path);
+        return initialize(model_path);
     }
     catch (const std::exception& e) {
         spdlog::error("Failed to initialize from JSON config: {}", e.what());
@@ -53,45 +92,219 @@ bool ObjectDetector::initialize(JsonConfigManager& config_manager) {
     }
 }
 
+bool ObjectDetector::selectModel(const ModelConfig& model_config, std::string& model_path,
+                                 std::string& optimized_model_path) {
+    model_path = model_config.path;
+    optimized_model_path = model_config.optimized_model_path;
+    if (model_config.precision != "int8") {
+        if (model_config.precision != "fp32") {
+            spdlog::warn("Unknown precision '{}', using fp32", model_config.precision);
+        }
+        return false;
+    }
+    
+    std::error_code ec;
+    if (model_config.int8_model_path.empty() || !std::filesystem::exists(model_config.int8_model_path, ec)) {
+        spdlog::warn("INT8 model '{}' not found, falling back to fp32 model {}",
+                     model_config.int8_model_path, model_config.path);
+        return false;
+    }
+    
+    model_path = model_config.int8_model_path;
+    if (!optimized_model_path.empty()) {
+        std::filesystem::path cache_path(optimized_model_path);
+        std::filesystem::path extension = cache_path.extension();
+        cache_path.replace_extension(".int8" + extension.string());
+        optimized_model_path = cache_path.string();
+    }
+    return true;
+}
+
+void ObjectDetector::applyConfig(JsonConfigManager& config_manager) {
+    // 从JSON配置获取参数
+    const auto& model_config = config_manager.getModelConfig();
+    const auto& detection_config = config_manager.getDetectionConfig();
+    const auto& classes_config = config_manager.getClassesConfig();
+    
+    Telemetry::instance().setEnabled(config_manager.getTelemetryConfig().enabled);
+    
+    // 设置模型参数
+    input_width_ = model_config.input_width;
+    input_height_ = model_config.input_height;
+    confidence_threshold_ = detection_config.confidence_threshold;
+    nms_threshold_ = detection_config.nms_threshold;
+    nms_options_.class_aware = detection_config.nms_class_aware;
+    nms_options_.top_k = detection_config.nms_top_k;
+    nms_options_.max_detections = detection_config.max_detections;
+    nms_options_.soft_nms = detection_config.soft_nms;
+    nms_options_.soft_nms_sigma = detection_config.soft_nms_sigma;
+    device_type_ = model_config.device_type; // 设置设备类型
+    providers_ = ExecutionProviders::fromConfig(model_config.providers, model_config.provider_options,
+                                                model_config.device_type);
+    provider_cache_path_ = model_config.provider_cache_path;
+    provider_probe_runs_ = std::max(1, model_config.provider_probe_runs);
+    max_batch_size_ = std::max(1, model_config.max_batch_size);
+    use_io_binding_ = model_config.io_binding;
+    preprocessor_.setNumThreads(model_config.preprocess_threads);
+    preprocess_threads_ = model_config.preprocess_threads;
+    setLetterboxMode(model_config.letterbox, model_config.stride);
+    intra_op_threads_ = model_config.intra_op_threads;
+    inter_op_threads_ = model_config.inter_op_threads;
+    execution_mode_ = model_config.execution_mode;
+    cpu_mem_arena_ = model_config.cpu_mem_arena;
+    mem_pattern_ = model_config.mem_pattern;
+    shared_arena_ = model_config.shared_arena;
+    arena_extend_strategy_ = model_config.arena_extend_strategy;
+    arena_initial_chunk_bytes_ = model_config.arena_initial_chunk_bytes;
+    if (!shared_arena_ && (arena_extend_strategy_ != "next_power_of_two" || arena_initial_chunk_bytes_ > 0)) {
+        spdlog::warn("arena_extend_strategy and arena_initial_chunk_bytes only apply with shared_arena enabled");
+    }
+    share_prepacked_weights_ = model_config.share_prepacked_weights;
+    optimized_model_path_ = model_config.optimized_model_path;
+    mmap_model_ = model_config.mmap_model;
+    warmup_runs_ = model_config.warmup_runs;
+    input_format_name_ = model_config.input_format;
+    
+    // 设置类别名称
+    if (!classes_config.names.empty()) {
+        class_names_ = classes_config.names;
+    } else {
+        // 默认类别名称
+        class_names_ = {"face"};
+    }
+}
+
+void ObjectDetector::setEnvironment(std::shared_ptr<Ort::Env> env, bool use_global_thread_pools) {
+    env_ = std::move(env);
+    use_global_thread_pools_ = env_ && use_global_thread_pools;
+}
+
 bool ObjectDetector::initialize(const std::string& model_path) {
     try {
         spdlog::info("Initializing ObjectDetector with model: {}", model_path);
         
-        // Create ONNX Runtime environment
-        env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "ObjectDetector");
+        // Create ONNX Runtime environment（已通过setEnvironment共享时直接复用）
+        if (!env_) {
+            env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "ObjectDetector");
+        }
+        
+        // 未配置提供者列表时按device_type；auto模式先测量（或读取缓存）选出最快的提供者
+        std::vector<ProviderSpec> providers = providers_.empty()
+            ? ExecutionProviders::fromConfig({}, {}, device_type_) : providers_;
+        if (ExecutionProviders::isAuto(providers) && !selectProvider(model_path, providers)) {
+            return false;
+        }
         
         // Create session options
         Ort::SessionOptions session_options;
-        session_options.SetIntraOpNumThreads(1);
-        
-        // 根据设备类型配置推理提供者
-        if (device_type_ == "GPU") {
-            // Enable CUDA provider for GPU inference
-            OrtCUDAProviderOptions cuda_options;
-            cuda_options.device_id = 0;  // Use the first GPU
-            cuda_options.arena_extend_strategy = 0;
-            cuda_options.gpu_mem_limit = SIZE_MAX;
-            cuda_options.cudnn_conv_algo_search = OrtCudnnConvAlgoSearchExhaustive;
-            cuda_options.do_copy_in_default_stream = 1;
-            
-            // 添加更多优化选项
-            // 如果需要更高的性能，可以尝试不同的cudnn_conv_algo_search选项：
-            // OrtCudnnConvAlgoSearchExhaustive (默认) - 最优化但可能较慢
-            // OrtCudnnConvAlgoSearchHeuristic - 启发式搜索，较快但可能不是最优
-            // OrtCudnnConvAlgoSearchNone - 不搜索，最快但可能不是最优
-            
-            session_options.AppendExecutionProvider_CUDA(cuda_options);
-            spdlog::info("Using GPU for inference with CUDA provider");
+        if (use_global_thread_pools_) {
+            // 线程数由Env的全局线程池决定
+            session_options.DisablePerSessionThreads();
         } else {
-            // CPU inference - no additional providers needed
-            spdlog::info("Using CPU for inference");
+            session_options.SetIntraOpNumThreads(intra_op_threads_);
+            session_options.SetInterOpNumThreads(inter_op_threads_);
+            if (!intra_op_affinities_.empty()) {
+                session_options.AddConfigEntry("session.intra_op_thread_affinities", intra_op_affinities_.c_str());
+            }
         }
+        session_options.SetExecutionMode(execution_mode_ == "parallel" ? ORT_PARALLEL : ORT_SEQUENTIAL);
         
-        // Convert string to wide string for ONNX Runtime
-        std::wstring w_model_path(model_path.begin(), model_path.end());
+        // 内存选项：共享arena注册在Env上，extend strategy与初始块大小只作用于共享arena
+        if (cpu_mem_arena_) {
+            session_options.EnableCpuMemArena();
+            if (shared_arena_ &&
+                OrtResources::registerCpuArena(env_, arena_extend_strategy_, arena_initial_chunk_bytes_)) {
+                session_options.AddConfigEntry("session.use_env_allocators", "1");
+            }
+        } else {
+            session_options.DisableCpuMemArena();
+        }
+        if (mem_pattern_) {
+            session_options.EnableMemPattern();
+        } else {
+            session_options.DisableMemPattern();
+        }
+        
+        // 按优先级追加执行提供者，当前构建不支持或追加失败的提供者被跳过
+        active_providers_ = ExecutionProviders::append(session_options, providers);
+        std::string provider_names;
+        for (const auto& name : active_providers_) {
+            provider_names += (provider_names.empty() ? "" : " > ") + name;
+        }
+        spdlog::info("Using execution providers: {}", provider_names);
+        
+        // 优化后模型缓存：缓存存在且不旧于原模型时直接加载，跳过图优化；否则本次创建会话时写出缓存
+        // 缓存包含与执行提供者相关的融合算子，文件名中加入实际生效的提供者标签（model.xnnpack-cpu.onnx），
+        // 提供者列表或其选项改变后使用另一份缓存
+        std::filesystem::path load_path(model_path);
+        bool use_cached_model = false;
+        if (!optimized_model_path_.empty()) {
+            std::filesystem::path cache_path(optimized_model_path_);
+            std::string extension = cache_path.extension().string();
+            cache_path.replace_extension("." + ExecutionProviders::cacheTag(providers, active_providers_) + extension);
+            bool ort_format = extension == ".ort";
+            std::error_code ec;
+            if (std::filesystem::exists(cache_path, ec)) {
+                auto cache_time = std::filesystem::last_write_time(cache_path, ec);
+                auto source_time = std::filesystem::last_write_time(load_path, ec);
+                // 只部署了缓存（原模型不存在）时同样使用缓存
+                use_cached_model = ec || cache_time >= source_time;
+            }
+            if (use_cached_model) {
+                load_path = cache_path;
+                session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                if (ort_format) {
+                    session_options.AddConfigEntry("session.load_model_format", "ORT");
+                }
+                spdlog::info("Loading cached optimized model: {}", cache_path.string());
+            } else {
+                session_options.SetOptimizedModelFilePath(cache_path.c_str());
+                if (ort_format) {
+                    session_options.AddConfigEntry("session.save_model_format", "ORT");
+                }
+                spdlog::info("Optimized model will be saved to: {}", cache_path.string());
+            }
+        }
+        
+        // 同一模型的会话共享预打包权重，避免每个会话各保存一份
+        // 重新初始化时先释放旧会话，再释放其使用的容器和映射
+        io_binding_.reset();
+        if (session_) {
+            Telemetry::instance().addGauge(TelemetryGauge::Sessions, -1);
+        }
+        session_.reset();
+        prepacked_weights_.reset();
+        model_file_.close();
+        if (share_prepacked_weights_) {
+            prepacked_weights_ = OrtResources::prepackedWeights(load_path.string());
+        }
         
         // Create session
-        session_ = std::make_unique<Ort::Session>(*env_, w_model_path.c_str(), session_options);
+        // ORT在Windows上使用宽字符路径、在Linux上使用char路径，filesystem::path::c_str()与之一致
+        auto session_start = std::chrono::high_resolution_clock::now();
+        OrtPrepackedWeightsContainer* prepacked = nullptr;
+        if (prepacked_weights_) {
+            prepacked = *prepacked_weights_;
+        }
+        if (mmap_model_ && model_file_.open(load_path.string())) {
+            // ORT格式模型可直接引用映射的字节，ONNX格式在创建会话时解析后即可释放映射
+            bool ort_bytes = load_path.extension() == ".ort";
+            if (ort_bytes) {
+                session_options.AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+            }
+            session_ = std::make_unique<Ort::Session>(*env_, model_file_.data(), model_file_.size(),
+                                                      session_options, prepacked);
+            if (!ort_bytes) {
+                model_file_.close();
+            }
+        } else {
+            session_ = std::make_unique<Ort::Session>(*env_, load_path.c_str(), session_options, prepacked);
+        }
+        auto session_end = std::chrono::high_resolution_clock::now();
+        Telemetry::instance().addGauge(TelemetryGauge::Sessions, 1);
+        spdlog::info("Session created in {} ms{}",
+                     std::chrono::duration_cast<std::chrono::milliseconds>(session_end - session_start).count(),
+                     use_cached_model ? " (cached optimized model)" : "");
         
         // Get input and output information
         Ort::AllocatorWithDefaultOptions allocator;
@@ -112,8 +325,80 @@ bool ObjectDetector::initialize(const std::string& model_path) {
             output_node_names_[i] = output_name.get();
         }
         
+        // 名称指针只构建一次，detect中直接复用
+        input_names_cstr_.clear();
+        output_names_cstr_.clear();
+        for (const auto& name : input_node_names_) {
+            input_names_cstr_.push_back(name.c_str());
+        }
+        for (const auto& name : output_node_names_) {
+            output_names_cstr_.push_back(name.c_str());
+        }
+        
+        // 检查输入batch维度是否为动态（导出时使用dynamic=True时为-1）
+        std::vector<int64_t> input_shape = session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        dynamic_batch_ = !input_shape.empty() && input_shape[0] < 0;
+        
+        if (!resolveInputFormat()) {
+            return false;
+        }
+        
+        // minimal模式每次调用设置不同的H/W，模型输入的空间维度须为动态
+        if (minimal_letterbox_) {
+            size_t h_axis = input_format_ == InputFormat::Uint8Nhwc ? 1 : 2;
+            if (input_shape.size() != 4 || input_shape[h_axis] > 0 || input_shape[h_axis + 1] > 0) {
+                spdlog::error("Letterbox mode 'minimal' requires a model with dynamic input height/width; "
+                              "re-export with dynamic=True or use 'square'");
+                return false;
+            }
+        }
+        shape_states_.clear();
+        
         spdlog::info("Model loaded successfully. Input nodes: {}, Output nodes: {}", 
                             num_input_nodes, num_output_nodes);
+        spdlog::info("Dynamic batch: {}", dynamic_batch_ ? "yes" : "no");
+        
+        // 按输出签名选择后处理路径：[K, 6]为图内NMS的端到端模型
+        std::vector<int64_t> output_shape = session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        output_format_ = isEndToEndOutput(output_shape) ? OutputFormat::EndToEnd : OutputFormat::RawAnchors;
+        if (output_format_ == OutputFormat::EndToEnd) {
+            // 输出不含batch序号，detectBatch逐张处理
+            dynamic_batch_ = false;
+            spdlog::info("Postprocess: in-graph NMS (end-to-end [K, 6] output)");
+        } else {
+            spdlog::info("Postprocess: decode + NMS on raw output");
+        }
+        
+        // 输出[N, 4+C, anchors]的类别数与配置的类别名称数量不一致时给出提示
+        if (output_shape.size() == 3 && output_shape[1] > 4 &&
+            output_shape[1] - 4 != static_cast<int64_t>(class_names_.size())) {
+            spdlog::warn("Model outputs {} classes but {} class names are configured",
+                         output_shape[1] - 4, class_names_.size());
+        }
+        
+        // 单张输入缓冲区在初始化时一次分配，IoBinding绑定后地址不再变化
+        size_t image_tensor_size = static_cast<size_t>(3) * input_width_ * input_height_;
+        if (input_format_ == InputFormat::Uint8Nhwc) {
+            input_bytes_.assign(image_tensor_size, 0);
+            input_buffer_.clear();
+        } else {
+            input_buffer_.assign(image_tensor_size, 0.0f);
+            input_bytes_.clear();
+        }
+        io_binding_.reset();
+        if (use_io_binding_ && output_format_ == OutputFormat::EndToEnd) {
+            // 检测数量随图像变化，输出无法预分配
+            spdlog::info("IoBinding is not used with end-to-end models (dynamic output size)");
+        } else if (use_io_binding_ && minimal_letterbox_) {
+            // 输出的anchor数随输入形状变化，按形状在首次推理后绑定
+            spdlog::info("IoBinding: bound per input shape on first use");
+        } else if (use_io_binding_ && !setupIoBinding()) {
+            spdlog::warn("IoBinding setup failed, falling back to regular Run");
+        }
+        
+        if (warmup_runs_ > 0) {
+            warmup(warmup_runs_);
+        }
         
         return true;
     }
@@ -127,142 +412,294 @@ bool ObjectDetector::initialize(const std::string& model_path) {
     }
 }
 
-std::vector<DetectionResult> ObjectDetector::detect(const cv::Mat& image) {
-    std::vector<DetectionResult> results;
+bool ObjectDetector::resolveInputFormat() {
+    auto input_info = session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo();
+    bool uint8_model = input_info.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8;
     
-    auto start_time = std::chrono::high_resolution_clock::now();
+    if (input_format_name_ == "uint8_nhwc") {
+        input_format_ = InputFormat::Uint8Nhwc;
+    } else if (input_format_name_ == "float_nchw") {
+        input_format_ = InputFormat::Float32Nchw;
+    } else {
+        if (input_format_name_ != "auto") {
+            spdlog::warn("Unknown input format '{}', detecting from model input type", input_format_name_);
+        }
+        input_format_ = uint8_model ? InputFormat::Uint8Nhwc : InputFormat::Float32Nchw;
+    }
     
+    bool uint8_input = input_format_ == InputFormat::Uint8Nhwc;
+    if (uint8_input != uint8_model) {
+        spdlog::error("Input format {} does not match model input type ({}); use tools/fold_preprocess.py to "
+                      "build a uint8 model", uint8_input ? "uint8_nhwc" : "float_nchw",
+                      uint8_model ? "uint8" : "non-uint8");
+        return false;
+    }
+    
+    // NHWC输入的最后一维为通道数
+    std::vector<int64_t> input_shape = input_info.GetShape();
+    if (uint8_input && (input_shape.size() != 4 || input_shape[3] != 3)) {
+        spdlog::error("uint8 input must be [N,H,W,3], got rank {}", input_shape.size());
+        return false;
+    }
+    spdlog::info("Input format: {}", uint8_input ? "uint8 NHWC BGR (preprocessing in graph)" : "float32 NCHW RGB");
+    return true;
+}
+
+void* ObjectDetector::inputData() {
+    if (input_format_ == InputFormat::Uint8Nhwc) {
+        return input_bytes_.data();
+    }
+    return input_buffer_.data();
+}
+
+void ObjectDetector::preprocessImage(const cv::Mat& image, const cv::Size& input_size, void* dst) {
+    // minimal模式下每种形状使用各自的预处理器，插值表不会因形状交替而反复重建
+    LetterboxPreprocessor& preprocessor = minimal_letterbox_ ? shapeState(input_size).preprocessor : preprocessor_;
+    if (input_format_ == InputFormat::Uint8Nhwc) {
+        preprocessor.runBytes(image, input_size, static_cast<uchar*>(dst));
+    } else {
+        preprocessor.run(image, input_size, static_cast<float*>(dst));
+    }
+}
+
+Ort::Value ObjectDetector::createInputTensor(void* data, int64_t batch_size, const cv::Size& input_size) {
+    int64_t height = input_size.height;
+    int64_t width = input_size.width;
+    size_t tensor_size = static_cast<size_t>(3 * height * width * batch_size);
+    if (input_format_ == InputFormat::Uint8Nhwc) {
+        std::array<int64_t, 4> input_shape{ batch_size, height, width, 3 };
+        return Ort::Value::CreateTensor<uint8_t>(
+            memory_info_, static_cast<uint8_t*>(data), tensor_size, input_shape.data(), input_shape.size());
+    }
+    std::array<int64_t, 4> input_shape{ batch_size, 3, height, width };
+    return Ort::Value::CreateTensor<float>(
+        memory_info_, static_cast<float*>(data), tensor_size, input_shape.data(), input_shape.size());
+}
+
+bool ObjectDetector::setupIoBinding() {
     try {
-        spdlog::info("Starting detection on image ({}x{})", image.cols, image.rows);
+        // 输出形状中的动态batch按1处理，其余维度必须为静态才能预分配
+        output_shape_ = session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        if (output_shape_.size() != 3) {
+            spdlog::warn("Unexpected output rank {}, cannot preallocate output tensor", output_shape_.size());
+            return false;
+        }
+        if (!output_shape_.empty() && output_shape_[0] < 0) {
+            output_shape_[0] = 1;
+        }
+        size_t output_size = 1;
+        for (int64_t dim : output_shape_) {
+            if (dim <= 0) {
+                spdlog::warn("Output shape is not static, cannot preallocate output tensor");
+                return false;
+            }
+            output_size *= static_cast<size_t>(dim);
+        }
+        output_buffer_.assign(output_size, 0.0f);
         
-        // Letterbox preprocessing
-        cv::Mat letterbox_image = letterboxResize(image, cv::Size(input_width_, input_height_));
+        input_tensor_ = createInputTensor(inputData(), 1, getInputSize());
+        output_tensor_ = Ort::Value::CreateTensor<float>(
+            memory_info_, output_buffer_.data(), output_buffer_.size(), output_shape_.data(), output_shape_.size());
         
-        // Convert to blob
-        cv::Mat blob;
-        cv::dnn::blobFromImage(letterbox_image, blob, 1.0 / 255.0, cv::Size(),
-            cv::Scalar(0, 0, 0), true, false);
-
-        // Prepare input tensor
-        std::array<int64_t, 4> input_shape{ 1, 3, input_height_, input_width_ };
-        auto input_tensor = Ort::Value::CreateTensor<float>(
-            Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault),
-            (float*)blob.data, blob.total(), input_shape.data(), input_shape.size());
+        io_binding_ = std::make_unique<Ort::IoBinding>(*session_);
+        io_binding_->BindInput(input_names_cstr_[0], input_tensor_);
+        io_binding_->BindOutput(output_names_cstr_[0], output_tensor_);
+        
+        spdlog::info("IoBinding enabled with {} preallocated output floats", output_size);
+        return true;
+    }
+    catch (const Ort::Exception& e) {
+        spdlog::error("ONNX Runtime Exception during IoBinding setup: {}", e.what());
+        io_binding_.reset();
+        return false;
+    }
+}
 
-        // 🔧 转换 std::string -> const char*
-        std::vector<const char*> input_names_cstr;
-        std::vector<const char*> output_names_cstr;
-        for (const auto& name : input_node_names_) {
-            input_names_cstr.push_back(name.c_str());
+bool ObjectDetector::warmup(int runs) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    // 首次Run会触发内存规划、arena扩展以及GPU上的卷积算法搜索
+    std::fill(input_buffer_.begin(), input_buffer_.end(), 0.0f);
+    std::fill(input_bytes_.begin(), input_bytes_.end(), static_cast<uint8_t>(0));
+    std::vector<float> output;
+    std::vector<int64_t> output_shape;
+    // 预热耗时不计入延迟直方图
+    warming_up_ = true;
+    for (int i = 0; i < runs; ++i) {
+        bool ok = true;
+        if (io_binding_) {
+            session_->Run(run_options_, *io_binding_);
+        } else if (input_format_ == InputFormat::Uint8Nhwc) {
+            ok = infer(input_bytes_.data(), output, output_shape);
+        } else {
+            ok = infer(input_buffer_.data(), output, output_shape);
         }
-        for (const auto& name : output_node_names_) {
-            output_names_cstr.push_back(name.c_str());
+        if (!ok) {
+            spdlog::warn("Warm-up run {} failed", i);
+            warming_up_ = false;
+            return false;
         }
+    }
+    warming_up_ = false;
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    spdlog::info("Warm-up completed: {} runs in {} ms", runs,
+                 std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
+    return true;
+}
 
-        // 正确调用 Run
-        auto output_tensors = session_->Run(
-            Ort::RunOptions{ nullptr },
-            input_names_cstr.data(),
-            &input_tensor,
-            input_names_cstr.size(),
-            output_names_cstr.data(),
-            output_names_cstr.size()
-        );
-        
-        // Process output [1, 5, 13125]
-        float* raw_output = output_tensors.front().GetTensorMutableData<float>();
-        Ort::TensorTypeAndShapeInfo output_info = output_tensors.front().GetTensorTypeAndShapeInfo();
-        std::vector<int64_t> output_dims = output_info.GetShape();
-        
-        if (output_dims.size() != 3 || output_dims[0] != 1 || output_dims[1] != 5) {
-            spdlog::error("Output tensor format error! Expected [1, 5, N], got [{}, {}, {}]", 
-                                output_dims.size(), output_dims[0], output_dims[1]);
-            return results;
+bool ObjectDetector::selectProvider(const std::string& model_path, std::vector<ProviderSpec>& providers) {
+    // 影响各提供者相对速度的设置也计入指纹
+    std::string settings = std::to_string(input_width_) + "x" + std::to_string(input_height_) + "|" +
+        std::to_string(intra_op_threads_) + "|" + std::to_string(inter_op_threads_) + "|" + execution_mode_;
+    for (const auto& spec : providers) {
+        for (const auto& [key, value] : spec.options) {
+            settings += "|" + spec.name + "." + key + "=" + value;
         }
-        
-        int num_anchors = static_cast<int>(output_dims[2]);
-        // 使用配置文件中的类别数量，如果未设置则默认为1
-        int num_classes = static_cast<int>(class_names_.size());
-        if (num_classes == 0) {
-            num_classes = 1;  // 默认类别数
+    }
+    std::string fingerprint = ExecutionProviders::fingerprint(model_path, settings);
+    auto specFor = [&providers](const std::string& name) {
+        ProviderSpec spec{ name, {} };
+        for (const auto& configured : providers) {
+            if (configured.name == name) {
+                spec.options = configured.options;
+            }
         }
+        return spec;
+    };
+    
+    std::string chosen;
+    if (ExecutionProviders::lookupChoice(provider_cache_path_, fingerprint, chosen)) {
+        spdlog::info("Execution provider '{}' selected from cache (fingerprint {})", chosen, fingerprint);
+        providers = { specFor(chosen) };
+        return true;
+    }
+    
+    // 测量期间不写优化模型缓存（融合结果与提供者相关），也不执行配置的预热
+    std::vector<ProviderSpec> configured = providers_;
+    std::string optimized_model_path = optimized_model_path_;
+    int warmup_runs = warmup_runs_;
+    optimized_model_path_.clear();
+    warmup_runs_ = 0;
+    double best_ms = 0.0;
+    for (const auto& name : ExecutionProviders::available()) {
+        providers_ = { specFor(name) };
+        // 首次Run不计时；提供者追加失败时会话实际运行在CPU上，不作为该提供者的结果
+        if (!initialize(model_path) || active_providers_.front() != name || !warmup(1)) {
+            spdlog::warn("Execution provider '{}' cannot run the model, excluded from selection", name);
+            continue;
+        }
+        auto start_time = std::chrono::steady_clock::now();
+        if (!warmup(provider_probe_runs_)) {
+            continue;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count() /
+                    provider_probe_runs_;
+        spdlog::info("Execution provider '{}': {:.2f} ms per inference", name, ms);
+        if (chosen.empty() || ms < best_ms) {
+            chosen = name;
+            best_ms = ms;
+        }
+    }
+    providers_ = configured;
+    optimized_model_path_ = optimized_model_path;
+    warmup_runs_ = warmup_runs;
+    
+    if (chosen.empty()) {
+        spdlog::error("No execution provider could run {}", model_path);
+        return false;
+    }
+    spdlog::info("Selected execution provider '{}' ({:.2f} ms per inference)", chosen, best_ms);
+    ExecutionProviders::storeChoice(provider_cache_path_, fingerprint, chosen, best_ms);
+    providers = { specFor(chosen) };
+    return true;
+}
+
+void ObjectDetector::setTerminate(bool terminate) {
+    if (terminate) {
+        run_options_.SetTerminate();
+    } else {
+        run_options_.UnsetTerminate();
+    }
+}
+
+std::vector<DetectionResult> ObjectDetector::detect(const cv::Mat& image) {
+    std::vector<DetectionResult> results;
+    detect(image, results);
+    return results;
+}
+
+bool ObjectDetector::detect(const cv::Mat& image, std::vector<DetectionResult>& results) {
+    results.clear();
+    
+    Telemetry& telemetry = Telemetry::instance();
+    telemetry.addGauge(TelemetryGauge::InFlight, 1);
+    auto start_time = Telemetry::Clock::now();
+    
+    try {
+        spdlog::debug("Starting detection on image ({}x{})", image.cols, image.rows);
         
-        spdlog::debug("Processing {} anchors with {} classes", num_anchors, num_classes);
-        
-        std::vector<cv::Rect> boxes;
-        std::vector<float> confidences;
-        std::vector<int> class_ids;
-        
-        // 计算Letterbox的缩放比例和偏移量
-        float scale = std::min(static_cast<float>(input_width_) / image.cols, 
-                              static_cast<float>(input_height_) / image.rows);
-        cv::Size new_size(static_cast<int>(image.cols * scale), static_cast<float>(image.rows * scale));
-        int top = (input_height_ - new_size.height) / 2;
-        int left = (input_width_ - new_size.width) / 2;
+        // 融合预处理：letterbox + 归一化 + BGR->RGB + HWC->CHW 直接写入输入缓冲区
+        // uint8输入模式下只做letterbox，其余步骤由模型图完成
+        // minimal模式下输入尺寸随宽高比变化（如1920x1080 -> 640x384），输出的anchor数随之减少
+        cv::Size input_size = inputSizeFor(image.size());
+        preprocessImage(image, input_size, inputData());
+        auto stage_time = telemetry.recordSince(TelemetryStage::Preprocess, start_time);
         
-        // 计算坐标转换参数
-        float scale_x = static_cast<float>(image.cols) / new_size.width;
-        float scale_y = static_cast<float>(image.rows) / new_size.height;
+        const float* raw_output = nullptr;
+        // 绑定路径直接引用持久的输出形状，不逐帧复制
+        std::vector<int64_t> dynamic_dims;
+        const std::vector<int64_t>* output_dims = &dynamic_dims;
+        std::vector<Ort::Value> output_tensors;
+        ShapeState* shape = nullptr;
+        if (minimal_letterbox_ && use_io_binding_ && output_format_ == OutputFormat::RawAnchors) {
+            shape = &shapeState(input_size);
+        }
         
-        int valid_detections = 0;
-        for (int i = 0; i < num_anchors; ++i) {
-            float cx = raw_output[0 * num_anchors + i];
-            float cy = raw_output[1 * num_anchors + i];
-            float w = raw_output[2 * num_anchors + i];
-            float h = raw_output[3 * num_anchors + i];
+        if (io_binding_) {
+            // 输入输出已预先绑定到持久缓冲区，Run直接写入output_buffer_
+            session_->Run(run_options_, *io_binding_);
+            raw_output = output_buffer_.data();
+            output_dims = &output_shape_;
+        } else if (shape && shape->io_binding) {
+            // 该形状已绑定：与固定尺寸的IoBinding路径相同
+            session_->Run(run_options_, *shape->io_binding);
+            raw_output = shape->output_buffer.data();
+            output_dims = &shape->output_shape;
+        } else {
+            // Prepare input tensor
+            auto input_tensor = createInputTensor(inputData(), 1, input_size);
             
-            // Find maximum class confidence
-            float max_conf = -1.0f;
-            int best_class = -1;
-            for (int c = 0; c < num_classes; ++c) {
-                float score = raw_output[(4 + c) * num_anchors + i];
-                if (score > max_conf) {
-                    max_conf = score;
-                    best_class = c;
-                }
-            }
+            output_tensors = session_->Run(
+                run_options_,
+                input_names_cstr_.data(),
+                &input_tensor,
+                input_names_cstr_.size(),
+                output_names_cstr_.data(),
+                output_names_cstr_.size()
+            );
             
-            if (max_conf > confidence_threshold_ && best_class >= 0) {
-                // Convert to original image coordinates (考虑Letterbox偏移)
-                float x1 = ((cx - w * 0.5f) - left) * scale_x;
-                float y1 = ((cy - h * 0.5f) - top) * scale_y;
-                float x2 = ((cx + w * 0.5f) - left) * scale_x;
-                float y2 = ((cy + h * 0.5f) - top) * scale_y;
-                
-                // Clip to image boundaries
-                int left_clip = static_cast<int>(std::max(0.0f, x1));
-                int top_clip = static_cast<int>(std::max(0.0f, y1));
-                int right_clip = static_cast<int>(std::min(static_cast<float>(image.cols), x2));
-                int bottom_clip = static_cast<int>(std::min(static_cast<float>(image.rows), y2));
-                
-                if (right_clip > left_clip && bottom_clip > top_clip) {
-                    boxes.emplace_back(left_clip, top_clip, right_clip - left_clip, bottom_clip - top_clip);
-                    confidences.push_back(max_conf);
-                    class_ids.push_back(best_class);
-                    valid_detections++;
-                }
+            // 直接读取ORT输出内存：[1, 4+C, N]或端到端的[K, 6]
+            raw_output = output_tensors.front().GetTensorMutableData<float>();
+            dynamic_dims = output_tensors.front().GetTensorTypeAndShapeInfo().GetShape();
+            if (shape && !shape->binding_failed) {
+                bindShape(*shape, dynamic_dims);
             }
         }
+        telemetry.recordSince(TelemetryStage::Inference, stage_time);
         
-        spdlog::debug("Found {} valid detections before NMS", valid_detections);
-        
-        // Apply NMS
-        std::vector<int> indices = nmsBoxes(boxes, confidences);
-        
-        // Prepare final results
-        for (int idx : indices) {
-            DetectionResult result;
-            result.box = boxes[idx];
-            result.class_id = class_ids[idx];
-            result.confidence = confidences[idx];
-            results.push_back(result);
+        if (!postprocessOutput(raw_output, *output_dims, cv::Size(image.cols, image.rows), results)) {
+            telemetry.increment(TelemetryCounter::Errors);
+            telemetry.addGauge(TelemetryGauge::InFlight, -1);
+            return false;
         }
         
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-        
-        spdlog::info("Detection completed in {} ms. Found {} objects", duration.count(), results.size());
-        
+        // 每帧日志只在debug级别输出，info级别下不产生格式化与刷盘开销
+        auto end_time = telemetry.recordSince(TelemetryStage::Detect, start_time);
+        spdlog::debug("Detection completed in {:.3f} ms. Found {} objects",
+                      std::chrono::duration<double, std::milli>(end_time - start_time).count(), results.size());
+        telemetry.addGauge(TelemetryGauge::InFlight, -1);
+        return true;
     }
     catch (const Ort::Exception& e) {
         spdlog::error("ONNX Runtime Exception during inference: {}", e.what());
@@ -273,55 +710,346 @@ std::vector<DetectionResult> ObjectDetector::detect(const cv::Mat& image) {
     catch (const std::exception& e) {
         spdlog::error("Standard Exception during inference: {}", e.what());
     }
+    // 异常时可能已写入部分结果，失败的帧不返回任何检测框
+    results.clear();
+    telemetry.increment(TelemetryCounter::Errors);
+    telemetry.addGauge(TelemetryGauge::InFlight, -1);
+    return false;
+}
+
+bool ObjectDetector::detect(const LoadedImage& loaded, std::vector<DetectionResult>& results) {
+    if (!detect(loaded.image, results)) {
+        return false;
+    }
+    scaleResults(results, loaded.image.size(), loaded.original_size);
+    return true;
+}
+
+void ObjectDetector::scaleResults(std::vector<DetectionResult>& results, const cv::Size& from, const cv::Size& to) {
+    if (from == to || from.width <= 0 || from.height <= 0) {
+        return;
+    }
     
-    return results;
+    // 按框的两个角点缩放，避免宽高单独取整造成的累积误差
+    double scale_x = static_cast<double>(to.width) / from.width;
+    double scale_y = static_cast<double>(to.height) / from.height;
+    for (auto& result : results) {
+        int x1 = static_cast<int>(std::lround(result.box.x * scale_x));
+        int y1 = static_cast<int>(std::lround(result.box.y * scale_y));
+        int x2 = static_cast<int>(std::lround((result.box.x + result.box.width) * scale_x));
+        int y2 = static_cast<int>(std::lround((result.box.y + result.box.height) * scale_y));
+        x1 = std::clamp(x1, 0, to.width);
+        y1 = std::clamp(y1, 0, to.height);
+        x2 = std::clamp(x2, 0, to.width);
+        y2 = std::clamp(y2, 0, to.height);
+        result.box = cv::Rect(x1, y1, x2 - x1, y2 - y1);
+    }
 }
 
-std::vector<int> ObjectDetector::nmsBoxes(const std::vector<cv::Rect>& boxes, 
-                                         const std::vector<float>& confidences) {
-    std::vector<int> indices;
+bool ObjectDetector::infer(const float* input_tensor, std::vector<float>& output, std::vector<int64_t>& output_shape,
+                           const cv::Size& input_size) {
+    if (!session_) {
+        spdlog::error("Session is not initialized");
+        return false;
+    }
+    if (input_format_ != InputFormat::Float32Nchw) {
+        spdlog::error("Model expects uint8 NHWC input, got a float tensor");
+        return false;
+    }
+    auto input = createInputTensor(const_cast<float*>(input_tensor), 1,
+                                   input_size.area() > 0 ? input_size : getInputSize());
+    return runSingle(input, output, output_shape);
+}
+
+bool ObjectDetector::infer(const uint8_t* input_tensor, std::vector<float>& output, std::vector<int64_t>& output_shape,
+                           const cv::Size& input_size) {
+    if (!session_) {
+        spdlog::error("Session is not initialized");
+        return false;
+    }
+    if (input_format_ != InputFormat::Uint8Nhwc) {
+        spdlog::error("Model expects float NCHW input, got a uint8 tensor");
+        return false;
+    }
+    auto input = createInputTensor(const_cast<uint8_t*>(input_tensor), 1,
+                                   input_size.area() > 0 ? input_size : getInputSize());
+    return runSingle(input, output, output_shape);
+}
+
+bool ObjectDetector::runSingle(Ort::Value& input, std::vector<float>& output, std::vector<int64_t>& output_shape) {
+    try {
+        auto start_time = Telemetry::Clock::now();
+        auto output_tensors = session_->Run(
+            run_options_,
+            input_names_cstr_.data(),
+            &input,
+            input_names_cstr_.size(),
+            output_names_cstr_.data(),
+            output_names_cstr_.size()
+        );
+        
+        auto type_info = output_tensors.front().GetTensorTypeAndShapeInfo();
+        output_shape = type_info.GetShape();
+        bool raw_anchors = output_shape.size() == 3 && output_shape[0] == 1 && output_shape[1] >= 5;
+        if (!raw_anchors && !isEndToEndOutput(output_shape)) {
+            spdlog::error("Output tensor format error! Expected [1, 4+C, N] or [K, 6], got {} dims",
+                          output_shape.size());
+            return false;
+        }
+        
+        const float* raw_output = output_tensors.front().GetTensorData<float>();
+        output.assign(raw_output, raw_output + type_info.GetElementCount());
+        if (!warming_up_) {
+            Telemetry::instance().recordSince(TelemetryStage::Inference, start_time);
+        }
+        return true;
+    }
+    catch (const Ort::Exception& e) {
+        spdlog::error("ONNX Runtime Exception during inference: {}", e.what());
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Standard Exception during inference: {}", e.what());
+    }
+    Telemetry::instance().increment(TelemetryCounter::Errors);
+    return false;
+}
+
+std::vector<std::vector<DetectionResult>> ObjectDetector::detectBatch(const std::vector<cv::Mat>& images) {
+    std::vector<bool> succeeded;
+    return detectBatch(images, succeeded);
+}
+
+std::vector<std::vector<DetectionResult>> ObjectDetector::detectBatch(const std::vector<cv::Mat>& images,
+                                                                      std::vector<bool>& succeeded) {
+    std::vector<std::vector<DetectionResult>> batch_results(images.size());
+    succeeded.assign(images.size(), false);
+    if (images.empty()) {
+        return batch_results;
+    }
     
-    // Get candidates above confidence threshold
-    std::vector<int> candidates;
-    for (size_t i = 0; i < confidences.size(); ++i) {
-        if (confidences[i] >= confidence_threshold_) {
-            candidates.push_back(static_cast<int>(i));
+    // 模型batch维度固定时无法一次送入多张图像，退化为逐张检测
+    if (!dynamic_batch_ || max_batch_size_ <= 1) {
+        spdlog::debug("Model does not support dynamic batch, falling back to per-image detection");
+        for (size_t i = 0; i < images.size(); ++i) {
+            succeeded[i] = detect(images[i], batch_results[i]);
         }
+        return batch_results;
     }
     
-    // Sort by confidence
-    std::sort(candidates.begin(), candidates.end(),
-              [&confidences](int a, int b) {
-                  return confidences[a] > confidences[b];
-              });
+    Telemetry& telemetry = Telemetry::instance();
+    telemetry.addGauge(TelemetryGauge::InFlight, 1);
+    auto start_time = Telemetry::Clock::now();
     
-    // NMS
-    std::vector<bool> suppressed(candidates.size(), false);
-    for (size_t i = 0; i < candidates.size(); ++i) {
-        if (suppressed[i]) continue;
-        
-        int curr_idx = candidates[i];
-        indices.push_back(curr_idx);
+    try {
+        // 跳过空图像，其结果保持为空
+        std::vector<size_t> valid_indices;
+        valid_indices.reserve(images.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            if (images[i].empty()) {
+                spdlog::warn("Skipping empty image at batch index {}", i);
+                continue;
+            }
+            valid_indices.push_back(i);
+        }
         
-        for (size_t j = i + 1; j < candidates.size(); ++j) {
-            if (suppressed[j]) continue;
+        // 按max_batch_size_分块，每块执行一次Run
+        for (size_t begin = 0; begin < valid_indices.size(); begin += max_batch_size_) {
+            size_t end = std::min(valid_indices.size(), begin + static_cast<size_t>(max_batch_size_));
+            int batch_size = static_cast<int>(end - begin);
             
-            int next_idx = candidates[j];
-            cv::Rect intersection = boxes[curr_idx] & boxes[next_idx];
-            cv::Rect union_rect = boxes[curr_idx] | boxes[next_idx];
+            // minimal模式下一块内的图像共用各自所需尺寸的最大值，宽高比相近的图像几乎没有额外填充
+            cv::Size input_size = getInputSize();
+            if (minimal_letterbox_) {
+                input_size = cv::Size(0, 0);
+                for (int b = 0; b < batch_size; ++b) {
+                    cv::Size size = inputSizeFor(images[valid_indices[begin + b]].size());
+                    input_size.width = std::max(input_size.width, size.width);
+                    input_size.height = std::max(input_size.height, size.height);
+                }
+            }
             
-            float iou = 0.0f;
-            if (union_rect.area() > 0) {
-                iou = static_cast<float>(intersection.area()) / union_rect.area();
+            // 每张图像预处理后写入连续NCHW缓冲区中对应的切片
+            size_t image_tensor_size = static_cast<size_t>(3) * input_size.width * input_size.height;
+            size_t batch_tensor_size = image_tensor_size * batch_size;
+            bool uint8_input = input_format_ == InputFormat::Uint8Nhwc;
+            if (uint8_input && batch_input_bytes_.size() < batch_tensor_size) {
+                batch_input_bytes_.resize(batch_tensor_size);
+            } else if (!uint8_input && batch_input_buffer_.size() < batch_tensor_size) {
+                batch_input_buffer_.resize(batch_tensor_size);
+            }
+            auto stage_time = Telemetry::Clock::now();
+            for (int b = 0; b < batch_size; ++b) {
+                void* slice = uint8_input ? static_cast<void*>(batch_input_bytes_.data() + b * image_tensor_size)
+                                          : static_cast<void*>(batch_input_buffer_.data() + b * image_tensor_size);
+                preprocessImage(images[valid_indices[begin + b]], input_size, slice);
+                stage_time = telemetry.recordSince(TelemetryStage::Preprocess, stage_time);
             }
             
-            if (iou > nms_threshold_) {
-                suppressed[j] = true;
+            void* batch_data = uint8_input ? static_cast<void*>(batch_input_bytes_.data())
+                                           : static_cast<void*>(batch_input_buffer_.data());
+            auto input_tensor = createInputTensor(batch_data, batch_size, input_size);
+            
+            auto output_tensors = session_->Run(
+                run_options_,
+                input_names_cstr_.data(),
+                &input_tensor,
+                input_names_cstr_.size(),
+                output_names_cstr_.data(),
+                output_names_cstr_.size()
+            );
+            
+            // Process output [N, 4+C, anchors]
+            float* raw_output = output_tensors.front().GetTensorMutableData<float>();
+            std::vector<int64_t> output_dims = output_tensors.front().GetTensorTypeAndShapeInfo().GetShape();
+            
+            if (output_dims.size() != 3 || output_dims[0] != batch_size || output_dims[1] < 5) {
+                spdlog::error("Output tensor format error! Expected [{}, 4+C, N], got {} dims", 
+                                    batch_size, output_dims.size());
+                telemetry.increment(TelemetryCounter::Errors);
+                telemetry.addGauge(TelemetryGauge::InFlight, -1);
+                return batch_results;
             }
+            telemetry.recordSince(TelemetryStage::Inference, stage_time);
+            telemetry.increment(TelemetryCounter::Batches);
+            
+            // 每张图像使用各自的缩放比例和偏移量解码对应的输出切片
+            int num_classes = static_cast<int>(output_dims[1] - 4);
+            int num_anchors = static_cast<int>(output_dims[2]);
+            size_t slice_size = static_cast<size_t>(output_dims[1]) * num_anchors;
+            for (int b = 0; b < batch_size; ++b) {
+                const cv::Mat& image = images[valid_indices[begin + b]];
+                postprocess(raw_output + b * slice_size, num_classes, num_anchors, cv::Size(image.cols, image.rows),
+                            input_size, batch_results[valid_indices[begin + b]]);
+                succeeded[valid_indices[begin + b]] = true;
+            }
+        }
+        
+        auto end_time = telemetry.recordSince(TelemetryStage::Detect, start_time);
+        spdlog::debug("Batch detection completed in {:.3f} ms for {} images",
+                      std::chrono::duration<double, std::milli>(end_time - start_time).count(), images.size());
+    }
+    catch (const Ort::Exception& e) {
+        spdlog::error("ONNX Runtime Exception during batch inference: {}", e.what());
+        telemetry.increment(TelemetryCounter::Errors);
+    }
+    catch (const cv::Exception& e) {
+        spdlog::error("OpenCV Exception during batch inference: {}", e.what());
+        telemetry.increment(TelemetryCounter::Errors);
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Standard Exception during batch inference: {}", e.what());
+        telemetry.increment(TelemetryCounter::Errors);
+    }
+    
+    // 出错的分块可能已写入部分结果，失败的图像不返回任何检测框
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!succeeded[i]) {
+            batch_results[i].clear();
         }
     }
+    telemetry.addGauge(TelemetryGauge::InFlight, -1);
+    return batch_results;
+}
+
+bool ObjectDetector::postprocessOutput(const float* output, const std::vector<int64_t>& output_shape,
+                                       const cv::Size& image_size, std::vector<DetectionResult>& results) {
+    if (isEndToEndOutput(output_shape)) {
+        postprocessEndToEnd(output, static_cast<int>(output_shape[0]), image_size, results);
+        return true;
+    }
+    
+    // 输出为[1, 4+C, N]，类别数由输出通道数决定
+    if (output_shape.size() != 3 || output_shape[0] != 1 || output_shape[1] < 5) {
+        spdlog::error("Output tensor format error! Expected [1, 4+C, N] or [K, 6], got {} dims", output_shape.size());
+        results.clear();
+        return false;
+    }
+    postprocess(output, static_cast<int>(output_shape[1] - 4), static_cast<int>(output_shape[2]), image_size, results);
+    return true;
+}
+
+void ObjectDetector::postprocessEndToEnd(const float* detections, int count, const cv::Size& image_size,
+                                         std::vector<DetectionResult>& results) {
+    results.clear();
+    
+    boxes_.clear();
+    confidences_.clear();
+    class_ids_.clear();
+    
+    // NMS已在图内完成，这里只按配置的阈值筛选并映射回原图坐标（图内按分数降序输出）
+    Telemetry& telemetry = Telemetry::instance();
+    auto stage_time = Telemetry::Clock::now();
+    LetterboxInfo letterbox = LetterboxPreprocessor::computeLetterbox(image_size, inputSizeFor(image_size));
+    OutputDecoder::decodeDetections(detections, count, confidence_threshold_, letterbox, image_size,
+                                    boxes_, confidences_, class_ids_);
+    telemetry.recordSince(TelemetryStage::Decode, stage_time);
+    
+    size_t kept = boxes_.size();
+    if (nms_options_.max_detections > 0) {
+        kept = std::min(kept, static_cast<size_t>(nms_options_.max_detections));
+    }
+    for (size_t k = 0; k < kept; ++k) {
+        DetectionResult result;
+        result.box = boxes_[k];
+        result.class_id = class_ids_[k];
+        result.confidence = confidences_[k];
+        results.push_back(result);
+    }
+    telemetry.increment(TelemetryCounter::Frames);
+    telemetry.increment(TelemetryCounter::Candidates, static_cast<uint64_t>(count));
+    telemetry.increment(TelemetryCounter::Detections, results.size());
+}
+
+void ObjectDetector::postprocess(const float* raw_output, int num_classes, int num_anchors,
+                                 const cv::Size& image_size, std::vector<DetectionResult>& results) {
+    postprocess(raw_output, num_classes, num_anchors, image_size, inputSizeFor(image_size), results);
+}
+
+void ObjectDetector::postprocess(const float* raw_output, int num_classes, int num_anchors, const cv::Size& image_size,
+                                 const cv::Size& input_size, std::vector<DetectionResult>& results) {
+    results.clear();
+    
+    spdlog::debug("Processing {} anchors with {} classes", num_anchors, num_classes);
+    
+    // 复用成员缓冲区，预热后不再分配
+    std::vector<cv::Rect>& boxes = boxes_;
+    std::vector<float>& confidences = confidences_;
+    std::vector<int>& class_ids = class_ids_;
+    boxes.clear();
+    confidences.clear();
+    class_ids.clear();
+    
+    // 计算Letterbox的缩放比例和偏移量
+    LetterboxInfo letterbox = LetterboxPreprocessor::computeLetterbox(image_size, input_size);
+    
+    // SIMD筛选类别最大分数超过阈值的anchor，只对候选计算框坐标
+    Telemetry& telemetry = Telemetry::instance();
+    auto stage_time = Telemetry::Clock::now();
+    decoder_.decode(raw_output, num_classes, num_anchors, confidence_threshold_,
+                    letterbox, image_size, boxes, confidences, class_ids);
+    stage_time = telemetry.recordSince(TelemetryStage::Decode, stage_time);
     
-    return indices;
+    spdlog::debug("Found {} valid detections before NMS", boxes.size());
+    
+    // Apply NMS
+    nms_options_.iou_threshold = nms_threshold_;
+    nms_options_.score_threshold = confidence_threshold_;
+    nms_engine_.run(boxes, confidences, class_ids, nms_options_, nms_indices_);
+    telemetry.recordSince(TelemetryStage::Nms, stage_time);
+    telemetry.increment(TelemetryCounter::Frames);
+    telemetry.increment(TelemetryCounter::Candidates, boxes.size());
+    telemetry.increment(TelemetryCounter::Detections, nms_indices_.size());
+    
+    // Prepare final results（Soft-NMS下使用衰减后的分数）
+    const std::vector<float>& kept_scores = nms_engine_.keptScores();
+    for (size_t k = 0; k < nms_indices_.size(); ++k) {
+        int idx = nms_indices_[k];
+        DetectionResult result;
+        result.box = boxes[idx];
+        result.class_id = class_ids[idx];
+        result.confidence = kept_scores[k];
+        results.push_back(result);
+    }
 }
 
 void ObjectDetector::setConfidenceThreshold(float threshold) {
@@ -332,10 +1060,103 @@ void ObjectDetector::setNMSThreshold(float threshold) {
     nms_threshold_ = threshold;
 }
 
+void ObjectDetector::setInputSize(int width, int height) {
+    input_width_ = width;
+    input_height_ = height;
+}
+
+void ObjectDetector::setLetterboxMode(const std::string& mode, int stride) {
+    if (mode != "square" && mode != "minimal") {
+        spdlog::warn("Unknown letterbox mode '{}', using square", mode);
+    }
+    minimal_letterbox_ = mode == "minimal";
+    stride_ = std::max(1, stride);
+}
+
+cv::Size ObjectDetector::inputSizeFor(const cv::Size& image_size) const {
+    cv::Size max_size(input_width_, input_height_);
+    if (!minimal_letterbox_ || image_size.width <= 0 || image_size.height <= 0) {
+        return max_size;
+    }
+    
+    // 缩放比例与square模式相同；缩放后的宽高向上取整后对齐到stride，不超过配置的输入尺寸
+    float scale = std::min(static_cast<float>(input_width_) / image_size.width,
+                           static_cast<float>(input_height_) / image_size.height);
+    auto align = [this](float scaled, int limit) {
+        int value = std::max(1, static_cast<int>(std::ceil(scaled - 1e-3f)));
+        return std::min(limit, (value + stride_ - 1) / stride_ * stride_);
+    };
+    return cv::Size(align(image_size.width * scale, input_width_), align(image_size.height * scale, input_height_));
+}
+
+ObjectDetector::ShapeState& ObjectDetector::shapeState(const cv::Size& input_size) {
+    ++shape_clock_;
+    for (auto& state : shape_states_) {
+        if (state->input_size == input_size) {
+            state->last_used = shape_clock_;
+            return *state;
+        }
+    }
+    
+    // 常见的宽高比只有少数几种，超过上限时淘汰最久未使用的形状
+    constexpr size_t kMaxShapes = 8;
+    if (shape_states_.size() >= kMaxShapes) {
+        auto oldest = std::min_element(shape_states_.begin(), shape_states_.end(),
+                                       [](const auto& a, const auto& b) { return a->last_used < b->last_used; });
+        shape_states_.erase(oldest);
+    }
+    auto state = std::make_unique<ShapeState>();
+    state->input_size = input_size;
+    state->last_used = shape_clock_;
+    state->preprocessor.setNumThreads(preprocess_threads_);
+    shape_states_.push_back(std::move(state));
+    spdlog::debug("New input shape {}x{} ({} cached)", input_size.width, input_size.height, shape_states_.size());
+    return *shape_states_.back();
+}
+
+void ObjectDetector::bindShape(ShapeState& state, const std::vector<int64_t>& output_shape) {
+    size_t output_size = 1;
+    for (int64_t dim : output_shape) {
+        output_size *= static_cast<size_t>(std::max<int64_t>(dim, 0));
+    }
+    if (output_shape.size() != 3 || output_size == 0) {
+        state.binding_failed = true;
+        return;
+    }
+    
+    try {
+        // 输入绑定到同一个持久缓冲区，只是形状不同
+        state.output_shape = output_shape;
+        state.output_buffer.assign(output_size, 0.0f);
+        state.input_tensor = createInputTensor(inputData(), 1, state.input_size);
+        state.output_tensor = Ort::Value::CreateTensor<float>(
+            memory_info_, state.output_buffer.data(), state.output_buffer.size(),
+            state.output_shape.data(), state.output_shape.size());
+        state.io_binding = std::make_unique<Ort::IoBinding>(*session_);
+        state.io_binding->BindInput(input_names_cstr_[0], state.input_tensor);
+        state.io_binding->BindOutput(output_names_cstr_[0], state.output_tensor);
+        spdlog::debug("IoBinding bound for input {}x{} ({} output floats)",
+                      state.input_size.width, state.input_size.height, output_size);
+    }
+    catch (const Ort::Exception& e) {
+        spdlog::warn("IoBinding setup failed for input {}x{}: {}", state.input_size.width, state.input_size.height,
+                     e.what());
+        state.io_binding.reset();
+        state.binding_failed = true;
+    }
+}
+
+void ObjectDetector::setClassNames(const std::vector<std::string>& class_names) {
+    class_names_ = class_names;
+}
+
 void ObjectDetector::drawBoxes(cv::Mat& image, const std::vector<DetectionResult>& detections) {
     for (const auto& detection : detections) {
         cv::rectangle(image, detection.box, cv::Scalar(0, 255, 0), 2);
-        std::string label = cv::format("%s: %.2f", class_names_[detection.class_id].c_str(), detection.confidence);
+        // 模型类别数多于配置的类别名称时使用类别编号
+        std::string class_name = (detection.class_id >= 0 && detection.class_id < static_cast<int>(class_names_.size()))
+            ? class_names_[detection.class_id] : std::to_string(detection.class_id);
+        std::string label = cv::format("%s: %.2f", class_name.c_str(), detection.confidence);
         int baseline;
         cv::Size label_size = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseline);
         cv::Point top_left = cv::Point(detection.box.x, std::max(detection.box.y - label_size.height - 10, 0));
@@ -0,0 +1,215 @@
+#include "ObjectTracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 噪声标准差与框高的比例（与DeepSORT相同的取值）
+constexpr float kPositionStdWeight = 1.0f / 20.0f;
+constexpr float kVelocityStdWeight = 1.0f / 160.0f;
+
+float rectIoU(const cv::Rect& a, const cv::Rect& b) {
+    float inter = static_cast<float>((a & b).area());
+    float uni = static_cast<float>(a.area() + b.area()) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+} // namespace
+
+void ObjectTracker::Axis::init(float value, float position_std, float velocity_std) {
+    position = value;
+    velocity = 0.0f;
+    p00 = position_std * position_std;
+    p01 = p10 = 0.0f;
+    p11 = velocity_std * velocity_std;
+}
+
+void ObjectTracker::Axis::predict(float position_std, float velocity_std) {
+    // x = F x，P = F P F^T + Q，F = [1 1; 0 1]
+    position += velocity;
+    float n00 = p00 + p01 + p10 + p11;
+    float n01 = p01 + p11;
+    float n10 = p10 + p11;
+    p00 = n00 + position_std * position_std;
+    p01 = n01;
+    p10 = n10;
+    p11 += velocity_std * velocity_std;
+}
+
+void ObjectTracker::Axis::correct(float value, float measurement_std) {
+    // 观测只有位置：H = [1 0]
+    float innovation = value - position;
+    float s = p00 + measurement_std * measurement_std;
+    float k0 = p00 / s;
+    float k1 = p10 / s;
+    position += k0 * innovation;
+    velocity += k1 * innovation;
+    float n00 = (1.0f - k0) * p00;
+    float n01 = (1.0f - k0) * p01;
+    float n10 = p10 - k1 * p00;
+    float n11 = p11 - k1 * p01;
+    p00 = n00;
+    p01 = n01;
+    p10 = n10;
+    p11 = n11;
+}
+
+cv::Rect ObjectTracker::Track::box() const {
+    float width = std::max(1.0f, w.position);
+    float height = std::max(1.0f, h.position);
+    return cv::Rect(static_cast<int>(std::lround(cx.position - width / 2)),
+                    static_cast<int>(std::lround(cy.position - height / 2)),
+                    static_cast<int>(std::lround(width)), static_cast<int>(std::lround(height)));
+}
+
+ObjectTracker::ObjectTracker()
+    : next_id_(1) {}
+
+void ObjectTracker::reset() {
+    tracks_.clear();
+    next_id_ = 1;
+    last_update_ = TrackerUpdateStats();
+}
+
+float ObjectTracker::minConfidence() const {
+    float confidence = 1.0f;
+    for (const auto& track : tracks_) {
+        // 上个关键帧未匹配的轨迹不输出，其置信度不影响结果的可靠性
+        if (track.misses == 0) {
+            confidence = std::min(confidence, track.confidence);
+        }
+    }
+    return confidence;
+}
+
+void ObjectTracker::initTrack(Track& track, const DetectionResult& detection) {
+    const cv::Rect& box = detection.box;
+    float height = static_cast<float>(std::max(1, box.height));
+    float position_std = 2.0f * kPositionStdWeight * height;
+    float velocity_std = 10.0f * kVelocityStdWeight * height;
+    track.id = next_id_++;
+    track.class_id = detection.class_id;
+    track.confidence = detection.confidence;
+    track.misses = 0;
+    track.cx.init(box.x + box.width * 0.5f, position_std, velocity_std);
+    track.cy.init(box.y + box.height * 0.5f, position_std, velocity_std);
+    track.w.init(static_cast<float>(box.width), position_std, velocity_std);
+    track.h.init(height, position_std, velocity_std);
+}
+
+void ObjectTracker::predictTrack(Track& track) const {
+    float height = std::max(1.0f, track.h.position);
+    float position_std = kPositionStdWeight * height;
+    float velocity_std = kVelocityStdWeight * height;
+    track.cx.predict(position_std, velocity_std);
+    track.cy.predict(position_std, velocity_std);
+    track.w.predict(position_std, velocity_std);
+    track.h.predict(position_std, velocity_std);
+}
+
+void ObjectTracker::correctTrack(Track& track, const DetectionResult& detection) const {
+    const cv::Rect& box = detection.box;
+    float measurement_std = kPositionStdWeight * std::max(1.0f, track.h.position);
+    track.cx.correct(box.x + box.width * 0.5f, measurement_std);
+    track.cy.correct(box.y + box.height * 0.5f, measurement_std);
+    track.w.correct(static_cast<float>(box.width), measurement_std);
+    track.h.correct(static_cast<float>(box.height), measurement_std);
+    track.class_id = detection.class_id;
+    track.confidence = detection.confidence;
+    track.misses = 0;
+}
+
+void ObjectTracker::emit(const Track& track, std::vector<DetectionResult>& results) const {
+    DetectionResult result;
+    result.box = track.box();
+    result.class_id = track.class_id;
+    result.confidence = track.confidence;
+    result.track_id = track.id;
+    results.push_back(result);
+}
+
+void ObjectTracker::predict(std::vector<DetectionResult>& results) {
+    results.clear();
+    for (auto& track : tracks_) {
+        predictTrack(track);
+        track.confidence *= options_.confidence_decay;
+        // 上个关键帧未匹配的轨迹只保留状态，不再输出
+        if (track.misses == 0) {
+            emit(track, results);
+        }
+    }
+}
+
+void ObjectTracker::update(const std::vector<DetectionResult>& detections, std::vector<DetectionResult>& results) {
+    results.clear();
+    last_update_ = TrackerUpdateStats();
+    for (auto& track : tracks_) {
+        predictTrack(track);
+    }
+
+    // 所有IoU超过阈值的（轨迹, 检测）对按IoU降序贪心匹配
+    candidates_.clear();
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        cv::Rect predicted = tracks_[t].box();
+        for (size_t d = 0; d < detections.size(); ++d) {
+            if (options_.class_aware && detections[d].class_id != tracks_[t].class_id) {
+                continue;
+            }
+            float iou = rectIoU(predicted, detections[d].box);
+            if (iou >= options_.iou_threshold) {
+                candidates_.push_back({ iou, static_cast<int>(t), static_cast<int>(d) });
+            }
+        }
+    }
+    std::sort(candidates_.begin(), candidates_.end(), [](const Candidate& a, const Candidate& b) {
+        return a.iou > b.iou;
+    });
+    track_match_.assign(tracks_.size(), -1);
+    detection_match_.assign(detections.size(), -1);
+    for (const auto& candidate : candidates_) {
+        if (track_match_[candidate.track] < 0 && detection_match_[candidate.detection] < 0) {
+            track_match_[candidate.track] = candidate.detection;
+            detection_match_[candidate.detection] = candidate.track;
+        }
+    }
+
+    // 校正匹配的轨迹，未匹配的轨迹累计miss，超过max_age删除；
+    // 此后detection_match_改存每个检测所属轨迹的编号（删除轨迹前记录，不受压缩影响）
+    size_t kept = 0;
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        Track& track = tracks_[t];
+        if (track_match_[t] >= 0) {
+            correctTrack(track, detections[track_match_[t]]);
+            detection_match_[track_match_[t]] = track.id;
+            ++last_update_.matched;
+        } else {
+            ++track.misses;
+            ++last_update_.lost;
+            if (track.misses > options_.max_age) {
+                ++last_update_.removed;
+                continue;
+            }
+        }
+        if (kept != t) {
+            tracks_[kept] = track;
+        }
+        ++kept;
+    }
+    tracks_.resize(kept);
+
+    for (size_t d = 0; d < detections.size(); ++d) {
+        if (detection_match_[d] < 0) {
+            Track track;
+            initTrack(track, detections[d]);
+            detection_match_[d] = track.id;
+            tracks_.push_back(track);
+            ++last_update_.created;
+        }
+    }
+
+    // 关键帧输出检测框本身，附上所属轨迹的编号
+    results.assign(detections.begin(), detections.end());
+    for (size_t d = 0; d < results.size(); ++d) {
+        results[d].track_id = detection_match_[d];
+    }
+}
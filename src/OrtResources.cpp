@@ -0,0 +1,62 @@
+#include "OrtResources.h"
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <mutex>
+#include <spdlog/spdlog.h>
+
+namespace {
+
+std::mutex g_resources_mutex;
+std::map<std::string, std::weak_ptr<Ort::PrepackedWeightsContainer>> g_prepacked_weights;
+// 最近一次确认共享arena已注册时所用的Env。分配器注册在进程级的OrtEnv上，
+// 这个Env失效只说明它已释放，OrtEnv可能仍被其他Env持有，因此失效后要重新确认
+std::weak_ptr<Ort::Env> g_arena_env;
+
+} // namespace
+
+std::shared_ptr<Ort::PrepackedWeightsContainer> OrtResources::prepackedWeights(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(g_resources_mutex);
+    auto& entry = g_prepacked_weights[model_path];
+    std::shared_ptr<Ort::PrepackedWeightsContainer> container = entry.lock();
+    if (!container) {
+        container = std::make_shared<Ort::PrepackedWeightsContainer>();
+        entry = container;
+        spdlog::debug("Created prepacked weights container for {}", model_path);
+    }
+    return container;
+}
+
+bool OrtResources::registerCpuArena(const std::shared_ptr<Ort::Env>& env, const std::string& extend_strategy,
+                                    int64_t initial_chunk_bytes) {
+    std::lock_guard<std::mutex> lock(g_resources_mutex);
+    // OrtEnv是进程级单例，只要仍有Env存活，之前注册的分配器就依然有效
+    if (!g_arena_env.expired()) {
+        return true;
+    }
+
+    try {
+        // 0: kNextPowerOfTwo, 1: kSameAsRequested；-1 表示使用默认值
+        int strategy = extend_strategy == "same_as_requested" ? 1 : 0;
+        int initial_chunk = initial_chunk_bytes > 0
+            ? static_cast<int>(std::min<int64_t>(initial_chunk_bytes, INT_MAX)) : -1;
+        Ort::ArenaCfg arena_cfg(0, strategy, initial_chunk, -1);
+        Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        env->CreateAndRegisterAllocator(memory_info, arena_cfg);
+        g_arena_env = env;
+        spdlog::info("Registered shared CPU arena (extend strategy: {}, initial chunk: {} bytes)",
+                     strategy == 1 ? "same_as_requested" : "next_power_of_two",
+                     initial_chunk > 0 ? initial_chunk : 0);
+        return true;
+    }
+    catch (const Ort::Exception& e) {
+        // 之前的Env已释放但OrtEnv仍存活时，分配器还在，ORT以"already been registered"拒绝重复注册
+        if (std::string(e.what()).find("already") != std::string::npos) {
+            g_arena_env = env;
+            spdlog::debug("Shared CPU arena already registered on the process-wide OrtEnv");
+            return true;
+        }
+        spdlog::error("Failed to register shared CPU arena: {}", e.what());
+        return false;
+    }
+}
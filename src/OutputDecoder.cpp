@@ -0,0 +1,240 @@
+#include "OutputDecoder.h"
+#include "SimdDispatch.h"
+#include <algorithm>
+
+#if defined(YOLO_SIMD_SSE41)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#if defined(YOLO_SIMD_AVX2)
+// 向量部分，候选追加到out_*并累加count，返回已处理的anchor数
+template <int kClasses>
+YOLO_TARGET_AVX2 int selectCandidatesAvx2(const float* scores, int runtime_classes, int num_anchors, float threshold,
+                                          int* out_indices, float* out_scores, int* out_classes, int& count) {
+    const int num_classes = kClasses > 0 ? kClasses : runtime_classes;
+    int i = 0;
+    const __m256 vthreshold = _mm256_set1_ps(threshold);
+    alignas(32) float max_lanes[8];
+    alignas(32) float class_lanes[8];
+    for (; i + 8 <= num_anchors; i += 8) {
+        __m256 vmax = _mm256_loadu_ps(scores + i);
+        __m256 vclass = _mm256_setzero_ps();
+        for (int c = 1; c < num_classes; ++c) {
+            __m256 v = _mm256_loadu_ps(scores + static_cast<size_t>(c) * num_anchors + i);
+            __m256 greater = _mm256_cmp_ps(v, vmax, _CMP_GT_OQ);
+            vmax = _mm256_blendv_ps(vmax, v, greater);
+            vclass = _mm256_blendv_ps(vclass, _mm256_set1_ps(static_cast<float>(c)), greater);
+        }
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(vmax, vthreshold, _CMP_GT_OQ));
+        if (mask == 0) {
+            continue;
+        }
+        _mm256_store_ps(max_lanes, vmax);
+        _mm256_store_ps(class_lanes, vclass);
+        for (int lane = 0; lane < 8; ++lane) {
+            if (mask & (1 << lane)) {
+                out_indices[count] = i + lane;
+                out_scores[count] = max_lanes[lane];
+                out_classes[count] = static_cast<int>(class_lanes[lane]);
+                ++count;
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+#if defined(YOLO_SIMD_SSE41)
+template <int kClasses>
+YOLO_TARGET_SSE41 int selectCandidatesSse41(const float* scores, int runtime_classes, int num_anchors, float threshold,
+                                            int* out_indices, float* out_scores, int* out_classes, int& count) {
+    const int num_classes = kClasses > 0 ? kClasses : runtime_classes;
+    int i = 0;
+    const __m128 vthreshold = _mm_set1_ps(threshold);
+    alignas(16) float max_lanes[4];
+    alignas(16) float class_lanes[4];
+    for (; i + 4 <= num_anchors; i += 4) {
+        __m128 vmax = _mm_loadu_ps(scores + i);
+        __m128 vclass = _mm_setzero_ps();
+        for (int c = 1; c < num_classes; ++c) {
+            __m128 v = _mm_loadu_ps(scores + static_cast<size_t>(c) * num_anchors + i);
+            __m128 greater = _mm_cmpgt_ps(v, vmax);
+            vmax = _mm_blendv_ps(vmax, v, greater);
+            vclass = _mm_blendv_ps(vclass, _mm_set1_ps(static_cast<float>(c)), greater);
+        }
+        int mask = _mm_movemask_ps(_mm_cmpgt_ps(vmax, vthreshold));
+        if (mask == 0) {
+            continue;
+        }
+        _mm_store_ps(max_lanes, vmax);
+        _mm_store_ps(class_lanes, vclass);
+        for (int lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) {
+                out_indices[count] = i + lane;
+                out_scores[count] = max_lanes[lane];
+                out_classes[count] = static_cast<int>(class_lanes[lane]);
+                ++count;
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+// 逐anchor求类别最大值并筛选，kClasses为0时使用运行时类别数
+template <int kClasses>
+int selectCandidatesImpl(const float* scores, int runtime_classes, int num_anchors, float threshold,
+                         int* out_indices, float* out_scores, int* out_classes) {
+    const int num_classes = kClasses > 0 ? kClasses : runtime_classes;
+    int count = 0;
+    int i = 0;
+
+    switch (SimdDispatch::level()) {
+#if defined(YOLO_SIMD_AVX2)
+    case SimdLevel::Avx2:
+        i = selectCandidatesAvx2<kClasses>(scores, num_classes, num_anchors, threshold,
+                                           out_indices, out_scores, out_classes, count);
+        break;
+#endif
+#if defined(YOLO_SIMD_SSE41)
+    case SimdLevel::Sse41:
+        i = selectCandidatesSse41<kClasses>(scores, num_classes, num_anchors, threshold,
+                                            out_indices, out_scores, out_classes, count);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    // 标量尾部（无SIMD时处理全部anchor）
+    for (; i < num_anchors; ++i) {
+        float max_score = scores[i];
+        int best_class = 0;
+        for (int c = 1; c < num_classes; ++c) {
+            float score = scores[static_cast<size_t>(c) * num_anchors + i];
+            if (score > max_score) {
+                max_score = score;
+                best_class = c;
+            }
+        }
+        if (max_score > threshold) {
+            out_indices[count] = i;
+            out_scores[count] = max_score;
+            out_classes[count] = best_class;
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+} // namespace
+
+int OutputDecoder::selectCandidates(const float* output, int num_classes, int num_anchors, float threshold) {
+    if (num_classes <= 0 || num_anchors <= 0) {
+        return 0;
+    }
+    if (static_cast<int>(indices_.size()) < num_anchors) {
+        indices_.resize(num_anchors);
+        scores_.resize(num_anchors);
+        classes_.resize(num_anchors);
+    }
+
+    // 分数通道从第4个通道开始
+    const float* scores = output + static_cast<size_t>(4) * num_anchors;
+    switch (num_classes) {
+    case 1:
+        return selectCandidatesImpl<1>(scores, num_classes, num_anchors, threshold,
+                                       indices_.data(), scores_.data(), classes_.data());
+    case 80:
+        return selectCandidatesImpl<80>(scores, num_classes, num_anchors, threshold,
+                                        indices_.data(), scores_.data(), classes_.data());
+    default:
+        return selectCandidatesImpl<0>(scores, num_classes, num_anchors, threshold,
+                                       indices_.data(), scores_.data(), classes_.data());
+    }
+}
+
+void OutputDecoder::decode(const float* output, int num_classes, int num_anchors, float threshold,
+                           const LetterboxInfo& letterbox, const cv::Size& image_size,
+                           std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                           std::vector<int>& class_ids) {
+    int count = selectCandidates(output, num_classes, num_anchors, threshold);
+
+    // 计算坐标转换参数
+    const float scale_x = static_cast<float>(image_size.width) / letterbox.new_width;
+    const float scale_y = static_cast<float>(image_size.height) / letterbox.new_height;
+    const float left = static_cast<float>(letterbox.left);
+    const float top = static_cast<float>(letterbox.top);
+    const float max_x = static_cast<float>(image_size.width);
+    const float max_y = static_cast<float>(image_size.height);
+
+    const float* cx_row = output;
+    const float* cy_row = output + num_anchors;
+    const float* w_row = output + static_cast<size_t>(2) * num_anchors;
+    const float* h_row = output + static_cast<size_t>(3) * num_anchors;
+
+    // 只对通过阈值的anchor计算框坐标
+    for (int k = 0; k < count; ++k) {
+        int i = indices_[k];
+        float cx = cx_row[i];
+        float cy = cy_row[i];
+        float w = w_row[i];
+        float h = h_row[i];
+
+        // Convert to original image coordinates (考虑Letterbox偏移)
+        float x1 = ((cx - w * 0.5f) - left) * scale_x;
+        float y1 = ((cy - h * 0.5f) - top) * scale_y;
+        float x2 = ((cx + w * 0.5f) - left) * scale_x;
+        float y2 = ((cy + h * 0.5f) - top) * scale_y;
+
+        // Clip to image boundaries
+        int left_clip = static_cast<int>(std::max(0.0f, x1));
+        int top_clip = static_cast<int>(std::max(0.0f, y1));
+        int right_clip = static_cast<int>(std::min(max_x, x2));
+        int bottom_clip = static_cast<int>(std::min(max_y, y2));
+
+        if (right_clip > left_clip && bottom_clip > top_clip) {
+            boxes.emplace_back(left_clip, top_clip, right_clip - left_clip, bottom_clip - top_clip);
+            confidences.push_back(scores_[k]);
+            class_ids.push_back(classes_[k]);
+        }
+    }
+}
+
+void OutputDecoder::decodeDetections(const float* detections, int count, float threshold,
+                                     const LetterboxInfo& letterbox, const cv::Size& image_size,
+                                     std::vector<cv::Rect>& boxes, std::vector<float>& confidences,
+                                     std::vector<int>& class_ids) {
+    // 与decode相同的坐标转换与裁剪
+    const float scale_x = static_cast<float>(image_size.width) / letterbox.new_width;
+    const float scale_y = static_cast<float>(image_size.height) / letterbox.new_height;
+    const float left = static_cast<float>(letterbox.left);
+    const float top = static_cast<float>(letterbox.top);
+    const float max_x = static_cast<float>(image_size.width);
+    const float max_y = static_cast<float>(image_size.height);
+
+    for (int k = 0; k < count; ++k) {
+        const float* row = detections + static_cast<size_t>(k) * 6;
+        if (!(row[4] > threshold)) {
+            continue;
+        }
+        float x1 = (row[0] - left) * scale_x;
+        float y1 = (row[1] - top) * scale_y;
+        float x2 = (row[2] - left) * scale_x;
+        float y2 = (row[3] - top) * scale_y;
+
+        int left_clip = static_cast<int>(std::max(0.0f, x1));
+        int top_clip = static_cast<int>(std::max(0.0f, y1));
+        int right_clip = static_cast<int>(std::min(max_x, x2));
+        int bottom_clip = static_cast<int>(std::min(max_y, y2));
+
+        if (right_clip > left_clip && bottom_clip > top_clip) {
+            boxes.emplace_back(left_clip, top_clip, right_clip - left_clip, bottom_clip - top_clip);
+            confidences.push_back(row[4]);
+            class_ids.push_back(static_cast<int>(row[5]));
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#include "ResultWriter.h"
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+bool ResultWriter::parseFormat(const std::string& name, Format& format) {
+    if (name == "jsonl" || name == "json") {
+        format = Format::JsonLines;
+        return true;
+    }
+    if (name == "csv") {
+        format = Format::Csv;
+        return true;
+    }
+    return false;
+}
+
+bool ResultWriter::open(const std::string& path, Format format, const std::vector<std::string>& class_names) {
+    close();
+    format_ = format;
+    class_names_ = class_names;
+
+    if (path.empty() || path == "-") {
+        out_ = &std::cout;
+    } else {
+        file_.open(path, std::ios::out | std::ios::trunc);
+        if (!file_.is_open()) {
+            spdlog::error("Cannot open output file: {}", path);
+            return false;
+        }
+        out_ = &file_;
+    }
+
+    if (format_ == Format::Csv) {
+        *out_ << "index,source,width,height,ok,class_id,class_name,confidence,x,y,w,h\n";
+    }
+    return true;
+}
+
+void ResultWriter::write(const FrameInfo& info, const std::vector<DetectionResult>& detections) {
+    if (!out_) {
+        return;
+    }
+
+    if (format_ == Format::JsonLines) {
+        nlohmann::json line;
+        line["index"] = info.index;
+        if (!info.source.empty()) {
+            line["source"] = info.source;
+        }
+        line["width"] = info.image_size.width;
+        line["height"] = info.image_size.height;
+        line["ok"] = info.valid;
+        line["latency_ms"] = info.latency_ms;
+        nlohmann::json objects = nlohmann::json::array();
+        for (const auto& detection : detections) {
+            nlohmann::json object = {
+                { "class_id", detection.class_id },
+                { "class_name", className(detection.class_id) },
+                { "confidence", detection.confidence },
+                { "box", { detection.box.x, detection.box.y, detection.box.width, detection.box.height } }
+            };
+            if (detection.track_id >= 0) {
+                object["track_id"] = detection.track_id;
+            }
+            objects.push_back(std::move(object));
+        }
+        line["detections"] = std::move(objects);
+        *out_ << line.dump() << '\n';
+        return;
+    }
+
+    // CSV每个检测框一行；没有检测框（或失败）的帧输出一行空检测，以便区分“已处理”
+    std::string prefix = std::to_string(info.index) + "," + csvEscape(info.source) + "," +
+                         std::to_string(info.image_size.width) + "," + std::to_string(info.image_size.height) + "," +
+                         (info.valid ? "1" : "0") + ",";
+    if (detections.empty()) {
+        *out_ << prefix << ",,,,,,\n";
+        return;
+    }
+    for (const auto& detection : detections) {
+        *out_ << prefix << detection.class_id << "," << csvEscape(className(detection.class_id)) << ","
+              << detection.confidence << "," << detection.box.x << "," << detection.box.y << ","
+              << detection.box.width << "," << detection.box.height << "\n";
+    }
+}
+
+void ResultWriter::close() {
+    if (out_) {
+        out_->flush();
+    }
+    if (file_.is_open()) {
+        file_.close();
+    }
+    out_ = nullptr;
+}
+
+std::string ResultWriter::className(int class_id) const {
+    if (class_id >= 0 && class_id < static_cast<int>(class_names_.size())) {
+        return class_names_[class_id];
+    }
+    return std::to_string(class_id);
+}
+
+std::string ResultWriter::csvEscape(const std::string& value) {
+    if (value.find_first_of(",\"\n\r") == std::string::npos) {
+        return value;
+    }
+    std::string escaped = "\"";
+    for (char c : value) {
+        if (c == '"') {
+            escaped += '"';
+        }
+        escaped += c;
+    }
+    escaped += '"';
+    return escaped;
+}
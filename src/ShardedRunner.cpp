@@ -0,0 +1,289 @@
+#include "ShardedRunner.h"
+#include <algorithm>
+
+ShardedRunner::ShardedRunner()
+    : next_id_(1)
+    , in_flight_(0)
+    , running_(false) {}
+
+ShardedRunner::~ShardedRunner() {
+    stop();
+}
+
+bool ShardedRunner::initialize(JsonConfigManager& config_manager) {
+    stop();
+    config_ = config_manager.getShardConfig();
+    config_.queue_capacity = std::max(1, config_.queue_capacity);
+    if (config_.group_by != "node" && config_.group_by != "cores") {
+        spdlog::warn("Unknown shard grouping '{}', using node", config_.group_by);
+        config_.group_by = "node";
+    }
+    if (config_.balance != "least_outstanding" && config_.balance != "stream_affinity") {
+        spdlog::warn("Unknown shard balancing '{}', using least_outstanding", config_.balance);
+        config_.balance = "least_outstanding";
+    }
+
+    std::vector<CoreGroup> nodes = NumaTopology::discover();
+    for (const CoreGroup& node : nodes) {
+        spdlog::info("NUMA node {}: CPUs {}", node.node, NumaTopology::formatCpuList(node.cpus));
+    }
+    int cores_per_group = 0;
+    if (config_.group_by == "cores") {
+        cores_per_group = config_.cores_per_instance > 0
+            ? config_.cores_per_instance : std::max(1, config_manager.getModelConfig().intra_op_threads);
+    }
+    std::vector<CoreGroup> groups = NumaTopology::split(nodes, cores_per_group);
+
+    // 实例数受限时按节点轮流取核组，使实例均匀分布在各节点上
+    if (config_.max_instances > 0 && static_cast<int>(groups.size()) > config_.max_instances) {
+        std::vector<CoreGroup> interleaved;
+        for (size_t round = 0; interleaved.size() < groups.size(); ++round) {
+            for (const CoreGroup& node : nodes) {
+                std::vector<const CoreGroup*> node_groups;
+                for (const CoreGroup& group : groups) {
+                    if (group.node == node.node) {
+                        node_groups.push_back(&group);
+                    }
+                }
+                if (round < node_groups.size()) {
+                    interleaved.push_back(*node_groups[round]);
+                }
+            }
+        }
+        interleaved.resize(config_.max_instances);
+        groups = interleaved;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+        in_flight_ = 0;
+    }
+    // 配置了优化模型缓存时，第一个实例初始化完成（缓存已写完）后再启动其余实例：
+    // 冷缓存时多个会话同时写同一个文件，之后的启动会加载到不完整的缓存
+    bool serialize_first = !config_manager.getModelConfig().optimized_model_path.empty();
+    bool all_ready = true;
+    std::vector<std::future<bool>> ready;
+    for (const CoreGroup& group : groups) {
+        auto shard = std::make_unique<Shard>();
+        shard->group = group;
+        std::promise<bool> promise;
+        std::future<bool> future = promise.get_future();
+        shard->worker = std::thread(&ShardedRunner::workerLoop, this, std::ref(*shard), config_manager,
+                                    std::move(promise));
+        shards_.push_back(std::move(shard));
+        if (serialize_first && shards_.size() == 1) {
+            all_ready = future.get();
+            if (!all_ready) {
+                break;
+            }
+        } else {
+            ready.push_back(std::move(future));
+        }
+    }
+
+    for (auto& future : ready) {
+        all_ready = future.get() && all_ready;
+    }
+    if (!all_ready) {
+        spdlog::error("Failed to initialize all shard instances");
+        stop();
+        return false;
+    }
+
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        const Shard& shard = *shards_[i];
+        spdlog::info("Shard {}: node {}, CPUs {} ({} intra-op threads{})", i, shard.group.node,
+                     NumaTopology::formatCpuList(shard.group.cpus), shard.group.cpus.size(),
+                     shard.pinned ? ", pinned" : config_.pin_threads ? ", pinning unavailable" : "");
+    }
+    spdlog::info("Sharded runner: {} instances on {} NUMA node(s), {} balancing, queue capacity {}",
+                 shards_.size(), nodes.size(), config_.balance, config_.queue_capacity);
+    return true;
+}
+
+uint64_t ShardedRunner::submit(const cv::Mat& image, Callback callback, int64_t stream_id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool affinity = config_.balance == "stream_affinity" && stream_id >= 0;
+    int index = -1;
+    auto has_space = [&]() {
+        if (!running_ || shards_.empty()) {
+            return true;
+        }
+        if (affinity) {
+            // 新的流分配给当前负载最少的实例，之后一直留在该实例上
+            auto it = stream_shards_.find(stream_id);
+            if (it == stream_shards_.end()) {
+                it = stream_shards_.emplace(stream_id, leastOutstanding()).first;
+            }
+            index = it->second;
+        } else {
+            index = leastOutstanding();
+        }
+        return shards_[index]->outstanding < static_cast<size_t>(config_.queue_capacity);
+    };
+    space_ready_.wait(lock, has_space);
+
+    if (!running_ || index < 0) {
+        lock.unlock();
+        if (callback) {
+            std::vector<DetectionResult> empty;
+            callback(0, AsyncStatus::Failed, empty);
+        }
+        return 0;
+    }
+
+    Shard& shard = *shards_[index];
+    Request request;
+    request.id = next_id_++;
+    request.image = image;
+    request.callback = std::move(callback);
+    uint64_t id = request.id;
+    shard.queue.push_back(std::move(request));
+    ++shard.outstanding;
+    ++in_flight_;
+    lock.unlock();
+    shard.work_ready.notify_one();
+    return id;
+}
+
+std::future<std::vector<DetectionResult>> ShardedRunner::detectAsync(const cv::Mat& image, int64_t stream_id) {
+    auto promise = std::make_shared<std::promise<std::vector<DetectionResult>>>();
+    std::future<std::vector<DetectionResult>> future = promise->get_future();
+    submit(image, [promise](uint64_t, AsyncStatus status, std::vector<DetectionResult>& results) {
+        if (status == AsyncStatus::Completed) {
+            promise->set_value(std::move(results));
+        } else {
+            promise->set_exception(std::make_exception_ptr(AsyncDetectError(status)));
+        }
+    }, stream_id);
+    return future;
+}
+
+std::vector<DetectionResult> ShardedRunner::detect(const cv::Mat& image, int64_t stream_id) {
+    return detectAsync(image, stream_id).get();
+}
+
+void ShardedRunner::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_ready_.wait(lock, [this]() { return in_flight_ == 0; });
+}
+
+void ShardedRunner::stop() {
+    if (shards_.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    // 已入队的帧由各实例执行完后工作线程退出
+    for (auto& shard : shards_) {
+        shard->work_ready.notify_all();
+    }
+    space_ready_.notify_all();
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) {
+            shard->worker.join();
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    shards_.clear();
+    stream_shards_.clear();
+}
+
+std::vector<ShardStats> ShardedRunner::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ShardStats> stats;
+    for (const auto& shard : shards_) {
+        ShardStats shard_stats;
+        shard_stats.node = shard->group.node;
+        shard_stats.cpus = shard->group.cpus;
+        shard_stats.pinned = shard->pinned;
+        shard_stats.completed = shard->completed;
+        shard_stats.failed = shard->failed;
+        shard_stats.outstanding = shard->outstanding;
+        stats.push_back(shard_stats);
+    }
+    return stats;
+}
+
+int ShardedRunner::leastOutstanding() const {
+    int best = 0;
+    for (int i = 1; i < static_cast<int>(shards_.size()); ++i) {
+        if (shards_[i]->outstanding < shards_[best]->outstanding) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void ShardedRunner::workerLoop(Shard& shard, JsonConfigManager config_manager, std::promise<bool> ready) {
+    const std::vector<int>& cpus = shard.group.cpus;
+    // 调用Run的线程本身也执行算子内计算，绑定到核组的第一个CPU；其余CPU各分配一个算子内线程
+    bool pinned = config_.pin_threads && NumaTopology::pinCurrentThread({ cpus.front() });
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shard.pinned = pinned;
+    }
+
+    // 每个实例独立的线程池与内存：不共享arena与预打包权重，否则它们只会分配在首个初始化的节点上
+    ModelConfig model_config = config_manager.getModelConfig();
+    model_config.intra_op_threads = static_cast<int>(cpus.size());
+    model_config.inter_op_threads = 1;
+    model_config.execution_mode = "sequential";
+    model_config.shared_arena = false;
+    model_config.share_prepacked_weights = false;
+    // OpenCV的全局线程池不属于任何核组，预处理在实例线程上串行执行
+    model_config.preprocess_threads = 1;
+    config_manager.setModelConfig(model_config);
+
+    // 检测器在绑定后的线程上创建并初始化，权重与张量由本节点的CPU首次写入
+    auto detector = std::make_unique<ObjectDetector>();
+    if (pinned && cpus.size() > 1) {
+        // ORT的亲和性字符串中逻辑处理器编号从1开始
+        std::string affinities;
+        for (size_t i = 1; i < cpus.size(); ++i) {
+            affinities += (i > 1 ? ";" : "") + std::to_string(cpus[i] + 1);
+        }
+        detector->setThreadAffinity(affinities);
+    }
+    bool initialized = detector->initialize(config_manager);
+    ready.set_value(initialized);
+    if (!initialized) {
+        return;
+    }
+
+    std::vector<DetectionResult> results;
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            shard.work_ready.wait(lock, [&]() { return !running_ || !shard.queue.empty(); });
+            if (shard.queue.empty()) {
+                return;
+            }
+            request = std::move(shard.queue.front());
+            shard.queue.pop_front();
+        }
+
+        // 推理出错的帧以Failed回调，与AsyncDetector一致
+        bool ok = detector->detect(request.image, results);
+        // 回调返回后才释放名额：回调中持有的图像与结果同样计入在途上限
+        if (request.callback) {
+            request.callback(request.id, ok ? AsyncStatus::Completed : AsyncStatus::Failed, results);
+        }
+        request.image.release();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --shard.outstanding;
+            --in_flight_;
+            if (ok) {
+                ++shard.completed;
+            } else {
+                ++shard.failed;
+            }
+        }
+        space_ready_.notify_all();
+    }
+}
@@ -0,0 +1,399 @@
+#include "SharedRing.h"
+#include <chrono>
+#include <new>
+#include <thread>
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 共享内存中的原子变量必须是无锁的，否则不同进程各自的锁无法互斥
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "SharedRing requires lock-free 32/64-bit atomics");
+
+namespace {
+
+constexpr uint32_t kRingMagic = 0x474E4952;  // "RING"
+constexpr uint32_t kRingVersion = 1;
+constexpr size_t kCacheLine = 64;
+
+enum SlotState : uint32_t {
+    kEmpty = 0,
+    kWriting = 1,
+    kReady = 2,
+    kReading = 3
+};
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// 先自旋让出CPU，等待较久后改为短暂休眠，避免空转占满一个核
+class Backoff {
+public:
+    explicit Backoff(int timeout_ms)
+        : deadline_(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms))
+        , infinite_(timeout_ms < 0) {}
+
+    // 返回false表示已超时
+    bool wait() {
+        if (++spins_ < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        return infinite_ || std::chrono::steady_clock::now() < deadline_;
+    }
+
+private:
+    std::chrono::steady_clock::time_point deadline_;
+    bool infinite_;
+    int spins_ = 0;
+};
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+struct SharedRing::RingHeader {
+    std::atomic<uint32_t> magic;        // 创建方初始化完成后最后写入
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t overflow;
+    uint64_t slot_bytes;
+    uint64_t slot_stride;
+    alignas(kCacheLine) std::atomic<uint64_t> write_seq;  // 下一个发布的序号（仅生产方写）
+    alignas(kCacheLine) std::atomic<uint64_t> consumed;   // 消费方归还的槽位数（仅消费方写）
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint32_t> closed;
+};
+
+SharedRing::~SharedRing() {
+    close();
+}
+
+bool SharedRing::create(const std::string& name, int slot_count, size_t slot_bytes, RingOverflow overflow) {
+    close();
+    if (slot_count < 2 || slot_bytes == 0) {
+        spdlog::error("Shared ring '{}' needs at least 2 slots of non-zero size", name);
+        return false;
+    }
+
+    size_t header_size = alignUp(sizeof(RingHeader), kCacheLine);
+    size_t slot_stride = alignUp(sizeof(SlotHeader), kCacheLine) + alignUp(slot_bytes, kCacheLine);
+    if (!map(name, header_size + slot_stride * static_cast<size_t>(slot_count), true)) {
+        return false;
+    }
+    slot_stride_ = slot_stride;
+
+    header_ = new (base_) RingHeader();
+    header_->version = kRingVersion;
+    header_->slot_count = static_cast<uint32_t>(slot_count);
+    header_->overflow = static_cast<uint32_t>(overflow);
+    header_->slot_bytes = slot_bytes;
+    header_->slot_stride = slot_stride;
+    header_->write_seq.store(0);
+    header_->consumed.store(0);
+    header_->dropped.store(0);
+    header_->closed.store(0);
+    for (int i = 0; i < slot_count; ++i) {
+        SlotHeader* slot = new (slotHeader(i)) SlotHeader();
+        slot->state.store(kEmpty);
+        slot->sequence.store(0);
+    }
+    header_->magic.store(kRingMagic, std::memory_order_release);
+    unlink_name_ = name;
+    return true;
+}
+
+bool SharedRing::open(const std::string& name) {
+    close();
+    if (!map(name, 0, false)) {
+        return false;
+    }
+    header_ = reinterpret_cast<RingHeader*>(base_);
+    if (header_->magic.load(std::memory_order_acquire) != kRingMagic || header_->version != kRingVersion) {
+        spdlog::error("Shared memory '{}' is not an initialized frame ring", name);
+        close();
+        return false;
+    }
+    // 槽位尺寸取自共享内存中的头部，须与实际映射的大小一致，否则槽位可能越过映射末尾
+    size_t header_size = alignUp(sizeof(RingHeader), kCacheLine);
+    size_t slot_stride = static_cast<size_t>(header_->slot_stride);
+    size_t slot_count = header_->slot_count;
+    if (mapped_size_ < header_size || slot_count < 2 || header_->slot_bytes == 0 ||
+        slot_stride < alignUp(sizeof(SlotHeader), kCacheLine) + header_->slot_bytes ||
+        slot_stride > (mapped_size_ - header_size) / slot_count) {
+        spdlog::error("Shared memory '{}' has an inconsistent ring layout", name);
+        close();
+        return false;
+    }
+    slot_stride_ = slot_stride;
+    return true;
+}
+
+bool SharedRing::map(const std::string& name, size_t size, bool create) {
+#ifdef _WIN32
+    std::wstring mapping_name = L"Local\\" + std::wstring(name.begin(), name.end());
+    HANDLE mapping = nullptr;
+    if (create) {
+        uint64_t size64 = size;
+        mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                     static_cast<DWORD>(size64 & 0xFFFFFFFFu), mapping_name.c_str());
+    } else {
+        mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, mapping_name.c_str());
+    }
+    if (mapping == nullptr) {
+        spdlog::error("Cannot {} shared memory '{}'", create ? "create" : "open", name);
+        return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, create ? size : 0);
+    if (data == nullptr) {
+        spdlog::error("MapViewOfFile failed for shared memory '{}'", name);
+        CloseHandle(mapping);
+        return false;
+    }
+    if (!create) {
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(data, &info, sizeof(info));
+        size = info.RegionSize;
+    }
+    mapping_handle_ = mapping;
+#else
+    std::string shm_name = "/" + name;
+    int fd = -1;
+    if (create) {
+        // 上次异常退出遗留的同名区域直接替换
+        shm_unlink(shm_name.c_str());
+        fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd >= 0 && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            shm_unlink(shm_name.c_str());
+            fd = -1;
+        }
+    } else {
+        fd = shm_open(shm_name.c_str(), O_RDWR, 0600);
+        struct stat shm_stat;
+        if (fd >= 0 && fstat(fd, &shm_stat) == 0) {
+            size = static_cast<size_t>(shm_stat.st_size);
+        }
+    }
+    if (fd < 0 || size < sizeof(RingHeader)) {
+        spdlog::error("Cannot {} shared memory '{}'", create ? "create" : "open", name);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // 映射建立后描述符不再需要
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        spdlog::error("mmap failed for shared memory '{}'", name);
+        if (create) {
+            shm_unlink(shm_name.c_str());
+        }
+        return false;
+    }
+#endif
+    base_ = static_cast<uint8_t*>(data);
+    mapped_size_ = size;
+    return true;
+}
+
+void SharedRing::close() {
+    if (base_) {
+#ifdef _WIN32
+        UnmapViewOfFile(base_);
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+        mapping_handle_ = nullptr;
+#else
+        munmap(base_, mapped_size_);
+        if (!unlink_name_.empty()) {
+            shm_unlink(("/" + unlink_name_).c_str());
+        }
+#endif
+    }
+    header_ = nullptr;
+    base_ = nullptr;
+    mapped_size_ = 0;
+    slot_stride_ = 0;
+    read_cursor_ = 0;
+    unlink_name_.clear();
+}
+
+SharedRing::SlotHeader* SharedRing::slotHeader(int index) const {
+    size_t header_size = alignUp(sizeof(RingHeader), kCacheLine);
+    return reinterpret_cast<SlotHeader*>(base_ + header_size + slot_stride_ * static_cast<size_t>(index));
+}
+
+bool SharedRing::acquireWrite(Slot& slot, int timeout_ms) {
+    if (!header_) {
+        return false;
+    }
+    const int slot_count = static_cast<int>(header_->slot_count);
+    const bool overwrite = header_->overflow == static_cast<uint32_t>(RingOverflow::OverwriteOldest);
+
+    Backoff backoff(timeout_ms);
+    while (true) {
+        // 优先使用空槽位；覆盖模式下没有空槽位时取序号最小（最早）的未读槽位。
+        // 消费方正在读取的槽位不会被选中，因此消费方慢时生产方也不会被阻塞
+        int oldest_ready = -1;
+        uint64_t oldest_sequence = 0;
+        for (int i = 0; i < slot_count; ++i) {
+            SlotHeader* candidate = slotHeader(i);
+            uint32_t state = candidate->state.load(std::memory_order_acquire);
+            if (state == kEmpty) {
+                uint32_t expected = kEmpty;
+                if (candidate->state.compare_exchange_strong(expected, kWriting, std::memory_order_acquire)) {
+                    fillSlot(slot, i, header_->write_seq.load(std::memory_order_relaxed));
+                    return true;
+                }
+            } else if (state == kReady) {
+                uint64_t sequence = candidate->sequence.load(std::memory_order_relaxed);
+                if (oldest_ready < 0 || sequence < oldest_sequence) {
+                    oldest_ready = i;
+                    oldest_sequence = sequence;
+                }
+            }
+        }
+        if (overwrite && oldest_ready >= 0) {
+            uint32_t expected = kReady;
+            SlotHeader* victim = slotHeader(oldest_ready);
+            if (victim->state.compare_exchange_strong(expected, kWriting, std::memory_order_acquire)) {
+                header_->dropped.fetch_add(1, std::memory_order_relaxed);
+                fillSlot(slot, oldest_ready, header_->write_seq.load(std::memory_order_relaxed));
+                return true;
+            }
+            // 消费方刚好取走了该槽位，重新扫描
+            continue;
+        }
+        if (!backoff.wait()) {
+            return false;
+        }
+    }
+}
+
+void SharedRing::publish(Slot& slot) {
+    if (!slot.valid()) {
+        return;
+    }
+    slot.header->sequence.store(slot.sequence, std::memory_order_relaxed);
+    slot.header->timestamp_us = nowMicros();
+    slot.header->state.store(kReady, std::memory_order_release);
+    header_->write_seq.store(slot.sequence + 1, std::memory_order_release);
+    slot = Slot();
+}
+
+bool SharedRing::acquireRead(Slot& slot, int timeout_ms) {
+    if (!header_) {
+        return false;
+    }
+    const int slot_count = static_cast<int>(header_->slot_count);
+    Backoff backoff(timeout_ms);
+    while (true) {
+        // 先读closed再读write_seq：closed之前发布的槽位都在write_seq之下
+        bool closed = header_->closed.load(std::memory_order_acquire) != 0;
+        // 扫描不是快照：扫描期间生产方可能把k发布到已扫描过的槽位、把k+1发布到之后的槽位。
+        // 因此只考虑扫描开始前已发布的序号[read_cursor_, write_seq)——它们在扫描时都已是Ready，
+        // 扫描中找不到的只可能已被覆盖（丢弃），其中最小的序号就是按发布顺序的下一帧
+        uint64_t published = header_->write_seq.load(std::memory_order_acquire);
+        int oldest = -1;
+        uint64_t oldest_sequence = 0;
+        for (int i = 0; i < slot_count; ++i) {
+            SlotHeader* candidate = slotHeader(i);
+            if (candidate->state.load(std::memory_order_acquire) != kReady) {
+                continue;
+            }
+            uint64_t sequence = candidate->sequence.load(std::memory_order_relaxed);
+            if (sequence < read_cursor_ || sequence >= published) {
+                continue;
+            }
+            if (oldest < 0 || sequence < oldest_sequence) {
+                oldest = i;
+                oldest_sequence = sequence;
+            }
+        }
+        if (oldest >= 0) {
+            uint32_t expected = kReady;
+            SlotHeader* candidate = slotHeader(oldest);
+            if (candidate->state.compare_exchange_strong(expected, kReading, std::memory_order_acquire)) {
+                if (candidate->sequence.load(std::memory_order_relaxed) == oldest_sequence) {
+                    read_cursor_ = oldest_sequence + 1;
+                    fillSlot(slot, oldest, oldest_sequence);
+                    return true;
+                }
+                // 扫描之后该槽位已被覆盖为更新的帧，其他槽位中可能还有更早的，放回后重新扫描
+                candidate->state.store(kReady, std::memory_order_release);
+            }
+            // 被覆盖模式的生产方抢先取走，重新扫描
+            continue;
+        }
+        // 扫描期间有新发布的帧：立即重新扫描
+        if (header_->write_seq.load(std::memory_order_acquire) != published) {
+            continue;
+        }
+        if (closed || !backoff.wait()) {
+            return false;
+        }
+    }
+}
+
+void SharedRing::release(Slot& slot) {
+    if (!slot.valid()) {
+        return;
+    }
+    header_->consumed.fetch_add(1, std::memory_order_relaxed);
+    slot.header->state.store(kEmpty, std::memory_order_release);
+    slot = Slot();
+}
+
+void SharedRing::fillSlot(Slot& slot, int index, uint64_t sequence) const {
+    SlotHeader* slot_header = slotHeader(index);
+    slot.header = slot_header;
+    slot.data = reinterpret_cast<uint8_t*>(slot_header) + alignUp(sizeof(SlotHeader), kCacheLine);
+    slot.capacity = static_cast<size_t>(header_->slot_bytes);
+    slot.sequence = sequence;
+    slot.index = index;
+}
+
+void SharedRing::markClosed() {
+    if (header_) {
+        header_->closed.store(1, std::memory_order_release);
+    }
+}
+
+bool SharedRing::closed() const {
+    return header_ && header_->closed.load(std::memory_order_acquire) != 0;
+}
+
+int SharedRing::slotCount() const {
+    return header_ ? static_cast<int>(header_->slot_count) : 0;
+}
+
+size_t SharedRing::slotBytes() const {
+    return header_ ? static_cast<size_t>(header_->slot_bytes) : 0;
+}
+
+RingOverflow SharedRing::overflow() const {
+    return header_ ? static_cast<RingOverflow>(header_->overflow) : RingOverflow::Block;
+}
+
+RingStats SharedRing::getStats() const {
+    RingStats stats;
+    if (header_) {
+        stats.written = header_->write_seq.load(std::memory_order_relaxed);
+        stats.read = header_->consumed.load(std::memory_order_relaxed);
+        stats.dropped = header_->dropped.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
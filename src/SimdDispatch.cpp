@@ -0,0 +1,74 @@
+#include "SimdDispatch.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(YOLO_SIMD_SSE41) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+SimdLevel detectLevel() {
+#if defined(YOLO_SIMD_SSE41)
+    bool sse41 = false;
+    bool avx2 = false;
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    sse41 = (info[2] & (1 << 19)) != 0;
+    // AVX2还要求操作系统保存YMM寄存器（OSXSAVE且XCR0的SSE/AVX状态位均已开启）
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    if (max_leaf >= 7 && fma && os_avx) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    // __builtin_cpu_supports同样检查操作系统是否开启了AVX状态
+    __builtin_cpu_init();
+    sse41 = __builtin_cpu_supports("sse4.1");
+    avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#if defined(YOLO_SIMD_AVX2)
+    if (avx2) {
+        return SimdLevel::Avx2;
+    }
+#else
+    (void)avx2;
+#endif
+    return sse41 ? SimdLevel::Sse41 : SimdLevel::Scalar;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+std::atomic<int> g_max_level{ static_cast<int>(SimdLevel::Avx2) };
+
+} // namespace
+
+SimdLevel SimdDispatch::detected() {
+    static const SimdLevel level = detectLevel();
+    return level;
+}
+
+SimdLevel SimdDispatch::level() {
+    return static_cast<SimdLevel>((std::min)(static_cast<int>(detected()), g_max_level.load(std::memory_order_relaxed)));
+}
+
+void SimdDispatch::setMaxLevel(SimdLevel level) {
+    g_max_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+const char* SimdDispatch::name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Sse41:
+        return "sse4.1";
+    default:
+        return "scalar";
+    }
+}
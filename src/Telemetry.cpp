@@ -0,0 +1,424 @@
+#include "Telemetry.h"
+#include "JsonConfigManager.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using SocketHandle = SOCKET;
+static const SocketHandle kInvalidSocket = INVALID_SOCKET;
+static void closeSocket(SocketHandle s) { closesocket(s); }
+static const int kSendFlags = 0;
+// 抓取方停止接收时单次send的最长阻塞时间
+static void setSendTimeout(SocketHandle s, int timeout_ms) {
+    DWORD timeout = static_cast<DWORD>(timeout_ms);
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using SocketHandle = int;
+static const SocketHandle kInvalidSocket = -1;
+static void closeSocket(SocketHandle s) { ::close(s); }
+// 抓取方中途断开时send返回错误而不是触发SIGPIPE终止进程
+#ifdef MSG_NOSIGNAL
+static const int kSendFlags = MSG_NOSIGNAL;
+#else
+static const int kSendFlags = 0;
+#endif
+// 抓取方停止接收时单次send的最长阻塞时间
+static void setSendTimeout(SocketHandle s, int timeout_ms) {
+    timeval timeout{ timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+    int flag = 1;
+    setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &flag, sizeof(flag));
+#endif
+}
+#endif
+
+double HistogramSnapshot::bucketUpperBoundMs(int bucket) {
+    if (bucket >= kNumBuckets - 1) {
+        return INFINITY;
+    }
+    return 0.01 * static_cast<double>(1ULL << bucket);
+}
+
+double HistogramSnapshot::quantileMs(double q) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    double target = std::clamp(q, 0.0, 1.0) * count;
+    uint64_t cumulative = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+        if (buckets[i] == 0) {
+            continue;
+        }
+        if (cumulative + buckets[i] >= target) {
+            double lower = i == 0 ? 0.0 : bucketUpperBoundMs(i - 1);
+            // 溢出桶没有上界，返回其下界
+            if (i == kNumBuckets - 1) {
+                return lower;
+            }
+            double fraction = (target - cumulative) / buckets[i];
+            return lower + (bucketUpperBoundMs(i) - lower) * fraction;
+        }
+        cumulative += buckets[i];
+    }
+    return bucketUpperBoundMs(kNumBuckets - 2);
+}
+
+void LatencyHistogram::record(int64_t nanoseconds) {
+    uint64_t ns = nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0;
+    // 桶i覆盖(10us * 2^(i-1), 10us * 2^i]：对ceil(ns / 10us) - 1求最高位位置
+    uint64_t units = (ns + 9999) / 10000;
+    int bucket = 0;
+    for (uint64_t v = units > 0 ? units - 1 : 0; v != 0; v >>= 1) {
+        ++bucket;
+    }
+    bucket = std::min(bucket, HistogramSnapshot::kNumBuckets - 1);
+
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    // 各字段分别读取，并发写入时快照内部可能有极小的不一致，对监控用途可以接受
+    HistogramSnapshot snapshot;
+    for (int i = 0; i < HistogramSnapshot::kNumBuckets; ++i) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum_ms = sum_ns_.load(std::memory_order_relaxed) / 1e6;
+    return snapshot;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_ns_.store(0, std::memory_order_relaxed);
+}
+
+Telemetry& Telemetry::instance() {
+    static Telemetry telemetry;
+    return telemetry;
+}
+
+Telemetry::~Telemetry() {
+    stopExporter();
+}
+
+void Telemetry::recordLatency(TelemetryStage stage, int64_t nanoseconds) {
+    if (!enabled()) {
+        return;
+    }
+    histograms_[static_cast<size_t>(stage)].record(nanoseconds);
+}
+
+Telemetry::Clock::time_point Telemetry::recordSince(TelemetryStage stage, Clock::time_point start) {
+    Clock::time_point now = Clock::now();
+    recordLatency(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+    return now;
+}
+
+void Telemetry::increment(TelemetryCounter counter, uint64_t value) {
+    if (!enabled()) {
+        return;
+    }
+    counters_[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void Telemetry::addGauge(TelemetryGauge gauge, int64_t delta) {
+    // 仪表记录的是当前状态，关闭指标时也保持增减配对
+    gauges_[static_cast<size_t>(gauge)].fetch_add(delta, std::memory_order_relaxed);
+}
+
+TelemetrySnapshot Telemetry::snapshot() const {
+    TelemetrySnapshot snapshot;
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        snapshot.stages[i] = histograms_[i].snapshot();
+    }
+    for (size_t i = 0; i < counters_.size(); ++i) {
+        snapshot.counters[i] = counters_[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < gauges_.size(); ++i) {
+        snapshot.gauges[i] = gauges_[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void Telemetry::reset() {
+    for (auto& histogram : histograms_) {
+        histogram.reset();
+    }
+    for (auto& counter : counters_) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* Telemetry::stageName(TelemetryStage stage) {
+    switch (stage) {
+    case TelemetryStage::Preprocess: return "preprocess";
+    case TelemetryStage::Inference: return "inference";
+    case TelemetryStage::Decode: return "decode";
+    case TelemetryStage::Nms: return "nms";
+    case TelemetryStage::Detect: return "detect";
+    default: return "unknown";
+    }
+}
+
+const char* Telemetry::counterName(TelemetryCounter counter) {
+    switch (counter) {
+    case TelemetryCounter::Frames: return "frames";
+    case TelemetryCounter::Batches: return "batches";
+    case TelemetryCounter::Candidates: return "candidates";
+    case TelemetryCounter::Detections: return "detections";
+    case TelemetryCounter::Errors: return "errors";
+    default: return "unknown";
+    }
+}
+
+const char* Telemetry::gaugeName(TelemetryGauge gauge) {
+    switch (gauge) {
+    case TelemetryGauge::InFlight: return "in_flight";
+    case TelemetryGauge::Sessions: return "sessions";
+    default: return "unknown";
+    }
+}
+
+std::string Telemetry::toPrometheus() const {
+    TelemetrySnapshot snapshot = this->snapshot();
+    std::ostringstream out;
+    out.precision(9);
+
+    out << "# HELP yolo_stage_latency_seconds Per-stage latency of the detector hot path.\n";
+    out << "# TYPE yolo_stage_latency_seconds histogram\n";
+    for (size_t s = 0; s < snapshot.stages.size(); ++s) {
+        const HistogramSnapshot& histogram = snapshot.stages[s];
+        const char* stage = stageName(static_cast<TelemetryStage>(s));
+        uint64_t cumulative = 0;
+        for (int i = 0; i < HistogramSnapshot::kNumBuckets; ++i) {
+            cumulative += histogram.buckets[i];
+            out << "yolo_stage_latency_seconds_bucket{stage=\"" << stage << "\",le=\"";
+            if (i == HistogramSnapshot::kNumBuckets - 1) {
+                out << "+Inf";
+            } else {
+                out << HistogramSnapshot::bucketUpperBoundMs(i) / 1000.0;
+            }
+            out << "\"} " << cumulative << "\n";
+        }
+        out << "yolo_stage_latency_seconds_sum{stage=\"" << stage << "\"} " << histogram.sum_ms / 1000.0 << "\n";
+        out << "yolo_stage_latency_seconds_count{stage=\"" << stage << "\"} " << histogram.count << "\n";
+    }
+
+    for (size_t c = 0; c < snapshot.counters.size(); ++c) {
+        const char* name = counterName(static_cast<TelemetryCounter>(c));
+        out << "# TYPE yolo_" << name << "_total counter\n";
+        out << "yolo_" << name << "_total " << snapshot.counters[c] << "\n";
+    }
+    for (size_t g = 0; g < snapshot.gauges.size(); ++g) {
+        const char* name = gaugeName(static_cast<TelemetryGauge>(g));
+        out << "# TYPE yolo_" << name << " gauge\n";
+        out << "yolo_" << name << " " << snapshot.gauges[g] << "\n";
+    }
+    return out.str();
+}
+
+bool Telemetry::writePrometheusFile(const std::string& path) const {
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::trunc);
+        if (!file.is_open()) {
+            spdlog::warn("Cannot write telemetry file: {}", tmp_path);
+            return false;
+        }
+        file << toPrometheus();
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        spdlog::warn("Cannot replace telemetry file {}: {}", path, ec.message());
+        return false;
+    }
+    return true;
+}
+
+void Telemetry::logSummary() const {
+    TelemetrySnapshot snapshot = this->snapshot();
+    for (size_t s = 0; s < snapshot.stages.size(); ++s) {
+        const HistogramSnapshot& histogram = snapshot.stages[s];
+        if (histogram.count == 0) {
+            continue;
+        }
+        spdlog::info("  {:<12} n={} mean={:.3f} ms p50={:.3f} ms p99={:.3f} ms",
+                     stageName(static_cast<TelemetryStage>(s)), histogram.count, histogram.meanMs(),
+                     histogram.quantileMs(0.50), histogram.quantileMs(0.99));
+    }
+    spdlog::info("  frames={} batches={} candidates={} detections={} errors={}",
+                 snapshot.counter(TelemetryCounter::Frames), snapshot.counter(TelemetryCounter::Batches),
+                 snapshot.counter(TelemetryCounter::Candidates), snapshot.counter(TelemetryCounter::Detections),
+                 snapshot.counter(TelemetryCounter::Errors));
+}
+
+bool Telemetry::startExporter(const TelemetryConfig& config) {
+    stopExporter();
+    setEnabled(config.enabled);
+    if (!config.enabled) {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(exporter_mutex_);
+        stop_exporter_ = false;
+    }
+
+    // 先建立监听套接字：端点无法建立时直接返回false，不留下已启动的导出线程
+    SocketHandle listen_socket = kInvalidSocket;
+    if (config.prometheus_port > 0) {
+#ifdef _WIN32
+        WSADATA wsa_data;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+            spdlog::error("Telemetry: WSAStartup failed");
+            return false;
+        }
+#endif
+        listen_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listen_socket == kInvalidSocket) {
+            spdlog::error("Telemetry: cannot create socket");
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+        int reuse = 1;
+        setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        // 只监听本机回环地址
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(config.prometheus_port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listen_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listen_socket, 8) != 0) {
+            spdlog::error("Telemetry: cannot listen on 127.0.0.1:{}", config.prometheus_port);
+            closeSocket(listen_socket);
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+    }
+
+    if (!config.prometheus_file.empty()) {
+        file_thread_ = std::thread(&Telemetry::fileExportLoop, this, config.prometheus_file,
+                                   std::max(100, config.export_interval_ms));
+        spdlog::info("Telemetry: writing Prometheus metrics to {} every {} ms",
+                     config.prometheus_file, std::max(100, config.export_interval_ms));
+    }
+    if (listen_socket != kInvalidSocket) {
+        http_thread_ = std::thread(&Telemetry::httpServeLoop, this, static_cast<intptr_t>(listen_socket));
+        spdlog::info("Telemetry: serving Prometheus metrics on http://127.0.0.1:{}/metrics", config.prometheus_port);
+    }
+    return true;
+}
+
+void Telemetry::stopExporter() {
+    {
+        std::lock_guard<std::mutex> lock(exporter_mutex_);
+        stop_exporter_ = true;
+    }
+    exporter_cv_.notify_all();
+    if (file_thread_.joinable()) {
+        file_thread_.join();
+    }
+    if (http_thread_.joinable()) {
+        http_thread_.join();
+    }
+}
+
+void Telemetry::fileExportLoop(std::string path, int interval_ms) {
+    std::unique_lock<std::mutex> lock(exporter_mutex_);
+    while (!stop_exporter_) {
+        exporter_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this]() { return stop_exporter_; });
+        // 写文件期间不持有锁；停止时再写一次，保留最终数值
+        lock.unlock();
+        writePrometheusFile(path);
+        lock.lock();
+    }
+}
+
+void Telemetry::httpServeLoop(intptr_t listen_handle) {
+    SocketHandle listen_socket = static_cast<SocketHandle>(listen_handle);
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(exporter_mutex_);
+            if (stop_exporter_) {
+                break;
+            }
+        }
+
+        // 带超时等待连接，以便及时响应停止请求
+        fd_set read_set;
+        FD_ZERO(&read_set);
+        FD_SET(listen_socket, &read_set);
+        timeval timeout{ 0, 200000 };
+        int ready = select(static_cast<int>(listen_socket) + 1, &read_set, nullptr, nullptr, &timeout);
+        if (ready <= 0) {
+            continue;
+        }
+
+        SocketHandle client = accept(listen_socket, nullptr, nullptr);
+        if (client == kInvalidSocket) {
+            continue;
+        }
+
+        // 只读取请求行；任何路径都返回指标。
+        // 同样带超时等待请求：连接后不发送数据的客户端不能阻塞导出线程（以及stopExporter的join）
+        FD_ZERO(&read_set);
+        FD_SET(client, &read_set);
+        timeout = { 0, 200000 };
+        if (select(static_cast<int>(client) + 1, &read_set, nullptr, nullptr, &timeout) <= 0) {
+            closeSocket(client);
+            continue;
+        }
+        // 对端已关闭或出错：不再向其回复
+        char request[1024];
+        if (recv(client, request, sizeof(request), 0) <= 0) {
+            closeSocket(client);
+            continue;
+        }
+
+        std::string body = toPrometheus();
+        std::string response = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: text/plain; version=0.0.4\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                               "Connection: close\r\n\r\n" + body;
+        // 发送同样有上限：单次send最多阻塞200 ms，整个响应最多1 s，
+        // 停止接收的抓取方不会阻塞导出线程（以及stopExporter的join）
+        setSendTimeout(client, 200);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        size_t sent = 0;
+        while (sent < response.size() && std::chrono::steady_clock::now() < deadline) {
+            int n = send(client, response.data() + sent, static_cast<int>(response.size() - sent), kSendFlags);
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        closeSocket(client);
+    }
+    closeSocket(listen_socket);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
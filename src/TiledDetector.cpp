@@ -0,0 +1,264 @@
+#include "TiledDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+TiledDetector::TiledDetector()
+    : detector_(nullptr), job_image_(nullptr), job_chunks_(0), job_generation_(0), pending_(0), stopping_(false) {}
+
+TiledDetector::~TiledDetector() {
+    stopWorkers();
+}
+
+bool TiledDetector::initialize(JsonConfigManager& config_manager) {
+    stopWorkers();
+    config_ = config_manager.getTilingConfig();
+    detector_ = nullptr;
+    pool_ = std::make_unique<DetectorPool>();
+    if (!pool_->initialize(config_manager, std::max(1, config_.sessions))) {
+        spdlog::error("Failed to initialize tiled detector sessions");
+        pool_.reset();
+        return false;
+    }
+    for (size_t chunk = 1; chunk < static_cast<size_t>(pool_->size()); ++chunk) {
+        workers_.emplace_back(&TiledDetector::workerLoop, this, chunk);
+    }
+    spdlog::info("Tiled detection: {}x{} tiles, overlap {:.2f}, full image pass {}, merge {} ({:.2f}), {} session(s)",
+                 config_.tile_width, config_.tile_height, config_.overlap, config_.full_image_pass,
+                 config_.merge, config_.merge_threshold, pool_->size());
+    return true;
+}
+
+void TiledDetector::initialize(ObjectDetector& detector, const TilingConfig& config) {
+    stopWorkers();
+    config_ = config;
+    pool_.reset();
+    detector_ = &detector;
+}
+
+std::vector<cv::Rect> TiledDetector::computeTiles(const cv::Size& image_size, const cv::Size& tile_size, float overlap) {
+    std::vector<cv::Rect> tiles;
+    if (image_size.width <= 0 || image_size.height <= 0) {
+        return tiles;
+    }
+
+    // 每个方向的起点：按步长推进，最后一个tile贴齐图像边缘
+    auto positions = [overlap](int length, int tile) {
+        std::vector<int> starts;
+        tile = std::min(tile, length);
+        int step = std::max(1, static_cast<int>(std::lround(tile * (1.0 - std::clamp(overlap, 0.0f, 0.9f)))));
+        for (int start = 0;; start += step) {
+            starts.push_back(std::min(start, length - tile));
+            if (start + tile >= length) {
+                break;
+            }
+        }
+        return starts;
+    };
+
+    int tile_width = std::min(std::max(1, tile_size.width), image_size.width);
+    int tile_height = std::min(std::max(1, tile_size.height), image_size.height);
+    for (int y : positions(image_size.height, tile_height)) {
+        for (int x : positions(image_size.width, tile_width)) {
+            tiles.emplace_back(x, y, tile_width, tile_height);
+        }
+    }
+    return tiles;
+}
+
+std::vector<DetectionResult> TiledDetector::detect(const cv::Mat& image) {
+    std::vector<DetectionResult> results;
+    detect(image, results);
+    return results;
+}
+
+void TiledDetector::detect(const cv::Mat& image, std::vector<DetectionResult>& results) {
+    results.clear();
+    regions_.clear();
+    if (image.empty() || (!pool_ && !detector_)) {
+        return;
+    }
+
+    std::vector<cv::Rect> tiles = computeTiles(image.size(), cv::Size(config_.tile_width, config_.tile_height),
+                                               config_.overlap);
+    // 只有一个tile时它就是整图，不再重复检测
+    if (config_.full_image_pass && tiles.size() > 1) {
+        regions_.emplace_back(0, 0, image.cols, image.rows);
+    }
+    regions_.insert(regions_.end(), tiles.begin(), tiles.end());
+
+    // 区域按会话数均分为连续的块，每块在一个会话上以batch推理
+    size_t chunks = pool_ ? std::min(regions_.size(), static_cast<size_t>(pool_->size())) : 1;
+    chunk_results_.resize(chunks);
+
+    if (chunks == 1) {
+        if (pool_) {
+            DetectorPool::Lease lease = pool_->acquire();
+            detectRegions(*lease, image, 0, regions_.size(), chunk_results_[0]);
+        } else {
+            detectRegions(*detector_, image, 0, regions_.size(), chunk_results_[0]);
+        }
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_image_ = &image;
+            job_chunks_ = chunks;
+            pending_ = chunks - 1;
+            ++job_generation_;
+        }
+        work_ready_.notify_all();
+        {
+            DetectorPool::Lease lease = pool_->acquire();
+            detectRegions(*lease, image, 0, chunkBegin(1, chunks), chunk_results_[0]);
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_done_.wait(lock, [this]() { return pending_ == 0; });
+        job_image_ = nullptr;
+    }
+
+    for (const auto& chunk_results : chunk_results_) {
+        results.insert(results.end(), chunk_results.begin(), chunk_results.end());
+    }
+    mergeDetections(results, config_, nms_engine_);
+}
+
+void TiledDetector::workerLoop(size_t chunk) {
+    uint64_t seen = 0;
+    while (true) {
+        const cv::Mat* image = nullptr;
+        size_t chunks = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_ready_.wait(lock, [this, seen]() { return stopping_ || job_generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = job_generation_;
+            image = job_image_;
+            chunks = job_chunks_;
+        }
+        // 区域少于会话数的帧只用到前几个线程，其余线程不参与计数
+        if (chunk >= chunks) {
+            continue;
+        }
+
+        {
+            DetectorPool::Lease lease = pool_->acquire();
+            detectRegions(*lease, *image, chunkBegin(chunk, chunks), chunkBegin(chunk + 1, chunks),
+                          chunk_results_[chunk]);
+        }
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            last = --pending_ == 0;
+        }
+        if (last) {
+            work_done_.notify_one();
+        }
+    }
+}
+
+void TiledDetector::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+}
+
+void TiledDetector::detectRegions(ObjectDetector& detector, const cv::Mat& image, size_t begin, size_t end,
+                                  std::vector<DetectionResult>& results) {
+    results.clear();
+
+    // ROI只引用源图像的像素，detectBatch把每个ROI直接预处理进batch张量中对应的切片
+    std::vector<cv::Mat> rois;
+    rois.reserve(end - begin);
+    for (size_t k = begin; k < end; ++k) {
+        rois.push_back(image(regions_[k]));
+    }
+    std::vector<std::vector<DetectionResult>> batch_results = detector.detectBatch(rois);
+
+    for (size_t k = begin; k < end; ++k) {
+        const cv::Point offset = regions_[k].tl();
+        for (DetectionResult result : batch_results[k - begin]) {
+            result.box += offset;
+            results.push_back(result);
+        }
+    }
+}
+
+void TiledDetector::mergeDetections(std::vector<DetectionResult>& detections, const TilingConfig& config,
+                                    NmsEngine& engine) {
+    if (detections.size() < 2) {
+        return;
+    }
+
+    if (config.merge == "nms") {
+        std::vector<cv::Rect> boxes;
+        std::vector<float> scores;
+        std::vector<int> class_ids;
+        boxes.reserve(detections.size());
+        scores.reserve(detections.size());
+        class_ids.reserve(detections.size());
+        for (const auto& detection : detections) {
+            boxes.push_back(detection.box);
+            scores.push_back(detection.confidence);
+            class_ids.push_back(detection.class_id);
+        }
+
+        NmsOptions options;
+        options.iou_threshold = config.merge_threshold;
+        options.class_aware = config.merge_class_aware;
+        options.top_k = 0;
+        std::vector<int> keep;
+        engine.run(boxes, scores, class_ids, options, keep);
+
+        std::vector<DetectionResult> kept;
+        kept.reserve(keep.size());
+        for (int index : keep) {
+            kept.push_back(detections[index]);
+        }
+        detections.swap(kept);
+        return;
+    }
+
+    // NMM：按分数从高到低，每个未被合并的框吸收与其交集占较小框面积超过阈值的框，
+    // 输出外接框与最高分数。tile边界切开的目标两半IoU很低，但交集/较小框面积接近1
+    std::vector<int> order(detections.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&detections](int a, int b) {
+        return detections[a].confidence > detections[b].confidence;
+    });
+
+    std::vector<char> merged(detections.size(), 0);
+    std::vector<DetectionResult> kept;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (merged[order[i]]) {
+            continue;
+        }
+        const DetectionResult& anchor = detections[order[i]];
+        DetectionResult result = anchor;
+        for (size_t j = i + 1; j < order.size(); ++j) {
+            const DetectionResult& other = detections[order[j]];
+            if (merged[order[j]] || (config.merge_class_aware && other.class_id != anchor.class_id)) {
+                continue;
+            }
+            int smaller_area = std::min(anchor.box.area(), other.box.area());
+            int intersection = (anchor.box & other.box).area();
+            if (smaller_area > 0 && intersection >= config.merge_threshold * smaller_area) {
+                result.box |= other.box;
+                merged[order[j]] = 1;
+            }
+        }
+        kept.push_back(result);
+    }
+    detections.swap(kept);
+}
@@ -0,0 +1,96 @@
+#include "TrackingDetector.h"
+#include <algorithm>
+
+TrackingDetector::TrackingDetector()
+    : detector_(nullptr)
+    , interval_(1)
+    , frames_since_keyframe_(-1) {}
+
+TrackingDetector::~TrackingDetector() = default;
+
+bool TrackingDetector::initialize(JsonConfigManager& config_manager) {
+    owned_detector_ = std::make_unique<ObjectDetector>();
+    if (!owned_detector_->initialize(config_manager)) {
+        spdlog::error("Failed to initialize detector for tracking");
+        owned_detector_.reset();
+        detector_ = nullptr;
+        return false;
+    }
+    initialize(*owned_detector_, config_manager.getTrackingConfig());
+    spdlog::info("Tracking: keyframe interval {} ({}, {}-{}), match IoU {:.2f}, max age {}",
+                 config_.keyframe_interval, config_.adaptive ? "adaptive" : "fixed",
+                 config_.min_interval, config_.max_interval, config_.iou_threshold, config_.max_age);
+    return true;
+}
+
+void TrackingDetector::initialize(ObjectDetector& detector, const TrackingConfig& config) {
+    detector_ = &detector;
+    config_ = config;
+    config_.min_interval = std::max(1, config_.min_interval);
+    config_.max_interval = std::max(config_.min_interval, config_.max_interval);
+
+    TrackerOptions options;
+    options.iou_threshold = config_.iou_threshold;
+    options.max_age = config_.max_age;
+    options.confidence_decay = config_.confidence_decay;
+    tracker_.setOptions(options);
+    reset();
+}
+
+void TrackingDetector::reset() {
+    tracker_.reset();
+    interval_ = std::max(1, config_.keyframe_interval);
+    if (config_.adaptive) {
+        interval_ = std::clamp(interval_, config_.min_interval, config_.max_interval);
+    }
+    frames_since_keyframe_ = -1;
+    stats_ = TrackingStats();
+    stats_.interval = interval_;
+}
+
+bool TrackingDetector::needsDetection() const {
+    if (frames_since_keyframe_ < 0 || frames_since_keyframe_ + 1 >= interval_) {
+        return true;
+    }
+    // 下一次外推后置信度将低于下限：跟踪结果已不可靠
+    return config_.adaptive && tracker_.trackCount() > 0 &&
+           tracker_.minConfidence() * config_.confidence_decay < config_.min_confidence;
+}
+
+bool TrackingDetector::process(const cv::Mat& frame, std::vector<DetectionResult>& results) {
+    results.clear();
+    if (!detector_ || frame.empty()) {
+        return false;
+    }
+
+    ++stats_.frames;
+    if (!needsDetection()) {
+        tracker_.predict(results);
+        ++frames_since_keyframe_;
+        return false;
+    }
+
+    if (frames_since_keyframe_ >= 0 && frames_since_keyframe_ + 1 < interval_) {
+        ++stats_.early_keyframes;
+    }
+    bool had_tracks = tracker_.trackCount() > 0;
+    detector_->detect(frame, detections_);
+    tracker_.update(detections_, results);
+    ++stats_.keyframes;
+    frames_since_keyframe_ = 0;
+    if (config_.adaptive) {
+        adjustInterval(had_tracks);
+    }
+    return true;
+}
+
+void TrackingDetector::adjustInterval(bool had_tracks) {
+    const TrackerUpdateStats& update = tracker_.lastUpdate();
+    if (had_tracks && (update.lost > 0 || update.created > 0)) {
+        // 目标丢失或新目标进入画面：提高检测频率
+        interval_ = std::max(config_.min_interval, interval_ / 2);
+    } else if (update.lost == 0 && update.created == 0) {
+        interval_ = std::min(config_.max_interval, interval_ + 1);
+    }
+    stats_.interval = interval_;
+}
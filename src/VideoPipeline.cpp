@@ -0,0 +1,396 @@
+#include "VideoPipeline.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+void recordStage(std::atomic<uint64_t>& frames, std::atomic<uint64_t>& busy_ns,
+                 std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    frames.fetch_add(1, std::memory_order_relaxed);
+    busy_ns.fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+}
+
+} // namespace
+
+VideoPipeline::VideoPipeline()
+    : stop_(false)
+    , decode_failed_(false)
+    , start_time_(std::chrono::steady_clock::now()) {
+}
+
+VideoPipeline::~VideoPipeline() {
+    stop();
+}
+
+bool VideoPipeline::initialize(JsonConfigManager& config_manager) {
+    config_ = config_manager.getPipelineConfig();
+    config_.preprocess_workers = std::max(1, config_.preprocess_workers);
+    config_.inference_workers = std::max(1, config_.inference_workers);
+    config_.postprocess_workers = std::max(1, config_.postprocess_workers);
+    config_.queue_capacity = std::max(2, config_.queue_capacity);
+
+    const auto& model_config = config_manager.getModelConfig();
+    input_size_ = cv::Size(model_config.input_width, model_config.input_height);
+
+    // 并行度由预处理线程数提供，单帧内默认不再拆分
+    preprocessors_.clear();
+    for (int i = 0; i < config_.preprocess_workers; ++i) {
+        auto preprocessor = std::make_unique<LetterboxPreprocessor>();
+        preprocessor->setNumThreads(model_config.preprocess_threads > 0 ? model_config.preprocess_threads : 1);
+        preprocessors_.push_back(std::move(preprocessor));
+    }
+
+    loaders_.clear();
+    for (int i = 0; i < config_.preprocess_workers; ++i) {
+        auto loader = std::make_unique<ImageLoader>();
+        loader->setTargetSize(input_size_);
+        loader->setReducedDecode(config_manager.getInputConfig().reduced_decode);
+        loaders_.push_back(std::move(loader));
+    }
+
+    // 每个推理线程独占一个会话，Run之间互不等待
+    inference_detectors_.clear();
+    for (int i = 0; i < config_.inference_workers; ++i) {
+        auto detector = std::make_unique<ObjectDetector>();
+        if (!detector->initialize(config_manager)) {
+            spdlog::error("Failed to initialize inference worker {}", i);
+            inference_detectors_.clear();
+            return false;
+        }
+        inference_detectors_.push_back(std::move(detector));
+    }
+    // 各推理会话加载同一模型，输入格式一致
+    input_format_ = inference_detectors_.front()->getInputFormat();
+
+    // 后处理只需要阈值、NMS选项和输入尺寸，不加载模型
+    postprocess_detectors_.clear();
+    for (int i = 0; i < config_.postprocess_workers; ++i) {
+        auto detector = std::make_unique<ObjectDetector>();
+        detector->applyConfig(config_manager);
+        postprocess_detectors_.push_back(std::move(detector));
+    }
+
+    spdlog::info("Video pipeline initialized: preprocess={}, inference={}, postprocess={}, queue capacity={}",
+                 config_.preprocess_workers, config_.inference_workers,
+                 config_.postprocess_workers, config_.queue_capacity);
+    return true;
+}
+
+void VideoPipeline::buildStages() {
+    const char* names[] = { "decode", "preprocess", "inference", "postprocess", "output" };
+    const int workers[] = { 1, config_.preprocess_workers, config_.inference_workers,
+                            config_.postprocess_workers, 1 };
+
+    std::lock_guard<std::mutex> lock(stages_mutex_);
+    stages_.clear();
+    size_t max_in_flight = 0;
+    for (size_t s = 0; s < 5; ++s) {
+        auto stage = std::make_unique<Stage>();
+        stage->name = names[s];
+        stage->workers = workers[s];
+        stage->producers = s > 0 ? workers[s - 1] : 0;
+        for (int q = 0; q < stage->producers * stage->workers; ++q) {
+            stage->inputs.push_back(std::make_unique<PacketQueue>(config_.queue_capacity));
+            max_in_flight += stage->inputs.back()->capacity();
+        }
+        max_in_flight += stage->workers;
+        stages_.push_back(std::move(stage));
+    }
+
+    // 在途帧数不会超过所有队列容量加上各线程手中的帧
+    free_packets_ = std::make_unique<PacketQueue>(max_in_flight);
+    start_time_ = std::chrono::steady_clock::now();
+}
+
+bool VideoPipeline::run(const std::string& source, const FrameCallback& callback, int64_t max_frames) {
+    if (inference_detectors_.empty()) {
+        spdlog::error("Video pipeline is not initialized");
+        return false;
+    }
+
+    cv::VideoCapture capture;
+    bool is_camera = !source.empty() &&
+        std::all_of(source.begin(), source.end(), [](unsigned char c) { return std::isdigit(c) != 0; });
+    if (is_camera) {
+        capture.open(std::stoi(source));
+    } else {
+        capture.open(source);
+    }
+    if (!capture.isOpened()) {
+        spdlog::error("Cannot open video source: {}", source);
+        return false;
+    }
+
+    return runStages(source, [&capture](FramePacket& packet) {
+        return capture.read(packet.frame) && !packet.frame.empty();
+    }, callback, max_frames);
+}
+
+bool VideoPipeline::runImages(ImageSource& images, const FrameCallback& callback, int64_t max_frames) {
+    if (inference_detectors_.empty()) {
+        spdlog::error("Video pipeline is not initialized");
+        return false;
+    }
+
+    // 只读取路径，解码交给多个预处理线程，避免单线程imread成为瓶颈
+    return runStages(images.description(), [&images](FramePacket& packet) {
+        return images.next(packet.path);
+    }, callback, max_frames);
+}
+
+bool VideoPipeline::runStages(const std::string& description, const FrameReader& reader,
+                              const FrameCallback& callback, int64_t max_frames) {
+    buildStages();
+    stop_.store(false);
+    decode_failed_.store(false);
+
+    spdlog::info("Starting pipeline on {}", description);
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(&VideoPipeline::decodeLoop, this, std::cref(reader), max_frames);
+    const Processor processors[] = { &VideoPipeline::preprocess, &VideoPipeline::inference,
+                                     &VideoPipeline::postprocess };
+    for (size_t s = 1; s <= 3; ++s) {
+        for (int w = 0; w < stages_[s]->workers; ++w) {
+            threads.emplace_back(&VideoPipeline::workerLoop, this, s, w, processors[s - 1]);
+        }
+    }
+
+    bool success = true;
+    try {
+        collectOutput(callback);
+    }
+    catch (const std::exception& e) {
+        spdlog::error("Exception in video pipeline output: {}", e.what());
+        success = false;
+    }
+
+    // 正常结束时各线程已发送结束标记并退出；提前停止时唤醒仍在等待队列的线程
+    stop_.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (decode_failed_.load()) {
+        success = false;
+    }
+
+    logStats();
+    return success;
+}
+
+void VideoPipeline::stop() {
+    stop_.store(true);
+}
+
+void VideoPipeline::decodeLoop(const FrameReader& reader, int64_t max_frames) {
+    Stage& stage = *stages_[0];
+    Stage& next = *stages_[1];
+
+    for (int64_t index = 0; !stop_.load(std::memory_order_relaxed); ++index) {
+        if (max_frames > 0 && index >= max_frames) {
+            break;
+        }
+
+        // 优先复用输出阶段归还的帧包，保留其张量缓冲区容量
+        PacketPtr packet;
+        if (!free_packets_->tryPop(packet)) {
+            packet = std::make_unique<FramePacket>();
+        }
+        packet->index = index;
+        packet->valid = true;
+        packet->path.clear();
+        packet->original_size = cv::Size();
+        packet->detections.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        packet->start = start;
+        try {
+            if (!reader(*packet)) {
+                break;
+            }
+        }
+        // 异常不能逃出线程函数（否则std::terminate）：记录错误后按流结束处理，
+        // 下游照常收到结束标记，已解码的帧输出后各线程正常退出
+        catch (const cv::Exception& e) {
+            spdlog::error("OpenCV Exception while decoding frame {}: {}", index, e.what());
+            decode_failed_.store(true);
+            break;
+        }
+        catch (const std::exception& e) {
+            spdlog::error("Standard Exception while decoding frame {}: {}", index, e.what());
+            decode_failed_.store(true);
+            break;
+        }
+        recordStage(stage.frames, stage.busy_ns, start);
+
+        if (!next.input(0, static_cast<int>(index % next.workers)).push(std::move(packet), stop_)) {
+            break;
+        }
+    }
+
+    sendEndOfStream(next, 0);
+}
+
+void VideoPipeline::workerLoop(size_t stage_index, int worker, Processor process) {
+    Stage& stage = *stages_[stage_index];
+    Stage& next = *stages_[stage_index + 1];
+
+    // 本线程负责的帧序号为 worker, worker + workers, ...，依次从对应上游线程的队列读取
+    for (int64_t index = worker; ; index += stage.workers) {
+        PacketPtr packet;
+        PacketQueue& input = stage.input(static_cast<int>(index % stage.producers), worker);
+        if (!input.pop(packet, stop_) || !packet) {
+            break;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (packet->valid) {
+            try {
+                (this->*process)(worker, *packet);
+            }
+            catch (const std::exception& e) {
+                spdlog::error("Exception in {} stage on frame {}: {}", stage.name, packet->index, e.what());
+                packet->valid = false;
+            }
+        }
+        recordStage(stage.frames, stage.busy_ns, start);
+
+        if (!next.input(worker, static_cast<int>(index % next.workers)).push(std::move(packet), stop_)) {
+            break;
+        }
+    }
+
+    sendEndOfStream(next, worker);
+}
+
+void VideoPipeline::sendEndOfStream(Stage& next, int producer) {
+    // 下游每个线程都可能在等待本线程的队列，因此每条队列各发送一个结束标记
+    for (int w = 0; w < next.workers; ++w) {
+        next.input(producer, w).push(PacketPtr(), stop_);
+    }
+}
+
+void VideoPipeline::collectOutput(const FrameCallback& callback) {
+    Stage& stage = *stages_.back();
+    auto last_report = std::chrono::steady_clock::now();
+
+    for (int64_t index = 0; ; ++index) {
+        PacketPtr packet;
+        if (!stage.input(static_cast<int>(index % stage.producers), 0).pop(packet, stop_) || !packet) {
+            break;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (callback) {
+            FrameInfo info;
+            info.index = packet->index;
+            info.source = packet->path;
+            info.image_size = packet->original_size.area() > 0 ? packet->original_size : packet->frame.size();
+            info.valid = packet->valid;
+            info.latency_ms = std::chrono::duration<double, std::milli>(start - packet->start).count();
+            callback(info, packet->frame, packet->detections);
+        }
+        recordStage(stage.frames, stage.busy_ns, start);
+
+        // 释放图像引用（回调可能仍持有浅拷贝），张量缓冲区随帧包回收
+        packet->frame.release();
+        free_packets_->tryPush(std::move(packet));
+
+        if (config_.stats_interval_ms > 0) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_report >= std::chrono::milliseconds(config_.stats_interval_ms)) {
+                logStats();
+                last_report = now;
+            }
+        }
+    }
+}
+
+void VideoPipeline::preprocess(int worker, FramePacket& packet) {
+    if (!packet.path.empty() && packet.frame.empty()) {
+        LoadedImage loaded;
+        if (!loaders_[worker]->load(packet.path, loaded)) {
+            spdlog::warn("Cannot decode image: {}", packet.path);
+            packet.valid = false;
+            return;
+        }
+        packet.frame = loaded.image;
+        packet.original_size = loaded.original_size;
+    } else {
+        packet.original_size = packet.frame.size();
+    }
+    // minimal模式下按帧的宽高比确定输入尺寸（只读取配置，可在预处理线程中调用）
+    packet.input_size = inference_detectors_.front()->inputSizeFor(packet.frame.size());
+    size_t tensor_size = static_cast<size_t>(3) * packet.input_size.width * packet.input_size.height;
+    auto start_time = Telemetry::Clock::now();
+    if (input_format_ == InputFormat::Uint8Nhwc) {
+        packet.input_bytes.resize(tensor_size);
+        preprocessors_[worker]->runBytes(packet.frame, packet.input_size, packet.input_bytes.data());
+    } else {
+        packet.input_tensor.resize(tensor_size);
+        preprocessors_[worker]->run(packet.frame, packet.input_size, packet.input_tensor.data());
+    }
+    Telemetry::instance().recordSince(TelemetryStage::Preprocess, start_time);
+}
+
+void VideoPipeline::inference(int worker, FramePacket& packet) {
+    ObjectDetector& detector = *inference_detectors_[worker];
+    if (input_format_ == InputFormat::Uint8Nhwc) {
+        packet.valid = detector.infer(packet.input_bytes.data(), packet.output, packet.output_shape,
+                                      packet.input_size);
+    } else {
+        packet.valid = detector.infer(packet.input_tensor.data(), packet.output, packet.output_shape,
+                                      packet.input_size);
+    }
+}
+
+void VideoPipeline::postprocess(int worker, FramePacket& packet) {
+    // 按输出签名选择解码+NMS或端到端模型的图内NMS结果
+    packet.valid = postprocess_detectors_[worker]->postprocessOutput(packet.output.data(), packet.output_shape,
+                                                                     cv::Size(packet.frame.cols, packet.frame.rows),
+                                                                     packet.detections);
+    ObjectDetector::scaleResults(packet.detections, packet.frame.size(), packet.original_size);
+}
+
+PipelineStats VideoPipeline::getStats() const {
+    std::lock_guard<std::mutex> lock(stages_mutex_);
+    PipelineStats stats;
+    stats.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+
+    for (const auto& stage : stages_) {
+        PipelineStageStats stage_stats;
+        stage_stats.name = stage->name;
+        stage_stats.workers = stage->workers;
+        stage_stats.frames = stage->frames.load(std::memory_order_relaxed);
+        uint64_t busy_ns = stage->busy_ns.load(std::memory_order_relaxed);
+        if (stats.elapsed_s > 0.0) {
+            stage_stats.fps = stage_stats.frames / stats.elapsed_s;
+        }
+        if (stage_stats.frames > 0) {
+            stage_stats.avg_latency_ms = busy_ns / 1e6 / stage_stats.frames;
+        }
+        for (const auto& queue : stage->inputs) {
+            stage_stats.queue_depth += queue->size();
+            stage_stats.queue_capacity += queue->capacity();
+        }
+        stats.stages.push_back(stage_stats);
+    }
+
+    if (!stats.stages.empty()) {
+        stats.frames = stats.stages.back().frames;
+        stats.fps = stats.stages.back().fps;
+    }
+    return stats;
+}
+
+void VideoPipeline::logStats() const {
+    PipelineStats stats = getStats();
+    spdlog::info("Pipeline: {} frames in {:.2f} s ({:.1f} FPS)", stats.frames, stats.elapsed_s, stats.fps);
+    for (const auto& stage : stats.stages) {
+        spdlog::info("  {:<12} workers={} frames={} fps={:.1f} avg={:.2f} ms queue={}/{}",
+                     stage.name, stage.workers, stage.frames, stage.fps,
+                     stage.avg_latency_ms, stage.queue_depth, stage.queue_capacity);
+    }
+}
@@ -1,5 +1,15 @@
 #include "ObjectDetector.h"
 #include "JsonConfigManager.h"
+#include "VideoPipeline.h"
+#include "Telemetry.h"
+#include "ImageSource.h"
+#include "ResultWriter.h"
+#include "ImageLoader.h"
+#include "TiledDetector.h"
+#include "TrackingDetector.h"
+#include "InferenceServer.h"
+#include "FrameRing.h"
+#include "FrameGate.h"
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <string>
@@ -7,14 +17,253 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <memory>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <csignal>
+#include <cstdlib>
+#include <thread>
+
+// 视频模式：通过多阶段流水线处理整段视频，按帧序输出检测结果
+static int runVideo(JsonConfigManager& config_manager, const std::string& source, int64_t max_frames) {
+    VideoPipeline pipeline;
+    if (!pipeline.initialize(config_manager)) {
+        spdlog::error("Failed to initialize video pipeline");
+        return -1;
+    }
+    
+    uint64_t total_detections = 0;
+    bool ok = pipeline.run(source, [&](const FrameInfo& info, const cv::Mat& frame,
+                                       const std::vector<DetectionResult>& detections) {
+        total_detections += detections.size();
+        spdlog::debug("Frame {} ({}x{}): {} objects", info.index, frame.cols, frame.rows, detections.size());
+    }, max_frames);
+    
+    spdlog::info("Video finished, {} detections in total", total_detections);
+    Telemetry::instance().logSummary();
+    return ok ? 0 : -1;
+}
+
+// 打开视频文件或摄像头（纯数字视为摄像头编号）
+static bool openCapture(cv::VideoCapture& capture, const std::string& source) {
+    bool is_camera = !source.empty() &&
+        std::all_of(source.begin(), source.end(), [](unsigned char c) { return std::isdigit(c) != 0; });
+    if (is_camera) {
+        capture.open(std::stoi(source));
+    } else {
+        capture.open(source);
+    }
+    if (!capture.isOpened()) {
+        spdlog::error("Cannot open video source: {}", source);
+        return false;
+    }
+    return true;
+}
+
+// 跟踪模式：逐帧顺序处理，只在关键帧上完整检测，中间帧由跟踪器外推
+static int runTracking(JsonConfigManager& config_manager, const std::string& source, int64_t max_frames) {
+    TrackingDetector tracker;
+    if (!tracker.initialize(config_manager)) {
+        spdlog::error("Failed to initialize tracking detector");
+        return -1;
+    }
+    
+    cv::VideoCapture capture;
+    if (!openCapture(capture, source)) {
+        return -1;
+    }
+    
+    cv::Mat frame;
+    std::vector<DetectionResult> results;
+    auto start_time = std::chrono::steady_clock::now();
+    while ((max_frames <= 0 || static_cast<int64_t>(tracker.getStats().frames) < max_frames) && capture.read(frame)) {
+        bool keyframe = tracker.process(frame, results);
+        spdlog::debug("Frame {} ({}): {} objects", tracker.getStats().frames - 1,
+                      keyframe ? "detect" : "track", results.size());
+    }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    
+    const TrackingStats& stats = tracker.getStats();
+    spdlog::info("Tracking finished: {} frames, {} keyframes ({} early), final interval {}, {:.1f} fps",
+                 stats.frames, stats.keyframes, stats.early_keyframes, stats.interval,
+                 elapsed_s > 0.0 ? stats.frames / elapsed_s : 0.0);
+    Telemetry::instance().logSummary();
+    return 0;
+}
+
+// 门控模式：逐帧计算指纹，画面与上次推理的帧几乎相同时复用缓存结果
+static int runGated(JsonConfigManager& config_manager, const std::string& source, int64_t max_frames) {
+    FrameGate gate;
+    if (!gate.initialize(config_manager)) {
+        spdlog::error("Failed to initialize frame gate");
+        return -1;
+    }
+    
+    cv::VideoCapture capture;
+    if (!openCapture(capture, source)) {
+        return -1;
+    }
+    
+    cv::Mat frame;
+    std::vector<DetectionResult> results;
+    auto start_time = std::chrono::steady_clock::now();
+    while ((max_frames <= 0 || static_cast<int64_t>(gate.getStats().frames) < max_frames) && capture.read(frame)) {
+        bool inferred = gate.process(frame, results);
+        spdlog::debug("Frame {} ({}): {} objects", gate.getStats().frames - 1,
+                      inferred ? "detect" : "cached", results.size());
+    }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    
+    const GateStats& stats = gate.getStats();
+    spdlog::info("Gating finished: {} frames, {} inferred ({} motion, {} stale), hit rate {:.1f}%, {:.1f} fps",
+                 stats.frames, stats.inferred, stats.motion_triggers, stats.stale_refreshes,
+                 stats.hitRate() * 100.0, elapsed_s > 0.0 ? stats.frames / elapsed_s : 0.0);
+    Telemetry::instance().logSummary();
+    return 0;
+}
+
+// 无界面批处理：目录/通配符/列表文件/视频，结果以JSON-lines或CSV流式写出
+static int runBatch(JsonConfigManager& config_manager, const std::string& input, const std::string& output_path,
+                    ResultWriter::Format format, int64_t max_frames) {
+    VideoPipeline pipeline;
+    if (!pipeline.initialize(config_manager)) {
+        spdlog::error("Failed to initialize pipeline");
+        return -1;
+    }
+    
+    ResultWriter writer;
+    if (!writer.open(output_path, format, config_manager.getClassesConfig().names)) {
+        return -1;
+    }
+    
+    // 端到端延迟记录在固定大小的直方图中，帧数再多也不增长内存
+    LatencyHistogram latency;
+    uint64_t frames = 0;
+    uint64_t failed = 0;
+    uint64_t total_detections = 0;
+    auto callback = [&](const FrameInfo& info, const cv::Mat&, const std::vector<DetectionResult>& detections) {
+        writer.write(info, detections);
+        latency.record(static_cast<int64_t>(info.latency_ms * 1e6));
+        ++frames;
+        failed += info.valid ? 0 : 1;
+        total_detections += detections.size();
+    };
+    
+    auto start_time = std::chrono::steady_clock::now();
+    ImageSource images;
+    bool ok = images.open(input)
+        ? pipeline.runImages(images, callback, max_frames)
+        : pipeline.run(input, callback, max_frames);
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    writer.close();
+    
+    HistogramSnapshot snapshot = latency.snapshot();
+    spdlog::info("Batch finished: {} images ({} failed), {} detections in {:.2f} s",
+                 frames, failed, total_detections, elapsed_s);
+    spdlog::info("Throughput: {:.1f} images/s, latency p50 {:.2f} ms, p99 {:.2f} ms",
+                 elapsed_s > 0.0 ? frames / elapsed_s : 0.0, snapshot.quantileMs(0.50), snapshot.quantileMs(0.99));
+    Telemetry::instance().logSummary();
+    return ok ? 0 : -1;
+}
+
+static std::atomic<bool> g_stop_requested{false};
+
+static void onStopSignal(int) {
+    g_stop_requested = true;
+}
+
+// 服务模式：在本机socket上接收其他进程的检测请求，动态合并为批次推理，Ctrl+C停止
+static int runServer(JsonConfigManager& config_manager) {
+    InferenceServer server;
+    if (!server.initialize(config_manager) || !server.start()) {
+        spdlog::error("Failed to start inference server");
+        return -1;
+    }
+    
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    while (!g_stop_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    server.stop();
+    Telemetry::instance().logSummary();
+    return 0;
+}
+
+// 共享内存模式：同机的解码进程把原始帧写入帧环，检测结果写回结果环；生产方关闭帧环或Ctrl+C时结束
+static int runSharedMemory(JsonConfigManager& config_manager) {
+    ObjectDetector detector;
+    if (!detector.initialize(config_manager)) {
+        spdlog::error("Failed to initialize detector");
+        return -1;
+    }
+    FrameRingReader ring;
+    if (!ring.create(config_manager.getShmRingConfig())) {
+        return -1;
+    }
+    
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    cv::Mat frame;
+    uint64_t frame_id = 0;
+    std::vector<DetectionResult> results;
+    while (!g_stop_requested) {
+        // 帧直接在共享内存槽位上检测，检测完成后立即归还槽位
+        if (!ring.nextFrame(frame, frame_id, 200)) {
+            if (ring.producerClosed()) {
+                break;
+            }
+            continue;
+        }
+        detector.detect(frame, results);
+        ring.releaseFrame();
+        ring.writeResults(frame_id, results, 1000);
+    }
+    
+    RingStats stats = ring.frameStats();
+    spdlog::info("Shared memory ring finished: {} frames written, {} detected, {} overwritten",
+                 stats.written, stats.read, stats.dropped);
+    Telemetry::instance().logSummary();
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
-    std::cout << "ORT Version: " << Ort::GetVersionString() << std::endl;
+    // 批处理模式：YoloV8Infer --batch <目录|通配符|列表文件|视频> [--output 文件] [--format jsonl|csv] [--max-frames N]
+    bool batch_mode = argc > 2 && std::string(argv[1]) == "--batch";
+    std::string batch_output;
+    std::string batch_format = "jsonl";
+    int64_t batch_max_frames = 0;
+    if (batch_mode) {
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--output" && i + 1 < argc) {
+                batch_output = argv[++i];
+            } else if (arg == "--format" && i + 1 < argc) {
+                batch_format = argv[++i];
+            } else if (arg == "--max-frames" && i + 1 < argc) {
+                batch_max_frames = std::atoll(argv[++i]);
+            } else {
+                std::cerr << "Usage: " << argv[0]
+                          << " --batch <dir|glob|list.txt|video> [--output file] [--format jsonl|csv] [--max-frames N]"
+                          << std::endl;
+                return -1;
+            }
+        }
+    }
+    // 结果写到stdout时，日志改写到stderr，避免混入结果流
+    bool results_on_stdout = batch_mode && (batch_output.empty() || batch_output == "-");
+    
     // Initialize spdlog
     try {
         // Create a logger that outputs to both console and file
         std::vector<spdlog::sink_ptr> sinks;
-        auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        spdlog::sink_ptr console_sink;
+        if (results_on_stdout) {
+            console_sink = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
+        } else {
+            console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        }
         // 使用项目根目录下的logs文件夹
         auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>("logs/yolov8_infer.log", true);
         
@@ -25,13 +274,15 @@ int main(int argc, char* argv[]) {
         combined_logger->set_level(spdlog::level::info);
         spdlog::set_default_logger(combined_logger);
         
-        spdlog::flush_on(spdlog::level::info);
+        // 只有warn及以上立即刷盘，其余由后台定时刷新，避免每帧日志同步写文件
+        spdlog::flush_on(spdlog::level::warn);
+        spdlog::flush_every(std::chrono::seconds(1));
     } catch (const spdlog::spdlog_ex& ex) {
         std::cerr << "Log initialization failed: " << ex.what() << std::endl;
         return -1;
     }
     
-    spdlog::info("Starting YoloV8Infer application");
+    spdlog::info("Starting YoloV8Infer application (ORT version {})", Ort::GetVersionString());
     
     // Load configuration
     JsonConfigManager config_manager("configs/config.json");
@@ -40,10 +291,48 @@ int main(int argc, char* argv[]) {
         return -1;
     }
     
+    // 可选的Prometheus导出（文件 / 127.0.0.1 HTTP端点）
+    if (!Telemetry::instance().startExporter(config_manager.getTelemetryConfig())) {
+        spdlog::warn("Telemetry exporter could not be started, metrics are still collected in memory");
+    }
+    
     // Get paths from configuration
     std::string model_path = config_manager.getModelConfig().path;
     std::string image_path = config_manager.getInputConfig().image_path;
     
+    if (batch_mode) {
+        ResultWriter::Format format;
+        if (!ResultWriter::parseFormat(batch_format, format)) {
+            spdlog::error("Unknown output format: {} (expected jsonl or csv)", batch_format);
+            return -1;
+        }
+        return runBatch(config_manager, argv[2], batch_output, format, batch_max_frames);
+    }
+    
+    // 服务模式：YoloV8Infer --serve（监听地址、批大小与排队延迟见server配置）
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        return runServer(config_manager);
+    }
+    
+    // 共享内存模式：YoloV8Infer --shm（环的名称、槽位数与溢出策略见shm_ring配置）
+    if (argc > 1 && std::string(argv[1]) == "--shm") {
+        return runSharedMemory(config_manager);
+    }
+    
+    // 视频模式：YoloV8Infer --video <视频文件或摄像头编号> [最大帧数]
+    // 开启tracking时改为逐帧的检测+跟踪（关键帧的选择依赖上一关键帧的跟踪结果，无法流水线并行）
+    // 开启gate时逐帧门控，静止画面复用上次的检测结果（tracking优先）
+    if (argc > 2 && std::string(argv[1]) == "--video") {
+        int64_t max_frames = argc > 3 ? std::atoll(argv[3]) : 0;
+        if (config_manager.getTrackingConfig().enabled) {
+            return runTracking(config_manager, argv[2], max_frames);
+        }
+        if (config_manager.getGateConfig().enabled) {
+            return runGated(config_manager, argv[2], max_frames);
+        }
+        return runVideo(config_manager, argv[2], max_frames);
+    }
+    
     // Parse command line arguments
     if (argc > 1) {
         image_path = argv[1];
@@ -56,19 +345,34 @@ int main(int argc, char* argv[]) {
     
     try {
         spdlog::info("Loading image: {}", image_path);
-        // Load image
-        cv::Mat image = cv::imread(image_path);
-        if (image.empty()) {
+        // Load image（开启reduced_decode时大尺寸JPEG按1/2、1/4、1/8解码；切片检测需要原分辨率，不降采样）
+        const auto& model_config = config_manager.getModelConfig();
+        const auto& tiling_config = config_manager.getTilingConfig();
+        ImageLoader loader;
+        loader.setTargetSize(cv::Size(model_config.input_width, model_config.input_height));
+        loader.setReducedDecode(config_manager.getInputConfig().reduced_decode && !tiling_config.enabled);
+        LoadedImage loaded;
+        if (!loader.load(image_path, loaded)) {
             spdlog::error("Cannot load image: {}", image_path);
             return -1;
         }
+        const cv::Mat& image = loaded.image;
         
-        spdlog::info("Image loaded successfully. Size: {}x{}", image.cols, image.rows);
+        spdlog::info("Image loaded successfully. Size: {}x{} (decoded at 1/{}: {}x{})",
+                     loaded.original_size.width, loaded.original_size.height,
+                     loaded.reduction, image.cols, image.rows);
         
-        // Initialize detector
+        // Initialize detector（切片模式下由TiledDetector创建tiling.sessions个会话）
         spdlog::info("Initializing ObjectDetector");
         ObjectDetector detector;
-        if (!detector.initialize(config_manager)) {
+        TiledDetector tiled_detector;
+        if (tiling_config.enabled) {
+            detector.applyConfig(config_manager);
+            if (!tiled_detector.initialize(config_manager)) {
+                spdlog::error("Failed to initialize tiled detector from JSON config");
+                return -1;
+            }
+        } else if (!detector.initialize(config_manager)) {
             spdlog::error("Failed to initialize detector from JSON config");
             return -1;
         }
@@ -77,7 +381,13 @@ int main(int argc, char* argv[]) {
         
         // Perform detection
         spdlog::info("Starting object detection");
-        std::vector<DetectionResult> results = detector.detect(image);
+        std::vector<DetectionResult> results;
+        if (tiling_config.enabled) {
+            tiled_detector.detect(image, results);
+            spdlog::info("Tiled detection over {} regions", tiled_detector.lastRegionCount());
+        } else {
+            detector.detect(loaded, results);
+        }
         
         // Display results
         spdlog::info("Detection results:");
@@ -90,8 +400,11 @@ int main(int argc, char* argv[]) {
         
         // Show image with detections
         spdlog::info("Displaying results");
+        // 检测框为原图坐标，绘制在降分辨率图像上时需要映射回解码尺寸
         cv::Mat result_image = image.clone();
-        detector.drawBoxes(result_image, results);
+        std::vector<DetectionResult> display_results = results;
+        ObjectDetector::scaleResults(display_results, loaded.original_size, image.size());
+        detector.drawBoxes(result_image, display_results);
         cv::imshow("Object Detection Result", result_image);
         cv::waitKey(0);
         
@@ -0,0 +1,141 @@
+#include "ObjectDetector.h"
+#include "ImageLoader.h"
+#include "LetterboxPreprocessor.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 降分辨率解码基准：1080p与4K JPEG上比较 全分辨率解码+预处理 与 DCT缩放解码+预处理，
+// 并用微型模型比较两种解码下的检测框（以全分辨率结果为参照的召回率与平均IoU）
+// 用法: decode_benchmark [迭代次数] [模型路径]
+
+#ifndef YOLO_TEST_DATA_DIR
+#define YOLO_TEST_DATA_DIR "tests/data"
+#endif
+
+template <typename Func>
+double benchmarkMs(Func&& func, int iterations) {
+    for (int i = 0; i < 3; ++i) {
+        func();
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// 带纹理和彩色矩形的场景，JPEG压缩后接近真实照片的解码负载
+cv::Mat makeScene(const cv::Size& size) {
+    cv::Mat image(size, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(64));
+    cv::GaussianBlur(image, image, cv::Size(0, 0), 3.0);
+    cv::RNG rng(42);
+    for (int i = 0; i < 25; ++i) {
+        cv::Rect rect(rng.uniform(0, size.width * 3 / 4), rng.uniform(0, size.height * 3 / 4),
+                      rng.uniform(size.width / 30, size.width / 5), rng.uniform(size.height / 20, size.height / 4));
+        cv::rectangle(image, rect, cv::Scalar(rng.uniform(64, 256), rng.uniform(64, 256), rng.uniform(64, 256)),
+                      cv::FILLED);
+    }
+    return image;
+}
+
+float iou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = static_cast<float>((a & b).area());
+    float uni = static_cast<float>(a.area() + b.area()) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 30;
+    std::string model_path = argc > 2 ? argv[2] : std::string(YOLO_TEST_DATA_DIR) + "/tiny_yolov8.onnx";
+    const cv::Size target_size(640, 640);
+
+    ObjectDetector detector;
+    detector.setInputSize(target_size.width, target_size.height);
+    std::vector<std::string> class_names;
+    for (int i = 0; i < 80; ++i) {
+        class_names.push_back(std::to_string(i));
+    }
+    detector.setClassNames(class_names);
+    detector.setConfidenceThreshold(0.25f);
+    detector.setNMSThreshold(0.45f);
+    spdlog::set_level(spdlog::level::warn);
+    bool has_model = detector.initialize(model_path);
+    spdlog::set_level(spdlog::level::info);
+    if (!has_model) {
+        spdlog::warn("Cannot load {}, box accuracy comparison skipped", model_path);
+    }
+
+    LetterboxPreprocessor preprocessor;
+    std::vector<float> tensor(static_cast<size_t>(3) * target_size.area());
+    ImageLoader full_loader;
+    full_loader.setTargetSize(target_size);
+    full_loader.setReducedDecode(false);
+    ImageLoader reduced_loader;
+    reduced_loader.setTargetSize(target_size);
+    reduced_loader.setReducedDecode(true);
+
+    for (const cv::Size& size : { cv::Size(1920, 1080), cv::Size(3840, 2160) }) {
+        std::vector<uchar> jpeg;
+        cv::imencode(".jpg", makeScene(size), jpeg, { cv::IMWRITE_JPEG_QUALITY, 90 });
+
+        LoadedImage full;
+        LoadedImage reduced;
+        double full_ms = benchmarkMs([&]() {
+            full_loader.decode(jpeg, full);
+            preprocessor.run(full.image, target_size, tensor.data());
+        }, iterations);
+        double reduced_ms = benchmarkMs([&]() {
+            reduced_loader.decode(jpeg, reduced);
+            preprocessor.run(reduced.image, target_size, tensor.data());
+        }, iterations);
+
+        spdlog::info("{}x{} JPEG ({} KB): full decode+preprocess {:.2f} ms, 1/{} decode ({}x{})+preprocess {:.2f} ms ({:.2f}x)",
+                     size.width, size.height, jpeg.size() / 1024, full_ms, reduced.reduction,
+                     reduced.image.cols, reduced.image.rows, reduced_ms, full_ms / reduced_ms);
+
+        if (!has_model) {
+            continue;
+        }
+
+        // 以全分辨率解码的检测结果为参照：同类别IoU最大者匹配，IoU >= 0.5视为召回
+        std::vector<DetectionResult> full_results;
+        std::vector<DetectionResult> reduced_results;
+        detector.detect(full, full_results);
+        detector.detect(reduced, reduced_results);
+        int matched = 0;
+        double iou_sum = 0.0;
+        std::vector<bool> used(reduced_results.size(), false);
+        for (const auto& reference : full_results) {
+            int best = -1;
+            float best_iou = 0.0f;
+            for (size_t j = 0; j < reduced_results.size(); ++j) {
+                if (used[j] || reduced_results[j].class_id != reference.class_id) {
+                    continue;
+                }
+                float value = iou(reference.box, reduced_results[j].box);
+                if (value > best_iou) {
+                    best_iou = value;
+                    best = static_cast<int>(j);
+                }
+            }
+            if (best >= 0 && best_iou >= 0.5f) {
+                used[best] = true;
+                ++matched;
+                iou_sum += best_iou;
+            }
+        }
+        spdlog::info("  boxes: full {}, reduced {}, recall {:.3f}, mean IoU of matches {:.3f}",
+                     full_results.size(), reduced_results.size(),
+                     full_results.empty() ? 1.0 : static_cast<double>(matched) / full_results.size(),
+                     matched > 0 ? iou_sum / matched : 0.0);
+    }
+
+    return 0;
+}
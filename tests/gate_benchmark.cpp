@@ -0,0 +1,150 @@
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+#include "FrameGate.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 帧门控基准：对同一段以静止画面为主的视频，分别逐帧detect与经过FrameGate，比较
+//   - 墙钟时间与进程CPU时间（std::clock，包含ONNX Runtime的所有线程）
+//   - 门控命中率，以及门控结果相对逐帧检测结果的召回率（同类别且IoU >= 0.5）
+// 未给出视频时合成一段固定机位画面：静止背景+传感器噪声，中间有一个目标穿过画面
+// 用法: gate_benchmark [配置文件] [视频路径] [最大帧数，默认300]
+struct RunResult {
+    double wall_s = 0.0;
+    double cpu_s = 0.0;
+    std::vector<std::vector<DetectionResult>> detections;
+};
+
+RunResult measure(const std::vector<cv::Mat>& frames,
+                  const std::function<void(const cv::Mat&, std::vector<DetectionResult>&)>& process) {
+    RunResult result;
+    result.detections.resize(frames.size());
+    std::clock_t cpu_start = std::clock();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames.size(); ++i) {
+        process(frames[i], result.detections[i]);
+    }
+    result.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.cpu_s = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    return result;
+}
+
+std::vector<cv::Mat> synthesizeScene(int count) {
+    cv::Mat background(720, 1280, CV_8UC3);
+    cv::randu(background, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::GaussianBlur(background, background, cv::Size(15, 15), 0);
+    cv::rectangle(background, cv::Rect(0, 500, 1280, 220), cv::Scalar(90, 90, 90), cv::FILLED);
+
+    std::vector<cv::Mat> frames;
+    cv::Mat noise(background.size(), CV_8UC3);
+    int enter = count / 3;
+    int leave = enter + count / 5;
+    for (int i = 0; i < count; ++i) {
+        cv::Mat frame;
+        cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(4));
+        cv::add(background, noise, frame);
+        if (i >= enter && i < leave) {
+            int x = (i - enter) * 1180 / std::max(1, leave - enter);
+            cv::rectangle(frame, cv::Rect(x, 300, 100, 260), cv::Scalar(40, 60, 200), cv::FILLED);
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+double recall(const std::vector<std::vector<DetectionResult>>& reference,
+              const std::vector<std::vector<DetectionResult>>& gated) {
+    size_t total = 0;
+    size_t matched = 0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        for (const auto& expected : reference[i]) {
+            ++total;
+            for (const auto& result : gated[i]) {
+                double intersection = (expected.box & result.box).area();
+                double iou = intersection / (expected.box.area() + result.box.area() - intersection);
+                if (result.class_id == expected.class_id && iou >= 0.5) {
+                    ++matched;
+                    break;
+                }
+            }
+        }
+    }
+    return total > 0 ? static_cast<double>(matched) / total : 1.0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = argc > 1 ? argv[1] : "configs/cpu_config.json";
+    std::string video_path = argc > 2 ? argv[2] : "";
+    int max_frames = argc > 3 ? std::atoi(argv[3]) : 300;
+
+    JsonConfigManager config_manager(config_path);
+    if (!config_manager.loadConfig()) {
+        spdlog::error("Failed to load config: {}", config_path);
+        return 1;
+    }
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    ObjectDetector detector;
+    bool ready = detector.initialize(config_manager);
+    spdlog::set_level(level);
+    if (!ready) {
+        spdlog::error("Failed to initialize detector");
+        return 1;
+    }
+
+    // 先把帧全部解码到内存，两种方式的计时都不包含解码
+    std::vector<cv::Mat> frames;
+    if (!video_path.empty()) {
+        cv::VideoCapture capture(video_path);
+        if (!capture.isOpened()) {
+            spdlog::error("Cannot open video: {}", video_path);
+            return 1;
+        }
+        cv::Mat frame;
+        while (static_cast<int>(frames.size()) < max_frames && capture.read(frame)) {
+            frames.push_back(frame.clone());
+        }
+    } else {
+        frames = synthesizeScene(max_frames);
+    }
+    if (frames.empty()) {
+        spdlog::error("No frames to process");
+        return 1;
+    }
+
+    // 预热
+    std::vector<DetectionResult> warmup;
+    detector.detect(frames[0], warmup);
+
+    RunResult every_frame = measure(frames, [&](const cv::Mat& frame, std::vector<DetectionResult>& results) {
+        detector.detect(frame, results);
+    });
+
+    GateConfig gate_config = config_manager.getGateConfig();
+    FrameGate gate;
+    gate.initialize(detector, gate_config);
+    RunResult gated = measure(frames, [&](const cv::Mat& frame, std::vector<DetectionResult>& results) {
+        gate.process(frame, results);
+    });
+    const GateStats& stats = gate.getStats();
+
+    spdlog::info("Frame gate benchmark: {} frames of {}x{} from {}", frames.size(), frames[0].cols, frames[0].rows,
+                 video_path.empty() ? "a synthetic static scene" : video_path);
+    spdlog::info("{:>12} {:>10} {:>10} {:>12}", "mode", "wall s", "cpu s", "cpu ms/frame");
+    spdlog::info("{:>12} {:>10.2f} {:>10.2f} {:>12.2f}", "every frame", every_frame.wall_s, every_frame.cpu_s,
+                 every_frame.cpu_s * 1000.0 / frames.size());
+    spdlog::info("{:>12} {:>10.2f} {:>10.2f} {:>12.2f}", "gated", gated.wall_s, gated.cpu_s,
+                 gated.cpu_s * 1000.0 / frames.size());
+    spdlog::info("Hit rate {:.1f}% ({} inferred: {} motion, {} stale), CPU saved {:.1f}%, recall {:.3f}",
+                 stats.hitRate() * 100.0, stats.inferred, stats.motion_triggers, stats.stale_refreshes,
+                 every_frame.cpu_s > 0.0 ? (1.0 - gated.cpu_s / every_frame.cpu_s) * 100.0 : 0.0,
+                 recall(every_frame.detections, gated.detections));
+    return 0;
+}
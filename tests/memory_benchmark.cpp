@@ -0,0 +1,100 @@
+#include "DetectorPool.h"
+#include "JsonConfigManager.h"
+#include <opencv2/opencv.hpp>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// 会话内存基准：分别在独立子进程中创建1/4/16个会话并各执行一次检测，报告峰值RSS
+// baseline为改动前的行为（每个会话独立arena、独立预打包权重），shared为共享arena+共享预打包权重
+// 用法: memory_benchmark [配置文件]
+
+static double peakRssMb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+    }
+    return 0.0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);  // macOS以字节为单位
+#else
+    return usage.ru_maxrss / 1024.0;             // Linux以KB为单位
+#endif
+#endif
+}
+
+// 子进程：按指定模式创建sessions个会话，完成一次检测后输出峰值RSS
+static int runChild(const std::string& config_path, int sessions, const std::string& mode) {
+    spdlog::set_level(spdlog::level::warn);
+    JsonConfigManager config_manager(config_path);
+    if (!config_manager.loadConfig()) {
+        return 1;
+    }
+
+    ModelConfig model_config = config_manager.getModelConfig();
+    bool shared = mode == "shared";
+    model_config.share_prepacked_weights = shared;
+    model_config.shared_arena = shared;
+    config_manager.setModelConfig(model_config);
+
+    double before_mb = peakRssMb();
+    DetectorPool pool;
+    if (!pool.initialize(config_manager, sessions)) {
+        return 1;
+    }
+
+    // 每个会话执行一次Run，使arena与内存模式完成分配
+    cv::Mat image(1080, 1920, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    std::vector<DetectorPool::Lease> leases;
+    for (int i = 0; i < sessions; ++i) {
+        leases.push_back(pool.acquire());
+        leases.back()->detect(image);
+    }
+
+    double peak_mb = peakRssMb();
+    spdlog::set_level(spdlog::level::info);
+    spdlog::info("{:>8} {:>9} {:>12.1f} {:>12.1f} {:>14.1f}", mode, sessions, peak_mb,
+                 peak_mb - before_mb, (peak_mb - before_mb) / sessions);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 4 && std::string(argv[1]) == "--child") {
+        return runChild(argv[2], std::atoi(argv[3]), argv[4]);
+    }
+
+    std::string config_path = argc > 1 ? argv[1] : "configs/cpu_config.json";
+    spdlog::info("Session memory benchmark ({})", config_path);
+    spdlog::info("{:>8} {:>9} {:>12} {:>12} {:>14}", "mode", "sessions", "peak MB", "sessions MB", "MB/session");
+
+    // 峰值RSS不会回落，每种组合在独立进程中测量
+    int failures = 0;
+    for (const char* mode : { "baseline", "shared" }) {
+        for (int sessions : { 1, 4, 16 }) {
+            std::string command = std::string("\"") + argv[0] + "\" --child \"" + config_path + "\" " +
+                                  std::to_string(sessions) + " " + mode;
+#ifdef _WIN32
+            // cmd.exe会去掉最外层引号
+            command = "\"" + command + "\"";
+#endif
+            if (std::system(command.c_str()) != 0) {
+                spdlog::error("{} with {} sessions failed", mode, sessions);
+                ++failures;
+            }
+        }
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+#include "NmsEngine.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 原ObjectDetector::nmsBoxes实现（O(n^2)、不区分类别、外接矩形IoU），作为对比基线
+std::vector<int> legacyNmsBoxes(const std::vector<cv::Rect>& boxes, const std::vector<float>& confidences,
+                                float confidence_threshold, float nms_threshold) {
+    std::vector<int> indices;
+    std::vector<int> candidates;
+    for (size_t i = 0; i < confidences.size(); ++i) {
+        if (confidences[i] >= confidence_threshold) {
+            candidates.push_back(static_cast<int>(i));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [&confidences](int a, int b) {
+                  return confidences[a] > confidences[b];
+              });
+    std::vector<bool> suppressed(candidates.size(), false);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (suppressed[i]) continue;
+        int curr_idx = candidates[i];
+        indices.push_back(curr_idx);
+        for (size_t j = i + 1; j < candidates.size(); ++j) {
+            if (suppressed[j]) continue;
+            int next_idx = candidates[j];
+            cv::Rect intersection = boxes[curr_idx] & boxes[next_idx];
+            cv::Rect union_rect = boxes[curr_idx] | boxes[next_idx];
+            float iou = 0.0f;
+            if (union_rect.area() > 0) {
+                iou = static_cast<float>(intersection.area()) / union_rect.area();
+            }
+            if (iou > nms_threshold) {
+                suppressed[j] = true;
+            }
+        }
+    }
+    return indices;
+}
+
+// 生成围绕若干目标中心聚集的候选框，模拟拥挤场景下的低阈值输出
+void makeCandidates(int count, int num_classes, std::mt19937& rng, std::vector<cv::Rect>& boxes,
+                    std::vector<float>& scores, std::vector<int>& class_ids) {
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    int num_objects = std::max(1, count / 20);
+    std::vector<cv::Point> centers;
+    for (int i = 0; i < num_objects; ++i) {
+        centers.emplace_back(static_cast<int>(uniform(rng) * 1920), static_cast<int>(uniform(rng) * 1080));
+    }
+    boxes.clear();
+    scores.clear();
+    class_ids.clear();
+    for (int i = 0; i < count; ++i) {
+        const cv::Point& center = centers[rng() % num_objects];
+        int w = 10 + static_cast<int>(rng() % 120);
+        int h = 10 + static_cast<int>(rng() % 120);
+        int x = center.x + static_cast<int>(uniform(rng) * 30) - 15 - w / 2;
+        int y = center.y + static_cast<int>(uniform(rng) * 30) - 15 - h / 2;
+        boxes.emplace_back(x, y, w, h);
+        scores.push_back(0.35f + 0.65f * uniform(rng));
+        class_ids.push_back(static_cast<int>(rng() % num_classes));
+    }
+}
+
+template <typename Func>
+double benchmarkMs(Func&& func, int iterations) {
+    func();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 5;
+    std::mt19937 rng(42);
+
+    NmsEngine engine;
+    NmsOptions options;
+    options.iou_threshold = 0.45f;
+    options.score_threshold = 0.35f;
+    options.top_k = 0;
+    std::vector<int> keep;
+
+    for (int num_classes : { 1, 80 }) {
+        for (int count : { 1000, 5000, 20000 }) {
+            std::vector<cv::Rect> boxes;
+            std::vector<float> scores;
+            std::vector<int> class_ids;
+            makeCandidates(count, num_classes, rng, boxes, scores, class_ids);
+
+            size_t legacy_kept = 0;
+            double legacy_ms = benchmarkMs([&]() {
+                legacy_kept = legacyNmsBoxes(boxes, scores, options.score_threshold, options.iou_threshold).size();
+            }, iterations);
+
+            options.soft_nms = false;
+            double engine_ms = benchmarkMs([&]() {
+                engine.run(boxes, scores, class_ids, options, keep);
+            }, iterations);
+            size_t engine_kept = keep.size();
+
+            options.soft_nms = true;
+            double soft_ms = benchmarkMs([&]() {
+                engine.run(boxes, scores, class_ids, options, keep);
+            }, iterations);
+
+            spdlog::info("{:>5} candidates, {:>2} classes: legacy {:.3f} ms ({} kept), engine {:.3f} ms ({} kept, {:.1f}x), soft-NMS {:.3f} ms ({} kept)",
+                         count, num_classes, legacy_ms, legacy_kept, engine_ms, engine_kept,
+                         legacy_ms / engine_ms, soft_ms, keep.size());
+        }
+    }
+
+    return 0;
+}
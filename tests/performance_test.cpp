@@ -32,6 +32,57 @@ double runPerformanceTest(ObjectDetector& detector, const cv::Mat& image, int it
     return avg_time;
 }
 
+// 冷启动测试：初始化检测器（含可选的缓存模型加载与预热）并完成第一次检测，报告首次检测耗时
+bool initializeWithTimeToFirstDetection(ObjectDetector& detector, JsonConfigManager& config,
+                                        const cv::Mat& image, const std::string& label) {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!detector.initialize(config)) {
+        return false;
+    }
+    auto initialized = std::chrono::high_resolution_clock::now();
+    detector.detect(image);
+    auto first_detection = std::chrono::high_resolution_clock::now();
+    
+    double initialize_ms = std::chrono::duration<double, std::milli>(initialized - start).count();
+    double first_detect_ms = std::chrono::duration<double, std::milli>(first_detection - initialized).count();
+    spdlog::info("{} time to first detection: {:.2f} ms (initialize {:.2f} ms incl. {} warm-up runs, first detect {:.2f} ms)",
+                 label, initialize_ms + first_detect_ms, initialize_ms,
+                 config.getModelConfig().warmup_runs, first_detect_ms);
+    return true;
+}
+
+// 批量推理吞吐量测试：比较逐张detect循环与detectBatch，返回{逐张, 批量}吞吐量(images/s)
+std::pair<double, double> runBatchThroughputTest(ObjectDetector& detector, const cv::Mat& image,
+                                                 int batch_size, int iterations = 10) {
+    std::vector<cv::Mat> images(batch_size, image);
+    
+    // 预热运行几次
+    for (int i = 0; i < 3; ++i) {
+        detector.detectBatch(images);
+    }
+    
+    // 逐张推理
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (const auto& img : images) {
+            detector.detect(img);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double loop_seconds = std::chrono::duration<double>(end - start).count();
+    
+    // 批量推理
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        detector.detectBatch(images);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double batch_seconds = std::chrono::duration<double>(end - start).count();
+    
+    double total_images = static_cast<double>(batch_size) * iterations;
+    return { total_images / loop_seconds, total_images / batch_seconds };
+}
+
 int main(int argc, char* argv[]) {
     // 初始化日志
     try {
@@ -54,40 +105,53 @@ int main(int argc, char* argv[]) {
     
     spdlog::info("Starting performance test");
     
-    if (argc < 2) {
-        spdlog::error("Usage: {} <image_path> [model_path]", argv[0]);
-        return -1;
+    // 用法: performance_test [image_path] [--cpu-config path] [--gpu-config path]
+    // 未提供图像时使用生成的1080p图像；只有显式提供--gpu-config时才测试GPU
+    std::string image_path;
+    std::string cpu_config_path = "configs/cpu_config.json";
+    std::string gpu_config_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--cpu-config" && i + 1 < argc) {
+            cpu_config_path = argv[++i];
+        } else if (arg == "--gpu-config" && i + 1 < argc) {
+            gpu_config_path = argv[++i];
+        } else if (image_path.empty() && arg.rfind("--", 0) != 0) {
+            image_path = arg;
+        } else {
+            spdlog::error("Usage: {} [image_path] [--cpu-config path] [--gpu-config path]", argv[0]);
+            return -1;
+        }
     }
     
-    std::string image_path = argv[1];
-    cv::Mat image = cv::imread(image_path);
-    
-    if (image.empty()) {
-        spdlog::error("Cannot load image: {}", image_path);
-        return -1;
+    cv::Mat image;
+    if (image_path.empty()) {
+        image = cv::Mat(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+        cv::RNG rng(0);
+        for (int i = 0; i < 20; ++i) {
+            cv::Rect rect(rng.uniform(0, 1600), rng.uniform(0, 800), rng.uniform(40, 320), rng.uniform(40, 280));
+            cv::rectangle(image, rect, cv::Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), cv::FILLED);
+        }
+        spdlog::info("No image given, using a generated {}x{} image", image.cols, image.rows);
+    } else {
+        image = cv::imread(image_path);
+        if (image.empty()) {
+            spdlog::error("Cannot load image: {}", image_path);
+            return -1;
+        }
+        spdlog::info("Image loaded successfully. Size: {}x{}", image.cols, image.rows);
     }
     
-    spdlog::info("Image loaded successfully. Size: {}x{}", image.cols, image.rows);
-    
     // 测试CPU推理性能
-    spdlog::info("Testing CPU inference performance...");
-    // 尝试不同的配置文件路径
-    //std::string cpu_config_path = "../configs/cpu_config.json";
-    std::string cpu_config_path = "cpu_config.json";
+    spdlog::info("Testing CPU inference performance ({})...", cpu_config_path);
     JsonConfigManager cpu_config(cpu_config_path);
     if (!cpu_config.loadConfig()) {
-        // 如果相对路径失败，尝试绝对路径
-        cpu_config_path = "D:/zxlong/workspace/pro/YoloV8Infer/configs/cpu_config.json";
-        JsonConfigManager cpu_config_abs(cpu_config_path);
-        if (!cpu_config_abs.loadConfig()) {
-            spdlog::error("Failed to load CPU configuration file from both relative and absolute paths");
-            return -1;
-        }
-        cpu_config = std::move(cpu_config_abs);
+        spdlog::error("Failed to load CPU configuration file: {}", cpu_config_path);
+        return -1;
     }
     
     ObjectDetector cpu_detector;
-    if (!cpu_detector.initialize(cpu_config)) {
+    if (!initializeWithTimeToFirstDetection(cpu_detector, cpu_config, image, "CPU")) {
         spdlog::error("Failed to initialize CPU detector");
         return -1;
     }
@@ -95,25 +159,27 @@ int main(int argc, char* argv[]) {
     double cpu_avg_time = runPerformanceTest(cpu_detector, image, 20);
     spdlog::info("CPU Average inference time over 20 runs: {:.2f} ms", cpu_avg_time);
     
+    // 测试CPU批量推理吞吐量
+    int batch_size = cpu_config.getModelConfig().max_batch_size;
+    spdlog::info("Testing CPU batch throughput (batch size {})...", batch_size);
+    auto [loop_fps, batch_fps] = runBatchThroughputTest(cpu_detector, image, batch_size);
+    spdlog::info("CPU per-image loop: {:.2f} images/s", loop_fps);
+    spdlog::info("CPU detectBatch:    {:.2f} images/s ({:.2f}x)", batch_fps, batch_fps / loop_fps);
+    
+    if (gpu_config_path.empty()) {
+        return 0;
+    }
+    
     // 测试GPU推理性能
-    spdlog::info("Testing GPU inference performance...");
-    // 尝试不同的配置文件路径
-    //std::string gpu_config_path = "../configs/gpu_config.json";
-    std::string gpu_config_path = "gpu_config.json";
+    spdlog::info("Testing GPU inference performance ({})...", gpu_config_path);
     JsonConfigManager gpu_config(gpu_config_path);
     if (!gpu_config.loadConfig()) {
-        // 如果相对路径失败，尝试绝对路径
-        gpu_config_path = "D:/zxlong/workspace/pro/YoloV8Infer/configs/gpu_config.json";
-        JsonConfigManager gpu_config_abs(gpu_config_path);
-        if (!gpu_config_abs.loadConfig()) {
-            spdlog::error("Failed to load GPU configuration file from both relative and absolute paths");
-            return -1;
-        }
-        gpu_config = std::move(gpu_config_abs);
+        spdlog::error("Failed to load GPU configuration file: {}", gpu_config_path);
+        return -1;
     }
     
     ObjectDetector gpu_detector;
-    if (!gpu_detector.initialize(gpu_config)) {
+    if (!initializeWithTimeToFirstDetection(gpu_detector, gpu_config, image, "GPU")) {
         spdlog::error("Failed to initialize GPU detector");
         return -1;
     }
@@ -0,0 +1,122 @@
+#include "DetectorPool.h"
+#include "JsonConfigManager.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 多线程吞吐量基准：扫描 调用线程数 × 会话数 × 算子内线程数
+// 用法: pool_benchmark [配置文件] [每个调用线程的帧数]
+struct SweepResult {
+    double images_per_second = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+};
+
+SweepResult runCallers(DetectorPool& pool, const cv::Mat& image, int callers, int frames_per_caller) {
+    std::vector<std::vector<double>> latencies(callers);
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+
+    for (int c = 0; c < callers; ++c) {
+        threads.emplace_back([&, c]() {
+            std::vector<DetectionResult> results;
+            latencies[c].reserve(frames_per_caller);
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < frames_per_caller; ++i) {
+                auto start = std::chrono::high_resolution_clock::now();
+                pool.detect(image, results);
+                auto end = std::chrono::high_resolution_clock::now();
+                latencies[c].push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+        });
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    go.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::vector<double> all;
+    for (const auto& caller_latencies : latencies) {
+        all.insert(all.end(), caller_latencies.begin(), caller_latencies.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    SweepResult result;
+    double seconds = std::chrono::duration<double>(end - start).count();
+    result.images_per_second = all.size() / seconds;
+    result.p50_ms = all[all.size() / 2];
+    result.p99_ms = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = argc > 1 ? argv[1] : "configs/cpu_config.json";
+    int frames_per_caller = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    JsonConfigManager config_manager(config_path);
+    if (!config_manager.loadConfig()) {
+        spdlog::error("Failed to load config: {}", config_path);
+        return 1;
+    }
+
+    cv::Mat image(1080, 1920, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> session_counts;
+    std::vector<int> intra_counts;
+    std::vector<int> caller_counts;
+    for (int n = 1; n <= cores; n *= 2) {
+        session_counts.push_back(n);
+        caller_counts.push_back(n);
+    }
+    for (int n = 1; n <= std::min(cores, 4); n *= 2) {
+        intra_counts.push_back(n);
+    }
+    caller_counts.push_back(cores * 2);
+
+    spdlog::info("Pool benchmark: {} cores, {} frames per caller, global thread pools: {}",
+                 cores, frames_per_caller, config_manager.getPoolConfig().global_thread_pools ? "yes" : "no");
+    spdlog::info("{:>8} {:>6} {:>8} {:>10} {:>9} {:>9}", "sessions", "intra", "callers", "images/s", "p50 ms", "p99 ms");
+
+    for (int intra : intra_counts) {
+        for (int sessions : session_counts) {
+            ModelConfig model_config = config_manager.getModelConfig();
+            model_config.intra_op_threads = intra;
+            config_manager.setModelConfig(model_config);
+
+            // 初始化与逐帧日志不计入结果
+            auto level = spdlog::get_level();
+            spdlog::set_level(spdlog::level::warn);
+            DetectorPool pool;
+            if (!pool.initialize(config_manager, sessions)) {
+                spdlog::set_level(level);
+                spdlog::error("Failed to initialize pool with {} sessions", sessions);
+                return 1;
+            }
+            runCallers(pool, image, sessions, 2);
+
+            std::vector<std::pair<int, SweepResult>> results;
+            for (int callers : caller_counts) {
+                results.emplace_back(callers, runCallers(pool, image, callers, frames_per_caller));
+            }
+            spdlog::set_level(level);
+
+            for (const auto& [callers, result] : results) {
+                spdlog::info("{:>8} {:>6} {:>8} {:>10.1f} {:>9.2f} {:>9.2f}", sessions, intra, callers,
+                             result.images_per_second, result.p50_ms, result.p99_ms);
+            }
+        }
+    }
+
+    return 0;
+}
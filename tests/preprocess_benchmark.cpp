@@ -0,0 +1,53 @@
+#include "ObjectDetector.h"
+#include "LetterboxPreprocessor.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <chrono>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 预处理微基准：比较 letterboxResize + blobFromImage 与融合预处理内核
+template <typename Func>
+double benchmarkMs(Func&& func, int iterations) {
+    for (int i = 0; i < 3; ++i) {
+        func();
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100;
+    const cv::Size target_size(640, 640);
+
+    ObjectDetector detector;
+    LetterboxPreprocessor preprocessor;
+    std::vector<float> tensor(static_cast<size_t>(3) * target_size.area());
+
+    const std::vector<cv::Size> source_sizes = { {1280, 720}, {1920, 1080}, {3840, 2160} };
+    for (const auto& source_size : source_sizes) {
+        cv::Mat image(source_size, CV_8UC3);
+        cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+
+        double reference_ms = benchmarkMs([&]() {
+            cv::Mat letterbox_image = detector.letterboxResize(image, target_size);
+            cv::Mat blob;
+            cv::dnn::blobFromImage(letterbox_image, blob, 1.0 / 255.0, cv::Size(),
+                cv::Scalar(0, 0, 0), true, false);
+        }, iterations);
+
+        double fused_ms = benchmarkMs([&]() {
+            preprocessor.run(image, target_size, tensor.data());
+        }, iterations);
+
+        spdlog::info("{}x{} -> {}x{}: letterbox+blob {:.3f} ms, fused {:.3f} ms ({:.2f}x)",
+                     source_size.width, source_size.height, target_size.width, target_size.height,
+                     reference_ms, fused_ms, reference_ms / fused_ms);
+    }
+
+    return 0;
+}
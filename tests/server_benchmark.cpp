@@ -0,0 +1,189 @@
+#include "InferenceServer.h"
+#include "InferenceClient.h"
+#include "DetectorPool.h"
+#include "JsonConfigManager.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 推理服务负载生成器：进程内启动InferenceServer，多个客户端经本机socket并发发送请求，
+// 扫描 最大批大小 × 最大排队延迟，输出吞吐量、延迟分位数与平均批大小
+// 每个客户端保持max_pending_per_client个请求在途（收到一个响应就发送下一个）
+// 用法: server_benchmark [配置文件] [客户端数] [每客户端请求数] [raw|jpeg]
+struct LoadResult {
+    double requests_per_second = 0.0;
+    double p50_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+    double mean_batch = 0.0;
+    uint64_t busy = 0;
+};
+
+bool runClient(const ServerConfig& config, const cv::Mat& image, const std::vector<uchar>& encoded,
+               int requests, std::atomic<bool>& go, std::vector<double>& latencies) {
+    InferenceClient client;
+    if (!client.connect(config.socket_path, config.port)) {
+        return false;
+    }
+    latencies.reserve(requests);
+    std::unordered_map<uint32_t, std::chrono::steady_clock::time_point> sent_at;
+    std::vector<DetectionResult> results;
+    uint32_t next_id = 1;
+    int received = 0;
+
+    auto sendNext = [&]() {
+        uint32_t id = next_id++;
+        sent_at[id] = std::chrono::steady_clock::now();
+        return encoded.empty() ? client.send(id, image) : client.sendEncoded(id, encoded);
+    };
+
+    while (!go.load()) {
+        std::this_thread::yield();
+    }
+    int window = std::min(requests, std::max(1, config.max_pending_per_client));
+    for (int i = 0; i < window; ++i) {
+        if (!sendNext()) {
+            return false;
+        }
+    }
+    while (received < requests) {
+        uint32_t id = 0;
+        inference_protocol::ResponseStatus status;
+        if (!client.receive(id, status, results)) {
+            return false;
+        }
+        auto it = sent_at.find(id);
+        if (it != sent_at.end()) {
+            latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - it->second).count());
+            sent_at.erase(it);
+        }
+        ++received;
+        if (static_cast<int>(next_id) <= requests && !sendNext()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runLoad(DetectorPool& pool, const ServerConfig& config, const cv::Mat& image, const std::vector<uchar>& encoded,
+             int clients, int requests_per_client, LoadResult& result) {
+    InferenceServer server;
+    if (!server.initialize(pool, config) || !server.start()) {
+        return false;
+    }
+
+    std::vector<std::vector<double>> latencies(clients);
+    std::atomic<bool> go{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c]() {
+            if (!runClient(config, image, encoded, requests_per_client, go, latencies[c])) {
+                ++failures;
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ServerStats stats = server.getStats();
+    server.stop();
+
+    std::vector<double> all;
+    for (const auto& client_latencies : latencies) {
+        all.insert(all.end(), client_latencies.begin(), client_latencies.end());
+    }
+    if (failures > 0 || all.empty()) {
+        spdlog::error("{} clients failed", failures.load());
+        return false;
+    }
+    std::sort(all.begin(), all.end());
+    auto quantile = [&all](double q) { return all[std::min(all.size() - 1, static_cast<size_t>(all.size() * q))]; };
+
+    result.requests_per_second = all.size() / seconds;
+    result.p50_ms = quantile(0.50);
+    result.p95_ms = quantile(0.95);
+    result.p99_ms = quantile(0.99);
+    result.mean_batch = stats.meanBatchSize();
+    result.busy = stats.busy;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = argc > 1 ? argv[1] : "configs/cpu_config.json";
+    int clients = argc > 2 ? std::atoi(argv[2]) : 8;
+    int requests_per_client = argc > 3 ? std::atoi(argv[3]) : 50;
+    bool use_jpeg = argc > 4 && std::string(argv[4]) == "jpeg";
+
+    JsonConfigManager config_manager(config_path);
+    if (!config_manager.loadConfig()) {
+        spdlog::error("Failed to load config: {}", config_path);
+        return 1;
+    }
+
+    cv::Mat image(720, 1280, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    std::vector<uchar> encoded;
+    if (use_jpeg) {
+        cv::imencode(".jpg", image, encoded);
+    }
+
+    const std::vector<int> batch_sizes = {1, 2, 4, 8};
+    const std::vector<float> delays_ms = {0.0f, 1.0f, 2.0f, 5.0f};
+    ServerConfig base_config = config_manager.getServerConfig();
+
+    // 模型的批大小上限取扫描中的最大值，所有组合共用同一个检测器池
+    ModelConfig model_config = config_manager.getModelConfig();
+    model_config.max_batch_size = std::max(model_config.max_batch_size, batch_sizes.back());
+    config_manager.setModelConfig(model_config);
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    DetectorPool pool;
+    if (!pool.initialize(config_manager, std::max(1, base_config.sessions))) {
+        spdlog::set_level(level);
+        spdlog::error("Failed to initialize detector pool");
+        return 1;
+    }
+    spdlog::set_level(level);
+
+    spdlog::info("Server benchmark: {} clients x {} requests, {} sessions, {} pending per client, {} payload",
+                 clients, requests_per_client, pool.size(), base_config.max_pending_per_client,
+                 use_jpeg ? "jpeg" : "raw");
+    spdlog::info("{:>6} {:>9} {:>10} {:>9} {:>9} {:>9} {:>10} {:>6}", "batch", "delay ms", "req/s",
+                 "p50 ms", "p95 ms", "p99 ms", "mean batch", "busy");
+
+    for (int batch_size : batch_sizes) {
+        for (float delay_ms : delays_ms) {
+            ServerConfig config = base_config;
+            config.max_batch_size = batch_size;
+            config.max_queue_delay_ms = delay_ms;
+
+            LoadResult result;
+            spdlog::set_level(spdlog::level::warn);
+            // 预热：第一次遇到该批大小时ORT会分配新形状的内存
+            bool ok = runLoad(pool, config, image, encoded, clients, 2, result) &&
+                      runLoad(pool, config, image, encoded, clients, requests_per_client, result);
+            spdlog::set_level(level);
+            if (!ok) {
+                spdlog::error("Load run failed (batch {}, delay {} ms)", batch_size, delay_ms);
+                return 1;
+            }
+            spdlog::info("{:>6} {:>9.1f} {:>10.1f} {:>9.2f} {:>9.2f} {:>9.2f} {:>10.2f} {:>6}", batch_size, delay_ms,
+                         result.requests_per_second, result.p50_ms, result.p95_ms, result.p99_ms,
+                         result.mean_batch, result.busy);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "ShardedRunner.h"
+#include "NumaTopology.h"
+#include "JsonConfigManager.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 多实例分片扩展性基准：实例数从1逐个增加到核组总数，每个实例数下测量总吞吐，
+// 报告相对单实例的加速比、并行效率，以及吞吐不再明显增长的饱和点。
+// 实例按节点轮流放置（2个节点时实例数为2即每节点一个），因此前几档同时反映跨节点扩展。
+// 单NUMA节点的机器上按节点分组只有一个实例，此时自动改为按model.intra_op_threads个核切分核组；
+// 最后一档额外关闭线程绑定测一次，对比绑定与否的差别。
+// 用法: shard_benchmark [配置文件] [每实例核数，0按NUMA节点] [每实例每轮帧数，默认50]
+struct ScalePoint {
+    int instances = 0;
+    bool pinned = true;
+    double fps = 0.0;
+};
+
+// 每轮提交frames帧，submit在各实例队列满时阻塞，返回每秒完成的帧数
+bool measure(JsonConfigManager& config_manager, const std::vector<cv::Mat>& images, int frames,
+             ScalePoint& point) {
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    ShardedRunner runner;
+    bool ready = runner.initialize(config_manager);
+    spdlog::set_level(level);
+    if (!ready) {
+        return false;
+    }
+
+    // 预热：每个实例至少执行两帧
+    for (int i = 0; i < 2 * runner.size(); ++i) {
+        runner.submit(images[i % images.size()], nullptr);
+    }
+    runner.waitIdle();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        runner.submit(images[i % images.size()], nullptr);
+    }
+    runner.waitIdle();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    point.instances = runner.size();
+    point.fps = seconds > 0.0 ? frames / seconds : 0.0;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = argc > 1 ? argv[1] : "configs/cpu_config.json";
+    int cores_per_instance = argc > 2 ? std::atoi(argv[2]) : 0;
+    int frames_per_instance = argc > 3 ? std::max(1, std::atoi(argv[3])) : 50;
+
+    JsonConfigManager config_manager(config_path);
+    if (!config_manager.loadConfig()) {
+        spdlog::error("Failed to load config: {}", config_path);
+        return 1;
+    }
+
+    std::vector<CoreGroup> nodes = NumaTopology::discover();
+    for (const CoreGroup& node : nodes) {
+        spdlog::info("NUMA node {}: {} CPUs ({})", node.node, node.cpus.size(),
+                     NumaTopology::formatCpuList(node.cpus));
+    }
+
+    ShardConfig shard_config = config_manager.getShardConfig();
+    if (cores_per_instance > 0) {
+        shard_config.group_by = "cores";
+        shard_config.cores_per_instance = cores_per_instance;
+    } else if (nodes.size() == 1) {
+        shard_config.group_by = "cores";
+        shard_config.cores_per_instance = std::max(1, config_manager.getModelConfig().intra_op_threads);
+        spdlog::info("Single NUMA node: scaling over groups of {} cores instead", shard_config.cores_per_instance);
+    } else {
+        shard_config.group_by = "node";
+        shard_config.cores_per_instance = 0;
+    }
+    int group_count = static_cast<int>(NumaTopology::split(
+        nodes, shard_config.group_by == "cores" ? shard_config.cores_per_instance : 0).size());
+    shard_config.balance = "least_outstanding";
+
+    // 几张不同内容的合成图像轮流提交
+    cv::RNG rng(7);
+    std::vector<cv::Mat> images;
+    for (int i = 0; i < 4; ++i) {
+        cv::Mat image(720, 1280, CV_8UC3);
+        cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+        cv::GaussianBlur(image, image, cv::Size(9, 9), 0);
+        for (int j = 0; j < 3; ++j) {
+            cv::rectangle(image, cv::Rect(rng.uniform(0, 1000), rng.uniform(0, 500), rng.uniform(80, 280),
+                                          rng.uniform(80, 220)),
+                          cv::Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), cv::FILLED);
+        }
+        images.push_back(image);
+    }
+
+    std::vector<ScalePoint> points;
+    for (int instances = 1; instances <= group_count; ++instances) {
+        shard_config.max_instances = instances;
+        shard_config.pin_threads = true;
+        config_manager.setShardConfig(shard_config);
+        ScalePoint point;
+        if (!measure(config_manager, images, frames_per_instance * instances, point)) {
+            spdlog::error("Failed to start {} instance(s)", instances);
+            return 1;
+        }
+        points.push_back(point);
+    }
+    if (group_count > 1) {
+        shard_config.max_instances = group_count;
+        shard_config.pin_threads = false;
+        config_manager.setShardConfig(shard_config);
+        ScalePoint point;
+        if (measure(config_manager, images, frames_per_instance * group_count, point)) {
+            point.pinned = false;
+            points.push_back(point);
+        }
+    }
+
+    spdlog::info("Sharded runner scaling: {} node(s), {} group(s) by {}, {} frames per instance",
+                 nodes.size(), group_count, shard_config.group_by, frames_per_instance);
+    spdlog::info("{:>10} {:>8} {:>10} {:>8} {:>11}", "instances", "pinned", "fps", "speedup", "efficiency");
+    double base_fps = points.front().fps;
+    for (const ScalePoint& point : points) {
+        double speedup = base_fps > 0.0 ? point.fps / base_fps : 0.0;
+        spdlog::info("{:>10} {:>8} {:>10.1f} {:>7.2f}x {:>10.1f}%", point.instances, point.pinned ? "yes" : "no",
+                     point.fps, speedup, speedup / point.instances * 100.0);
+    }
+
+    // 饱和点：再增加一个实例吞吐提升不足5%的第一档
+    int saturation = 0;
+    for (size_t i = 1; i < points.size() && points[i].pinned; ++i) {
+        if (points[i].fps < points[i - 1].fps * 1.05) {
+            saturation = points[i - 1].instances;
+            break;
+        }
+    }
+    if (saturation > 0) {
+        spdlog::info("Throughput saturates at {} instance(s)", saturation);
+    } else {
+        spdlog::info("No saturation within {} instance(s)", group_count);
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+#include "FrameRing.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 帧交接基准：生产线程模拟解码进程产出1280x720 BGR帧，检测线程取帧后处理，比较
+//   - 共享内存帧环：帧直接写入槽位，检测方把槽位包装为cv::Mat，无编解码与拷贝
+//   - 文件交接：生产方imwrite编码写盘，检测方imread读回解码（现有解码进程的做法）
+// 分别测量 只交接+letterbox 与 交接+完整detect 两种负载下的帧率
+// 用法: shm_benchmark [配置文件] [帧数] [文件格式，默认jpg]
+using FrameConsumer = std::function<void(const cv::Mat&)>;
+
+// 生产线程与消费线程并行运行，返回消费方的帧率
+double runRing(const ShmRingConfig& config, const cv::Mat& source, int frames, const FrameConsumer& consume) {
+    FrameRingReader reader;
+    if (!reader.create(config)) {
+        return 0.0;
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&]() {
+        FrameRingWriter writer;
+        if (!writer.open(config.name)) {
+            return;
+        }
+        for (int i = 0; i < frames; ++i) {
+            // 解码器直接输出到槽位，这里以复制源帧代替解码
+            cv::Mat slot;
+            if (!writer.beginFrame(source.cols, source.rows, slot)) {
+                break;
+            }
+            source.copyTo(slot);
+            writer.commitFrame(i);
+        }
+        writer.close();
+    });
+
+    cv::Mat frame;
+    uint64_t frame_id = 0;
+    int consumed = 0;
+    while (reader.nextFrame(frame, frame_id, 5000)) {
+        consume(frame);
+        ++consumed;
+    }
+    producer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return consumed / seconds;
+}
+
+double runFiles(const std::filesystem::path& directory, const std::string& extension, const cv::Mat& source,
+                int frames, const FrameConsumer& consume) {
+    std::filesystem::create_directories(directory);
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::string> paths;
+    bool finished = false;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&]() {
+        for (int i = 0; i < frames; ++i) {
+            std::string path = (directory / ("frame_" + std::to_string(i) + "." + extension)).string();
+            cv::imwrite(path, source);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                paths.push_back(path);
+            }
+            ready.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        ready.notify_one();
+    });
+
+    int consumed = 0;
+    while (true) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&]() { return finished || !paths.empty(); });
+            if (paths.empty()) {
+                break;
+            }
+            path = paths.front();
+            paths.pop_front();
+        }
+        cv::Mat frame = cv::imread(path, cv::IMREAD_COLOR);
+        std::filesystem::remove(path);
+        if (!frame.empty()) {
+            consume(frame);
+            ++consumed;
+        }
+    }
+    producer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return consumed / seconds;
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = argc > 1 ? argv[1] : "configs/cpu_config.json";
+    int frames = argc > 2 ? std::atoi(argv[2]) : 300;
+    std::string extension = argc > 3 ? argv[3] : "jpg";
+
+    JsonConfigManager config_manager(config_path);
+    if (!config_manager.loadConfig()) {
+        spdlog::error("Failed to load config: {}", config_path);
+        return 1;
+    }
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    ObjectDetector detector;
+    bool detector_ready = detector.initialize(config_manager);
+    spdlog::set_level(level);
+    if (!detector_ready) {
+        spdlog::warn("Detector could not be initialized, only the letterbox workload is measured");
+    }
+
+    // 带纹理的合成帧，使JPEG/PNG编码代价接近真实画面
+    cv::Mat source(720, 1280, CV_8UC3);
+    cv::randu(source, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::GaussianBlur(source, source, cv::Size(7, 7), 0);
+
+    ShmRingConfig ring_config = config_manager.getShmRingConfig();
+    ring_config.name = "yolov8infer_shm_benchmark";
+    ring_config.max_width = std::max(ring_config.max_width, source.cols);
+    ring_config.max_height = std::max(ring_config.max_height, source.rows);
+    ring_config.overflow = "block";
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "yolov8infer_handoff";
+
+    const ModelConfig& model_config = config_manager.getModelConfig();
+    cv::Size input_size(model_config.input_width, model_config.input_height);
+    cv::Mat letterboxed;
+    std::vector<std::pair<std::string, FrameConsumer>> workloads;
+    workloads.emplace_back("letterbox", [&](const cv::Mat& frame) {
+        letterboxed = detector.letterboxResize(frame, input_size, cv::Scalar(114, 114, 114));
+    });
+    if (detector_ready) {
+        workloads.emplace_back("detect", [&](const cv::Mat& frame) {
+            std::vector<DetectionResult> results;
+            detector.detect(frame, results);
+        });
+    }
+
+    spdlog::info("Frame handoff benchmark: {} frames of {}x{}, ring of {} slots vs .{} files in {}", frames,
+                 source.cols, source.rows, ring_config.slots, extension, directory.string());
+    spdlog::info("{:>10} {:>12} {:>12} {:>9}", "workload", "ring fps", "file fps", "speedup");
+    for (const auto& [name, consume] : workloads) {
+        // 预热（模型首次Run、磁盘缓存）
+        runRing(ring_config, source, 5, consume);
+        double ring_fps = runRing(ring_config, source, frames, consume);
+        double file_fps = runFiles(directory, extension, source, frames, consume);
+        spdlog::info("{:>10} {:>12.1f} {:>12.1f} {:>8.2f}x", name, ring_fps, file_fps,
+                     file_fps > 0.0 ? ring_fps / file_fps : 0.0);
+    }
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,491 @@
+#include "ObjectDetector.h"
+#include "LetterboxPreprocessor.h"
+#include "OutputDecoder.h"
+#include "NmsEngine.h"
+#include "SimdDispatch.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+// 分阶段基准套件：letterbox、blob转换、Run、输出解码、NMS分别计时，
+// 输出p50/p95/p99、每次迭代的堆分配次数与吞吐量的JSON，便于在提交之间跟踪回归。
+// 只使用CPU，输入为生成的图像、tests/data中的微型模型以及候选密度可控的合成输出张量。
+//
+// 用法: stage_benchmark [--json 文件] [--filter 子串] [--min-time-ms 毫秒] [--model 模型路径] [--model-u8 模型路径]
+//                       [--model-end2end 模型路径]
+
+#ifndef YOLO_TEST_DATA_DIR
+#define YOLO_TEST_DATA_DIR "tests/data"
+#endif
+
+// 统计堆分配次数（cv::Mat每次分配都会new一个UMatData，因此也会被计入）
+static std::atomic<size_t> g_allocation_count{0};
+
+void* operator new(std::size_t size) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+struct BenchmarkOptions {
+    std::string json_path;
+    std::string filter;
+    std::string model_path = std::string(YOLO_TEST_DATA_DIR) + "/tiny_yolov8.onnx";
+    // 预处理并入模型图的uint8 NHWC版本（tools/fold_preprocess.py生成），为空时跳过
+    std::string model_u8_path = std::string(YOLO_TEST_DATA_DIR) + "/tiny_yolov8_u8.onnx";
+    // 图内TopK/NMS的端到端版本（tools/export_end2end.py生成），为空时跳过
+    std::string model_end2end_path = std::string(YOLO_TEST_DATA_DIR) + "/tiny_yolov8_end2end.onnx";
+    double min_time_ms = 500.0;
+    int min_iterations = 10;
+    int max_iterations = 100000;
+};
+
+class BenchmarkSuite {
+public:
+    explicit BenchmarkSuite(const BenchmarkOptions& options) : options_(options) {}
+
+    // 预热后重复执行func，直到累计时间和次数都达到下限，返回每秒次数（被过滤时为0）
+    template <typename Func>
+    double run(const std::string& name, Func&& func, const nlohmann::json& params = nlohmann::json::object()) {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) {
+            return 0.0;
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            func();
+        }
+
+        std::vector<double> samples;
+        samples.reserve(1024);
+        double total_ms = 0.0;
+        size_t allocations_before = g_allocation_count.load(std::memory_order_relaxed);
+        while ((total_ms < options_.min_time_ms || static_cast<int>(samples.size()) < options_.min_iterations) &&
+               static_cast<int>(samples.size()) < options_.max_iterations) {
+            auto start = std::chrono::high_resolution_clock::now();
+            func();
+            auto end = std::chrono::high_resolution_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            samples.push_back(ms);
+            total_ms += ms;
+        }
+        size_t allocations = g_allocation_count.load(std::memory_order_relaxed) - allocations_before;
+        // samples自身的扩容不计入被测函数
+        size_t iterations = samples.size();
+
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&samples](double p) {
+            size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * (samples.size() - 1) + 0.5));
+            return samples[index];
+        };
+
+        nlohmann::json result;
+        result["name"] = name;
+        result["params"] = params;
+        result["iterations"] = iterations;
+        result["mean_ms"] = total_ms / iterations;
+        result["min_ms"] = samples.front();
+        result["p50_ms"] = percentile(0.50);
+        result["p95_ms"] = percentile(0.95);
+        result["p99_ms"] = percentile(0.99);
+        result["allocations_per_iteration"] = static_cast<double>(allocations) / iterations;
+        result["throughput_per_s"] = 1000.0 * iterations / total_ms;
+        results_.push_back(result);
+
+        spdlog::info("{:<44} p50 {:>9.3f} ms  p99 {:>9.3f} ms  {:>10.1f}/s  {:>7.1f} allocs/iter",
+                     name, result["p50_ms"].get<double>(), result["p99_ms"].get<double>(),
+                     result["throughput_per_s"].get<double>(), result["allocations_per_iteration"].get<double>());
+        return result["throughput_per_s"].get<double>();
+    }
+
+    nlohmann::json toJson() const {
+        nlohmann::json context;
+        context["opencv_version"] = CV_VERSION;
+        context["onnxruntime_version"] = Ort::GetVersionString();
+        context["opencv_threads"] = cv::getNumThreads();
+        context["simd"] = SimdDispatch::name(SimdDispatch::level());
+        context["min_time_ms"] = options_.min_time_ms;
+
+        nlohmann::json root;
+        root["context"] = context;
+        root["benchmarks"] = results_;
+        return root;
+    }
+
+private:
+    BenchmarkOptions options_;
+    std::vector<nlohmann::json> results_;
+};
+
+// 生成带若干彩色矩形的图像（纯噪声图像经池化后几乎不产生候选）
+cv::Mat makeSceneImage(const cv::Size& size, int num_objects, std::mt19937& rng) {
+    cv::Mat image(size, CV_8UC3, cv::Scalar(0, 0, 0));
+    std::uniform_int_distribution<int> color(0, 255);
+    for (int i = 0; i < num_objects; ++i) {
+        int w = 20 + static_cast<int>(rng() % std::max(1, size.width / 4));
+        int h = 20 + static_cast<int>(rng() % std::max(1, size.height / 4));
+        int x = static_cast<int>(rng() % std::max(1, size.width - w));
+        int y = static_cast<int>(rng() % std::max(1, size.height - h));
+        cv::rectangle(image, cv::Rect(x, y, w, h), cv::Scalar(color(rng), color(rng), color(rng)), cv::FILLED);
+    }
+    return image;
+}
+
+// 合成[4+C, N]输出：density比例的anchor有一个类别分数超过阈值，
+// 候选框聚集在若干目标周围以模拟NMS的真实负载，其余anchor为低分背景
+std::vector<float> makeSyntheticOutput(int num_classes, int num_anchors, double density, std::mt19937& rng) {
+    std::vector<float> output(static_cast<size_t>(4 + num_classes) * num_anchors);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    int num_candidates = std::max(1, static_cast<int>(num_anchors * density));
+    int num_objects = std::max(1, num_candidates / 20);
+    std::vector<cv::Point2f> centers;
+    for (int i = 0; i < num_objects; ++i) {
+        centers.emplace_back(32.0f + uniform(rng) * 576.0f, 32.0f + uniform(rng) * 576.0f);
+    }
+
+    for (int a = 0; a < num_anchors; ++a) {
+        const cv::Point2f& center = centers[rng() % num_objects];
+        output[0 * static_cast<size_t>(num_anchors) + a] = center.x + (uniform(rng) - 0.5f) * 16.0f;
+        output[1 * static_cast<size_t>(num_anchors) + a] = center.y + (uniform(rng) - 0.5f) * 16.0f;
+        output[2 * static_cast<size_t>(num_anchors) + a] = 20.0f + uniform(rng) * 60.0f;
+        output[3 * static_cast<size_t>(num_anchors) + a] = 20.0f + uniform(rng) * 60.0f;
+        for (int c = 0; c < num_classes; ++c) {
+            output[(4 + c) * static_cast<size_t>(num_anchors) + a] = uniform(rng) * 0.3f;
+        }
+    }
+    // 随机挑选num_candidates个anchor提升为候选
+    std::vector<int> anchors(num_anchors);
+    for (int a = 0; a < num_anchors; ++a) {
+        anchors[a] = a;
+    }
+    std::shuffle(anchors.begin(), anchors.end(), rng);
+    for (int i = 0; i < std::min(num_candidates, num_anchors); ++i) {
+        int a = anchors[i];
+        int c = static_cast<int>(rng() % num_classes);
+        output[(4 + c) * static_cast<size_t>(num_anchors) + a] = 0.4f + 0.6f * uniform(rng);
+    }
+    return output;
+}
+
+void benchmarkPreprocess(BenchmarkSuite& suite) {
+    std::mt19937 rng(1);
+    const cv::Size target_size(640, 640);
+    ObjectDetector detector;
+    LetterboxPreprocessor preprocessor;
+    std::vector<float> tensor(static_cast<size_t>(3) * target_size.area());
+    std::vector<uint8_t> bytes(static_cast<size_t>(3) * target_size.area());
+
+    const std::vector<std::pair<std::string, cv::Size>> sources = {
+        { "720p", { 1280, 720 } }, { "1080p", { 1920, 1080 } }, { "4k", { 3840, 2160 } } };
+    for (const auto& [label, size] : sources) {
+        cv::Mat image = makeSceneImage(size, 20, rng);
+        nlohmann::json params = { { "width", size.width }, { "height", size.height } };
+
+        suite.run("letterbox/legacy/" + label, [&]() {
+            cv::Mat letterbox_image = detector.letterboxResize(image, target_size);
+        }, params);
+
+        for (int threads : { 1, 0 }) {
+            preprocessor.setNumThreads(threads);
+            nlohmann::json fused_params = params;
+            fused_params["threads"] = threads;
+            suite.run("letterbox+blob/fused/" + label + (threads == 1 ? "/1thread" : "/parallel"), [&]() {
+                preprocessor.run(image, target_size, tensor.data());
+            }, fused_params);
+        }
+
+        // uint8输入模式：只做letterbox，归一化/通道交换/转置由模型图完成
+        suite.run("letterbox/bytes/" + label, [&]() {
+            preprocessor.runBytes(image, target_size, bytes.data());
+        }, params);
+    }
+
+    // blob转换单独计时：输入为已letterbox的640x640图像
+    cv::Mat letterbox_image = detector.letterboxResize(makeSceneImage({ 1920, 1080 }, 20, rng), target_size);
+    cv::Mat blob;
+    suite.run("blob/blobFromImage/640x640", [&]() {
+        cv::dnn::blobFromImage(letterbox_image, blob, 1.0 / 255.0, cv::Size(), cv::Scalar(0, 0, 0), true, false);
+    });
+}
+
+void benchmarkRun(BenchmarkSuite& suite, const std::string& model_path) {
+    ObjectDetector detector;
+    detector.setInputSize(640, 640);
+    std::vector<std::string> class_names;
+    for (int i = 0; i < 80; ++i) {
+        class_names.push_back(std::to_string(i));
+    }
+    detector.setClassNames(class_names);
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    bool initialized = detector.initialize(model_path);
+    spdlog::set_level(level);
+    if (!initialized) {
+        spdlog::warn("Skipping Run benchmark: cannot load {}", model_path);
+        return;
+    }
+
+    std::mt19937 rng(2);
+    LetterboxPreprocessor preprocessor;
+    cv::Mat image = makeSceneImage({ 1920, 1080 }, 20, rng);
+    std::vector<float> tensor(static_cast<size_t>(3) * 640 * 640);
+    std::vector<uint8_t> bytes(tensor.size());
+    preprocessor.run(image, cv::Size(640, 640), tensor.data());
+    preprocessor.runBytes(image, cv::Size(640, 640), bytes.data());
+
+    // 预处理并入模型图的uint8模型直接接收letterbox字节
+    bool uint8_input = detector.getInputFormat() == InputFormat::Uint8Nhwc;
+    std::vector<float> output;
+    std::vector<int64_t> output_shape;
+    suite.run("run/" + std::filesystem::path(model_path).stem().string() + "/640x640", [&]() {
+        if (uint8_input) {
+            detector.infer(bytes.data(), output, output_shape);
+        } else {
+            detector.infer(tensor.data(), output, output_shape);
+        }
+    }, { { "model", model_path }, { "input", uint8_input ? "uint8_nhwc" : "float_nchw" } });
+}
+
+void benchmarkDecodeAndNms(BenchmarkSuite& suite) {
+    std::mt19937 rng(3);
+    const int num_anchors = 8400;
+    const float threshold = 0.35f;
+    const cv::Size image_size(1920, 1080);
+    LetterboxInfo letterbox = LetterboxPreprocessor::computeLetterbox(image_size, cv::Size(640, 640));
+
+    OutputDecoder decoder;
+    NmsEngine engine;
+    NmsOptions options;
+    options.iou_threshold = 0.45f;
+    options.score_threshold = threshold;
+    std::vector<cv::Rect> boxes;
+    std::vector<float> scores;
+    std::vector<int> class_ids;
+    std::vector<int> keep;
+
+    for (int num_classes : { 1, 80 }) {
+        for (double density : { 0.001, 0.01, 0.1, 0.5 }) {
+            std::vector<float> output = makeSyntheticOutput(num_classes, num_anchors, density, rng);
+            std::string label = std::to_string(num_classes) + "cls/density=" + cv::format("%g", density);
+
+            suite.run("decode/" + label, [&]() {
+                boxes.clear();
+                scores.clear();
+                class_ids.clear();
+                decoder.decode(output.data(), num_classes, num_anchors, threshold, letterbox, image_size,
+                               boxes, scores, class_ids);
+            }, { { "classes", num_classes }, { "anchors", num_anchors }, { "density", density } });
+
+            // NMS输入为上面解码得到的候选
+            nlohmann::json params = { { "classes", num_classes }, { "candidates", boxes.size() } };
+            suite.run("nms/" + label, [&]() {
+                engine.run(boxes, scores, class_ids, options, keep);
+            }, params);
+        }
+    }
+}
+
+bool initializeQuiet(ObjectDetector& detector, const std::string& model_path) {
+    detector.setInputSize(640, 640);
+    std::vector<std::string> class_names;
+    for (int i = 0; i < 80; ++i) {
+        class_names.push_back(std::to_string(i));
+    }
+    detector.setClassNames(class_names);
+    detector.setConfidenceThreshold(0.35f);
+    detector.setNMSThreshold(0.45f);
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    bool initialized = detector.initialize(model_path);
+    spdlog::set_level(level);
+    return initialized;
+}
+
+// 后处理路径对比：CPU上的解码+NMS与图内TopK/NMS（ORT算子）在不同候选密度下的耗时。
+// postprocess/raw 包含把[1, 84, 8400]输出拷出ORT的开销，postprocess/in_graph 只拷贝[K, 6]结果，
+// 两者的输入是同一份合成张量，图内路径使用tests/data/postprocess_80cls.onnx（与端到端模型相同的后处理子图，
+// score 0.35、IoU 0.45），因此可以单独衡量后处理而不受骨干网络影响。
+void benchmarkEndToEnd(BenchmarkSuite& suite, const std::string& raw_model_path, const std::string& end2end_model_path) {
+    const int num_classes = 80;
+    const int num_anchors = 8400;
+    const cv::Size image_size(1920, 1080);
+    std::string postprocess_model_path = std::string(YOLO_TEST_DATA_DIR) + "/postprocess_80cls.onnx";
+
+    ObjectDetector detector;
+    detector.setInputSize(640, 640);
+    detector.setConfidenceThreshold(0.35f);
+    detector.setNMSThreshold(0.45f);
+
+    std::unique_ptr<Ort::Session> session;
+    Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "stage_benchmark");
+    try {
+        Ort::SessionOptions session_options;
+        session_options.SetIntraOpNumThreads(1);
+        session = std::make_unique<Ort::Session>(env, postprocess_model_path.c_str(), session_options);
+    }
+    catch (const Ort::Exception& e) {
+        spdlog::warn("Skipping in-graph postprocess benchmark: {}", e.what());
+    }
+
+    std::mt19937 rng(4);
+    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    const char* input_names[] = { "output0" };
+    const char* output_names[] = { "detections" };
+    const std::array<int64_t, 3> input_shape = { 1, 4 + num_classes, num_anchors };
+    std::vector<float> copied;
+    std::vector<DetectionResult> results;
+
+    for (double density : { 0.001, 0.01, 0.1, 0.5 }) {
+        std::vector<float> output = makeSyntheticOutput(num_classes, num_anchors, density, rng);
+        std::string label = std::to_string(num_classes) + "cls/density=" + cv::format("%g", density);
+        nlohmann::json params = { { "classes", num_classes }, { "anchors", num_anchors }, { "density", density } };
+
+        suite.run("postprocess/raw/" + label, [&]() {
+            copied.assign(output.begin(), output.end());
+            detector.postprocess(copied.data(), num_classes, num_anchors, image_size, results);
+        }, params);
+
+        if (session) {
+            Ort::Value input = Ort::Value::CreateTensor<float>(memory_info, output.data(), output.size(),
+                                                               input_shape.data(), input_shape.size());
+            suite.run("postprocess/in_graph/" + label, [&]() {
+                auto outputs = session->Run(Ort::RunOptions{ nullptr }, input_names, &input, 1, output_names, 1);
+                auto shape = outputs.front().GetTensorTypeAndShapeInfo().GetShape();
+                const float* detections = outputs.front().GetTensorData<float>();
+                copied.assign(detections, detections + shape[0] * shape[1]);
+                detector.postprocessEndToEnd(copied.data(), static_cast<int>(shape[0]), image_size, results);
+            }, params);
+        }
+    }
+
+    // 整图检测：同一骨干网络的原始输出模型与端到端模型
+    if (end2end_model_path.empty()) {
+        return;
+    }
+    cv::Mat image = makeSceneImage(image_size, 20, rng);
+    for (const std::string& model_path : { raw_model_path, end2end_model_path }) {
+        ObjectDetector model_detector;
+        if (!initializeQuiet(model_detector, model_path)) {
+            spdlog::warn("Skipping detect benchmark: cannot load {}", model_path);
+            continue;
+        }
+        bool end_to_end = model_detector.getOutputFormat() == OutputFormat::EndToEnd;
+        suite.run(std::string("detect/") + (end_to_end ? "end2end" : "raw") + "/1080p", [&]() {
+            model_detector.detect(image, results);
+        }, { { "model", model_path } });
+    }
+}
+
+// letterbox模式对比：常见宽高比的整图检测在square（固定640x640）与minimal（stride对齐的最小矩形）下的吞吐量。
+// minimal模式的计算量与输入面积成正比，16:9图像输入为640x384（anchor 8400 -> 5040）。
+// 需要H/W为动态维度的模型（tests/data中的微型模型满足）。
+void benchmarkLetterbox(BenchmarkSuite& suite, const std::string& model_path) {
+    ObjectDetector square_detector;
+    ObjectDetector minimal_detector;
+    minimal_detector.setLetterboxMode("minimal");
+    if (!initializeQuiet(square_detector, model_path) || !initializeQuiet(minimal_detector, model_path)) {
+        spdlog::warn("Skipping letterbox benchmark: {} needs dynamic input height/width", model_path);
+        return;
+    }
+
+    const std::pair<std::string, cv::Size> aspects[] = {
+        { "16:9", cv::Size(1920, 1080) }, { "4:3", cv::Size(1280, 960) }, { "21:9", cv::Size(2560, 1080) },
+        { "9:16", cv::Size(1080, 1920) }, { "1:1", cv::Size(1080, 1080) }
+    };
+    std::mt19937 rng(5);
+    std::vector<DetectionResult> results;
+    for (const auto& [label, image_size] : aspects) {
+        cv::Mat image = makeSceneImage(image_size, 20, rng);
+        cv::Size input_size = minimal_detector.inputSizeFor(image_size);
+        double square_fps = suite.run("detect/letterbox=square/" + label, [&]() {
+            square_detector.detect(image, results);
+        }, { { "image", cv::format("%dx%d", image_size.width, image_size.height) }, { "input", "640x640" } });
+        double minimal_fps = suite.run("detect/letterbox=minimal/" + label, [&]() {
+            minimal_detector.detect(image, results);
+        }, { { "image", cv::format("%dx%d", image_size.width, image_size.height) },
+             { "input", cv::format("%dx%d", input_size.width, input_size.height) } });
+        if (square_fps > 0.0 && minimal_fps > 0.0) {
+            spdlog::info("letterbox {:<5} input {}x{} ({:.0f}% of 640x640): {:.2f}x throughput", label,
+                         input_size.width, input_size.height, 100.0 * input_size.area() / (640 * 640),
+                         minimal_fps / square_fps);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            options.json_path = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time-ms" && i + 1 < argc) {
+            options.min_time_ms = std::atof(argv[++i]);
+        } else if (arg == "--model" && i + 1 < argc) {
+            options.model_path = argv[++i];
+        } else if (arg == "--model-u8" && i + 1 < argc) {
+            options.model_u8_path = argv[++i];
+        } else if (arg == "--model-end2end" && i + 1 < argc) {
+            options.model_end2end_path = argv[++i];
+        } else {
+            spdlog::error("Usage: {} [--json file] [--filter substring] [--min-time-ms ms] [--model path] "
+                          "[--model-u8 path] [--model-end2end path]", argv[0]);
+            return 1;
+        }
+    }
+
+    BenchmarkSuite suite(options);
+    benchmarkPreprocess(suite);
+    benchmarkRun(suite, options.model_path);
+    if (!options.model_u8_path.empty()) {
+        benchmarkRun(suite, options.model_u8_path);
+    }
+    benchmarkDecodeAndNms(suite);
+    benchmarkEndToEnd(suite, options.model_path, options.model_end2end_path);
+    benchmarkLetterbox(suite, options.model_path);
+
+    nlohmann::json report = suite.toJson();
+    if (options.json_path.empty()) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::ofstream file(options.json_path);
+        if (!file.is_open()) {
+            spdlog::error("Cannot write {}", options.json_path);
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+        spdlog::info("Results written to {}", options.json_path);
+    }
+    return 0;
+}
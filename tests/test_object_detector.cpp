@@ -0,0 +1,1746 @@
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+#include "LetterboxPreprocessor.h"
+#include "OutputDecoder.h"
+#include "NmsEngine.h"
+#include "SimdDispatch.h"
+#include "SpscQueue.h"
+#include "Telemetry.h"
+#include "ImageSource.h"
+#include "ImageLoader.h"
+#include "TiledDetector.h"
+#include "ObjectTracker.h"
+#include "TrackingDetector.h"
+#include "DetectorPool.h"
+#include "AsyncDetector.h"
+#include "InferenceServer.h"
+#include "InferenceClient.h"
+#include "FrameRing.h"
+#include "FrameGate.h"
+#include "ExecutionProviders.h"
+#include "NumaTopology.h"
+#include "ShardedRunner.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <spdlog/spdlog.h>
+
+#ifndef YOLO_TEST_DATA_DIR
+#define YOLO_TEST_DATA_DIR "tests/data"
+#endif
+
+// 替换全局operator new以统计堆分配次数，用于验证稳态零分配
+static std::atomic<size_t> g_allocation_count{0};
+
+void* operator new(std::size_t size) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+// 预热后执行iterations次func，返回期间的堆分配次数
+template <typename Func>
+size_t countAllocations(Func&& func, int warmup, int iterations) {
+    for (int i = 0; i < warmup; ++i) {
+        func();
+    }
+    size_t before = g_allocation_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    return g_allocation_count.load(std::memory_order_relaxed) - before;
+}
+
+// 生成合成的[5, N]输出张量：每隔stride个anchor放置一个高置信度框
+std::vector<float> makeSyntheticOutput(int num_anchors, int stride) {
+    std::vector<float> output(static_cast<size_t>(5) * num_anchors, 0.0f);
+    for (int i = 0; i < num_anchors; i += stride) {
+        output[0 * num_anchors + i] = 20.0f + static_cast<float>((i * 7) % 600);
+        output[1 * num_anchors + i] = 20.0f + static_cast<float>((i * 13) % 600);
+        output[2 * num_anchors + i] = 24.0f + static_cast<float>(i % 40);
+        output[3 * num_anchors + i] = 24.0f + static_cast<float>(i % 30);
+        output[4 * num_anchors + i] = 0.4f + 0.5f * static_cast<float>(i % 100) / 100.0f;
+    }
+    return output;
+}
+
+// tests/data中微型模型的检测器：640x640输入、80个数字类名、阈值0.25/0.45，
+// 加载期间日志级别临时提到warn；加载失败返回nullptr
+std::unique_ptr<ObjectDetector> makeTinyDetector(const std::string& model_name = "tiny_yolov8.onnx",
+                                                 const std::string& letterbox_mode = "square") {
+    auto detector = std::make_unique<ObjectDetector>();
+    detector->setInputSize(640, 640);
+    std::vector<std::string> class_names;
+    for (int i = 0; i < 80; ++i) {
+        class_names.push_back(std::to_string(i));
+    }
+    detector->setClassNames(class_names);
+    detector->setConfidenceThreshold(0.25f);
+    detector->setNMSThreshold(0.45f);
+    detector->setLetterboxMode(letterbox_mode);
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    bool initialized = detector->initialize(std::string(YOLO_TEST_DATA_DIR) + "/" + model_name);
+    spdlog::set_level(level);
+    return initialized ? std::move(detector) : nullptr;
+}
+
+// 加载微型模型的配置：会话使用各自的线程池，避免测试之间共享全局线程池
+JsonConfigManager tinyModelConfig() {
+    JsonConfigManager config_manager("");
+    ModelConfig model_config;
+    model_config.path = std::string(YOLO_TEST_DATA_DIR) + "/tiny_yolov8.onnx";
+    config_manager.setModelConfig(model_config);
+    PoolConfig pool_config;
+    pool_config.global_thread_pools = false;
+    config_manager.setPoolConfig(pool_config);
+    return config_manager;
+}
+
+// 融合预处理与 letterboxResize + blobFromImage 的最大允许误差（1个8位量化级）
+static const float kPreprocessTolerance = 1.0f / 255.0f + 1e-5f;
+
+// 比较融合预处理内核与原有预处理路径的输出
+bool testFusedPreprocessMatchesReference(ObjectDetector& detector, const cv::Mat& image,
+                                         cv::Size target_size, const char* name) {
+    cv::Mat letterbox_image = detector.letterboxResize(image, target_size);
+    cv::Mat blob;
+    cv::dnn::blobFromImage(letterbox_image, blob, 1.0 / 255.0, cv::Size(),
+        cv::Scalar(0, 0, 0), true, false);
+
+    std::vector<float> fused(static_cast<size_t>(3) * target_size.area());
+    LetterboxPreprocessor preprocessor;
+    preprocessor.run(image, target_size, fused.data());
+
+    const float* reference = reinterpret_cast<const float*>(blob.data);
+    float max_diff = 0.0f;
+    for (size_t i = 0; i < fused.size(); ++i) {
+        max_diff = std::max(max_diff, std::abs(fused[i] - reference[i]));
+    }
+
+    bool passed = max_diff <= kPreprocessTolerance;
+    if (passed) {
+        spdlog::info("[PASS] {}: max diff {:.6f}", name, max_diff);
+    } else {
+        spdlog::error("[FAIL] {}: max diff {:.6f} exceeds {:.6f}", name, max_diff, kPreprocessTolerance);
+    }
+    return passed;
+}
+
+// 比较SIMD解码器与逐anchor标量参考实现的候选筛选结果
+bool testOutputDecoderMatchesScalar(int num_classes, int num_anchors) {
+    std::vector<float> output(static_cast<size_t>(4 + num_classes) * num_anchors);
+    cv::Mat output_mat(1, static_cast<int>(output.size()), CV_32FC1, output.data());
+    cv::randu(output_mat, cv::Scalar::all(0.0), cv::Scalar::all(0.5));
+    const float threshold = 0.35f;
+
+    OutputDecoder decoder;
+    int count = decoder.selectCandidates(output.data(), num_classes, num_anchors, threshold);
+
+    int expected = 0;
+    bool matched = true;
+    for (int i = 0; i < num_anchors; ++i) {
+        float max_conf = -1.0f;
+        int best_class = -1;
+        for (int c = 0; c < num_classes; ++c) {
+            float score = output[static_cast<size_t>(4 + c) * num_anchors + i];
+            if (score > max_conf) {
+                max_conf = score;
+                best_class = c;
+            }
+        }
+        if (max_conf > threshold) {
+            if (expected >= count || decoder.candidateIndices()[expected] != i ||
+                decoder.candidateScores()[expected] != max_conf ||
+                decoder.candidateClasses()[expected] != best_class) {
+                matched = false;
+            }
+            ++expected;
+        }
+    }
+    matched = matched && expected == count;
+
+    if (!matched) {
+        spdlog::error("[FAIL] output decoder C={} N={}: {} candidates, expected {}",
+                      num_classes, num_anchors, count, expected);
+        return false;
+    }
+    spdlog::info("[PASS] output decoder C={} N={} ({} candidates)", num_classes, num_anchors, count);
+    return true;
+}
+
+// 重叠框IoU按真实并集计算：(0,0,100,100)与(20,20,100,100)的IoU为0.47，外接矩形计算仅为0.44
+bool testNmsTrueUnionIoU() {
+    std::vector<cv::Rect> boxes = { cv::Rect(0, 0, 100, 100), cv::Rect(20, 20, 100, 100) };
+    std::vector<float> scores = { 0.9f, 0.8f };
+    std::vector<int> class_ids = { 0, 0 };
+    NmsOptions options;
+    options.iou_threshold = 0.45f;
+
+    NmsEngine engine;
+    std::vector<int> keep;
+    engine.run(boxes, scores, class_ids, options, keep);
+    if (keep.size() != 1 || keep[0] != 0) {
+        spdlog::error("[FAIL] NMS true-union IoU: kept {} boxes", keep.size());
+        return false;
+    }
+    spdlog::info("[PASS] NMS true-union IoU");
+    return true;
+}
+
+// 不同类别的相同框互不抑制，class_aware关闭时相互抑制
+bool testNmsClassAware() {
+    std::vector<cv::Rect> boxes = { cv::Rect(10, 10, 50, 50), cv::Rect(10, 10, 50, 50) };
+    std::vector<float> scores = { 0.9f, 0.8f };
+    std::vector<int> class_ids = { 0, 1 };
+    NmsOptions options;
+
+    NmsEngine engine;
+    std::vector<int> keep;
+    engine.run(boxes, scores, class_ids, options, keep);
+    size_t aware_kept = keep.size();
+    options.class_aware = false;
+    engine.run(boxes, scores, class_ids, options, keep);
+    size_t agnostic_kept = keep.size();
+
+    if (aware_kept != 2 || agnostic_kept != 1) {
+        spdlog::error("[FAIL] NMS class-aware: {} kept (aware), {} kept (agnostic)", aware_kept, agnostic_kept);
+        return false;
+    }
+    spdlog::info("[PASS] NMS class-aware");
+    return true;
+}
+
+// 与逐对比较的贪心NMS参考实现逐项比较（覆盖网格剪枝路径）
+bool testNmsMatchesBruteForce(int count, int num_classes) {
+    cv::Mat values(count, 5, CV_32FC1);
+    cv::randu(values, cv::Scalar::all(0.0), cv::Scalar::all(1.0));
+    std::vector<cv::Rect> boxes;
+    std::vector<float> scores;
+    std::vector<int> class_ids;
+    for (int i = 0; i < count; ++i) {
+        const float* v = values.ptr<float>(i);
+        int w = 10 + static_cast<int>(v[2] * 100);
+        int h = 10 + static_cast<int>(v[3] * 100);
+        boxes.emplace_back(static_cast<int>(v[0] * 600), static_cast<int>(v[1] * 400), w, h);
+        scores.push_back(0.35f + 0.6f * v[4]);
+        class_ids.push_back(i % num_classes);
+    }
+    NmsOptions options;
+    options.iou_threshold = 0.45f;
+
+    std::vector<int> order(count);
+    for (int i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&scores](int a, int b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    });
+    std::vector<int> expected;
+    for (int i : order) {
+        bool suppressed = false;
+        for (int k : expected) {
+            if (class_ids[k] != class_ids[i]) continue;
+            float inter = static_cast<float>((boxes[i] & boxes[k]).area());
+            float uni = static_cast<float>(boxes[i].area()) + static_cast<float>(boxes[k].area()) - inter;
+            if (inter > options.iou_threshold * uni) {
+                suppressed = true;
+                break;
+            }
+        }
+        if (!suppressed) {
+            expected.push_back(i);
+        }
+    }
+
+    NmsEngine engine;
+    std::vector<int> keep;
+    engine.run(boxes, scores, class_ids, options, keep);
+    if (keep != expected) {
+        spdlog::error("[FAIL] NMS brute force {} boxes / {} classes: kept {}, expected {}",
+                      count, num_classes, keep.size(), expected.size());
+        return false;
+    }
+    spdlog::info("[PASS] NMS brute force {} boxes / {} classes ({} kept)", count, num_classes, keep.size());
+    return true;
+}
+
+bool testPreprocessZeroAllocation() {
+    cv::Mat image(1080, 1920, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    std::vector<float> tensor(static_cast<size_t>(3) * 640 * 640);
+
+    // cv::parallel_for_每次调用都会分配任务对象，零分配模式下使用单线程预处理
+    LetterboxPreprocessor preprocessor;
+    preprocessor.setNumThreads(1);
+    size_t allocations = countAllocations([&]() {
+        preprocessor.run(image, cv::Size(640, 640), tensor.data());
+    }, 3, 20);
+
+    if (allocations != 0) {
+        spdlog::error("[FAIL] preprocess zero allocation: {} allocations in 20 runs", allocations);
+        return false;
+    }
+    spdlog::info("[PASS] preprocess zero allocation");
+    return true;
+}
+
+bool testPostprocessZeroAllocation() {
+    ObjectDetector detector;
+    detector.setInputSize(640, 640);
+    detector.setClassNames({ "face" });
+    detector.setConfidenceThreshold(0.35f);
+    detector.setNMSThreshold(0.45f);
+
+    const int num_anchors = 8400;
+    std::vector<float> output = makeSyntheticOutput(num_anchors, 16);
+    std::vector<DetectionResult> results;
+    size_t allocations = countAllocations([&]() {
+        detector.postprocess(output.data(), 1, num_anchors, cv::Size(1920, 1080), results);
+    }, 3, 20);
+
+    if (allocations != 0 || results.empty()) {
+        spdlog::error("[FAIL] postprocess zero allocation: {} allocations in 20 runs, {} results",
+                      allocations, results.size());
+        return false;
+    }
+    spdlog::info("[PASS] postprocess zero allocation ({} results)", results.size());
+    return true;
+}
+
+bool testSpscQueueOrdering() {
+    // 小容量队列迫使生产者与消费者频繁在满/空之间切换
+    SpscQueue<int> queue(4);
+    std::atomic<bool> stop{false};
+    const int count = 200000;
+
+    std::thread producer([&]() {
+        for (int i = 0; i < count; ++i) {
+            int value = i;
+            queue.push(std::move(value), stop);
+        }
+    });
+
+    bool ordered = true;
+    for (int i = 0; i < count; ++i) {
+        int value = -1;
+        queue.pop(value, stop);
+        if (value != i) {
+            ordered = false;
+            stop = true;
+            break;
+        }
+    }
+    producer.join();
+
+    if (!ordered || queue.size() != 0 || queue.capacity() != 4) {
+        spdlog::error("[FAIL] SPSC queue ordering");
+        return false;
+    }
+    spdlog::info("[PASS] SPSC queue ordering ({} items)", count);
+    return true;
+}
+
+bool testTelemetryHistogram() {
+    LatencyHistogram histogram;
+    size_t allocations = countAllocations([&]() {
+        for (int i = 0; i < 90; ++i) {
+            histogram.record(1000000);    // 1 ms
+        }
+        for (int i = 0; i < 10; ++i) {
+            histogram.record(50000000);   // 50 ms
+        }
+    }, 0, 1);
+
+    HistogramSnapshot snapshot = histogram.snapshot();
+    double p50 = snapshot.quantileMs(0.50);
+    double p99 = snapshot.quantileMs(0.99);
+    bool histogram_ok = snapshot.count == 100 && std::abs(snapshot.meanMs() - 5.9) < 1e-6 &&
+                        p50 > 0.64 && p50 <= 1.28 && p99 > 40.96 && p99 <= 81.92;
+
+    // Prometheus输出的桶计数是累计值，最后一个桶等于总数
+    Telemetry& telemetry = Telemetry::instance();
+    telemetry.recordLatency(TelemetryStage::Nms, 1000000);
+    std::string text = telemetry.toPrometheus();
+    bool export_ok = text.find("# TYPE yolo_stage_latency_seconds histogram") != std::string::npos &&
+                     text.find("yolo_stage_latency_seconds_bucket{stage=\"nms\",le=\"+Inf\"}") != std::string::npos &&
+                     text.find("yolo_frames_total") != std::string::npos;
+
+    if (allocations != 0 || !histogram_ok || !export_ok) {
+        spdlog::error("[FAIL] telemetry histogram: {} allocations, count {}, p50 {:.3f} ms, p99 {:.3f} ms, export {}",
+                      allocations, snapshot.count, p50, p99, export_ok);
+        return false;
+    }
+    spdlog::info("[PASS] telemetry histogram (p50 {:.3f} ms, p99 {:.3f} ms)", p50, p99);
+    return true;
+}
+
+bool testImageSourceEnumeration() {
+    namespace fs = std::filesystem;
+    fs::path root = fs::temp_directory_path() / "yolo_image_source_test";
+    fs::remove_all(root);
+    fs::create_directories(root / "sub");
+    for (const char* name : { "a.jpg", "b.PNG", "notes.txt", "sub/c.jpeg" }) {
+        std::ofstream(root / name) << "x";
+    }
+    std::ofstream(root / "list.txt") << "first.jpg\n\n# comment\n  second.png \r\n";
+
+    auto collect = [](const std::string& spec) {
+        std::vector<std::string> paths;
+        ImageSource source;
+        if (source.open(spec)) {
+            std::string path;
+            while (source.next(path)) {
+                paths.push_back(fs::path(path).filename().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    };
+
+    bool ok = collect(root.string()) == std::vector<std::string>{ "a.jpg", "b.PNG", "c.jpeg" } &&
+              collect((root / "*.jpg").string()) == std::vector<std::string>{ "a.jpg" } &&
+              collect((root / "list.txt").string()) == std::vector<std::string>{ "first.jpg", "second.png" } &&
+              collect((root / "a.jpg").string()) == std::vector<std::string>{ "a.jpg" } &&
+              !ImageSource().open((root / "video.mp4").string());
+    fs::remove_all(root);
+
+    if (!ok) {
+        spdlog::error("[FAIL] image source enumeration");
+        return false;
+    }
+    spdlog::info("[PASS] image source enumeration");
+    return true;
+}
+
+bool testReducedDecode() {
+    cv::Mat image(2160, 3840, CV_8UC3, cv::Scalar(40, 80, 120));
+    cv::rectangle(image, cv::Rect(1000, 600, 800, 400), cv::Scalar(255, 255, 255), cv::FILLED);
+    std::vector<uchar> jpeg;
+    cv::imencode(".jpg", image, jpeg);
+
+    cv::Size header_size;
+    bool header_ok = ImageLoader::readJpegSize(jpeg.data(), jpeg.size(), header_size) &&
+                     header_size == image.size();
+
+    // 4K -> 640x640的letterbox缩放比例为1/6，最大可用的2的幂为4
+    ImageLoader loader;
+    loader.setTargetSize(cv::Size(640, 640));
+    loader.setReducedDecode(true);
+    LoadedImage loaded;
+    bool decode_ok = loader.decode(jpeg, loaded) && loaded.reduction == 4 &&
+                     loaded.image.size() == cv::Size(960, 540) && loaded.original_size == image.size();
+
+    // 解码坐标中的框映射回原图坐标
+    std::vector<DetectionResult> results = { { cv::Rect(250, 150, 200, 100), 0, 0.9f } };
+    ObjectDetector::scaleResults(results, loaded.image.size(), loaded.original_size);
+    bool scale_ok = results[0].box == cv::Rect(1000, 600, 800, 400);
+
+    if (!header_ok || !decode_ok || !scale_ok) {
+        spdlog::error("[FAIL] reduced decode: header {}, decode {} (1/{}, {}x{}), scale {}", header_ok, decode_ok,
+                      loaded.reduction, loaded.image.cols, loaded.image.rows, scale_ok);
+        return false;
+    }
+    spdlog::info("[PASS] reduced decode (1/{} -> {}x{})", loaded.reduction, loaded.image.cols, loaded.image.rows);
+    return true;
+}
+
+bool testSelectQuantizedModel() {
+    namespace fs = std::filesystem;
+    fs::path int8_path = fs::temp_directory_path() / "yolo_select_model_test.int8.onnx";
+    fs::remove(int8_path);
+
+    ModelConfig model_config;
+    model_config.path = "model.onnx";
+    model_config.optimized_model_path = "cache/model.opt.ort";
+    model_config.precision = "int8";
+    model_config.int8_model_path = int8_path.string();
+
+    std::string model_path;
+    std::string optimized_path;
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::err);
+    // INT8模型不存在时回退到FP32模型和原缓存路径
+    bool fallback_ok = !ObjectDetector::selectModel(model_config, model_path, optimized_path) &&
+                       model_path == "model.onnx" && optimized_path == "cache/model.opt.ort";
+    spdlog::set_level(level);
+
+    std::ofstream(int8_path) << "x";
+    bool int8_ok = ObjectDetector::selectModel(model_config, model_path, optimized_path) &&
+                   model_path == int8_path.string() &&
+                   fs::path(optimized_path) == fs::path("cache/model.opt.int8.ort");
+    fs::remove(int8_path);
+
+    model_config.precision = "fp32";
+    bool fp32_ok = !ObjectDetector::selectModel(model_config, model_path, optimized_path) &&
+                   model_path == "model.onnx";
+
+    if (!fallback_ok || !int8_ok || !fp32_ok) {
+        spdlog::error("[FAIL] quantized model selection: fallback {}, int8 {}, fp32 {}", fallback_ok, int8_ok, fp32_ok);
+        return false;
+    }
+    spdlog::info("[PASS] quantized model selection");
+    return true;
+}
+
+// 使用tests/data中的微型模型（tools/make_tiny_model.py生成）验证完整的CPU检测路径：
+// detectBatch的结果应与逐张detect一致
+bool testTinyModelDetectBatchMatchesDetect() {
+    std::unique_ptr<ObjectDetector> detector = makeTinyDetector();
+    if (!detector) {
+        spdlog::error("[FAIL] tiny model: cannot load {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::RNG rng(7);
+    std::vector<cv::Mat> images;
+    for (const cv::Size& size : { cv::Size(1920, 1080), cv::Size(640, 480), cv::Size(720, 1280) }) {
+        cv::Mat image(size, CV_8UC3, cv::Scalar(0, 0, 0));
+        for (int i = 0; i < 12; ++i) {
+            cv::Rect rect(rng.uniform(0, size.width / 2), rng.uniform(0, size.height / 2),
+                          rng.uniform(20, size.width / 2), rng.uniform(20, size.height / 2));
+            cv::rectangle(image, rect, cv::Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)),
+                          cv::FILLED);
+        }
+        images.push_back(image);
+    }
+
+    std::vector<std::vector<DetectionResult>> batch_results = detector->detectBatch(images);
+    bool matches = batch_results.size() == images.size();
+    size_t total = 0;
+    for (size_t i = 0; matches && i < images.size(); ++i) {
+        std::vector<DetectionResult> single = detector->detect(images[i]);
+        const std::vector<DetectionResult>& batched = batch_results[i];
+        matches = single.size() == batched.size();
+        for (size_t j = 0; matches && j < single.size(); ++j) {
+            cv::Rect a = single[j].box;
+            cv::Rect b = batched[j].box;
+            matches = single[j].class_id == batched[j].class_id &&
+                      std::abs(single[j].confidence - batched[j].confidence) < 1e-4f &&
+                      std::abs(a.x - b.x) <= 1 && std::abs(a.y - b.y) <= 1 &&
+                      std::abs(a.width - b.width) <= 1 && std::abs(a.height - b.height) <= 1;
+        }
+        total += single.size();
+    }
+
+    if (!matches || total == 0) {
+        spdlog::error("[FAIL] tiny model detectBatch matches detect ({} detections)", total);
+        return false;
+    }
+    spdlog::info("[PASS] tiny model detectBatch matches detect ({} detections)", total);
+    return true;
+}
+
+// uint8输入模式：tiny_yolov8_u8.onnx由tools/fold_preprocess.py从tiny_yolov8.onnx生成，
+// 对同一letterbox字节，uint8模型的输出应与float模型在对应float张量上的输出一致
+bool testUint8InputMatchesFloat() {
+    std::unique_ptr<ObjectDetector> float_detector = makeTinyDetector();
+    std::unique_ptr<ObjectDetector> uint8_detector = makeTinyDetector("tiny_yolov8_u8.onnx");
+    if (!float_detector || !uint8_detector || uint8_detector->getInputFormat() != InputFormat::Uint8Nhwc) {
+        spdlog::error("[FAIL] uint8 input: cannot load tiny models from {}", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::Mat image(1080, 1920, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::rectangle(image, cv::Rect(300, 200, 700, 500), cv::Scalar(255, 255, 255), cv::FILLED);
+
+    // float张量由相同的letterbox字节按blobFromImage的方式得到
+    LetterboxPreprocessor preprocessor;
+    std::vector<uint8_t> bytes(static_cast<size_t>(3) * 640 * 640);
+    preprocessor.runBytes(image, cv::Size(640, 640), bytes.data());
+    cv::Mat letterbox_image(640, 640, CV_8UC3, bytes.data());
+    cv::Mat blob = cv::dnn::blobFromImage(letterbox_image, 1.0 / 255.0, cv::Size(), cv::Scalar(), true, false);
+
+    std::vector<float> float_output;
+    std::vector<float> uint8_output;
+    std::vector<int64_t> float_shape;
+    std::vector<int64_t> uint8_shape;
+    bool ran = float_detector->infer(blob.ptr<float>(), float_output, float_shape) &&
+               uint8_detector->infer(bytes.data(), uint8_output, uint8_shape);
+    // 输入格式不匹配的调用应被拒绝
+    bool rejected = !uint8_detector->infer(blob.ptr<float>(), uint8_output, uint8_shape);
+
+    float max_error = 0.0f;
+    bool outputs_match = ran && float_shape == uint8_shape && float_output.size() == uint8_output.size();
+    for (size_t i = 0; outputs_match && i < float_output.size(); ++i) {
+        max_error = std::max(max_error, std::abs(float_output[i] - uint8_output[i]));
+    }
+    outputs_match = outputs_match && max_error < 1e-3f;
+
+    // detect与detectBatch在uint8模式下同样走字节输入路径
+    std::vector<DetectionResult> single = uint8_detector->detect(image);
+    std::vector<std::vector<DetectionResult>> batched = uint8_detector->detectBatch({ image, image });
+    bool detect_ok = !single.empty() && batched.size() == 2 && batched[0].size() == single.size() &&
+                     batched[1].size() == single.size();
+
+    if (!outputs_match || !rejected || !detect_ok) {
+        spdlog::error("[FAIL] uint8 input: outputs match {} (max error {}), mismatched input rejected {}, detect {}",
+                      outputs_match, max_error, rejected, detect_ok);
+        return false;
+    }
+    spdlog::info("[PASS] uint8 input matches float path (max error {:.2e}, {} detections)", max_error, single.size());
+    return true;
+}
+
+// 完整detect路径（io_binding + 单线程预处理）预热后不产生本项目代码的堆分配。
+// ONNX Runtime每次Run内部仍会创建执行帧等少量对象，其次数只取决于模型图；
+// 以同一会话只执行Run（warmup在IoBinding模式下不做其他事）的分配次数为基准，
+// detect的分配次数必须与之相同，且不随帧数、图像内容或检测数变化
+bool testDetectZeroAllocation() {
+    JsonConfigManager config_manager = tinyModelConfig();
+    ModelConfig model_config = config_manager.getModelConfig();
+    model_config.io_binding = true;
+    model_config.preprocess_threads = 1;
+    // 单线程执行，ORT内部的分配次数与调度无关
+    model_config.intra_op_threads = 1;
+    model_config.inter_op_threads = 1;
+    config_manager.setModelConfig(model_config);
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    ObjectDetector detector;
+    bool initialized = detector.initialize(config_manager);
+    if (!initialized) {
+        spdlog::set_level(level);
+        spdlog::error("[FAIL] detect zero allocation: cannot initialize with {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    // 一张随机噪声图与一张有大块目标的图，覆盖不同的候选数
+    cv::Mat noise(1080, 1920, CV_8UC3);
+    cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat shapes(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+    cv::rectangle(shapes, cv::Rect(200, 150, 600, 500), cv::Scalar(255, 255, 255), cv::FILLED);
+    cv::rectangle(shapes, cv::Rect(1200, 400, 400, 450), cv::Scalar(40, 200, 40), cv::FILLED);
+    std::vector<DetectionResult> results;
+    results.reserve(1024);
+
+    const int frames = 10;
+    size_t run_allocations = countAllocations([&]() { detector.warmup(1); }, 5, frames);
+    size_t noise_allocations = countAllocations([&]() { detector.detect(noise, results); }, 5, frames);
+    size_t shapes_allocations = countAllocations([&]() { detector.detect(shapes, results); }, 5, frames);
+    size_t repeat_allocations = countAllocations([&]() { detector.detect(noise, results); }, 0, frames);
+    spdlog::set_level(level);
+
+    bool passed = noise_allocations == run_allocations && shapes_allocations == run_allocations &&
+                  repeat_allocations == run_allocations;
+    if (!passed) {
+        spdlog::error("[FAIL] detect zero allocation: {} / {} / {} allocations in {} detect calls, "
+                      "Run alone {} (must be equal)", noise_allocations, shapes_allocations, repeat_allocations,
+                      frames, run_allocations);
+        return false;
+    }
+    spdlog::info("[PASS] detect zero allocation (0 outside ONNX Runtime, {:.1f} per frame inside Run)",
+                 static_cast<double>(run_allocations) / frames);
+    return true;
+}
+
+bool testEndToEndMatchesRawPostprocess() {
+    std::unique_ptr<ObjectDetector> raw_detector = makeTinyDetector();
+    std::unique_ptr<ObjectDetector> end2end_detector = makeTinyDetector("tiny_yolov8_end2end.onnx");
+    if (!raw_detector || !end2end_detector || raw_detector->getOutputFormat() != OutputFormat::RawAnchors ||
+        end2end_detector->getOutputFormat() != OutputFormat::EndToEnd) {
+        spdlog::error("[FAIL] end-to-end: cannot load tiny models from {} or output format not detected",
+                      YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::Mat image(1080, 1920, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::rectangle(image, cv::Rect(300, 200, 700, 500), cv::Scalar(255, 255, 255), cv::FILLED);
+
+    std::vector<DetectionResult> raw = raw_detector->detect(image);
+    std::vector<DetectionResult> end2end = end2end_detector->detect(image);
+    // 端到端模型的输出不含batch序号，detectBatch逐张处理
+    std::vector<std::vector<DetectionResult>> batched = end2end_detector->detectBatch({ image, image });
+    bool batch_ok = batched.size() == 2 && batched[0].size() == end2end.size() && batched[1].size() == end2end.size();
+
+    // 图内NMS按float坐标计算IoU，NmsEngine使用整数框，阈值附近的个别框可能取舍不同
+    auto iou = [](const cv::Rect& a, const cv::Rect& b) {
+        double intersection = (a & b).area();
+        double union_area = a.area() + b.area() - intersection;
+        return union_area > 0.0 ? intersection / union_area : 0.0;
+    };
+    int matched = 0;
+    for (const auto& expected : raw) {
+        for (const auto& actual : end2end) {
+            if (actual.class_id == expected.class_id && std::abs(actual.confidence - expected.confidence) < 1e-4f &&
+                iou(actual.box, expected.box) > 0.9) {
+                ++matched;
+                break;
+            }
+        }
+    }
+    double recall = raw.empty() ? 0.0 : static_cast<double>(matched) / raw.size();
+    bool count_ok = std::abs(static_cast<int>(raw.size()) - static_cast<int>(end2end.size())) <=
+                    std::max<int>(1, static_cast<int>(raw.size()) / 20);
+    if (raw.empty() || recall < 0.95 || !count_ok || !batch_ok) {
+        spdlog::error("[FAIL] end-to-end: {} raw vs {} in-graph detections, recall {:.3f}, batch {}",
+                      raw.size(), end2end.size(), recall, batch_ok);
+        return false;
+    }
+    spdlog::info("[PASS] end-to-end model matches raw postprocess ({} vs {} detections, recall {:.3f})",
+                 raw.size(), end2end.size(), recall);
+    return true;
+}
+
+bool testTiledDetection() {
+    // tile覆盖整幅图像、尺寸完整且相邻tile至少重叠overlap比例
+    std::vector<cv::Rect> tiles = TiledDetector::computeTiles(cv::Size(1920, 1080), cv::Size(640, 640), 0.2f);
+    cv::Mat coverage(1080, 1920, CV_8U, cv::Scalar(0));
+    bool layout_ok = tiles.size() == 8;
+    for (const auto& tile : tiles) {
+        layout_ok = layout_ok && tile.size() == cv::Size(640, 640) && (tile & cv::Rect(0, 0, 1920, 1080)) == tile;
+        coverage(tile).setTo(1);
+    }
+    layout_ok = layout_ok && cv::countNonZero(coverage) == coverage.rows * coverage.cols &&
+                tiles[0].x + tiles[0].width - tiles[1].x >= 128;
+    std::vector<cv::Rect> small = TiledDetector::computeTiles(cv::Size(300, 200), cv::Size(640, 640), 0.2f);
+    layout_ok = layout_ok && small.size() == 1 && small[0] == cv::Rect(0, 0, 300, 200);
+
+    // tile边界切开的同一目标：两半IoU很低，nmm合并为外接框，nms保留两个
+    TilingConfig config;
+    NmsEngine engine;
+    std::vector<DetectionResult> halves = {
+        { cv::Rect(600, 100, 60, 60), 0, 0.8f },
+        { cv::Rect(620, 100, 80, 60), 0, 0.9f },
+        { cv::Rect(605, 100, 30, 60), 1, 0.7f } };
+    std::vector<DetectionResult> merged = halves;
+    config.merge = "nmm";
+    TiledDetector::mergeDetections(merged, config, engine);
+    std::vector<DetectionResult> suppressed = halves;
+    config.merge = "nms";
+    TiledDetector::mergeDetections(suppressed, config, engine);
+    bool merge_ok = merged.size() == 2 && merged[0].box == cv::Rect(600, 100, 100, 60) &&
+                    merged[0].confidence == 0.9f && merged[1].class_id == 1 && suppressed.size() == 3;
+
+    // 微型模型上的完整切片检测：整图 + 8个tile，结果位于原图范围内
+    std::unique_ptr<ObjectDetector> detector = makeTinyDetector();
+    if (!detector) {
+        spdlog::error("[FAIL] tiled detection: cannot load {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::Mat image(1080, 1920, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::rectangle(image, cv::Rect(300, 200, 700, 500), cv::Scalar(255, 255, 255), cv::FILLED);
+    TiledDetector tiled;
+    tiled.initialize(*detector, TilingConfig());
+    std::vector<DetectionResult> results = tiled.detect(image);
+    bool detect_ok = tiled.lastRegionCount() == 9 && !results.empty();
+    for (const auto& result : results) {
+        detect_ok = detect_ok && (result.box & cv::Rect(0, 0, 1920, 1080)) == result.box;
+    }
+
+    if (!layout_ok || !merge_ok || !detect_ok) {
+        spdlog::error("[FAIL] tiled detection: layout {} ({} tiles), merge {} (nmm {}, nms {}), detect {} ({} regions)",
+                      layout_ok, tiles.size(), merge_ok, merged.size(), suppressed.size(), detect_ok,
+                      tiled.lastRegionCount());
+        return false;
+    }
+    spdlog::info("[PASS] tiled detection ({} tiles, {} merged detections)", tiles.size(), results.size());
+    return true;
+}
+
+bool testObjectTracking() {
+    // 两个匀速运动的目标，每5帧提供一次精确检测框，中间帧由跟踪器外推
+    auto truth = [](int frame) {
+        std::vector<DetectionResult> boxes(2);
+        boxes[0].box = cv::Rect(100 + 4 * frame, 200, 50, 80);
+        boxes[0].class_id = 0;
+        boxes[0].confidence = 0.9f;
+        boxes[1].box = cv::Rect(400, 100 + 3 * frame, 60, 60);
+        boxes[1].class_id = 1;
+        boxes[1].confidence = 0.8f;
+        return boxes;
+    };
+    auto iou = [](const cv::Rect& a, const cv::Rect& b) {
+        double intersection = (a & b).area();
+        return intersection / (a.area() + b.area() - intersection);
+    };
+
+    ObjectTracker tracker;
+    std::vector<DetectionResult> results;
+    bool ids_stable = true;
+    double worst_iou = 1.0;
+    for (int frame = 0; frame < 40; ++frame) {
+        std::vector<DetectionResult> expected = truth(frame);
+        if (frame % 5 == 0) {
+            tracker.update(expected, results);
+        } else {
+            tracker.predict(results);
+        }
+        ids_stable = ids_stable && results.size() == 2 && results[0].track_id == 1 && results[1].track_id == 2;
+        // 速度收敛后外推框与真实框基本重合
+        for (size_t i = 0; frame >= 20 && i < results.size(); ++i) {
+            worst_iou = std::min(worst_iou, iou(results[i].box, expected[i].box));
+        }
+    }
+
+    // 第二个目标消失：连续max_age个关键帧未匹配后删除；新目标分配新编号
+    // 未匹配的轨迹不再输出，其衰减的置信度也不计入minConfidence（不触发提前关键帧）
+    std::vector<DetectionResult> remaining(1);
+    bool lost_ignored = true;
+    for (int frame = 40; frame <= 50; ++frame) {
+        remaining[0] = truth(frame)[0];
+        if (frame % 5 == 0) {
+            tracker.update(remaining, results);
+        } else {
+            tracker.predict(results);
+        }
+        if (frame == 45) {
+            lost_ignored = tracker.trackCount() == 2 && tracker.minConfidence() == remaining[0].confidence;
+        }
+    }
+    bool removed = tracker.trackCount() == 1 && tracker.lastUpdate().removed == 1;
+    remaining[0] = truth(51)[0];
+    remaining.push_back({ cv::Rect(800, 600, 40, 40), 2, 0.7f });
+    tracker.update(remaining, results);
+    bool new_id = results.size() == 2 && results[0].track_id == 1 && results[1].track_id == 3;
+
+    // 自适应调度：画面不变时所有轨迹都能匹配，检测间隔逐步增加到max_interval
+    std::unique_ptr<ObjectDetector> detector = makeTinyDetector();
+    if (!detector) {
+        spdlog::error("[FAIL] tracking: cannot load {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::Mat image(1080, 1920, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::rectangle(image, cv::Rect(300, 200, 700, 500), cv::Scalar(255, 255, 255), cv::FILLED);
+    TrackingConfig config;
+    config.keyframe_interval = 2;
+    config.max_interval = 6;
+    config.confidence_decay = 1.0f;
+    TrackingDetector tracking;
+    tracking.initialize(*detector, config);
+    std::vector<DetectionResult> tracked;
+    bool tracking_ok = true;
+    for (int frame = 0; frame < 40 && tracking_ok; ++frame) {
+        tracking.process(image, tracked);
+        tracking_ok = !tracked.empty() && std::all_of(tracked.begin(), tracked.end(),
+            [](const DetectionResult& result) { return result.track_id > 0; });
+    }
+    const TrackingStats& stats = tracking.getStats();
+    tracking_ok = tracking_ok && stats.interval == 6 && stats.keyframes < 15;
+
+    if (!ids_stable || worst_iou < 0.9 || !removed || !new_id || !lost_ignored || !tracking_ok) {
+        spdlog::error("[FAIL] tracking: ids stable {}, worst extrapolated IoU {:.3f}, removed {}, new id {}, "
+                      "lost track ignored {}, adaptive {} ({} keyframes, interval {})", ids_stable, worst_iou,
+                      removed, new_id, lost_ignored, tracking_ok, stats.keyframes, stats.interval);
+        return false;
+    }
+    spdlog::info("[PASS] tracking (worst extrapolated IoU {:.3f}, {} keyframes in {} frames)",
+                 worst_iou, stats.keyframes, stats.frames);
+    return true;
+}
+
+// minimal letterbox：输入尺寸为容纳缩放后图像的最小32倍数，张量形状逐次设置，
+// 解码按实际的anchor数进行；重复的形状复用缓存的状态
+bool testMinimalLetterbox() {
+    std::unique_ptr<ObjectDetector> detector_ptr = makeTinyDetector("tiny_yolov8.onnx", "minimal");
+    if (!detector_ptr) {
+        spdlog::error("[FAIL] minimal letterbox: cannot load {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+    ObjectDetector& detector = *detector_ptr;
+
+    bool sizes_ok = detector.inputSizeFor(cv::Size(1920, 1080)) == cv::Size(640, 384) &&
+                    detector.inputSizeFor(cv::Size(1080, 1920)) == cv::Size(384, 640) &&
+                    detector.inputSizeFor(cv::Size(2560, 1080)) == cv::Size(640, 288) &&
+                    detector.inputSizeFor(cv::Size(1280, 960)) == cv::Size(640, 480) &&
+                    detector.inputSizeFor(cv::Size(1080, 1080)) == cv::Size(640, 640) &&
+                    detector.inputSizeFor(cv::Size(300, 100)) == cv::Size(640, 224);
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+
+    cv::Mat image(1080, 1920, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::rectangle(image, cv::Rect(300, 200, 700, 500), cv::Scalar(255, 255, 255), cv::FILLED);
+    cv::Mat portrait;
+    cv::rotate(image, portrait, cv::ROTATE_90_CLOCKWISE);
+
+    // 参照：手动letterbox到640x384后推理，输出应为80*48 + 40*24 + 20*12 = 5040个anchor
+    cv::Size input_size = detector.inputSizeFor(image.size());
+    LetterboxPreprocessor preprocessor;
+    std::vector<float> tensor(static_cast<size_t>(3) * input_size.area());
+    preprocessor.run(image, input_size, tensor.data());
+    std::vector<float> output;
+    std::vector<int64_t> output_shape;
+    std::vector<DetectionResult> expected;
+    bool reference_ok = detector.infer(tensor.data(), output, output_shape, input_size) &&
+                        output_shape.size() == 3 && output_shape[2] == 5040 &&
+                        detector.postprocessOutput(output.data(), output_shape, image.size(), expected);
+
+    auto same = [](const std::vector<DetectionResult>& a, const std::vector<DetectionResult>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].box != b[i].box || a[i].class_id != b[i].class_id ||
+                std::abs(a[i].confidence - b[i].confidence) > 1e-4f) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // 横竖两种形状交替检测，第二轮复用缓存的形状
+    std::vector<DetectionResult> results;
+    std::vector<DetectionResult> portrait_results;
+    std::vector<DetectionResult> repeated;
+    detector.detect(image, results);
+    detector.detect(portrait, portrait_results);
+    detector.detect(image, repeated);
+    bool detect_ok = same(results, expected) && same(results, repeated) && !portrait_results.empty();
+    detector.detect(portrait, repeated);
+    detect_ok = detect_ok && same(portrait_results, repeated) && detector.cachedShapeCount() == 2;
+
+    // 按配置开启批量推理与按形状绑定的IoBinding：同一宽高比的图像在detectBatch中共用640x384的输入，
+    // 第二次detect走该形状的IoBinding
+    JsonConfigManager config_manager = tinyModelConfig();
+    ModelConfig model_config = config_manager.getModelConfig();
+    model_config.max_batch_size = 4;
+    model_config.io_binding = true;
+    model_config.letterbox = "minimal";
+    config_manager.setModelConfig(model_config);
+    ObjectDetector batch_detector;
+    spdlog::set_level(spdlog::level::err);
+    bool batch_ok = batch_detector.initialize(config_manager);
+    spdlog::set_level(spdlog::level::warn);
+    cv::Mat small_image;
+    cv::resize(image, small_image, cv::Size(1280, 720));
+    std::vector<DetectionResult> bound_results;
+    std::vector<DetectionResult> small_results;
+    batch_detector.detect(image, results);
+    batch_detector.detect(image, bound_results);
+    batch_detector.detect(small_image, small_results);
+    std::vector<std::vector<DetectionResult>> batch_results = batch_detector.detectBatch({ image, small_image });
+    batch_ok = batch_ok && !results.empty() && same(results, bound_results) && batch_results.size() == 2 &&
+               same(batch_results[0], results) && same(batch_results[1], small_results);
+    spdlog::set_level(level);
+
+    if (!sizes_ok || !reference_ok || expected.empty() || !detect_ok || !batch_ok) {
+        spdlog::error("[FAIL] minimal letterbox: sizes {}, reference {} ({} detections), detect {}, batch {}",
+                      sizes_ok, reference_ok, expected.size(), detect_ok, batch_ok);
+        return false;
+    }
+    spdlog::info("[PASS] minimal letterbox (640x384 input, {} detections, {} cached shapes)",
+                 expected.size(), detector.cachedShapeCount());
+    return true;
+}
+
+// 检测器池的无锁空闲栈：多个线程在少量会话上反复acquire/tryAcquire与归还，
+// 同一会话任何时刻只被一个线程持有，结束后所有会话都回到池中
+bool testDetectorPoolConcurrency() {
+    JsonConfigManager config_manager = tinyModelConfig();
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::err);
+    DetectorPool pool;
+    bool initialized = pool.initialize(config_manager, 3);
+    spdlog::set_level(level);
+    if (!initialized) {
+        spdlog::error("[FAIL] detector pool: cannot load {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    // 先租出全部会话，记下每个会话的地址
+    std::vector<ObjectDetector*> sessions;
+    {
+        std::vector<DetectorPool::Lease> leases;
+        for (int i = 0; i < pool.size(); ++i) {
+            leases.push_back(pool.tryAcquire());
+            sessions.push_back(leases.back() ? &*leases.back() : nullptr);
+        }
+    }
+    std::unique_ptr<std::atomic<int>[]> holders(new std::atomic<int>[sessions.size()]);
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        holders[i].store(0);
+    }
+
+    const int threads = 8;
+    const int iterations = 20000;
+    std::atomic<int> overlaps{ 0 };
+    std::atomic<int> unknown{ 0 };
+    std::atomic<int> acquired{ 0 };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int i = 0; i < iterations; ++i) {
+                DetectorPool::Lease lease = (i + t) % 3 == 0 ? pool.tryAcquire() : pool.acquire();
+                if (!lease) {
+                    continue;
+                }
+                auto it = std::find(sessions.begin(), sessions.end(), &*lease);
+                if (it == sessions.end()) {
+                    unknown.fetch_add(1);
+                    continue;
+                }
+                std::atomic<int>& holder = holders[it - sessions.begin()];
+                if (holder.fetch_add(1) != 0) {
+                    overlaps.fetch_add(1);
+                }
+                acquired.fetch_add(1, std::memory_order_relaxed);
+                if (i % 7 == 0) {
+                    std::this_thread::yield();
+                }
+                holder.fetch_sub(1);
+                lease.release();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // 所有会话都已归还：可以同时再租出pool.size()个互不相同的会话，之后池为空
+    std::vector<DetectorPool::Lease> leases;
+    std::vector<ObjectDetector*> returned;
+    for (int i = 0; i < pool.size(); ++i) {
+        leases.push_back(pool.tryAcquire());
+        returned.push_back(leases.back() ? &*leases.back() : nullptr);
+    }
+    bool exhausted = !pool.tryAcquire();
+    std::sort(returned.begin(), returned.end());
+    std::vector<ObjectDetector*> expected = sessions;
+    std::sort(expected.begin(), expected.end());
+    bool all_returned = exhausted && returned == expected &&
+                        std::adjacent_find(returned.begin(), returned.end()) == returned.end() &&
+                        std::find(returned.begin(), returned.end(), nullptr) == returned.end();
+
+    if (overlaps != 0 || unknown != 0 || !all_returned) {
+        spdlog::error("[FAIL] detector pool: {} overlapping holds, {} unknown sessions, all returned {}",
+                      overlaps.load(), unknown.load(), all_returned);
+        return false;
+    }
+    spdlog::info("[PASS] detector pool ({} threads, {} sessions, {} leases)", threads, pool.size(), acquired.load());
+    return true;
+}
+
+// 异步检测：大量并发请求全部正确完成且在途数不超过上限；reject策略下拒绝数与完成数之和等于提交数；
+// 排队中的请求可以取消，取消的future抛出AsyncDetectError
+bool testAsyncDetect() {
+    JsonConfigManager config_manager = tinyModelConfig();
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::err);
+    DetectorPool pool;
+    ObjectDetector reference_detector;
+    bool initialized = pool.initialize(config_manager, 2) && reference_detector.initialize(config_manager);
+    if (!initialized) {
+        spdlog::set_level(level);
+        spdlog::error("[FAIL] async detect: cannot load {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::RNG rng(9);
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<DetectionResult>> expected;
+    for (int i = 0; i < 4; ++i) {
+        cv::Mat image(720, 1280, CV_8UC3, cv::Scalar(0, 0, 0));
+        for (int k = 0; k < 6; ++k) {
+            cv::rectangle(image, cv::Rect(rng.uniform(0, 900), rng.uniform(0, 500), rng.uniform(40, 300),
+                                          rng.uniform(40, 200)),
+                          cv::Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), cv::FILLED);
+        }
+        images.push_back(image);
+        expected.push_back(reference_detector.detect(image));
+    }
+
+    // wait策略：一次提交200个请求，提交方在在途数达到上限时阻塞
+    AsyncConfig config;
+    config.max_in_flight = 4;
+    config.overflow = "wait";
+    AsyncDetector async_detector;
+    async_detector.initialize(pool, config);
+    const int num_requests = 200;
+    std::vector<std::future<std::vector<DetectionResult>>> futures;
+    for (int i = 0; i < num_requests; ++i) {
+        futures.push_back(async_detector.detectAsync(images[i % images.size()]));
+    }
+    int correct = 0;
+    for (int i = 0; i < num_requests; ++i) {
+        std::vector<DetectionResult> results = futures[i].get();
+        const std::vector<DetectionResult>& reference = expected[i % expected.size()];
+        bool same = results.size() == reference.size();
+        for (size_t j = 0; same && j < results.size(); ++j) {
+            same = results[j].box == reference[j].box && results[j].class_id == reference[j].class_id;
+        }
+        correct += same ? 1 : 0;
+    }
+    async_detector.waitIdle();
+    AsyncStats wait_stats = async_detector.getStats();
+    bool wait_ok = correct == num_requests && wait_stats.completed == static_cast<uint64_t>(num_requests) &&
+                   wait_stats.peak_in_flight <= 4 && wait_stats.in_flight == 0;
+
+    // reject策略：超出上限的请求立即以Rejected结束
+    config.overflow = "reject";
+    async_detector.initialize(pool, config);
+    std::atomic<int> callback_completed{0};
+    std::atomic<int> callback_rejected{0};
+    for (int i = 0; i < 50; ++i) {
+        async_detector.submit(images[i % images.size()],
+                              [&](uint64_t, AsyncStatus status, std::vector<DetectionResult>&) {
+            if (status == AsyncStatus::Completed) {
+                ++callback_completed;
+            } else if (status == AsyncStatus::Rejected) {
+                ++callback_rejected;
+            }
+        });
+    }
+    async_detector.waitIdle();
+    AsyncStats reject_stats = async_detector.getStats();
+    bool reject_ok = callback_rejected > 0 && callback_completed + callback_rejected == 50 &&
+                     reject_stats.rejected == static_cast<uint64_t>(callback_rejected.load()) &&
+                     reject_stats.peak_in_flight <= 4;
+
+    // 推理出错（空图像在预处理中抛出异常）的请求以Failed结束，而不是以空结果Completed
+    uint64_t failed_before = async_detector.getStats().failed;
+    bool failed_ok = false;
+    try {
+        async_detector.detectAsync(cv::Mat()).get();
+    }
+    catch (const AsyncDetectError& e) {
+        failed_ok = e.status() == AsyncStatus::Failed;
+    }
+    async_detector.waitIdle();
+    failed_ok = failed_ok && async_detector.getStats().failed == failed_before + 1;
+
+    // 取消：单个工作线程忙碌时排队的请求
+    DetectorPool single_pool;
+    single_pool.initialize(config_manager, 1);
+    config.max_in_flight = 16;
+    config.overflow = "wait";
+    async_detector.initialize(single_pool, config);
+    std::vector<std::future<std::vector<DetectionResult>>> queued;
+    std::vector<uint64_t> ids(12);
+    for (int i = 0; i < 12; ++i) {
+        queued.push_back(async_detector.detectAsync(images[0], &ids[i]));
+    }
+    bool cancelled_one = async_detector.cancel(ids.back());
+    size_t cancelled = async_detector.cancelAll() + (cancelled_one ? 1 : 0);
+    int thrown = 0;
+    int finished = 0;
+    for (auto& future : queued) {
+        try {
+            future.get();
+            ++finished;
+        }
+        catch (const AsyncDetectError& e) {
+            thrown += e.status() == AsyncStatus::Cancelled ? 1 : 0;
+        }
+    }
+    async_detector.stop();
+    bool cancel_ok = cancelled_one && cancelled > 0 && static_cast<size_t>(thrown) == cancelled && finished + thrown == 12;
+    bool stopped_ok = async_detector.submit(images[0], nullptr) == 0;
+    spdlog::set_level(level);
+
+    if (!wait_ok || !reject_ok || !failed_ok || !cancel_ok || !stopped_ok) {
+        spdlog::error("[FAIL] async detect: wait {} ({}/{} correct, peak {}), reject {} ({} rejected), "
+                      "failed on error {}, cancel {} ({} cancelled, {} finished), reject after stop {}", wait_ok,
+                      correct, num_requests, wait_stats.peak_in_flight, reject_ok, callback_rejected.load(),
+                      failed_ok, cancel_ok, cancelled, finished, stopped_ok);
+        return false;
+    }
+    spdlog::info("[PASS] async detect ({} requests, peak {} in flight, {} rejected, {} cancelled)",
+                 num_requests, wait_stats.peak_in_flight, callback_rejected.load(), cancelled);
+    return true;
+}
+
+// 本机推理服务：多个连接的流水线请求经动态批处理后，结果应与直接detect一致
+bool testInferenceServer() {
+    JsonConfigManager config_manager = tinyModelConfig();
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::err);
+    DetectorPool pool;
+    ObjectDetector reference_detector;
+    bool initialized = pool.initialize(config_manager, 1) && reference_detector.initialize(config_manager);
+    if (!initialized) {
+        spdlog::set_level(level);
+        spdlog::error("[FAIL] inference server: cannot load {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::RNG rng(21);
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<DetectionResult>> expected;
+    for (int i = 0; i < 4; ++i) {
+        cv::Mat image(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+        for (int k = 0; k < 5; ++k) {
+            cv::rectangle(image, cv::Rect(rng.uniform(0, 450), rng.uniform(0, 300), rng.uniform(40, 180),
+                                          rng.uniform(40, 160)),
+                          cv::Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), cv::FILLED);
+        }
+        images.push_back(image);
+        expected.push_back(reference_detector.detect(image));
+    }
+    auto sameResults = [](const std::vector<DetectionResult>& a, const std::vector<DetectionResult>& b) {
+        bool same = a.size() == b.size();
+        for (size_t j = 0; same && j < a.size(); ++j) {
+            same = a[j].class_id == b[j].class_id && std::abs(a[j].box.x - b[j].box.x) <= 1 &&
+                   std::abs(a[j].box.y - b[j].box.y) <= 1 && std::abs(a[j].box.width - b[j].box.width) <= 1 &&
+                   std::abs(a[j].box.height - b[j].box.height) <= 1;
+        }
+        return same;
+    };
+
+    ServerConfig config;
+    config.socket_path = (std::filesystem::temp_directory_path() / "yolov8infer_test.sock").string();
+    config.max_batch_size = 4;
+    config.max_queue_delay_ms = 20.0f;
+    config.max_pending_per_client = 4;
+    InferenceServer server;
+    if (!server.initialize(pool, config) || !server.start()) {
+        spdlog::set_level(level);
+        spdlog::error("[FAIL] inference server: cannot listen on {}", config.socket_path);
+        return false;
+    }
+
+    // 3个连接各流水线发送4个原始帧请求，排队延迟内到达的请求合并为批次
+    const int num_clients = 3;
+    const int per_client = 4;
+    std::atomic<int> correct{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < num_clients; ++c) {
+        threads.emplace_back([&, c]() {
+            InferenceClient client;
+            if (!client.connect(config.socket_path)) {
+                return;
+            }
+            for (int i = 0; i < per_client; ++i) {
+                client.send(static_cast<uint32_t>(i), images[(c + i) % images.size()]);
+            }
+            std::vector<DetectionResult> results;
+            for (int i = 0; i < per_client; ++i) {
+                uint32_t id = 0;
+                inference_protocol::ResponseStatus status;
+                if (!client.receive(id, status, results) || id >= static_cast<uint32_t>(per_client)) {
+                    return;
+                }
+                bool ok = status == inference_protocol::ResponseStatus::Ok &&
+                          sameResults(results, expected[(c + id) % expected.size()]);
+                correct += ok ? 1 : 0;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // 编码图像（PNG无损）、无法解码的数据与同步detect
+    InferenceClient client;
+    bool connected = client.connect(config.socket_path);
+    std::vector<uchar> png;
+    cv::imencode(".png", images[1], png);
+    std::vector<uchar> garbage(100, 7);
+    std::vector<DetectionResult> encoded_results;
+    std::vector<DetectionResult> sync_results;
+    uint32_t id = 0;
+    inference_protocol::ResponseStatus encoded_status = inference_protocol::ResponseStatus::Failed;
+    inference_protocol::ResponseStatus garbage_status = inference_protocol::ResponseStatus::Ok;
+    bool encoded_ok = connected && client.sendEncoded(100, png) &&
+                      client.receive(id, encoded_status, encoded_results) && id == 100 &&
+                      encoded_status == inference_protocol::ResponseStatus::Ok &&
+                      sameResults(encoded_results, expected[1]);
+    bool garbage_ok = connected && client.sendEncoded(101, garbage) &&
+                      client.receive(id, garbage_status, encoded_results) && id == 101 &&
+                      garbage_status == inference_protocol::ResponseStatus::BadRequest;
+    bool sync_ok = connected && client.detect(images[2], sync_results) && sameResults(sync_results, expected[2]);
+
+    // 推理出错（会话的Run被中止）的请求以Failed响应而不是Ok与空结果；恢复后照常返回结果
+    pool.acquire()->setTerminate(true);
+    inference_protocol::ResponseStatus failed_status = inference_protocol::ResponseStatus::Ok;
+    bool failed_ok = connected && client.send(102, images[0]) && client.receive(id, failed_status, encoded_results) &&
+                     id == 102 && failed_status == inference_protocol::ResponseStatus::Failed &&
+                     encoded_results.empty();
+    pool.acquire()->setTerminate(false);
+    failed_ok = failed_ok && client.detect(images[0], sync_results) && sameResults(sync_results, expected[0]);
+    client.close();
+
+    ServerStats stats = server.getStats();
+    server.stop();
+    spdlog::set_level(level);
+
+    const int total = num_clients * per_client;
+    bool batched = stats.largest_batch > 1 && stats.largest_batch <= 4;
+    if (correct != total || !encoded_ok || !garbage_ok || !sync_ok || !failed_ok || !batched ||
+        stats.bad_requests != 1 || stats.failed != 1) {
+        spdlog::error("[FAIL] inference server: {}/{} pipelined correct, encoded {}, bad request {}, sync {}, "
+                      "failed on error {} ({} failed), largest batch {}", correct.load(), total, encoded_ok,
+                      garbage_ok, sync_ok, failed_ok, stats.failed, stats.largest_batch);
+        return false;
+    }
+    spdlog::info("[PASS] inference server ({} requests in {} batches, largest {})", stats.completed, stats.batches,
+                 stats.largest_batch);
+    return true;
+}
+
+// 共享内存帧环：block模式按序无丢失，overwrite模式只保留最新的槽位数帧，结果环带回帧号
+bool testSharedFrameRing() {
+    ShmRingConfig config;
+    config.name = "yolov8infer_test_ring";
+    config.slots = 4;
+    config.max_width = 320;
+    config.max_height = 240;
+    config.overflow = "block";
+
+    FrameRingReader reader;
+    if (!reader.create(config)) {
+        spdlog::error("[FAIL] shared frame ring: cannot create shared memory");
+        return false;
+    }
+
+    // block：生产方线程写入60帧（尺寸与像素随帧号变化），检测方逐帧校验后写回结果
+    const int num_frames = 60;
+    std::atomic<int> results_ok{0};
+    std::thread producer([&]() {
+        FrameRingWriter writer;
+        if (!writer.open(config.name)) {
+            return;
+        }
+        std::vector<DetectionResult> results;
+        uint64_t result_id = 0;
+        for (int i = 0; i < num_frames; ++i) {
+            cv::Mat image(120 + i, 160 + 2 * i, CV_8UC3, cv::Scalar(i, 255 - i, 7));
+            writer.writeFrame(image, 1000 + i);
+            while (writer.readResults(result_id, results, 0)) {
+                results_ok += results.size() == 1 && results[0].class_id == static_cast<int>(result_id % 80) ? 1 : 0;
+            }
+        }
+        while (results_ok < num_frames && writer.readResults(result_id, results, 1000)) {
+            results_ok += results.size() == 1 && results[0].class_id == static_cast<int>(result_id % 80) ? 1 : 0;
+        }
+        writer.close();
+    });
+
+    cv::Mat frame;
+    uint64_t frame_id = 0;
+    int in_order = 0;
+    int64_t expected_id = 1000;
+    while (reader.nextFrame(frame, frame_id, 2000)) {
+        int i = static_cast<int>(frame_id - 1000);
+        cv::Vec3b pixel = frame.at<cv::Vec3b>(frame.rows - 1, frame.cols - 1);
+        bool ok = static_cast<int64_t>(frame_id) == expected_id && frame.cols == 160 + 2 * i &&
+                  frame.rows == 120 + i && pixel == cv::Vec3b(i, 255 - i, 7);
+        in_order += ok ? 1 : 0;
+        ++expected_id;
+        DetectionResult result;
+        result.box = cv::Rect(0, 0, frame.cols, frame.rows);
+        result.class_id = static_cast<int>(frame_id % 80);
+        result.confidence = 1.0f;
+        reader.releaseFrame();
+        reader.writeResults(frame_id, { result }, 1000);
+    }
+    producer.join();
+    RingStats block_stats = reader.frameStats();
+    bool block_ok = in_order == num_frames && results_ok == num_frames && block_stats.dropped == 0 &&
+                    reader.producerClosed();
+
+    // overwrite：检测方不读取时生产方不阻塞，之后只能读到最新的4帧
+    config.overflow = "overwrite";
+    reader.create(config);
+    FrameRingWriter writer;
+    bool opened = writer.open(config.name);
+    cv::Mat image(240, 320, CV_8UC3, cv::Scalar(1, 2, 3));
+    int written = 0;
+    for (int i = 0; opened && i < 10; ++i) {
+        written += writer.writeFrame(image, i, 0) ? 1 : 0;
+    }
+    std::vector<uint64_t> latest;
+    while (reader.nextFrame(frame, frame_id, 0)) {
+        latest.push_back(frame_id);
+    }
+    reader.releaseFrame();
+    writer.close();
+    RingStats overwrite_stats = reader.frameStats();
+    bool overwrite_ok = written == 10 && latest == std::vector<uint64_t>{ 6, 7, 8, 9 } && overwrite_stats.dropped == 6;
+
+    // 槽位头由另一个进程写入：超出槽位的帧尺寸、错误的类型与超过容量的检测框数都被拒绝
+    config.overflow = "block";
+    reader.create(config);
+    SharedRing forged_frames;
+    SharedRing forged_results;
+    bool forged_opened = forged_frames.open(config.name) && forged_results.open(config.name + "_results");
+    auto forgeFrame = [&](uint64_t tag, int32_t width, int32_t height, int32_t stride, int32_t type) {
+        SharedRing::Slot slot;
+        if (forged_frames.acquireWrite(slot, 0)) {
+            slot.header->tag = tag;
+            slot.header->width = width;
+            slot.header->height = height;
+            slot.header->stride = stride;
+            slot.header->type = type;
+            forged_frames.publish(slot);
+        }
+    };
+    std::vector<uint64_t> accepted;
+    if (forged_opened) {
+        forgeFrame(1, 320, 100000, 960, CV_8UC3);   // 超出槽位
+        forgeFrame(2, 320, 240, 100, CV_8UC3);      // 行字节数小于宽度
+        forgeFrame(3, 320, 240, 960 * 4, CV_32FC3); // 类型不符
+        forgeFrame(4, 320, 240, 960, CV_8UC3);
+        while (reader.nextFrame(frame, frame_id, 0)) {
+            accepted.push_back(frame_id);
+        }
+        reader.releaseFrame();
+    }
+    FrameRingWriter result_writer;
+    std::vector<DetectionResult> forged;
+    uint64_t forged_id = 0;
+    bool oversized_rejected = false;
+    if (forged_opened && result_writer.open(config.name)) {
+        SharedRing::Slot slot;
+        if (forged_results.acquireWrite(slot, 0)) {
+            slot.header->tag = 7;
+            slot.header->width = config.max_detections + 1;
+            forged_results.publish(slot);
+            oversized_rejected = !result_writer.readResults(forged_id, forged, 0);
+        }
+    }
+    bool forged_ok = forged_opened && accepted == std::vector<uint64_t>{ 4 } && oversized_rejected;
+    forged_frames.close();
+    forged_results.close();
+    result_writer.close();
+    reader.close();
+
+    if (!block_ok || !overwrite_ok || !forged_ok) {
+        spdlog::error("[FAIL] shared frame ring: block {} ({}/{} frames in order, {} results), overwrite {} "
+                      "({} written, {} read, {} dropped), malformed headers rejected {}", block_ok, in_order,
+                      num_frames, results_ok.load(), overwrite_ok, written, latest.size(), overwrite_stats.dropped,
+                      forged_ok);
+        return false;
+    }
+    spdlog::info("[PASS] shared frame ring ({} frames in order, {} overwritten)", num_frames,
+                 overwrite_stats.dropped);
+    return true;
+}
+
+// 帧门控：静止帧与轻微噪声返回缓存结果，监测区域内的变化触发推理，区域外的变化不触发；
+// 画面一直不变时缓存结果复用max_stale_frames帧后强制推理一次
+bool testFrameGate() {
+    std::unique_ptr<ObjectDetector> detector = makeTinyDetector();
+    if (!detector) {
+        spdlog::error("[FAIL] frame gate: cannot load {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::Mat base(1080, 1920, CV_8UC3);
+    cv::randu(base, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::GaussianBlur(base, base, cv::Size(9, 9), 0);
+    cv::rectangle(base, cv::Rect(300, 200, 700, 500), cv::Scalar(255, 255, 255), cv::FILLED);
+    cv::Mat noise(base.size(), CV_8UC3);
+    cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(3));
+    cv::Mat noisy;
+    cv::add(base, noise, noisy);
+    cv::Mat left_change = base.clone();
+    cv::rectangle(left_change, cv::Rect(100, 700, 200, 200), cv::Scalar(0, 0, 0), cv::FILLED);
+    cv::Mat right_change = base.clone();
+    cv::rectangle(right_change, cv::Rect(1500, 600, 200, 200), cv::Scalar(0, 0, 0), cv::FILLED);
+
+    GateConfig config;
+    config.max_stale_frames = 0;
+    config.max_stale_ms = 0;
+    FrameGate gate;
+    gate.initialize(*detector, config);
+    std::vector<DetectionResult> first;
+    std::vector<DetectionResult> results;
+    bool sequence_ok = gate.process(base, first);
+    sequence_ok = sequence_ok && !gate.process(base, results) && results.size() == first.size();
+    sequence_ok = sequence_ok && !gate.process(noisy, results);
+    sequence_ok = sequence_ok && gate.process(left_change, results);
+    sequence_ok = sequence_ok && gate.process(base, results);
+
+    // 只监测左半幅
+    cv::Mat mask(base.size(), CV_8UC1, cv::Scalar(0));
+    mask(cv::Rect(0, 0, base.cols / 2, base.rows)).setTo(255);
+    gate.setMask(mask);
+    bool mask_ok = gate.process(base, results);
+    mask_ok = mask_ok && !gate.process(right_change, results) && gate.process(left_change, results);
+
+    config.max_stale_frames = 5;
+    FrameGate stale_gate;
+    stale_gate.initialize(*detector, config);
+    for (int i = 0; i < 10; ++i) {
+        stale_gate.process(base, results);
+    }
+    const GateStats& stats = stale_gate.getStats();
+    bool stale_ok = stats.inferred == 2 && stats.cached == 8 && stats.stale_refreshes == 1 &&
+                    std::abs(stats.hitRate() - 0.8) < 1e-9;
+
+    // 推理出错的帧返回空结果，但不替换参考帧与缓存：静止画面仍返回上次成功的结果，
+    // 变化的画面在推理恢复后再次触发推理
+    config.max_stale_frames = 0;
+    FrameGate failure_gate;
+    failure_gate.initialize(*detector, config);
+    bool failure_ok = failure_gate.process(base, first);
+    detector->setTerminate(true);
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::critical);
+    failure_ok = failure_ok && !failure_gate.process(left_change, results) && results.empty();
+    spdlog::set_level(level);
+    failure_ok = failure_ok && !failure_gate.process(base, results) && results.size() == first.size();
+    detector->setTerminate(false);
+    failure_ok = failure_ok && failure_gate.process(left_change, results);
+    const GateStats& failure_stats = failure_gate.getStats();
+    failure_ok = failure_ok && failure_stats.failed == 1 && failure_stats.inferred == 2;
+
+    if (!sequence_ok || !mask_ok || !stale_ok || !failure_ok) {
+        spdlog::error("[FAIL] frame gate: sequence {}, mask {}, staleness {} ({} inferred, {} cached, {} stale), "
+                      "failed inference kept reference {}", sequence_ok, mask_ok, stale_ok, stats.inferred,
+                      stats.cached, stats.stale_refreshes, failure_ok);
+        return false;
+    }
+    spdlog::info("[PASS] frame gate (hit rate {:.0f}% on a static scene with max_stale_frames 5)",
+                 stats.hitRate() * 100.0);
+    return true;
+}
+
+// 执行提供者：名称规范化；未编译进来的提供者被跳过而不是导致初始化失败；
+// auto模式测量后选出一个可用的提供者并写入缓存文件，第二个实例直接使用缓存的选择
+bool testExecutionProviders() {
+    std::vector<ProviderSpec> specs = ExecutionProviders::fromConfig(
+        { "XNNPACK", "oneDNN", "cpu" }, { { "XnnPack", { { "intra_op_num_threads", "2" } } } }, "CPU");
+    bool names_ok = specs.size() == 3 && specs[0].name == "xnnpack" && specs[1].name == "dnnl" &&
+                    specs[0].options.count("intra_op_num_threads") == 1 &&
+                    ExecutionProviders::fromConfig({}, {}, "GPU").front().name == "cuda";
+    // 优化后模型缓存的提供者标签：按实际生效的提供者区分，带选项时附加选项哈希
+    std::string tag = ExecutionProviders::cacheTag(specs, { "xnnpack", "cpu" });
+    names_ok = names_ok && ExecutionProviders::cacheTag(specs, { "cpu" }) == "cpu" &&
+               tag.size() == 20 && tag.rfind("xnnpack-cpu-", 0) == 0 &&
+               tag != ExecutionProviders::cacheTag(ExecutionProviders::fromConfig({ "xnnpack" }, {}, "CPU"),
+                                                   { "xnnpack", "cpu" });
+
+    JsonConfigManager config_manager = tinyModelConfig();
+    ModelConfig model_config = config_manager.getModelConfig();
+    model_config.providers = { "openvino", "dnnl", "xnnpack", "cpu" };
+    config_manager.setModelConfig(model_config);
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::err);
+    ObjectDetector fallback_detector;
+    bool fallback_ok = fallback_detector.initialize(config_manager);
+    const std::vector<std::string>& active = fallback_detector.getActiveProviders();
+    fallback_ok = fallback_ok && !active.empty() && active.back() == "cpu" &&
+                  std::all_of(active.begin(), active.end(), ExecutionProviders::isAvailable);
+
+    std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "yolov8infer_provider_cache.json";
+    std::filesystem::remove(cache_path);
+    model_config.providers = { "auto" };
+    model_config.provider_cache_path = cache_path.string();
+    model_config.provider_probe_runs = 2;
+    config_manager.setModelConfig(model_config);
+    ObjectDetector auto_detector;
+    ObjectDetector cached_detector;
+    bool auto_ok = auto_detector.initialize(config_manager) && cached_detector.initialize(config_manager);
+    spdlog::set_level(level);
+    std::string cached_choice;
+    if (auto_ok && std::filesystem::exists(cache_path)) {
+        std::ifstream file(cache_path);
+        nlohmann::json cache = nlohmann::json::parse(file);
+        cached_choice = cache.size() == 1 ? cache.begin().value()["provider"].get<std::string>() : "";
+    }
+    std::filesystem::remove(cache_path);
+    std::string chosen = auto_ok ? auto_detector.getActiveProviders().front() : "";
+    auto_ok = auto_ok && !cached_choice.empty() && cached_choice == chosen &&
+              cached_detector.getActiveProviders().front() == chosen;
+    cv::Mat image(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+    std::vector<DetectionResult> results;
+    if (auto_ok) {
+        auto_detector.detect(image, results);
+    }
+
+    if (!names_ok || !fallback_ok || !auto_ok) {
+        spdlog::error("[FAIL] execution providers: names {}, fallback {}, auto {} (chose '{}', cached '{}')",
+                      names_ok, fallback_ok, auto_ok, chosen, cached_choice);
+        return false;
+    }
+    spdlog::info("[PASS] execution providers (fallback used {} provider(s), auto chose {})", active.size(), chosen);
+    return true;
+}
+
+// 多实例分片：CPU列表解析与核组切分（不跨节点、按节点轮流分配）；
+// stream_affinity下同一路流的帧按提交顺序完成，结果与单个检测器一致
+bool testShardedRunner() {
+    std::vector<int> cpus = NumaTopology::parseCpuList("0-3,8-11,5");
+    std::vector<CoreGroup> nodes = { { 0, { 0, 1, 2, 3, 4 } }, { 1, { 8, 9, 10, 11, 12 } } };
+    std::vector<CoreGroup> groups = NumaTopology::split(nodes, 2);
+    bool topology_ok = NumaTopology::formatCpuList(cpus) == "0-3,5,8-11" && groups.size() == 4 &&
+                       groups[1].cpus == std::vector<int>{ 2, 3, 4 } && groups[2].node == 1 &&
+                       !NumaTopology::discover().front().cpus.empty();
+
+    JsonConfigManager config_manager = tinyModelConfig();
+    ShardConfig shard_config;
+    shard_config.group_by = "cores";
+    shard_config.cores_per_instance = 1;
+    shard_config.max_instances = 2;
+    shard_config.balance = "stream_affinity";
+    shard_config.queue_capacity = 2;
+    config_manager.setShardConfig(shard_config);
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::err);
+    ObjectDetector reference_detector;
+    ShardedRunner runner;
+    bool initialized = reference_detector.initialize(config_manager) && runner.initialize(config_manager);
+    spdlog::set_level(level);
+    if (!initialized) {
+        spdlog::error("[FAIL] sharded runner: cannot initialize with {}/tiny_yolov8.onnx", YOLO_TEST_DATA_DIR);
+        return false;
+    }
+
+    cv::RNG rng(11);
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<DetectionResult>> expected;
+    for (int i = 0; i < 4; ++i) {
+        cv::Mat image(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+        cv::rectangle(image, cv::Rect(rng.uniform(0, 300), rng.uniform(0, 200), rng.uniform(80, 300),
+                                      rng.uniform(80, 250)), cv::Scalar(255, 255, 255), cv::FILLED);
+        images.push_back(image);
+        expected.push_back(reference_detector.detect(image));
+    }
+
+    // 两路流交替提交，回调记录每路流的完成顺序
+    const int frames_per_stream = 20;
+    std::mutex mutex;
+    std::vector<std::vector<int>> completed(2);
+    std::atomic<int> correct{0};
+    for (int i = 0; i < frames_per_stream; ++i) {
+        for (int stream = 0; stream < 2; ++stream) {
+            int index = (i + stream) % static_cast<int>(images.size());
+            runner.submit(images[index], [&, stream, i, index](uint64_t, AsyncStatus status,
+                                                                std::vector<DetectionResult>& results) {
+                const std::vector<DetectionResult>& reference = expected[index];
+                bool same = status == AsyncStatus::Completed && results.size() == reference.size();
+                for (size_t j = 0; same && j < results.size(); ++j) {
+                    same = results[j].box == reference[j].box && results[j].class_id == reference[j].class_id;
+                }
+                correct += same ? 1 : 0;
+                std::lock_guard<std::mutex> lock(mutex);
+                completed[stream].push_back(i);
+            }, stream);
+        }
+    }
+    runner.waitIdle();
+    bool in_order = true;
+    for (const auto& order : completed) {
+        in_order = in_order && order.size() == frames_per_stream && std::is_sorted(order.begin(), order.end());
+    }
+    uint64_t total = 0;
+    for (const ShardStats& stats : runner.getStats()) {
+        total += stats.completed;
+    }
+    int instances = runner.size();
+    runner.stop();
+
+    // 停止后提交的帧立即以失败结束
+    bool rejected = false;
+    try {
+        runner.detect(images[0]);
+    }
+    catch (const AsyncDetectError& e) {
+        rejected = e.status() == AsyncStatus::Failed;
+    }
+    bool runner_ok = correct == 2 * frames_per_stream && in_order && total == 2 * frames_per_stream && rejected;
+
+    if (!topology_ok || !runner_ok) {
+        spdlog::error("[FAIL] sharded runner: topology {}, {}/{} frames correct, in order {}, {} completed, "
+                      "rejected after stop {}", topology_ok, correct.load(), 2 * frames_per_stream, in_order, total,
+                      rejected);
+        return false;
+    }
+    spdlog::info("[PASS] sharded runner ({} frames on {} instance(s))", total, instances);
+    return true;
+}
+
+int main() {
+    ObjectDetector detector;
+    int failures = 0;
+
+    cv::Mat image_1080p(1080, 1920, CV_8UC3);
+    cv::randu(image_1080p, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat image_4k(2160, 3840, CV_8UC3);
+    cv::randu(image_4k, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat image_small(200, 300, CV_8UC3);
+    cv::randu(image_small, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    failures += !testFusedPreprocessMatchesReference(detector, image_1080p, cv::Size(640, 640), "fused preprocess 1080p");
+    failures += !testFusedPreprocessMatchesReference(detector, image_4k, cv::Size(640, 640), "fused preprocess 4K");
+    failures += !testFusedPreprocessMatchesReference(detector, image_small, cv::Size(640, 640), "fused preprocess upscale");
+    failures += !testFusedPreprocessMatchesReference(detector, image_1080p, cv::Size(640, 384), "fused preprocess non-square");
+    failures += !testFusedPreprocessMatchesReference(detector, image_1080p(cv::Rect(100, 50, 800, 900)),
+                                                     cv::Size(640, 640), "fused preprocess ROI");
+
+    failures += !testOutputDecoderMatchesScalar(1, 13125);
+    failures += !testOutputDecoderMatchesScalar(80, 8400);
+    failures += !testOutputDecoderMatchesScalar(7, 8403);
+    failures += !testNmsTrueUnionIoU();
+    failures += !testNmsClassAware();
+    failures += !testNmsMatchesBruteForce(2000, 1);
+    failures += !testNmsMatchesBruteForce(2000, 3);
+
+    // 内核按运行时检测到的指令集分派，上面覆盖了最高级别，这里逐级降低后再与参考实现比较
+    for (int level = static_cast<int>(SimdDispatch::detected()) - 1; level >= 0; --level) {
+        SimdDispatch::setMaxLevel(static_cast<SimdLevel>(level));
+        spdlog::info("SIMD kernels limited to {}", SimdDispatch::name(SimdDispatch::level()));
+        failures += !testFusedPreprocessMatchesReference(detector, image_1080p, cv::Size(640, 640), "fused preprocess 1080p");
+        failures += !testOutputDecoderMatchesScalar(80, 8400);
+        failures += !testOutputDecoderMatchesScalar(7, 8403);
+        failures += !testNmsMatchesBruteForce(2000, 3);
+    }
+    SimdDispatch::setMaxLevel(SimdLevel::Avx2);
+    failures += !testPreprocessZeroAllocation();
+    failures += !testPostprocessZeroAllocation();
+    failures += !testDetectZeroAllocation();
+    failures += !testSpscQueueOrdering();
+    failures += !testTelemetryHistogram();
+    failures += !testImageSourceEnumeration();
+    failures += !testReducedDecode();
+    failures += !testSelectQuantizedModel();
+    failures += !testTinyModelDetectBatchMatchesDetect();
+    failures += !testUint8InputMatchesFloat();
+    failures += !testEndToEndMatchesRawPostprocess();
+    failures += !testTiledDetection();
+    failures += !testObjectTracking();
+    failures += !testMinimalLetterbox();
+    failures += !testDetectorPoolConcurrency();
+    failures += !testAsyncDetect();
+    failures += !testInferenceServer();
+    failures += !testSharedFrameRing();
+    failures += !testFrameGate();
+    failures += !testExecutionProviders();
+    failures += !testShardedRunner();
+
+    if (failures > 0) {
+        spdlog::error("{} test(s) failed", failures);
+        return 1;
+    }
+    spdlog::info("All tests passed");
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include "ObjectDetector.h"
+#include "TiledDetector.h"
+#include "JsonConfigManager.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 切片检测基准：与单次整图detect比较延迟（p50/p99）和召回率。
+// - 提供YOLO格式标签文件（每行 class cx cy w h，归一化坐标）时，以标注为参照计算召回率，
+//   并单独统计小目标（原图中短边 < 32 像素）的召回率
+// - 无标签时只比较两种方式的检测结果：整图结果被切片结果覆盖的比例，以及只有切片检测到的框数
+// 扫描 整图检测开/关 × 会话数（1、2、4，不超过CPU核数）。
+// 用法: tiling_benchmark [配置文件] [迭代次数] [图像路径] [YOLO标签文件]
+
+struct RunStats {
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+};
+
+template <typename Func>
+RunStats measure(Func&& func, int iterations) {
+    func();
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    RunStats stats;
+    stats.p50_ms = samples[samples.size() / 2];
+    stats.p99_ms = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    return stats;
+}
+
+// 4K场景：低对比度纹理背景上分布大量小目标和少量大目标
+cv::Mat makeScene(const cv::Size& size) {
+    cv::Mat image(size, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(64));
+    cv::GaussianBlur(image, image, cv::Size(0, 0), 3.0);
+    cv::RNG rng(7);
+    for (int i = 0; i < 200; ++i) {
+        int side = rng.uniform(12, 40);
+        cv::Rect rect(rng.uniform(0, size.width - side), rng.uniform(0, size.height - side), side, side);
+        cv::rectangle(image, rect, cv::Scalar(rng.uniform(128, 256), rng.uniform(128, 256), rng.uniform(128, 256)),
+                      cv::FILLED);
+    }
+    for (int i = 0; i < 5; ++i) {
+        cv::Rect rect(rng.uniform(0, size.width / 2), rng.uniform(0, size.height / 2), size.width / 4, size.height / 3);
+        cv::rectangle(image, rect, cv::Scalar(rng.uniform(64, 256), rng.uniform(64, 256), rng.uniform(64, 256)),
+                      cv::FILLED);
+    }
+    return image;
+}
+
+std::vector<DetectionResult> loadLabels(const std::string& path, const cv::Size& image_size) {
+    std::vector<DetectionResult> labels;
+    std::ifstream file(path);
+    DetectionResult label;
+    float cx = 0.0f, cy = 0.0f, w = 0.0f, h = 0.0f;
+    while (file >> label.class_id >> cx >> cy >> w >> h) {
+        label.box = cv::Rect(cvRound((cx - w / 2) * image_size.width), cvRound((cy - h / 2) * image_size.height),
+                             cvRound(w * image_size.width), cvRound(h * image_size.height));
+        label.confidence = 1.0f;
+        labels.push_back(label);
+    }
+    return labels;
+}
+
+float iou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = static_cast<float>((a & b).area());
+    float uni = static_cast<float>(a.area() + b.area()) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+// 同类别IoU >= 0.5的贪心一对一匹配，返回reference中被匹配的数量（small_only时只统计小目标）
+int countMatches(const std::vector<DetectionResult>& reference, const std::vector<DetectionResult>& results,
+                 bool small_only, int* total) {
+    std::vector<bool> used(results.size(), false);
+    int matched = 0;
+    *total = 0;
+    for (const auto& expected : reference) {
+        if (small_only && std::min(expected.box.width, expected.box.height) >= 32) {
+            continue;
+        }
+        ++*total;
+        int best = -1;
+        float best_iou = 0.5f;
+        for (size_t j = 0; j < results.size(); ++j) {
+            if (!used[j] && results[j].class_id == expected.class_id) {
+                float value = iou(expected.box, results[j].box);
+                if (value >= best_iou) {
+                    best_iou = value;
+                    best = static_cast<int>(j);
+                }
+            }
+        }
+        if (best >= 0) {
+            used[best] = true;
+            ++matched;
+        }
+    }
+    return matched;
+}
+
+int main(int argc, char* argv[]) {
+    std::string config_path = argc > 1 ? argv[1] : "configs/cpu_config.json";
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    std::string image_path = argc > 3 ? argv[3] : "";
+    std::string label_path = argc > 4 ? argv[4] : "";
+
+    JsonConfigManager config_manager(config_path);
+    if (!config_manager.loadConfig()) {
+        spdlog::error("Failed to load config: {}", config_path);
+        return 1;
+    }
+
+    cv::Mat image = image_path.empty() ? cv::Mat() : cv::imread(image_path, cv::IMREAD_COLOR);
+    if (image.empty()) {
+        spdlog::info("Using a synthetic 3840x2160 scene");
+        image = makeScene(cv::Size(3840, 2160));
+    }
+    std::vector<DetectionResult> labels;
+    if (!label_path.empty()) {
+        labels = loadLabels(label_path, image.size());
+        spdlog::info("Loaded {} labels from {}", labels.size(), label_path);
+    }
+
+    spdlog::set_level(spdlog::level::warn);
+    ObjectDetector detector;
+    bool initialized = detector.initialize(config_manager);
+    spdlog::set_level(spdlog::level::info);
+    if (!initialized) {
+        spdlog::error("Failed to initialize detector");
+        return 1;
+    }
+
+    std::vector<DetectionResult> single_results;
+    RunStats single = measure([&]() { detector.detect(image, single_results); }, iterations);
+    auto logRecall = [&labels](const std::vector<DetectionResult>& results) {
+        if (labels.empty()) {
+            return;
+        }
+        int total = 0;
+        int small_total = 0;
+        int matched = countMatches(labels, results, false, &total);
+        int small_matched = countMatches(labels, results, true, &small_total);
+        spdlog::info("    recall {:.3f} ({}/{}), small objects {:.3f} ({}/{})",
+                     total > 0 ? static_cast<double>(matched) / total : 0.0, matched, total,
+                     small_total > 0 ? static_cast<double>(small_matched) / small_total : 0.0,
+                     small_matched, small_total);
+    };
+    spdlog::info("{}x{} image, single-pass detect: p50 {:.2f} ms, p99 {:.2f} ms, {} boxes",
+                 image.cols, image.rows, single.p50_ms, single.p99_ms, single_results.size());
+    logRecall(single_results);
+
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    TilingConfig base = config_manager.getTilingConfig();
+    for (bool full_image_pass : { false, true }) {
+        for (int sessions : { 1, 2, 4 }) {
+            if (sessions > cores) {
+                continue;
+            }
+            TilingConfig tiling = base;
+            tiling.full_image_pass = full_image_pass;
+            tiling.sessions = sessions;
+            config_manager.setTilingConfig(tiling);
+
+            spdlog::set_level(spdlog::level::warn);
+            TiledDetector tiled;
+            initialized = tiled.initialize(config_manager);
+            spdlog::set_level(spdlog::level::info);
+            if (!initialized) {
+                spdlog::error("Failed to initialize tiled detector with {} sessions", sessions);
+                return 1;
+            }
+
+            std::vector<DetectionResult> tiled_results;
+            RunStats stats = measure([&]() { tiled.detect(image, tiled_results); }, iterations);
+            spdlog::info("tiled {}x{} overlap {:.2f}, full pass {}, {} session(s): {} regions, p50 {:.2f} ms, "
+                         "p99 {:.2f} ms ({:.2f}x single), {} boxes",
+                         tiling.tile_width, tiling.tile_height, tiling.overlap, full_image_pass, sessions,
+                         tiled.lastRegionCount(), stats.p50_ms, stats.p99_ms, stats.p50_ms / single.p50_ms,
+                         tiled_results.size());
+            logRecall(tiled_results);
+            if (labels.empty()) {
+                // 无标注时以整图结果为参照：切片是否保留了整图检测到的目标，以及额外找到多少框
+                int total = 0;
+                int kept = countMatches(single_results, tiled_results, false, &total);
+                spdlog::info("    single-pass boxes also found {:.3f} ({}/{}), tiled-only boxes {}",
+                             total > 0 ? static_cast<double>(kept) / total : 1.0, kept, total,
+                             static_cast<int>(tiled_results.size()) - kept);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include "ObjectDetector.h"
+#include "TrackingDetector.h"
+#include "JsonConfigManager.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// 检测+跟踪基准：在录制的视频上比较逐帧检测与不同关键帧间隔（固定K与自适应）的
+// 有效帧率（只计检测/跟踪耗时，不含视频解码）和跟踪精度。
+// 精度以逐帧检测结果为参照：同类别IoU >= 0.5的贪心匹配给出召回率、精确率与匹配框的平均IoU，
+// 另外统计出现过的轨迹数（同一目标的轨迹断裂会使其增加）。
+// 不提供视频时使用合成的运动矩形序列。
+// 用法: tracking_benchmark [配置文件] [视频路径] [最大帧数]
+
+class FrameSource {
+public:
+    FrameSource(const std::string& path, int max_frames) : path_(path), max_frames_(max_frames) {}
+
+    bool open() {
+        index_ = 0;
+        if (path_.empty()) {
+            return true;
+        }
+        capture_.open(path_);
+        return capture_.isOpened();
+    }
+
+    bool read(cv::Mat& frame) {
+        if (index_ >= max_frames_) {
+            return false;
+        }
+        if (path_.empty()) {
+            renderSynthetic(index_, frame);
+        } else if (!capture_.read(frame)) {
+            return false;
+        }
+        ++index_;
+        return true;
+    }
+
+private:
+    // 720p背景上若干匀速移动、在边缘反弹的矩形
+    static void renderSynthetic(int index, cv::Mat& frame) {
+        frame.create(720, 1280, CV_8UC3);
+        frame.setTo(cv::Scalar(40, 40, 40));
+        cv::RNG rng(11);
+        for (int i = 0; i < 8; ++i) {
+            int w = rng.uniform(60, 200);
+            int h = rng.uniform(60, 200);
+            int range_x = 1280 - w;
+            int range_y = 720 - h;
+            int x = (rng.uniform(0, range_x) + index * rng.uniform(1, 6)) % (2 * range_x);
+            int y = (rng.uniform(0, range_y) + index * rng.uniform(1, 4)) % (2 * range_y);
+            x = x < range_x ? x : 2 * range_x - x;
+            y = y < range_y ? y : 2 * range_y - y;
+            cv::rectangle(frame, cv::Rect(x, y, w, h),
+                          cv::Scalar(rng.uniform(128, 256), rng.uniform(128, 256), rng.uniform(128, 256)), cv::FILLED);
+        }
+    }
+
+    std::string path_;
+    int max_frames_;
+    int index_ = 0;
+    cv::VideoCapture capture_;
+};
+
+float iou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = static_cast<float>((a & b).area());
+    float uni = static_cast<float>(a.area() + b.area()) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+struct Accuracy {
+    int reference = 0;
+    int predicted = 0;
+    int matched = 0;
+    double iou_sum = 0.0;
+    std::set<int> track_ids;
+
+    void add(const std::vector<DetectionResult>& expected, const std::vector<DetectionResult>& results) {
+        reference += static_cast<int>(expected.size());
+        predicted += static_cast<int>(results.size());
+        std::vector<bool> used(results.size(), false);
+        for (const auto& truth : expected) {
+            int best = -1;
+            float best_iou = 0.5f;
+            for (size_t j = 0; j < results.size(); ++j) {
+                if (!used[j] && results[j].class_id == truth.class_id) {
+                    float value = iou(truth.box, results[j].box);
+                    if (value >= best_iou) {
+                        best_iou = value;
+                        best = static_cast<int>(j);
+                    }
+                }
+            }
+            if (best >= 0) {
+                used[best] = true;
+                ++matched;
+                iou_sum += best_iou;
+            }
+        }
+        for (const auto& result : results) {
+            track_ids.insert(result.track_id);
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::string config_path = argc > 1 ? argv[1] : "configs/cpu_config.json";
+    std::string video_path = argc > 2 ? argv[2] : "";
+    int max_frames = argc > 3 ? std::atoi(argv[3]) : 500;
+
+    JsonConfigManager config_manager(config_path);
+    if (!config_manager.loadConfig()) {
+        spdlog::error("Failed to load config: {}", config_path);
+        return 1;
+    }
+
+    spdlog::set_level(spdlog::level::warn);
+    ObjectDetector detector;
+    bool initialized = detector.initialize(config_manager);
+    spdlog::set_level(spdlog::level::info);
+    if (!initialized) {
+        spdlog::error("Failed to initialize detector");
+        return 1;
+    }
+
+    FrameSource source(video_path, max_frames);
+    if (!source.open()) {
+        spdlog::error("Cannot open video: {}", video_path);
+        return 1;
+    }
+
+    // 参照：逐帧完整检测
+    std::vector<std::vector<DetectionResult>> reference;
+    cv::Mat frame;
+    double detect_ms = 0.0;
+    while (source.read(frame)) {
+        reference.emplace_back();
+        auto start = std::chrono::high_resolution_clock::now();
+        detector.detect(frame, reference.back());
+        detect_ms += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    if (reference.empty()) {
+        spdlog::error("No frames read");
+        return 1;
+    }
+    double detect_fps = 1000.0 * reference.size() / detect_ms;
+    spdlog::info("{} frames from {}, detect every frame: {:.1f} fps", reference.size(),
+                 video_path.empty() ? "synthetic scene" : video_path, detect_fps);
+
+    struct Variant {
+        std::string name;
+        int interval;
+        bool adaptive;
+    };
+    const TrackingConfig base = config_manager.getTrackingConfig();
+    std::vector<Variant> variants = { { "every 2", 2, false }, { "every 3", 3, false }, { "every 5", 5, false },
+                                      { "every 10", 10, false },
+                                      { "adaptive " + std::to_string(base.min_interval) + "-" +
+                                        std::to_string(base.max_interval), base.keyframe_interval, true } };
+    for (const auto& variant : variants) {
+        TrackingConfig config = base;
+        config.keyframe_interval = variant.interval;
+        config.adaptive = variant.adaptive;
+        TrackingDetector tracking;
+        tracking.initialize(detector, config);
+
+        if (!source.open()) {
+            spdlog::error("Cannot reopen video: {}", video_path);
+            return 1;
+        }
+        Accuracy accuracy;
+        std::vector<DetectionResult> results;
+        double elapsed_ms = 0.0;
+        for (size_t index = 0; index < reference.size() && source.read(frame); ++index) {
+            auto start = std::chrono::high_resolution_clock::now();
+            tracking.process(frame, results);
+            elapsed_ms += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            accuracy.add(reference[index], results);
+        }
+
+        const TrackingStats& stats = tracking.getStats();
+        double fps = 1000.0 * stats.frames / elapsed_ms;
+        spdlog::info("{:<14} {:>7.1f} fps ({:.2f}x), keyframes {:>5} ({:>4} early), recall {:.3f}, precision {:.3f}, "
+                     "mean IoU {:.3f}, tracks {}",
+                     variant.name, fps, fps / detect_fps, stats.keyframes, stats.early_keyframes,
+                     accuracy.reference > 0 ? static_cast<double>(accuracy.matched) / accuracy.reference : 1.0,
+                     accuracy.predicted > 0 ? static_cast<double>(accuracy.matched) / accuracy.predicted : 1.0,
+                     accuracy.matched > 0 ? accuracy.iou_sum / accuracy.matched : 0.0, accuracy.track_ids.size());
+    }
+    return 0;
+}
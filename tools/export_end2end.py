@@ -0,0 +1,255 @@
+"""在YOLOv8 ONNX模型末尾追加TopK/NonMaxSuppression/Gather节点，生成端到端模型。
+
+原模型输出 [N, 4+C, A]（cx, cy, w, h + C个类别分数）替换为 detections [K, 6]：
+    x1, y1, x2, y2, score, class_id   （模型输入即letterbox图像的像素坐标，按分数降序）
+会话只输出最终检测结果，ObjectDetector按输出签名自动选择图内后处理，不再复制整个原始输出张量。
+
+追加的子图：
+    每个anchor的最大类别分数 -> TopK(--pre-nms-top-k) 截取候选
+    -> NonMaxSuppression(按类别或--agnostic, center_point_box=1)
+    -> Gather候选的框/分数/类别 -> TopK(--max-det) 按分数排序 -> 转为角点坐标
+
+NMS的IoU阈值、最低分数阈值与最大检测数在导出时固定（配置中的confidence_threshold只能进一步提高阈值）。
+输出不含batch序号，端到端模型按单张图像使用。
+
+--postprocess-only 只导出追加的子图（输入为原始输出张量），供基准单独测量图内后处理。
+默认在合成图像上与原模型 + NumPy参考NMS对比，召回率低于--min-recall时以非0状态退出。
+
+用法: python tools/export_end2end.py --model yolov8n.onnx --output yolov8n_end2end.onnx
+      [--score-threshold 0.25] [--iou-threshold 0.45] [--max-det 300] [--pre-nms-top-k 30000]
+      [--agnostic] [--postprocess-only] [--no-verify]
+"""
+import argparse
+import sys
+
+import numpy as np
+import onnx
+from onnx import TensorProto, helper, numpy_helper
+
+
+class GraphBuilder:
+    """按opset生成节点（Unsqueeze/ReduceMax的axes在新opset中改为输入）。"""
+
+    def __init__(self, opset, prefix):
+        self.opset = opset
+        self.prefix = prefix
+        self.nodes = []
+        self.initializers = []
+        self.counter = 0
+
+    def name(self, hint):
+        self.counter += 1
+        return f"{self.prefix}{hint}_{self.counter}"
+
+    def const(self, value, dtype, hint="const"):
+        name = self.name(hint)
+        self.initializers.append(numpy_helper.from_array(np.array(value, dtype=dtype), name))
+        return name
+
+    def op(self, op_type, inputs, outputs=1, hint=None, **attrs):
+        names = [self.name(hint or op_type.lower()) for _ in range(outputs)]
+        self.nodes.append(helper.make_node(op_type, inputs, names, name=self.name(op_type), **attrs))
+        return names[0] if outputs == 1 else names
+
+    def unsqueeze(self, x, axes):
+        if self.opset >= 13:
+            return self.op("Unsqueeze", [x, self.const(axes, np.int64, "axes")])
+        return self.op("Unsqueeze", [x], axes=axes)
+
+    def reduce_max(self, x, axis):
+        if self.opset >= 18:
+            return self.op("ReduceMax", [x, self.const([axis], np.int64, "axes")], keepdims=0)
+        return self.op("ReduceMax", [x], axes=[axis], keepdims=0)
+
+    def slice(self, x, start, end, axis):
+        return self.op("Slice", [x, self.const([start], np.int64, "starts"), self.const([end], np.int64, "ends"),
+                                 self.const([axis], np.int64, "axes")])
+
+
+def build_postprocess(builder, raw, args):
+    """raw: [N, 4+C, A]，返回 [K, 6] 输出名称。"""
+    b = builder
+    boxes = b.op("Transpose", [b.slice(raw, 0, 4, 1)], perm=[0, 2, 1], hint="boxes")      # [N, A, 4]
+    scores = b.slice(raw, 4, np.iinfo(np.int64).max, 1)                                   # [N, C, A]
+    max_scores = b.reduce_max(scores, 1)                                                   # [N, A]
+
+    # 按最大类别分数截取前pre_nms_top_k个anchor（anchor数更少时取全部）
+    anchors = b.slice(b.op("Shape", [max_scores]), 1, 2, 0)
+    k = b.op("Min", [anchors, b.const([args.pre_nms_top_k], np.int64, "top_k")])
+    top_scores, top_index = b.op("TopK", [max_scores, k], outputs=2, axis=1, largest=1, sorted=1)  # [N, K]
+
+    index4 = b.op("Expand", [b.unsqueeze(top_index, [2]), b.const([1, 1, 4], np.int64, "shape")])
+    top_boxes = b.op("GatherElements", [boxes, index4], axis=1)                            # [N, K, 4]
+
+    if args.agnostic:
+        nms_scores = b.unsqueeze(top_scores, [1])                                          # [N, 1, K]
+        classes = b.op("GatherElements", [b.op("ArgMax", [scores], axis=1, keepdims=0), top_index], axis=1)
+    else:
+        num_classes = b.slice(b.op("Shape", [scores]), 1, 2, 0)
+        class_shape = b.op("Concat", [b.const([1], np.int64), num_classes, b.const([1], np.int64)], axis=0)
+        index_c = b.op("Expand", [b.unsqueeze(top_index, [1]), class_shape])
+        top_class_scores = b.op("GatherElements", [scores, index_c], axis=2)               # [N, C, K]
+        # 与OutputDecoder一致：每个anchor只以最大分数的类别参与NMS
+        is_best = b.op("Equal", [top_class_scores, b.unsqueeze(top_scores, [1])])
+        nms_scores = b.op("Where", [is_best, top_class_scores, b.const(0.0, np.float32, "zero")])
+
+    selected = b.op("NonMaxSuppression", [
+        top_boxes, nms_scores,
+        b.const([args.max_det], np.int64, "max_output"),
+        b.const([args.iou_threshold], np.float32, "iou_threshold"),
+        b.const([args.score_threshold], np.float32, "score_threshold"),
+    ], center_point_box=1)                                                                 # [M, 3]: batch, class, k
+
+    batch_and_box = b.op("Gather", [selected, b.const([0, 2], np.int64, "columns")], axis=1)
+    kept_boxes = b.op("GatherND", [top_boxes, batch_and_box])                              # [M, 4]
+    if args.agnostic:
+        kept_scores = b.op("GatherND", [top_scores, batch_and_box])                        # [M]
+        kept_classes = b.unsqueeze(b.op("GatherND", [classes, batch_and_box]), [1])        # [M, 1]
+    else:
+        kept_scores = b.op("GatherND", [nms_scores, selected])
+        kept_classes = b.op("Gather", [selected, b.const([1], np.int64, "class_column")], axis=1)
+
+    # 各类别的结果合并后按分数排序并截取max_det个
+    count = b.op("Shape", [kept_scores])
+    final_k = b.op("Min", [count, b.const([args.max_det], np.int64, "max_det")])
+    final_scores, order = b.op("TopK", [kept_scores, final_k], outputs=2, axis=0, largest=1, sorted=1)
+    final_boxes = b.op("Gather", [kept_boxes, order], axis=0)
+    final_classes = b.op("Cast", [b.op("Gather", [kept_classes, order], axis=0)], to=TensorProto.FLOAT)
+
+    center = b.slice(final_boxes, 0, 2, 1)
+    half = b.op("Mul", [b.slice(final_boxes, 2, 4, 1), b.const(0.5, np.float32, "half")])
+    return b.op("Concat", [b.op("Sub", [center, half]), b.op("Add", [center, half]),
+                           b.unsqueeze(final_scores, [1]), final_classes], axis=1, hint="detections")
+
+
+def export(model, args):
+    graph = model.graph
+    if len(graph.output) != 1:
+        raise ValueError(f"expected a single [N, 4+C, A] output, got {len(graph.output)} outputs")
+    raw = graph.output[0]
+    if len(raw.type.tensor_type.shape.dim) != 3:
+        raise ValueError("expected a rank-3 [N, 4+C, A] output")
+    opset = next((o.version for o in model.opset_import if o.domain in ("", "ai.onnx")), 0)
+    if opset < 11:
+        raise ValueError(f"opset {opset} is too old, NonMaxSuppression/TopK need opset >= 11")
+
+    builder = GraphBuilder(opset, "e2e_")
+    output_name = build_postprocess(builder, raw.name, args)
+    output = helper.make_tensor_value_info("detections", TensorProto.FLOAT, ["num_detections", 6])
+
+    if args.postprocess_only:
+        new_graph = helper.make_graph(builder.nodes, "yolov8_postprocess", [raw], [output], builder.initializers)
+        result = helper.make_model(new_graph, opset_imports=[helper.make_opsetid("", opset)],
+                                   producer_name="YoloV8Infer tools")
+        result.ir_version = model.ir_version
+    else:
+        graph.node.extend(builder.nodes)
+        graph.initializer.extend(builder.initializers)
+        graph.output.remove(raw)
+        graph.output.append(output)
+        result = model
+    # 最后一个Concat的输出改名为detections
+    for node in result.graph.node:
+        node.output[:] = ["detections" if name == output_name else name for name in node.output]
+    onnx.checker.check_model(result)
+    return result
+
+
+def reference_nms(raw, score_threshold, iou_threshold, max_det, pre_nms_top_k, agnostic):
+    """NumPy参考实现（与OutputDecoder一致，每个anchor只取最大分数的类别）：raw为单张图像的[4+C, A]。"""
+    boxes = raw[:4].T
+    scores = raw[4:]
+    classes = scores.argmax(axis=0)
+    best = scores.max(axis=0)
+    keep = np.nonzero(best > score_threshold)[0]
+    keep = keep[np.argsort(-best[keep], kind="stable")[:pre_nms_top_k]]
+    corners = np.stack([boxes[:, 0] - boxes[:, 2] / 2, boxes[:, 1] - boxes[:, 3] / 2,
+                        boxes[:, 0] + boxes[:, 2] / 2, boxes[:, 1] + boxes[:, 3] / 2], axis=1)
+    results = []
+    for c in ([None] if agnostic else range(scores.shape[0])):
+        if c is None:
+            candidates, candidate_scores = keep, best[keep]
+        else:
+            candidates = keep[classes[keep] == c]
+            candidate_scores = best[candidates]
+        order = candidates[np.argsort(-candidate_scores, kind="stable")]
+        while len(order) > 0:
+            i = order[0]
+            results.append((*corners[i], best[i], classes[i]))
+            rest = order[1:]
+            x1 = np.maximum(corners[i, 0], corners[rest, 0])
+            y1 = np.maximum(corners[i, 1], corners[rest, 1])
+            x2 = np.minimum(corners[i, 2], corners[rest, 2])
+            y2 = np.minimum(corners[i, 3], corners[rest, 3])
+            inter = np.clip(x2 - x1, 0, None) * np.clip(y2 - y1, 0, None)
+            area = (corners[:, 2] - corners[:, 0]) * (corners[:, 3] - corners[:, 1])
+            iou = inter / np.maximum(area[i] + area[rest] - inter, 1e-9)
+            order = rest[iou <= iou_threshold]
+    results.sort(key=lambda r: -r[4])
+    return np.array(results[:max_det], dtype=np.float32).reshape(-1, 6)
+
+
+def verify(original_path, end2end_path, args):
+    import onnxruntime as ort
+
+    original = ort.InferenceSession(original_path, providers=["CPUExecutionProvider"])
+    end2end = ort.InferenceSession(end2end_path, providers=["CPUExecutionProvider"])
+    feed = original.get_inputs()[0]
+    shape = [d if isinstance(d, int) and d > 0 else s for d, s in zip(feed.shape, [1, 3, 640, 640])]
+    rng = np.random.default_rng(0)
+
+    matched = 0
+    expected_total = 0
+    for _ in range(args.verify_images):
+        image = np.zeros(shape, dtype=np.float32)
+        for _ in range(20):
+            x, y = rng.integers(0, shape[3] - 32), rng.integers(0, shape[2] - 32)
+            w, h = rng.integers(16, shape[3] // 3), rng.integers(16, shape[2] // 3)
+            image[0, :, y:y + h, x:x + w] = rng.random((3, 1, 1))
+        raw = original.run(None, {feed.name: image})[0][0]
+        expected = reference_nms(raw, args.score_threshold, args.iou_threshold, args.max_det, args.pre_nms_top_k,
+                                 args.agnostic)
+        if args.postprocess_only:
+            actual = end2end.run(None, {end2end.get_inputs()[0].name: raw[np.newaxis]})[0]
+        else:
+            actual = end2end.run(None, {feed.name: image})[0]
+        # 同类别且坐标一致的框视为匹配（分数相同的候选在两边的先后顺序可能不同）
+        for row in expected:
+            same = (actual[:, 5] == row[5]) & (np.abs(actual[:, :4] - row[:4]).max(axis=1) < 1e-2)
+            matched += bool(same.any())
+        expected_total += len(expected)
+    return matched, expected_total
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--model", required=True, help="输出为[N, 4+C, A]的YOLOv8 ONNX模型")
+    parser.add_argument("--output", required=True, help="输出的端到端模型")
+    parser.add_argument("--score-threshold", type=float, default=0.25)
+    parser.add_argument("--iou-threshold", type=float, default=0.45)
+    parser.add_argument("--max-det", type=int, default=300, help="每张图像最多输出的检测数（也是每个类别的上限）")
+    parser.add_argument("--pre-nms-top-k", type=int, default=30000,
+                        help="进入NMS的候选anchor上限（与detection.nms_top_k对应）")
+    parser.add_argument("--agnostic", action="store_true", help="不区分类别执行NMS")
+    parser.add_argument("--postprocess-only", action="store_true", help="只导出后处理子图（输入为原始输出）")
+    parser.add_argument("--verify-images", type=int, default=4, help="验证使用的合成图像数")
+    parser.add_argument("--min-recall", type=float, default=0.99, help="相对参考NMS的最低召回率")
+    parser.add_argument("--no-verify", action="store_true")
+    args = parser.parse_args()
+
+    onnx.save(export(onnx.load(args.model), args), args.output)
+    print(f"Wrote {args.output}")
+    if args.no_verify:
+        return 0
+
+    matched, total = verify(args.model, args.output, args)
+    recall = matched / total if total else 1.0
+    print(f"Reference NMS agreement: {matched}/{total} detections ({recall:.4f})")
+    if recall < args.min_recall:
+        print("End-to-end output differs from the reference postprocessing", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
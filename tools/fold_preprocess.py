@@ -0,0 +1,150 @@
+"""把预处理并入YOLOv8 ONNX模型：输入改为letterbox后的 uint8 [N, H, W, 3] BGR 图像。
+
+在原模型输入之前插入：
+    Transpose(NHWC -> NCHW) -> Gather(BGR -> RGB) -> Cast(float) -> Div(255)
+转置和通道交换在uint8上完成，搬运的字节数只有float的1/4；之后的归一化由ORT的算子完成，
+ObjectDetector在 "input_format": "uint8_nhwc" 模式下把letterbox结果直接作为输入张量，不再做float转换。
+
+输入名称保持不变，batch/高/宽维度沿用原模型（动态维度仍为动态）。
+默认在若干合成图像（以及--images指定的图像）上对比新旧两条路径的输出：
+    旧：letterbox -> blobFromImage(1/255, swapRB) -> 原模型
+    新：letterbox -> 新模型
+差异超过容差时以非0状态退出。
+
+用法: python tools/fold_preprocess.py --model yolov8n.onnx --output yolov8n_u8.onnx [--images a.jpg b.jpg] [--no-verify]
+"""
+import argparse
+import sys
+
+import numpy as np
+import onnx
+from onnx import TensorProto, helper, numpy_helper
+
+
+def fold_preprocess(model):
+    graph = model.graph
+    initializer_names = {init.name for init in graph.initializer}
+    inputs = [value for value in graph.input if value.name not in initializer_names]
+    if len(inputs) != 1:
+        raise ValueError(f"expected exactly one image input, got {len(inputs)}")
+    image_input = inputs[0]
+    tensor_type = image_input.type.tensor_type
+    if tensor_type.elem_type == TensorProto.UINT8:
+        raise ValueError("model input is already uint8")
+    dims = list(tensor_type.shape.dim)
+    if len(dims) != 4 or (dims[1].HasField("dim_value") and dims[1].dim_value != 3):
+        raise ValueError("expected a [N, 3, H, W] image input")
+
+    name = image_input.name
+    float_name = f"{name}_preprocessed"
+    for node in graph.node:
+        for index, node_input in enumerate(node.input):
+            if node_input == name:
+                node.input[index] = float_name
+    for output in graph.output:
+        if output.name == name:
+            raise ValueError("image input is also a graph output")
+
+    # 新输入沿用原模型的batch/高/宽维度（包括动态维度名）
+    def copy_dim(dim):
+        return dim.dim_param if dim.HasField("dim_param") else (dim.dim_value if dim.HasField("dim_value") else None)
+
+    new_input = helper.make_tensor_value_info(
+        name, TensorProto.UINT8, [copy_dim(dims[0]), copy_dim(dims[2]), copy_dim(dims[3]), 3])
+
+    channel_order = numpy_helper.from_array(np.array([2, 1, 0], dtype=np.int64), f"{name}_rgb_order")
+    scale = numpy_helper.from_array(np.array(255.0, dtype=np.float32), f"{name}_scale")
+    nodes = [
+        helper.make_node("Transpose", [name], [f"{name}_nchw"], perm=[0, 3, 1, 2], name=f"{name}_to_nchw"),
+        helper.make_node("Gather", [f"{name}_nchw", channel_order.name], [f"{name}_rgb"], axis=1,
+                         name=f"{name}_bgr_to_rgb"),
+        helper.make_node("Cast", [f"{name}_rgb"], [f"{name}_float"], to=TensorProto.FLOAT, name=f"{name}_cast"),
+        helper.make_node("Div", [f"{name}_float", scale.name], [float_name], name=f"{name}_normalize"),
+    ]
+
+    graph.input.remove(image_input)
+    graph.input.insert(0, new_input)
+    graph.initializer.extend([channel_order, scale])
+    for node in reversed(nodes):
+        graph.node.insert(0, node)
+    onnx.checker.check_model(model)
+    return model
+
+
+def letterbox(image, width, height):
+    """与LetterboxPreprocessor::runBytes相同：等比缩放、居中、黑色填充。"""
+    import cv2
+
+    scale = min(width / image.shape[1], height / image.shape[0])
+    new_width = int(image.shape[1] * scale)
+    new_height = int(image.shape[0] * scale)
+    left = (width - new_width) // 2
+    top = (height - new_height) // 2
+    canvas = np.zeros((height, width, 3), dtype=np.uint8)
+    canvas[top:top + new_height, left:left + new_width] = cv2.resize(
+        image, (new_width, new_height), interpolation=cv2.INTER_LINEAR)
+    return canvas
+
+
+def verify(original_path, folded_path, image_paths, width, height):
+    import cv2
+    import onnxruntime as ort
+
+    original = ort.InferenceSession(original_path, providers=["CPUExecutionProvider"])
+    folded = ort.InferenceSession(folded_path, providers=["CPUExecutionProvider"])
+    input_name = original.get_inputs()[0].name
+
+    rng = np.random.default_rng(0)
+    images = [rng.integers(0, 256, size=(1080, 1920, 3), dtype=np.uint8),
+              rng.integers(0, 256, size=(480, 640, 3), dtype=np.uint8)]
+    for path in image_paths:
+        image = cv2.imread(path, cv2.IMREAD_COLOR)
+        if image is None:
+            raise ValueError(f"cannot read {path}")
+        images.append(image)
+
+    worst = 0.0
+    for image in images:
+        canvas = letterbox(image, width, height)
+        blob = cv2.dnn.blobFromImage(canvas, 1.0 / 255.0, (width, height), swapRB=True)
+        expected = original.run(None, {input_name: blob})
+        actual = folded.run(None, {input_name: canvas[np.newaxis]})
+        for e, a in zip(expected, actual):
+            # 相对输出幅值的最大误差，框坐标为像素尺度、分数在[0, 1]
+            error = float(np.max(np.abs(e - a)) / max(1.0, float(np.max(np.abs(e)))))
+            worst = max(worst, error)
+    return len(images), worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--model", required=True, help="float输入的YOLOv8 ONNX模型")
+    parser.add_argument("--output", required=True, help="输出的uint8 NHWC输入模型")
+    parser.add_argument("--images", nargs="*", default=[], help="额外用于等价性验证的图像")
+    parser.add_argument("--input-size", type=int, nargs=2, metavar=("W", "H"),
+                        help="验证使用的输入尺寸（模型高宽为动态时需要，默认取模型的静态尺寸或640x640）")
+    parser.add_argument("--tolerance", type=float, default=1e-4, help="相对输出幅值的最大允许误差")
+    parser.add_argument("--no-verify", action="store_true", help="跳过等价性验证")
+    args = parser.parse_args()
+
+    model = onnx.load(args.model)
+    dims = model.graph.input[0].type.tensor_type.shape.dim
+    static_height = dims[2].dim_value if len(dims) == 4 and dims[2].HasField("dim_value") else 640
+    static_width = dims[3].dim_value if len(dims) == 4 and dims[3].HasField("dim_value") else 640
+    onnx.save(fold_preprocess(model), args.output)
+    print(f"Wrote {args.output}")
+
+    if args.no_verify:
+        return 0
+    width, height = args.input_size if args.input_size else (static_width, static_height)
+    count, worst = verify(args.model, args.output, args.images, width, height)
+    print(f"Verified {count} image(s) at {width}x{height}: max relative error {worst:.3g} "
+          f"(tolerance {args.tolerance:g})")
+    if worst > args.tolerance:
+        print("Outputs differ from the float preprocessing path", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,78 @@
+"""生成用于测试与基准的微型YOLOv8风格ONNX模型。
+
+输入  images  [N, 3, H, W] float32（batch与尺寸均为动态，H/W需为32的倍数）
+输出  output0 [N, 4 + C, A]，A = (H/8)(W/8) + (H/16)(W/16) + (H/32)(W/32)，640x640时为8400
+
+每个尺度先做平均池化，再用1x1卷积映射到4+C个通道，经Sigmoid后
+框坐标乘以输入尺寸、类别分数保持在[0, 1]。权重固定随机种子，输出可复现。
+
+用法: python tools/make_tiny_model.py [--classes 80] [--output tests/data/tiny_yolov8.onnx]
+"""
+import argparse
+
+import numpy as np
+import onnx
+from onnx import TensorProto, helper, numpy_helper
+
+
+def build_model(num_classes, input_size, class_bias, seed):
+    rng = np.random.default_rng(seed)
+    channels = 4 + num_classes
+    nodes = []
+    initializers = []
+    branch_outputs = []
+
+    for stride in (8, 16, 32):
+        pooled = f"pool{stride}"
+        conv = f"conv{stride}"
+        flat = f"flat{stride}"
+        weight = rng.normal(0.0, 2.0, size=(channels, 3, 1, 1)).astype(np.float32)
+        bias = rng.normal(0.0, 0.5, size=(channels,)).astype(np.float32)
+        bias[4:] += class_bias
+        initializers.append(numpy_helper.from_array(weight, f"w{stride}"))
+        initializers.append(numpy_helper.from_array(bias, f"b{stride}"))
+        nodes.append(helper.make_node("AveragePool", ["images"], [pooled],
+                                      kernel_shape=[stride, stride], strides=[stride, stride]))
+        nodes.append(helper.make_node("Conv", [pooled, f"w{stride}", f"b{stride}"], [conv]))
+        nodes.append(helper.make_node("Reshape", [conv, "flat_shape"], [flat]))
+        branch_outputs.append(flat)
+
+    initializers.append(numpy_helper.from_array(np.array([0, channels, -1], dtype=np.int64), "flat_shape"))
+    scale = np.ones((1, channels, 1), dtype=np.float32)
+    scale[0, :4, 0] = input_size
+    initializers.append(numpy_helper.from_array(scale, "scale"))
+
+    nodes.append(helper.make_node("Concat", branch_outputs, ["concat"], axis=2))
+    nodes.append(helper.make_node("Sigmoid", ["concat"], ["sigmoid"]))
+    nodes.append(helper.make_node("Mul", ["sigmoid", "scale"], ["output0"]))
+
+    graph = helper.make_graph(
+        nodes,
+        "tiny_yolov8",
+        [helper.make_tensor_value_info("images", TensorProto.FLOAT, ["batch", 3, "height", "width"])],
+        [helper.make_tensor_value_info("output0", TensorProto.FLOAT, ["batch", channels, "anchors"])],
+        initializers,
+    )
+    model = helper.make_model(graph, opset_imports=[helper.make_opsetid("", 17)],
+                              producer_name="YoloV8Infer tools")
+    model.ir_version = 8
+    onnx.checker.check_model(model)
+    return model
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--classes", type=int, default=80)
+    parser.add_argument("--input-size", type=int, default=640, help="框坐标的缩放尺寸")
+    parser.add_argument("--class-bias", type=float, default=-6.0, help="类别通道偏置，越小候选越稀疏")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--output", default="tests/data/tiny_yolov8.onnx")
+    args = parser.parse_args()
+
+    model = build_model(args.classes, args.input_size, args.class_bias, args.seed)
+    onnx.save(model, args.output)
+    print(f"Saved {args.output} ({args.classes} classes)")
+
+
+if __name__ == "__main__":
+    main()
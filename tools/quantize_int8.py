@@ -0,0 +1,128 @@
+"""将FP32 YOLOv8 ONNX模型静态量化为QDQ格式的INT8模型。
+
+校准数据由 quantize_tool calibrate 生成（[N, 3, H, W] float32 的 .npy），
+与ObjectDetector使用同一letterbox预处理，保证校准分布与线上输入一致。
+
+- 权重：按通道对称INT8；激活：非对称UINT8（VNNI/AMX上由ORT融合为QLinearConv等整数算子）
+- 校准方法：entropy（KL散度，默认）、percentile（--percentile）、minmax
+- 默认保持输出头（从最后一层卷积到模型输出的Concat/Sigmoid/Mul等）为FP32，
+  这些节点计算量很小，但量化后会直接降低框坐标精度；--quantize-head 可关闭
+
+用法: python tools/quantize_int8.py --model yolov8n.onnx --calibration calib.npy --output yolov8n.int8.onnx
+      [--method entropy|percentile|minmax] [--percentile 99.999] [--batch 1] [--quantize-head]
+"""
+import argparse
+import os
+import tempfile
+
+import numpy as np
+import onnx
+from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat, QuantType,
+                                      quantize_static)
+from onnxruntime.quantization.shape_inference import quant_pre_process
+
+METHODS = {
+    "entropy": CalibrationMethod.Entropy,
+    "percentile": CalibrationMethod.Percentile,
+    "minmax": CalibrationMethod.MinMax,
+}
+
+# 这些算子本身有参数或计算量，输出头的回溯在此停止
+HEAD_BOUNDARY_OPS = {"Conv", "ConvTranspose", "MatMul", "Gemm"}
+
+
+class NpyCalibrationReader(CalibrationDataReader):
+    """按batch读取内存映射的校准张量，避免一次载入全部图像。"""
+
+    def __init__(self, path, input_name, batch):
+        self.data = np.load(path, mmap_mode="r")
+        if self.data.ndim != 4 or self.data.shape[1] != 3:
+            raise ValueError(f"{path}: expected [N, 3, H, W], got {self.data.shape}")
+        self.input_name = input_name
+        self.batch = batch
+        self.position = 0
+
+    def get_next(self):
+        if self.position >= len(self.data):
+            return None
+        chunk = np.ascontiguousarray(self.data[self.position:self.position + self.batch], dtype=np.float32)
+        self.position += self.batch
+        return {self.input_name: chunk}
+
+    def rewind(self):
+        self.position = 0
+
+
+def head_nodes(model):
+    """从模型输出向上回溯，直到遇到卷积/矩阵乘，返回途经的节点名称。"""
+    producers = {}
+    for node in model.graph.node:
+        for output in node.output:
+            producers[output] = node
+    excluded = set()
+    pending = [output.name for output in model.graph.output]
+    while pending:
+        node = producers.get(pending.pop())
+        if node is None or node.name in excluded or node.op_type in HEAD_BOUNDARY_OPS:
+            continue
+        excluded.add(node.name)
+        pending.extend(node.input)
+    return sorted(excluded)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--model", required=True, help="FP32 ONNX模型")
+    parser.add_argument("--calibration", required=True, help="quantize_tool calibrate生成的.npy")
+    parser.add_argument("--output", required=True, help="输出的INT8 QDQ模型")
+    parser.add_argument("--method", choices=sorted(METHODS), default="entropy")
+    parser.add_argument("--percentile", type=float, default=99.999, help="percentile校准使用的百分位")
+    parser.add_argument("--batch", type=int, default=1, help="每次校准推理的图像数（模型需支持动态batch）")
+    parser.add_argument("--quantize-head", action="store_true", help="同时量化输出头")
+    parser.add_argument("--skip-preprocess", action="store_true", help="跳过量化前的形状推断与图优化")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as workdir:
+        model_path = args.model
+        if not args.skip_preprocess:
+            # ONNX形状推断 + 图优化，使量化器能够覆盖全部算子（导出的YOLOv8无需符号形状推断）
+            model_path = os.path.join(workdir, "preprocessed.onnx")
+            quant_pre_process(args.model, model_path, skip_symbolic_shape=True)
+
+        model = onnx.load(model_path)
+        input_name = model.graph.input[0].name
+        # 量化器按名称排除节点，为未命名的节点补上名称
+        if any(not node.name for node in model.graph.node):
+            for index, node in enumerate(model.graph.node):
+                if not node.name:
+                    node.name = f"{node.op_type}_{index}"
+            model_path = os.path.join(workdir, "named.onnx")
+            onnx.save(model, model_path)
+        nodes_to_exclude = [] if args.quantize_head else head_nodes(model)
+        if nodes_to_exclude:
+            print(f"Keeping {len(nodes_to_exclude)} head node(s) in FP32: {', '.join(nodes_to_exclude)}")
+
+        reader = NpyCalibrationReader(args.calibration, input_name, max(1, args.batch))
+        print(f"Calibrating with {len(reader.data)} image(s), method {args.method}")
+        quantize_static(
+            model_path,
+            args.output,
+            reader,
+            quant_format=QuantFormat.QDQ,
+            activation_type=QuantType.QUInt8,
+            weight_type=QuantType.QInt8,
+            per_channel=True,
+            calibrate_method=METHODS[args.method],
+            nodes_to_exclude=nodes_to_exclude,
+            extra_options={
+                "CalibPercentile": args.percentile,
+                "WeightSymmetric": True,
+                "ActivationSymmetric": False,
+                "CalibTensorRangeSymmetric": False,
+            },
+        )
+    print(f"Wrote {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,382 @@
+#include "ObjectDetector.h"
+#include "JsonConfigManager.h"
+#include "LetterboxPreprocessor.h"
+#include "ImageSource.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+// INT8量化工具：
+//   calibrate  用与ObjectDetector相同的letterbox预处理生成校准张量（.npy，[N,3,H,W] float32）
+//   quantize   calibrate + 调用tools/quantize_int8.py生成QDQ INT8模型（静态校准）
+//   report     在验证集上对比FP32与INT8模型的推理延迟和检测一致性（以FP32结果为参照的召回率/IoU）
+//
+// 用法:
+//   quantize_tool calibrate <图像> <输出.npy> [--size 640x640] [--max-images 200]
+//   quantize_tool quantize <fp32.onnx> <图像> <int8.onnx> [--method entropy|percentile|minmax]
+//                 [--percentile 99.999] [--size 640x640] [--max-images 200] [--python python3]
+//   quantize_tool report <fp32.onnx> <int8.onnx> <图像> [--config 配置] [--size 640x640]
+//                 [--max-images 200] [--runs 3] [--iou 0.5]
+// <图像>可以是目录、通配符或列表文件（与--batch相同）
+
+#ifndef YOLO_TOOLS_DIR
+#define YOLO_TOOLS_DIR "tools"
+#endif
+
+namespace {
+
+struct ToolOptions {
+    cv::Size input_size{ 640, 640 };
+    int max_images = 200;
+    std::string method = "entropy";
+    std::string percentile = "99.999";
+    std::string python = "python3";
+    std::string config_path;
+    int runs = 3;
+    float match_iou = 0.5f;
+};
+
+bool parseSize(const std::string& text, cv::Size& size) {
+    int width = 0;
+    int height = 0;
+    char separator = 0;
+    std::istringstream stream(text);
+    if (!(stream >> width >> separator >> height) || (separator != 'x' && separator != 'X') ||
+        width <= 0 || height <= 0) {
+        return false;
+    }
+    size = cv::Size(width, height);
+    return true;
+}
+
+// 位置参数写入positional，其余按选项解析
+bool parseArguments(int argc, char* argv[], int first, std::vector<std::string>& positional, ToolOptions& options) {
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--size" && has_value) {
+            if (!parseSize(argv[++i], options.input_size)) {
+                spdlog::error("Invalid --size {}, expected WxH", argv[i]);
+                return false;
+            }
+        } else if (arg == "--max-images" && has_value) {
+            options.max_images = std::atoi(argv[++i]);
+        } else if (arg == "--method" && has_value) {
+            options.method = argv[++i];
+        } else if (arg == "--percentile" && has_value) {
+            options.percentile = argv[++i];
+        } else if (arg == "--python" && has_value) {
+            options.python = argv[++i];
+        } else if (arg == "--config" && has_value) {
+            options.config_path = argv[++i];
+        } else if (arg == "--runs" && has_value) {
+            options.runs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--iou" && has_value) {
+            options.match_iou = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg.rfind("--", 0) == 0) {
+            spdlog::error("Unknown option {}", arg);
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    return true;
+}
+
+// 写入NumPy .npy v1.0文件头；头部固定128字节，图像数在写完数据后回填
+void writeNpyHeader(std::ostream& out, int count, const cv::Size& size) {
+    std::string header = "{'descr': '<f4', 'fortran_order': False, 'shape': (" + std::to_string(count) +
+                         ", 3, " + std::to_string(size.height) + ", " + std::to_string(size.width) + "), }";
+    const size_t total = 128;
+    const size_t prefix = 10;  // 魔数(6) + 版本(2) + 头长度(2)
+    header.resize(total - prefix - 1, ' ');
+    header += '\n';
+    out.seekp(0);
+    out.write("\x93NUMPY\x01\x00", 8);
+    uint16_t length = static_cast<uint16_t>(header.size());
+    char length_bytes[2] = { static_cast<char>(length & 0xFF), static_cast<char>(length >> 8) };
+    out.write(length_bytes, 2);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+}
+
+int calibrate(const std::string& images_spec, const std::string& output_path, const ToolOptions& options) {
+    ImageSource images;
+    if (!images.open(images_spec)) {
+        spdlog::error("Cannot enumerate calibration images: {}", images_spec);
+        return 1;
+    }
+    std::ofstream out(output_path, std::ios::binary);
+    if (!out.is_open()) {
+        spdlog::error("Cannot write calibration tensor: {}", output_path);
+        return 1;
+    }
+
+    // 与ObjectDetector::detect相同的融合letterbox预处理，校准数据的分布与线上输入一致
+    LetterboxPreprocessor preprocessor;
+    std::vector<float> tensor(static_cast<size_t>(3) * options.input_size.area());
+    writeNpyHeader(out, 0, options.input_size);
+    int count = 0;
+    std::string path;
+    while ((options.max_images <= 0 || count < options.max_images) && images.next(path)) {
+        cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+        if (image.empty()) {
+            spdlog::warn("Skipping unreadable image {}", path);
+            continue;
+        }
+        preprocessor.run(image, options.input_size, tensor.data());
+        out.write(reinterpret_cast<const char*>(tensor.data()),
+                  static_cast<std::streamsize>(tensor.size() * sizeof(float)));
+        ++count;
+    }
+    if (count == 0) {
+        spdlog::error("No calibration images found in {}", images_spec);
+        return 1;
+    }
+    writeNpyHeader(out, count, options.input_size);
+    out.close();
+    if (!out) {
+        spdlog::error("Failed to write calibration tensor: {}", output_path);
+        return 1;
+    }
+    spdlog::info("Wrote {} calibration images ({}x{}) to {}", count, options.input_size.width,
+                 options.input_size.height, output_path);
+    return 0;
+}
+
+int quantize(const std::string& model_path, const std::string& images_spec, const std::string& output_path,
+             const ToolOptions& options) {
+    std::string calibration_path = output_path + ".calib.npy";
+    if (calibrate(images_spec, calibration_path, options) != 0) {
+        return 1;
+    }
+
+    // 量化本身由onnxruntime.quantization完成（ORT的C++ API不提供量化器）
+    std::string script = std::string(YOLO_TOOLS_DIR) + "/quantize_int8.py";
+    std::string command = options.python + " \"" + script + "\" --model \"" + model_path +
+                          "\" --calibration \"" + calibration_path + "\" --output \"" + output_path +
+                          "\" --method " + options.method + " --percentile " + options.percentile;
+    spdlog::info("Running: {}", command);
+    int status = std::system(command.c_str());
+    std::remove(calibration_path.c_str());
+    if (status != 0) {
+        spdlog::error("Quantization script failed with status {}", status);
+        return 1;
+    }
+    spdlog::info("INT8 model written to {}", output_path);
+    return 0;
+}
+
+float boxIou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = static_cast<float>((a & b).area());
+    float uni = static_cast<float>(a.area() + b.area()) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+double percentile(std::vector<double> values, double q) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(q * (values.size() - 1) + 0.5));
+    return values[index];
+}
+
+double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+bool initializeDetector(ObjectDetector& detector, const std::string& model_path, const ToolOptions& options) {
+    if (!options.config_path.empty()) {
+        // 沿用配置中的线程数、阈值与类别，只替换模型路径
+        JsonConfigManager config_manager(options.config_path);
+        if (!config_manager.loadConfig()) {
+            return false;
+        }
+        ModelConfig model_config = config_manager.getModelConfig();
+        model_config.path = model_path;
+        model_config.precision = "fp32";
+        model_config.optimized_model_path.clear();
+        model_config.warmup_runs = std::max(model_config.warmup_runs, 3);
+        config_manager.setModelConfig(model_config);
+        return detector.initialize(config_manager);
+    }
+    detector.setInputSize(options.input_size.width, options.input_size.height);
+    std::vector<std::string> class_names;
+    for (int i = 0; i < 80; ++i) {
+        class_names.push_back(std::to_string(i));
+    }
+    detector.setClassNames(class_names);
+    detector.setConfidenceThreshold(0.25f);
+    detector.setNMSThreshold(0.45f);
+    return detector.initialize(model_path);
+}
+
+// 对单个模型执行runs次推理，返回最小耗时（毫秒）并解码最后一次的输出
+double inferAndDecode(ObjectDetector& detector, const float* tensor, const cv::Size& image_size, int runs,
+                      std::vector<float>& output, std::vector<int64_t>& output_shape,
+                      std::vector<DetectionResult>& results) {
+    double best_ms = 0.0;
+    for (int run = 0; run < runs; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        if (!detector.infer(tensor, output, output_shape)) {
+            return -1.0;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best_ms = run == 0 ? ms : std::min(best_ms, ms);
+    }
+    if (!detector.postprocessOutput(output.data(), output_shape, image_size, results)) {
+        return -1.0;
+    }
+    return best_ms;
+}
+
+int report(const std::string& fp32_path, const std::string& int8_path, const std::string& images_spec,
+           ToolOptions options) {
+    ObjectDetector fp32_detector;
+    ObjectDetector int8_detector;
+    if (!initializeDetector(fp32_detector, fp32_path, options) ||
+        !initializeDetector(int8_detector, int8_path, options)) {
+        spdlog::error("Failed to load models");
+        return 1;
+    }
+    options.input_size = fp32_detector.getInputSize();
+
+    ImageSource images;
+    if (!images.open(images_spec)) {
+        spdlog::error("Cannot enumerate validation images: {}", images_spec);
+        return 1;
+    }
+
+    LetterboxPreprocessor preprocessor;
+    std::vector<float> tensor(static_cast<size_t>(3) * options.input_size.area());
+    std::vector<float> output;
+    std::vector<int64_t> output_shape;
+    std::vector<DetectionResult> fp32_results;
+    std::vector<DetectionResult> int8_results;
+    std::vector<double> fp32_ms;
+    std::vector<double> int8_ms;
+    size_t fp32_boxes = 0;
+    size_t int8_boxes = 0;
+    size_t matched = 0;
+    double iou_sum = 0.0;
+    double confidence_delta_sum = 0.0;
+
+    auto level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::warn);
+    std::string path;
+    int count = 0;
+    while ((options.max_images <= 0 || count < options.max_images) && images.next(path)) {
+        cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+        if (image.empty()) {
+            continue;
+        }
+        preprocessor.run(image, options.input_size, tensor.data());
+        double fp32 = inferAndDecode(fp32_detector, tensor.data(), image.size(), options.runs, output,
+                                     output_shape, fp32_results);
+        double int8 = inferAndDecode(int8_detector, tensor.data(), image.size(), options.runs, output,
+                                     output_shape, int8_results);
+        if (fp32 < 0.0 || int8 < 0.0) {
+            spdlog::warn("Inference failed on {}", path);
+            continue;
+        }
+        fp32_ms.push_back(fp32);
+        int8_ms.push_back(int8);
+        ++count;
+
+        // 以FP32结果为参照：同类别IoU最大者贪心匹配，IoU >= match_iou视为一致
+        std::vector<bool> used(int8_results.size(), false);
+        for (const auto& reference : fp32_results) {
+            int best = -1;
+            float best_iou = 0.0f;
+            for (size_t j = 0; j < int8_results.size(); ++j) {
+                if (used[j] || int8_results[j].class_id != reference.class_id) {
+                    continue;
+                }
+                float value = boxIou(reference.box, int8_results[j].box);
+                if (value > best_iou) {
+                    best_iou = value;
+                    best = static_cast<int>(j);
+                }
+            }
+            if (best >= 0 && best_iou >= options.match_iou) {
+                used[best] = true;
+                ++matched;
+                iou_sum += best_iou;
+                confidence_delta_sum += std::abs(reference.confidence - int8_results[best].confidence);
+            }
+        }
+        fp32_boxes += fp32_results.size();
+        int8_boxes += int8_results.size();
+    }
+    spdlog::set_level(level);
+
+    if (count == 0) {
+        spdlog::error("No validation images processed from {}", images_spec);
+        return 1;
+    }
+
+    spdlog::info("Validation images: {} ({}x{} input, best of {} runs per image)", count,
+                 options.input_size.width, options.input_size.height, options.runs);
+    spdlog::info("{:<6} {:>10} {:>10} {:>10}", "model", "mean ms", "p50 ms", "p99 ms");
+    spdlog::info("{:<6} {:>10.3f} {:>10.3f} {:>10.3f}", "fp32", mean(fp32_ms), percentile(fp32_ms, 0.5),
+                 percentile(fp32_ms, 0.99));
+    spdlog::info("{:<6} {:>10.3f} {:>10.3f} {:>10.3f}", "int8", mean(int8_ms), percentile(int8_ms, 0.5),
+                 percentile(int8_ms, 0.99));
+    spdlog::info("Speedup: {:.2f}x", mean(int8_ms) > 0.0 ? mean(fp32_ms) / mean(int8_ms) : 0.0);
+    spdlog::info("Boxes: fp32 {}, int8 {}, matched {} (IoU >= {:.2f})", fp32_boxes, int8_boxes, matched,
+                 options.match_iou);
+    spdlog::info("Recall vs fp32: {:.4f}, precision vs fp32: {:.4f}",
+                 fp32_boxes > 0 ? static_cast<double>(matched) / fp32_boxes : 1.0,
+                 int8_boxes > 0 ? static_cast<double>(matched) / int8_boxes : 1.0);
+    spdlog::info("Mean IoU of matches: {:.4f}, mean |confidence delta|: {:.4f}",
+                 matched > 0 ? iou_sum / matched : 0.0, matched > 0 ? confidence_delta_sum / matched : 0.0);
+    return 0;
+}
+
+void printUsage(const char* program) {
+    spdlog::error("Usage:");
+    spdlog::error("  {} calibrate <images> <output.npy> [--size WxH] [--max-images N]", program);
+    spdlog::error("  {} quantize <fp32.onnx> <images> <int8.onnx> [--method entropy|percentile|minmax] "
+                  "[--percentile P] [--size WxH] [--max-images N] [--python exe]", program);
+    spdlog::error("  {} report <fp32.onnx> <int8.onnx> <images> [--config file] [--size WxH] "
+                  "[--max-images N] [--runs R] [--iou T]", program);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string mode = argv[1];
+    std::vector<std::string> positional;
+    ToolOptions options;
+    if (!parseArguments(argc, argv, 2, positional, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (mode == "calibrate" && positional.size() == 2) {
+        return calibrate(positional[0], positional[1], options);
+    }
+    if (mode == "quantize" && positional.size() == 3) {
+        return quantize(positional[0], positional[1], positional[2], options);
+    }
+    if (mode == "report" && positional.size() == 3) {
+        return report(positional[0], positional[1], positional[2], options);
+    }
+    printUsage(argv[0]);
+    return 1;
+}